@@ -1,4 +1,5 @@
 #include <iostream>
+#include <chrono>
 #include <Math/Shapes/AABB.h>
 #include <Core/Transform.h>
 #include <ECS/ECS.h>
@@ -46,9 +47,9 @@ int main(int argc, char* argv[]) {
     auto& ovIn = overworld.addStage<LevelInStage>();
     auto& renIn = renderer.addStage<RendererInStage>();
 
-    overworld.addStage<PhysicsStage>();
+    auto& physics = overworld.addStage<PhysicsStage>();
 
-    overworld.addStage<LevelOutStage>(&renIn.proxy, &renderer); // overworldOut writes to RendererIn
+    overworld.addStage<LevelOutStage>(&renIn.proxy, &renderer, &physics.timestep); // overworldOut writes to RendererIn
     renderer.addStage<ForwardRenderStage>();
     renderer.addStage<LevelOutStage>(&ovIn.proxy, &overworld); // rendererOut writes to OverworldIn
 
@@ -57,6 +58,7 @@ int main(int argc, char* argv[]) {
     auto owAssembler = overworld.createSystemAssembler<ECSStageDetector, OverworldStages>();
     owAssembler.addSystem<InputSystem::InputReceiver>();
     owAssembler.addSystem<PlayerController>();
+    owAssembler.addSystem<PhysicsHistorySystem>();
     owAssembler.addSystem<MovementSystem>();
     owAssembler.addSystem<ChangeListener>();
     owAssembler.addSystem<SlowdownSystem>();
@@ -110,16 +112,31 @@ int main(int argc, char* argv[]) {
     params.name = "Zombie";
     params.flipTextureUV = true;
     params.bakeTransforms = true;
-    auto zombie = s.loadModel(params);
-    auto e = overworld.createEntity(Model(zombie), Transform(glm::vec3(90, 0, 0)));
+    // imported on a worker, the model is registered by the loader's onLevelOut once it is ready
+    s.loadModelAsync(params);
+    bool zombieSpawned = false;
 
-    for (auto& node : zombie->nodes) {
-        std::cout << node.name << std::endl;
-        std::cout << "  : " << node.localTransform << std::endl;
-    }
     size_t i = 0;
+    auto frameStart = std::chrono::steady_clock::now();
     while (true) {
+        const auto now = std::chrono::steady_clock::now();
+        const uint32_t steps = physics.timestep.advance(std::chrono::duration<double>(now - frameStart).count());
+        frameStart = now;
+
+        for (uint32_t step = 0; step < steps; ++step) {
+            overworld.run<PhysicsStage>();
+        }
         overworld.run();
+
+        if (!zombieSpawned) {
+            if (const auto* zombie = s.findModel(params.name)) {
+                overworld.createEntity(Model(zombie), Transform(glm::vec3(90, 0, 0)));
+                zombieSpawned = true;
+            } else if (!s.isLoading()) {
+                std::cerr << "Failed to load " << params.path << std::endl;
+                zombieSpawned = true;
+            }
+        }
         renderer.run();
         app.onUpdate();
     }
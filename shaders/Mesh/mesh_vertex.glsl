@@ -5,13 +5,18 @@ layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
 layout (location = 3) in vec3 aTangent;
 layout (location = 4) in vec3 aBitangent;
+layout (location = 5) in ivec4 aBoneIds;
+layout (location = 6) in vec4 aWeights;
 
 out vec2 TexCoords;
 out vec3 Normal;
 out vec3 WorldPos;
 
+const uint NO_PALETTE = 0xffffffffu;
+
 struct Instance {
-    mat4 model;
+    uint matrix;
+    uint palette;
 };
 
 layout(std140, binding = 0) uniform GlobalTransforms {
@@ -21,17 +26,38 @@ layout(std140, binding = 0) uniform GlobalTransforms {
     vec3 camera_pos;
 };
 
-layout(std430, binding = 1) buffer InstanceData {
+layout(std430, binding = 1) readonly buffer NodeMatrices {
+    mat4 matrices[];
+};
+
+layout(std430, binding = 2) readonly buffer InstanceData {
     Instance instances[];
 };
 
-uniform int index;
+// the skinning matrices of every skinned instance this frame, each instance's bones from its palette offset on
+layout(std430, binding = 3) readonly buffer BonePalettes {
+    mat4 palettes[];
+};
 
-uniform mat4 matrices[10];
+mat4 skinOf(uint palette) {
+    mat4 skin = mat4(0.0);
+    float total = 0.0;
+    for (int i = 0; i < 4; ++i) {
+        // unused influences keep the bone id -1
+        if (aBoneIds[i] < 0) continue;
+        skin += palettes[palette + uint(aBoneIds[i])] * aWeights[i];
+        total += aWeights[i];
+    }
+    return total > 0.0 ? skin : mat4(1.0);
+}
 
 void main() {
     TexCoords = aTexCoords;
-    mat4 model = matrices[index];
+    Instance instance = instances[gl_BaseInstance + gl_InstanceID];
+    mat4 model = matrices[instance.matrix];
+    if (instance.palette != NO_PALETTE) {
+        model = model * skinOf(instance.palette);
+    }
     WorldPos = vec3(model * vec4(aPos, 1.0));
     gl_Position = projection3D * view * vec4(WorldPos, 1.0);
 
@@ -1,4 +1,6 @@
 #pragma once
+#include <bitset>
+
 #include "ECS/Component/Component.h"
 #include "Math/BoundingVolumeHierarchy.h"
 #include "Math/Shapes/AABB.h"
@@ -161,5 +163,7 @@ struct RigidBody : PrimaryComponent {
     float damping = 5.f;
     bool onGround = false;
     float maxVelocity = 0.1f;
+    float restitution = 0.f;
+    float friction = 0.5f;
 };
 
@@ -2,6 +2,7 @@
 #include <ECS/ECS.h>
 
 #include "PhysicsStage.h"
+#include "ContactSolver.h"
 
 struct CollisionScanners : SystemPack {
     struct AABBScanner :
@@ -71,35 +72,82 @@ struct CollisionNarrowPhase : SystemPack {
         float distance = 0.f;
     };
 
+    /* resolves the broad phase candidates as contacts, see ContactSolver */
     struct AABBResolver :
         PhysicsSystem,
         ReadsResources<TerrainWorld>,
         Pipeline<CollisionNarrowPhase>,
-        Reads<Transform, Collider, AABBCollision>
+        Reads<AABBCollision, StaticCollider>,
+        Writes<Transform, Velocity, RigidBody>
     {
-        static auto make_collision(Entity first, Entity second, glm::vec3 mtv, glm::vec3 contactNormal, float distance) {
-            return Collision{ first, second, mtv, contactNormal, distance };
-        }
+        /* a body counts as standing on a contact whose normal points up at least this much */
+        static constexpr float GROUND_NORMAL = 0.7f;
 
-        static ecs::frame_vector<Collision> onPhysicsUpdate(PhysicsView<AABBResolver> view, In<CollisionScanners::AABBScanner> candidates) {
-            auto& world = view.get<TerrainWorld>();
+        ContactSolver solver;
 
+        ecs::frame_vector<Collision> onPhysicsUpdate(PhysicsView<AABBResolver> view, In<CollisionScanners::AABBScanner> candidates) {
             auto collisions = view.allocate<std::vector, Collision>(candidates->size());
 
+            view.query<RigidBody>().forEach([](const Entity e, RigidBody& body) {
+                body.onGround = false;
+            });
+
+            std::vector<Entity> entities;
+            std::vector<ContactBody> bodies;
+            std::vector<ContactSolver::Pair> pairs;
+            std::unordered_map<Entity, uint32_t> indexOf;
+
+            auto bodyOf = [&](const Entity e, const AABBCollision& aabb) {
+                const auto [it, inserted] = indexOf.try_emplace(e, static_cast<uint32_t>(bodies.size()));
+                if (!inserted) return it->second;
+
+                ContactBody& body = bodies.emplace_back();
+                body.box = aabb.world(*view.get<Transform>(e));
+
+                const auto* velocity = view.get<Velocity>(e);
+                const auto* rigidBody = view.get<RigidBody>(e);
+                if (rigidBody) {
+                    body.restitution = rigidBody->restitution;
+                    body.friction = rigidBody->friction;
+                }
+                if (velocity && rigidBody && !view.has<StaticCollider>(e) && rigidBody->mass > 0.f) {
+                    body.velocity = *velocity;
+                    body.inverseMass = 1.f / rigidBody->mass;
+                }
+                entities.push_back(e);
+                return it->second;
+            };
+
             for (const auto& [candidate, target] : *candidates) {
-                if (const auto AABB = view.get<AABBCollision>(target)) {
-                    auto targetWorldAABB = AABB->world(*view.get<Transform>(target));
-                    auto [mtv, depth] = geom::mtv(candidate.worldAABB, targetWorldAABB);
+                const auto* first = view.get<AABBCollision>(candidate.entity);
+                const auto* second = view.get<AABBCollision>(target);
+                if (!first || !second) continue;
+
+                pairs.push_back({ bodyOf(candidate.entity, *first), bodyOf(target, *second), candidate.entity, target });
+            }
+
+            std::vector<glm::vec3> centers(bodies.size());
+            for (size_t i = 0; i < bodies.size(); ++i) {
+                centers[i] = bodies[i].box.center;
+            }
 
-                    glm::vec3 contactNormal = glm::length2(mtv) > 1e-6f ? glm::normalize(mtv) : glm::vec3(0.0f);
-                    collisions.emplace_back(candidate.entity, target, mtv, contactNormal, depth);
+            // solved even without pairs, so contacts that ended this step leave the cache
+            for (const auto& contact : solver.solve(bodies, pairs, view.getStep())) {
+                collisions.emplace_back(entities[contact.first], entities[contact.second], contact.normal * contact.depth, contact.normal, contact.depth);
 
-                    if (view.has<PlayerComponent>(target) || view.has<PlayerComponent>(candidate.entity)) {
-                        std::cout << "PLAYER COLLISION " << std::endl;
-                    }
-                    std::cout << "COLLISION " << target << " " << candidate.entity << std::endl;
+                if (contact.normal.y >= GROUND_NORMAL) {
+                    if (auto* body = view.get<RigidBody>(entities[contact.first])) body->onGround = true;
+                } else if (-contact.normal.y >= GROUND_NORMAL) {
+                    if (auto* body = view.get<RigidBody>(entities[contact.second])) body->onGround = true;
                 }
             }
+
+            for (size_t i = 0; i < bodies.size(); ++i) {
+                if (bodies[i].inverseMass <= 0.f) continue;
+
+                view.get<Transform>(entities[i])->translation += bodies[i].box.center - centers[i];
+                *view.get<Velocity>(entities[i]) = bodies[i].velocity;
+            }
             return collisions;
         }
     };
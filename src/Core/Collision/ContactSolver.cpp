@@ -0,0 +1,138 @@
+#include "ContactSolver.h"
+
+#include <cmath>
+#include <algorithm>
+#include <glm/geometric.hpp>
+
+namespace {
+    /* cached impulses are reused while the normal stays within about 25 degrees */
+    constexpr float WARM_START_ALIGNMENT = 0.9f;
+
+    void applyImpulse(ContactBody& first, ContactBody& second, const glm::vec3& impulse) {
+        first.velocity += impulse * first.inverseMass;
+        second.velocity -= impulse * second.inverseMass;
+    }
+}
+
+std::span<const ContactSolver::Contact> ContactSolver::solve(const std::span<ContactBody> bodies, const std::span<const Pair> pairs, const float seconds) {
+    ++step;
+    contacts.clear();
+    constraints.clear();
+    keys.clear();
+    velocities.clear();
+    for (const ContactBody& body : bodies) {
+        velocities.push_back(body.velocity);
+    }
+
+    for (const Pair& pair : pairs) {
+        ContactBody& first = bodies[pair.first];
+        ContactBody& second = bodies[pair.second];
+
+        const float inverseMassSum = first.inverseMass + second.inverseMass;
+        if (inverseMassSum <= 0.f) continue;
+
+        const glm::vec3 delta = first.box.center - second.box.center;
+        const glm::vec3 overlap = first.box.halfSize + second.box.halfSize - glm::abs(delta);
+        if (overlap.x <= 0.f || overlap.y <= 0.f || overlap.z <= 0.f) continue;
+
+        // the axis of least penetration, as geom::mtv picks it
+        const int axis = overlap.x < overlap.y && overlap.x < overlap.z ? 0 : overlap.y < overlap.z ? 1 : 2;
+
+        Contact& contact = contacts.emplace_back();
+        contact.first = pair.first;
+        contact.second = pair.second;
+        contact.normal = glm::vec3(0.f);
+        contact.normal[axis] = delta[axis] < 0.f ? -1.f : 1.f;
+        contact.depth = overlap[axis];
+        contact.point = (glm::max(first.box.min(), second.box.min()) + glm::min(first.box.max(), second.box.max())) * 0.5f;
+
+        // keyed in a fixed order since the broad phase may report a pair either way round, cached vectors point the key's way
+        const bool ordered = !(pair.secondEntity < pair.firstEntity);
+        const float sign = ordered ? 1.f : -1.f;
+        const auto& key = keys.emplace_back(ordered ? pair.firstEntity : pair.secondEntity, ordered ? pair.secondEntity : pair.firstEntity);
+
+        const float closing = glm::dot(first.velocity - second.velocity, contact.normal);
+        const float restitution = std::max(first.restitution, second.restitution);
+        constraints.push_back({
+            inverseMassSum,
+            closing < -settings.restitutionThreshold ? -restitution * closing : 0.f,
+            std::sqrt(first.friction * second.friction),
+            sign,
+            0.f
+        });
+
+        if (const auto it = cache.find(key); it != cache.end()) {
+            if (glm::dot(it->second.normal * sign, contact.normal) > WARM_START_ALIGNMENT) {
+                contact.normalImpulse = it->second.normalImpulse;
+                contact.tangentImpulse = it->second.tangentImpulse * sign;
+                applyImpulse(first, second, contact.normal * contact.normalImpulse + contact.tangentImpulse);
+            }
+        }
+    }
+
+    for (uint32_t iteration = 0; iteration < settings.iterations; ++iteration) {
+        for (size_t i = 0; i < contacts.size(); ++i) {
+            Contact& contact = contacts[i];
+            const Constraint& constraint = constraints[i];
+            ContactBody& first = bodies[contact.first];
+            ContactBody& second = bodies[contact.second];
+
+            // normal impulses only ever push, their sum is clamped rather than each iteration's share
+            const float normalVelocity = glm::dot(first.velocity - second.velocity, contact.normal);
+            const float normalImpulse = std::max(contact.normalImpulse + (constraint.bounce - normalVelocity) / constraint.inverseMassSum, 0.f);
+            applyImpulse(first, second, contact.normal * (normalImpulse - contact.normalImpulse));
+            contact.normalImpulse = normalImpulse;
+
+            // friction opposes the sliding velocity, bounded by the Coulomb cone of the normal impulse
+            const glm::vec3 relative = first.velocity - second.velocity;
+            const glm::vec3 sliding = relative - contact.normal * glm::dot(relative, contact.normal);
+            glm::vec3 tangentImpulse = contact.tangentImpulse - sliding / constraint.inverseMassSum;
+
+            const float maxFriction = constraint.friction * contact.normalImpulse;
+            if (const float length = glm::length(tangentImpulse); length > maxFriction) {
+                tangentImpulse *= length > 0.f ? maxFriction / length : 0.f;
+            }
+            applyImpulse(first, second, tangentImpulse - contact.tangentImpulse);
+            contact.tangentImpulse = tangentImpulse;
+        }
+    }
+
+    // along the contact planes only, into and out of a contact the position pass below is the correction
+    planes.assign(bodies.size(), glm::vec3(1.f));
+    for (const Contact& contact : contacts) {
+        const glm::vec3 tangent = glm::vec3(1.f) - glm::abs(contact.normal);
+        planes[contact.first] *= tangent;
+        planes[contact.second] *= tangent;
+    }
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        bodies[i].box.center += (bodies[i].velocity - velocities[i]) * planes[i] * seconds;
+    }
+
+    // the depth is measured again every pass, a body pushed out of one contact may be pushed into the next
+    for (size_t i = 0; i < contacts.size(); ++i) {
+        constraints[i].separation = glm::dot(bodies[contacts[i].first].box.center - bodies[contacts[i].second].box.center, contacts[i].normal);
+    }
+    for (uint32_t iteration = 0; iteration < settings.positionIterations; ++iteration) {
+        for (size_t i = 0; i < contacts.size(); ++i) {
+            const Contact& contact = contacts[i];
+            ContactBody& first = bodies[contact.first];
+            ContactBody& second = bodies[contact.second];
+
+            const float separation = glm::dot(first.box.center - second.box.center, contact.normal);
+            const float depth = contact.depth + constraints[i].separation - separation;
+            const float correction = std::max(depth - settings.slop, 0.f) * settings.correction / constraints[i].inverseMassSum;
+            first.box.center += contact.normal * (correction * first.inverseMass);
+            second.box.center -= contact.normal * (correction * second.inverseMass);
+        }
+    }
+
+    for (size_t i = 0; i < contacts.size(); ++i) {
+        const Contact& contact = contacts[i];
+        const float sign = constraints[i].keySign;
+        cache[keys[i]] = Cached{ contact.normal * sign, contact.normalImpulse, contact.tangentImpulse * sign, step };
+    }
+    std::erase_if(cache, [&](const auto& entry) {
+        return entry.second.step != step;
+    });
+    return contacts;
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <unordered_map>
+#include <glm/vec3.hpp>
+#include <ECS/Entity/Entity.h>
+
+#include "Math/Shapes/AABB.h"
+
+/* a box collider as the solver sees it, static bodies have no inverse mass */
+struct ContactBody {
+    AABB box;
+    glm::vec3 velocity = glm::vec3(0.f);
+    float inverseMass = 0.f;
+    float restitution = 0.f;
+    float friction = 0.5f;
+};
+
+/*
+ * Sequential impulse solver for axis aligned boxes. Every overlapping pair becomes a manifold along the axis
+ * of least penetration, the bodies carry no rotation so one point at the center of the overlap describes it.
+ * The accumulated normal and friction impulses of a pair are kept between steps and applied up front the next
+ * time the pair touches along the same normal, so resting contacts start from the impulse that held them.
+ * Velocities are solved first, then what penetration is left beyond `slop` is pushed apart.
+ */
+class ContactSolver {
+public:
+    struct Settings {
+        uint32_t iterations = 8;
+        uint32_t positionIterations = 4;
+        /* penetration left in place, so resting contacts keep overlapping and stay cached */
+        float slop = 0.005f;
+        /* share of the remaining penetration corrected per step */
+        float correction = 0.8f;
+        /* closing speeds below this do not bounce */
+        float restitutionThreshold = 0.05f;
+    };
+
+    struct Pair {
+        uint32_t first, second;
+        Entity firstEntity, secondEntity;
+    };
+
+    struct Contact {
+        uint32_t first, second;
+        glm::vec3 normal;       /* from second to first */
+        glm::vec3 point;
+        float depth = 0;
+        float normalImpulse = 0;
+        glm::vec3 tangentImpulse = glm::vec3(0.f);
+    };
+
+    ContactSolver() = default;
+    explicit ContactSolver(const Settings& settings) : settings(settings) {}
+
+    /*
+     * moves and accelerates `bodies` apart, returns the contacts of the step. Bodies that already moved `seconds`
+     * at their velocity are moved again by what the contacts changed of it along their contact planes,
+     * as if friction had acted before the move, so a box that friction holds does not creep a step at a time.
+     */
+    std::span<const Contact> solve(std::span<ContactBody> bodies, std::span<const Pair> pairs, float seconds = 0.f);
+
+    size_t cachedContacts() const {
+        return cache.size();
+    }
+private:
+    struct PairHash {
+        size_t operator()(const std::pair<Entity, Entity>& pair) const {
+            const size_t h = std::hash<Entity>{}(pair.first);
+            return h ^ (std::hash<Entity>{}(pair.second) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2));
+        }
+    };
+
+    struct Cached {
+        glm::vec3 normal;
+        float normalImpulse;
+        glm::vec3 tangentImpulse;
+        uint64_t step;
+    };
+
+    struct Constraint {
+        float inverseMassSum;
+        float bounce;
+        float friction;
+        float keySign;
+        float separation;   /* of the centers along the normal when the contact was found */
+    };
+
+    Settings settings;
+    std::unordered_map<std::pair<Entity, Entity>, Cached, PairHash> cache;
+    std::vector<Contact> contacts;
+    std::vector<Constraint> constraints;
+    std::vector<std::pair<Entity, Entity>> keys;
+    std::vector<glm::vec3> velocities;
+    std::vector<glm::vec3> planes;
+    uint64_t step = 0;
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+/*
+ * Accumulates frame time and hands it out as whole physics steps of a fixed length. Frames that take too long
+ * run at most `maxSubSteps` steps and drop the rest of their time, so a slow frame cannot make the next one
+ * slower still. What is left over is `getAlpha()` of a step, how far rendering should blend from the previous
+ * physics state to the current one.
+ *
+ * The step count of every frame can be recorded and replayed, which together with the frame's input replays
+ * a session step for step, independent of how long the frames took.
+ */
+class FixedTimestep {
+public:
+    struct Settings {
+        float rate = 60.f;
+        uint32_t maxSubSteps = 4;
+    };
+
+    FixedTimestep() = default;
+    explicit FixedTimestep(const Settings& settings) : settings(settings) {}
+
+    /* takes effect from the next step, the time already accumulated is kept */
+    void setSettings(const Settings& newSettings) {
+        settings = newSettings;
+        accumulator = std::min(accumulator, static_cast<double>(getStep()));
+    }
+
+    const Settings& getSettings() const {
+        return settings;
+    }
+
+    float getStep() const {
+        return 1.f / settings.rate;
+    }
+
+    /* the number of steps to run for a frame that took `seconds` */
+    uint32_t advance(const double seconds) {
+        uint32_t steps;
+        if (replayCursor < replaying.size()) {
+            steps = replaying[replayCursor++];
+            accumulator = 0;
+        } else {
+            const double step = getStep();
+            accumulator += std::max(seconds, 0.0);
+            steps = static_cast<uint32_t>(accumulator / step);
+            if (steps > settings.maxSubSteps) {
+                steps = settings.maxSubSteps;
+                accumulator = 0;
+            } else {
+                accumulator -= steps * step;
+            }
+        }
+
+        if (recording) recording->push_back(steps);
+        tick += steps;
+        return steps;
+    }
+
+    float getAlpha() const {
+        return static_cast<float>(accumulator / getStep());
+    }
+
+    /* steps run since the start */
+    uint64_t getTick() const {
+        return tick;
+    }
+
+    void record(std::vector<uint32_t>* steps) {
+        recording = steps;
+    }
+
+    /* replaces the clock with the recorded step counts until they run out */
+    void replay(const std::span<const uint32_t> steps) {
+        replaying.assign(steps.begin(), steps.end());
+        replayCursor = 0;
+    }
+
+    bool isReplaying() const {
+        return replayCursor < replaying.size();
+    }
+private:
+    Settings settings;
+    double accumulator = 0;
+    uint64_t tick = 0;
+
+    std::vector<uint32_t>* recording = nullptr;
+    std::vector<uint32_t> replaying;
+    size_t replayCursor = 0;
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include <cmath>
+#include <algorithm>
+
+#include "CollisionComponents.h"
+
+/*
+ * One physics step of a body, semi-implicit Euler: the velocity is integrated first, then the position moves
+ * by the new velocity. SlowdownSystem and MovementSystem run these for every body.
+ */
+namespace integrate {
+    /* the air speed clamp was tuned as a cut of maxAirSpeed per step at this rate, a constant deceleration */
+    constexpr float AIR_CLAMP_RATE = 60.f;
+
+    inline void velocity(Velocity& velocity, const RigidBody& body, const float step) {
+        if (!body.onGround) {
+            velocity.y -= body.gravity * step;
+
+            float horizontalSpeed = sqrt(velocity.x * velocity.x + velocity.z * velocity.z);
+            float maxAirSpeed = .15f;
+
+            if (horizontalSpeed > maxAirSpeed) {
+                const float scale = maxAirSpeed * step * AIR_CLAMP_RATE / horizontalSpeed;
+                const float keep = std::max(1.f - scale, 0.f);
+                velocity.x *= keep;
+                velocity.z *= keep;
+            }
+        } else {
+            const float decay = std::exp(-body.damping * step);
+            velocity.x *= decay;
+            velocity.y *= decay;
+            velocity.z *= decay;
+        }
+        constexpr float epsilon = 0.0001f;
+        if (std::abs(velocity.x) < epsilon) velocity.x = 0.0f;
+        if (std::abs(velocity.y) < epsilon) velocity.y = 0.0f;
+        if (std::abs(velocity.z) < epsilon) velocity.z = 0.0f;
+    }
+
+    inline void position(Transform& transform, const Velocity& velocity, const float step) {
+        transform.translation += velocity * step;
+    }
+}
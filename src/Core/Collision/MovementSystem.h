@@ -1,46 +1,43 @@
 #pragma once
+#include <Renderer/Common.h>
+
+#include "Integrator.h"
 #include "PhysicsStage.h"
 
+/* keeps the state the renderer interpolates from, before anything moves in this step */
+struct PhysicsHistorySystem : Reads<Transform>, Writes<PreviousTransform>, Stages<PhysicsStage> {
+    static void onPhysicsUpdate(PhysicsView<PhysicsHistorySystem> level) {
+        level.query<Transform, PreviousTransform>().forEach([](const Entity e, const Transform& transform, PreviousTransform& previous) {
+            previous.transform = transform;
+        });
+    }
+};
+
+/* semi-implicit Euler: velocities are integrated first, then positions move by the new velocities */
 struct SlowdownSystem : Reads<RigidBody>, Writes<Velocity>, Stages<PhysicsStage> {
     static void onPhysicsUpdate(PhysicsView<SlowdownSystem> level) {
-        level.query<Velocity, RigidBody>().forEach([](const Entity e, Velocity& velocity, const RigidBody& body) {
-            if (!body.onGround) {
-                velocity.y -= 0.35f * PhysicsStage::Hz;
-
-                float horizontalSpeed = sqrt(velocity.x * velocity.x + velocity.z * velocity.z);
-                float maxAirSpeed = .15f;
-
-                if (horizontalSpeed > maxAirSpeed) {
-                    float scale = maxAirSpeed / horizontalSpeed;
-                    velocity.x *= 1.f - scale;
-                    velocity.z *= 1.f - scale;
-                }
-            } else {
-                const float decay = std::exp(-body.damping * PhysicsStage::Hz);
-                velocity.x *= decay;
-                velocity.y *= decay;
-                velocity.z *= decay;
-            }
-            constexpr float epsilon = 0.0001f;
-            if (std::abs(velocity.x) < epsilon) velocity.x = 0.0f;
-            if (std::abs(velocity.y) < epsilon) velocity.y = 0.0f;
-            if (std::abs(velocity.z) < epsilon) velocity.z = 0.0f;
+        const float step = level.getStep();
+        level.query<Velocity, RigidBody>().forEach([step](const Entity e, Velocity& velocity, const RigidBody& body) {
+            integrate::velocity(velocity, body, step);
         });
     }
 };
 
-struct MovementSystem : Reads<Velocity>, Writes<Transform>, Dependencies<SlowdownSystem>, Stages<PhysicsStage> {
+struct MovementSystem : Reads<Velocity>, Writes<Transform>, Dependencies<SlowdownSystem, PhysicsHistorySystem>, Stages<PhysicsStage> {
     void onPhysicsUpdate(PhysicsView<MovementSystem> level) {
-        level.query<Transform, Velocity>().forEach([](const Entity e, Transform& transform, const Velocity& velocity) {
-            transform.translation += velocity * PhysicsStage::Hz;
+        const float step = level.getStep();
+        level.query<Transform, Velocity>().forEach([step](const Entity e, Transform& transform, const Velocity& velocity) {
+            integrate::position(transform, velocity, step);
         });
     }
 };
 
-struct CameraMovementSystem : Writes<CameraComponent>, Reads<Transform> {
-    void onUpdate(LevelUpdateView<CameraMovementSystem> level) {
-        level.query<Transform, CameraComponent>().forEach([](const Entity e, const Transform& transform, CameraComponent& camera) {
-            camera.position = transform.translation;
+/* at the end of the frame, when the physics steps it ran and so the interpolation alpha are known */
+struct CameraMovementSystem : Writes<CameraComponent>, Reads<Transform, PreviousTransform> {
+    void onLevelOut(LevelOutView<CameraMovementSystem> level) {
+        const float alpha = level.getAlpha();
+        level.query<Transform, CameraComponent>().forEach([&](const Entity e, const Transform& transform, CameraComponent& camera) {
+            camera.position = renderTransform(transform, level.get<PreviousTransform>(e), alpha).translation;
             camera.updateViewMatrix();
         });
     }
@@ -1,5 +1,8 @@
 #pragma once
 #include <ECS/System/ISystem.h>
+#include <Core/Transform.h>
+
+#include "FixedTimestep.h"
 
 template <typename> struct PhysicsView;
 
@@ -16,9 +19,17 @@ struct PhysicsStage : Stage<PhysicsStage> {
     };
 
     static constexpr auto ExecutionModel = StageExecutionModel::DETERMINISTIC;
-    static constexpr auto ScheduleModel = StageScheduleModel::FIXED_HZ;
+    /* run once per step handed out by `timestep` */
+    static constexpr auto ScheduleModel = StageScheduleModel::MANUAL;
+    /* the default step length */
     static constexpr auto Hz = 1.f / 60.f;
 
+    /* advanced once per frame by the main loop */
+    FixedTimestep timestep;
+
+    PhysicsStage() = default;
+    explicit PhysicsStage(const FixedTimestep::Settings& settings) : timestep(settings) {}
+
     template <typename System>
     using StageView = PhysicsView<System>;
     /* Deterministic: LevelUpdateView,
@@ -40,6 +51,30 @@ struct PhysicsStage : Stage<PhysicsStage> {
 template <typename S>
 struct PhysicsView : public LevelDeterministicView<PhysicsStage, S> {
     using LevelDeterministicView<PhysicsStage, S>::LevelDeterministicView;
+
+    float getStep() const {
+        return this->stage->timestep.getStep();
+    }
 };
 
-struct PhysicsSystem : Stages<PhysicsStage> {};
\ No newline at end of file
+struct PhysicsSystem : Stages<PhysicsStage> {};
+
+/* the transform before the last physics step, rendering blends from it to the current one by the step's alpha */
+struct PreviousTransform : PrimaryComponent {
+    Transform transform;
+
+    PreviousTransform() = default;
+    explicit PreviousTransform(const Transform& transform) : transform(transform) {}
+};
+
+inline Transform interpolate(const Transform& previous, const Transform& current, const float alpha) {
+    return Transform(
+        glm::mix(previous.translation, current.translation, alpha),
+        glm::mix(previous.scale, current.scale, alpha),
+        glm::slerp(previous.rotation, current.rotation, alpha));
+}
+
+/* the transform to draw a body at `alpha` of the way from its previous physics step to the last one */
+inline Transform renderTransform(const Transform& transform, const PreviousTransform* previous, const float alpha) {
+    return previous ? interpolate(previous->transform, transform, alpha) : transform;
+}
\ No newline at end of file
@@ -3,11 +3,26 @@
 
 #include "InputEvents.h"
 #include <Core/App.h>
+#include <Core/Collision/PhysicsStage.h>
 #include <Renderer/Common.h>
 
 #include "Renderer/GeometrySystem.h"
 #include "SDL2/SDL_events.h"
 
+/*
+ * The input of every frame and the physics steps each frame ran. Replaying both runs the physics through
+ * the same steps with the same input, however long the frames take.
+ */
+struct InputRecording {
+    struct Frame {
+        std::vector<SDL_Keycode> keys;
+        MouseMotionEvent mouseMotion;
+    };
+
+    std::vector<Frame> frames;
+    std::vector<uint32_t> physicsSteps;
+};
+
 struct InputOut {
     ecs::frame_vector<KeyPressEvent> keyPressEvents;
     ecs::frame_vector<MouseMotionEvent> mouseMotionEvents;
@@ -39,6 +54,22 @@ struct InputSystem {
         mem::vector<MouseMotionEvent> mouseWheelEvents;
         mem::vector<KeyPressEvent> keyPressEvents;
 
+        InputRecording* recording = nullptr;
+        const InputRecording* replaying = nullptr;
+        size_t replayFrame = 0;
+
+        /* `timestep` is the physics clock of the level the input drives */
+        void record(InputRecording& into, FixedTimestep& timestep) {
+            recording = &into;
+            timestep.record(&into.physicsSteps);
+        }
+
+        void replay(const InputRecording& from, FixedTimestep& timestep) {
+            replaying = &from;
+            replayFrame = 0;
+            timestep.replay(from.physicsSteps);
+        }
+
         void readInput() {
             SDL_Event event;
 
@@ -78,6 +109,21 @@ struct InputSystem {
         }
 
         void onLevelOut(LevelOutView<InputPoller> view) {
+            if (replaying && replayFrame < replaying->frames.size()) {
+                const auto& frame = replaying->frames[replayFrame++];
+                keyPressEvents.clear();
+                for (const auto key : frame.keys) {
+                    keyPressEvents.emplace_back(key);
+                }
+                mouseMotionEvent = frame.mouseMotion;
+            } else if (recording) {
+                auto& frame = recording->frames.emplace_back();
+                for (const auto& event : keyPressEvents) {
+                    frame.keys.push_back(event.key);
+                }
+                frame.mouseMotion = mouseMotionEvent;
+            }
+
             view.send(keyPressEvents);
 
             if (mouseMotionEvent.xrel != 0 || mouseMotionEvent.yrel != 0)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include <glm/detail/type_quat.hpp>
 #include <glm/ext/scalar_constants.hpp>
 #include <util/glm_double.h>
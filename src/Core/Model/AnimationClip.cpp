@@ -0,0 +1,138 @@
+#include "AnimationClip.h"
+
+#include <algorithm>
+#include <glm/gtc/quaternion.hpp>
+
+namespace {
+    glm::vec4 pack(const glm::vec3& v) {
+        return { v, 0.f };
+    }
+
+    glm::vec4 pack(const glm::quat& q) {
+        return { q.x, q.y, q.z, q.w };
+    }
+
+    glm::quat unpackRotation(const glm::vec4& v) {
+        return { v.w, v.x, v.y, v.z };
+    }
+
+    MeshAffected affectedOf(const AnimationChannel& source) {
+        unsigned affected = 0;
+        affected |= source.position.empty() ? 0 : static_cast<unsigned>(MeshAffected::POSITION);
+        affected |= source.scale.empty() ? 0 : static_cast<unsigned>(MeshAffected::SCALE);
+        affected |= source.rotation.empty() ? 0 : static_cast<unsigned>(MeshAffected::ROTATION);
+        affected |= source.tint.empty() ? 0 : static_cast<unsigned>(MeshAffected::COLOR);
+        return static_cast<MeshAffected>(affected);
+    }
+}
+
+template <typename CurveT>
+void AnimationClip::addCurve(Curve& curve, const CurveT& source) {
+    curve.firstKey = static_cast<uint32_t>(times.size());
+    curve.keyCount = static_cast<uint32_t>(source.size());
+    curve.easing = source.getEasingFunction();
+    curve.interpolation = source.getInterpolationType();
+
+    times.insert(times.end(), source.getTimes().begin(), source.getTimes().end());
+    for (size_t k = 0; k < source.size(); ++k) {
+        values.push_back(pack(source.getValues()[k]));
+        inTangents.push_back(pack(source.getInTangents()[k]));
+        outTangents.push_back(pack(source.getOutTangents()[k]));
+    }
+}
+
+AnimationClip::AnimationClip(const ModelAnimation& animation) : duration(static_cast<float>(animation.getDuration())) {
+    size_t keys = 0;
+    for (const AnimationChannel& channel : animation.getChannels()) {
+        keys += channel.position.size() + channel.scale.size() + channel.tint.size() + channel.rotation.size();
+    }
+    times.reserve(keys);
+    values.reserve(keys);
+    inTangents.reserve(keys);
+    outTangents.reserve(keys);
+    channels.reserve(animation.getChannels().size());
+
+    for (const AnimationChannel& source : animation.getChannels()) {
+        Channel& channel = channels.emplace_back();
+        channel.target = source.target;
+
+        addCurve(channel.curves[POSITION], source.position);
+        addCurve(channel.curves[SCALE], source.scale);
+        addCurve(channel.curves[TINT], source.tint);
+        addCurve(channel.curves[ROTATION], source.rotation);
+        channel.affected = affectedOf(source);
+    }
+}
+
+AnimationClip::AnimationClip(const ModelAnimation& animation, const CompressedAnimation::Settings& settings, const CompressedAnimation::Hierarchy& hierarchy)
+    : compressed(std::make_unique<const CompressedAnimation>(animation, settings, hierarchy)),
+      duration(static_cast<float>(animation.getDuration()))
+{
+    channels.reserve(animation.getChannels().size());
+    for (const AnimationChannel& source : animation.getChannels()) {
+        Channel& channel = channels.emplace_back();
+        channel.target = source.target;
+        channel.affected = affectedOf(source);
+    }
+}
+
+uint32_t AnimationClip::findSegment(const Curve& curve, const float time, const uint32_t hint) const {
+    return static_cast<uint32_t>(curves::findSegment(times.data() + curve.firstKey, curve.keyCount, time, hint));
+}
+
+glm::vec4 AnimationClip::sampleCurve(const Curve& curve, const float time, const glm::vec4& from, const bool isRotation, uint32_t& hint) const {
+    if (curve.keyCount == 0 || time <= 0.f) return from;
+
+    const float* keyTimes = times.data() + curve.firstKey;
+    const glm::vec4* keyValues = values.data() + curve.firstKey;
+    const uint32_t last = curve.keyCount - 1;
+
+    if (time >= keyTimes[last]) return keyValues[last];
+
+    // before the first key the segment starts at the pose the track started from
+    const bool beforeFirst = time < keyTimes[0];
+    if (!beforeFirst) {
+        hint = findSegment(curve, time, hint);
+    }
+    const uint32_t next = beforeFirst ? 0 : hint + 1;
+
+    const glm::vec4 a = beforeFirst ? from : keyValues[hint];
+    const glm::vec4 outA = beforeFirst ? glm::vec4(0.f) : outTangents[curve.firstKey + hint];
+    const float start = beforeFirst ? 0.f : keyTimes[hint];
+
+    const glm::vec4 b = keyValues[next];
+    const glm::vec4 inB = inTangents[curve.firstKey + next];
+    const float end = keyTimes[next];
+
+    const float span = end - start;
+    if (span <= 0.f) return b;
+
+    const auto eased = static_cast<float>(curve.easing((time - start) / span));
+
+    if (curve.interpolation == InterpolationType::HERMITE) {
+        const float t2 = eased * eased;
+        const float t3 = t2 * eased;
+        return (t3 * 2 - t2 * 3 + 1) * a + (t3 - 2 * t2 + eased) * (outA * span)
+             + (t3 * -2 + t2 * 3) * b + (t3 - t2) * (inB * span);
+    }
+    if (isRotation) {
+        return pack(glm::slerp(unpackRotation(a), unpackRotation(b), eased));
+    }
+    return a + (b - a) * eased;
+}
+
+MeshPose AnimationClip::sample(const uint32_t channel, const float time, const MeshPose& from, Hints& hints) const {
+    const Channel& c = channels[channel];
+    auto property = [&](const Property p, const glm::vec4& value) {
+        return compressed
+            ? compressed->sampleCurve(channel, p, time, value, hints[p])
+            : sampleCurve(c.curves[p], time, value, p == ROTATION, hints[p]);
+    };
+
+    MeshPose pose;
+    pose.transform.translation = glm::vec3(property(POSITION, pack(from.transform.translation)));
+    pose.transform.scale = glm::vec3(property(SCALE, pack(from.transform.scale)));
+    pose.tint = glm::vec3(property(TINT, pack(from.tint)));
+    pose.transform.rotation = unpackRotation(property(ROTATION, pack(from.transform.rotation)));
+    return pose;
+}
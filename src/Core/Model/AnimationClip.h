@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <glm/vec4.hpp>
+
+#include "ModelAnimation.h"
+#include "AnimationCompression.h"
+
+/*
+ * Immutable, shareable form of a ModelAnimation that tracks sample from instead of copying its curves.
+ *
+ * The keys of every curve of every channel live in four parallel arrays (times, values, in/out tangents);
+ * a curve is a range of them. Vectors are stored in a vec4 with w = 0, quaternions as (x, y, z, w).
+ * Sampling prepends the caller's `from` value as a key at time 0, as the player did when it copied the curves.
+ * A compressed clip keeps no such arrays and samples its CompressedAnimation instead.
+ */
+class AnimationClip {
+public:
+    enum Property : uint8_t {
+        POSITION, SCALE, TINT, ROTATION, PROPERTY_COUNT
+    };
+
+    struct Curve {
+        uint32_t firstKey = 0;
+        uint32_t keyCount = 0;
+        EasingFunction easing = Easing::linear;
+        InterpolationType interpolation = InterpolationType::LERP;
+    };
+
+    struct Channel {
+        std::string target;
+        std::array<Curve, PROPERTY_COUNT> curves;
+        MeshAffected affected;
+    };
+
+    /* per channel key cursors of one playback */
+    using Hints = std::array<uint32_t, PROPERTY_COUNT>;
+
+    explicit AnimationClip(const ModelAnimation& animation);
+
+    AnimationClip(const ModelAnimation& animation, const CompressedAnimation::Settings& settings, const CompressedAnimation::Hierarchy& hierarchy = {});
+
+    AnimationClip(const AnimationClip&) = delete;
+    AnimationClip& operator=(const AnimationClip&) = delete;
+
+    MeshPose sample(uint32_t channel, float time, const MeshPose& from, Hints& hints) const;
+
+    const std::vector<Channel>& getChannels() const {
+        return channels;
+    }
+
+    size_t channelCount() const {
+        return channels.size();
+    }
+
+    float getDuration() const {
+        return duration;
+    }
+
+    size_t keyCount() const {
+        return times.size();
+    }
+
+    /* nullptr for an uncompressed clip */
+    const CompressedAnimation* getCompressed() const {
+        return compressed.get();
+    }
+private:
+    template <typename CurveT>
+    void addCurve(Curve& curve, const CurveT& source);
+
+    glm::vec4 sampleCurve(const Curve& curve, float time, const glm::vec4& from, bool isRotation, uint32_t& hint) const;
+
+    /* the segment [i, i + 1] containing `time`, walking forward from the hint before falling back to a binary search */
+    uint32_t findSegment(const Curve& curve, float time, uint32_t hint) const;
+
+    std::vector<Channel> channels;
+    std::vector<float> times;
+    std::vector<glm::vec4> values;
+    std::vector<glm::vec4> inTangents;
+    std::vector<glm::vec4> outTangents;
+    std::unique_ptr<const CompressedAnimation> compressed;
+    float duration = 0;
+};
@@ -0,0 +1,304 @@
+#include "AnimationCompression.h"
+
+#include <cmath>
+#include <algorithm>
+#include <glm/geometric.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Skeleton.h"
+
+namespace {
+    /* the order of AnimationClip::Property */
+    enum Property : uint32_t {
+        POSITION, SCALE, TINT, ROTATION
+    };
+
+    constexpr float WORD_MAX = 65535.f;
+    constexpr float COMPONENT_MAX = 32767.f;
+    constexpr uint16_t COMPONENT_MASK = 0x7fff;
+    constexpr float SMALLEST_THREE_RANGE = 0.70710678f; /* the three smallest components of a unit quaternion are within +-1/sqrt(2) */
+
+    struct Keys {
+        std::vector<float> times;
+        std::vector<glm::vec4> values;
+    };
+
+    glm::vec4 pack(const glm::vec3& v) {
+        return { v, 0.f };
+    }
+
+    glm::vec4 pack(const glm::quat& q) {
+        return { q.x, q.y, q.z, q.w };
+    }
+
+    glm::quat unpackRotation(const glm::vec4& v) {
+        return { v.w, v.x, v.y, v.z };
+    }
+
+    template <typename CurveT>
+    Keys keysOf(const CurveT& curve, const float resampleRate) {
+        Keys keys;
+        const auto times = curve.getTimes();
+        if (times.empty()) return keys;
+
+        if (curve.getInterpolationType() == InterpolationType::LERP && curve.getEasingFunction() == Easing::linear) {
+            keys.times.assign(times.begin(), times.end());
+            for (const auto& value : curve.getValues()) {
+                keys.values.push_back(pack(value));
+            }
+            return keys;
+        }
+
+        const float first = times.front();
+        const float last = times.back();
+        const auto steps = static_cast<size_t>(std::ceil((last - first) * resampleRate));
+        size_t cursor = 0;
+        for (size_t i = 0; i <= steps; ++i) {
+            const float time = i == steps ? last : first + static_cast<float>(i) / resampleRate;
+            keys.times.push_back(time);
+            keys.values.push_back(pack(curve.at(time, cursor)));
+        }
+        return keys;
+    }
+
+    glm::vec4 interpolate(const glm::vec4& a, const glm::vec4& b, const float u, const bool isRotation) {
+        if (isRotation) {
+            return pack(glm::slerp(unpackRotation(a), unpackRotation(b), u));
+        }
+        return a + (b - a) * u;
+    }
+
+    /* how far a reconstructed value moves what the channel carries, in model units (or tint units) */
+    float errorOf(const uint32_t property, const glm::vec4& value, const glm::vec4& original, const float lever) {
+        switch (property) {
+            case POSITION:
+                return glm::length(glm::vec3(value) - glm::vec3(original));
+            case SCALE:
+                return glm::length(glm::vec3(value) - glm::vec3(original)) * lever;
+            case TINT: {
+                const glm::vec3 d = glm::abs(glm::vec3(value) - glm::vec3(original));
+                return std::max({ d.x, d.y, d.z });
+            }
+            default: {
+                // the angle from the chord between the quaternions, acos of their dot product is too coarse near 1
+                const float chord = std::min(glm::length(value - original), glm::length(value + original));
+                return 4.f * std::asin(std::min(1.f, chord * 0.5f)) * lever;
+            }
+        }
+    }
+
+    uint16_t quantize(const float value, const float min, const float extent) {
+        if (extent <= 0.f) return 0;
+        return static_cast<uint16_t>(std::lround(std::clamp((value - min) / extent, 0.f, 1.f) * WORD_MAX));
+    }
+
+    std::array<uint16_t, 3> encodeRotation(const glm::vec4& rotation) {
+        glm::vec4 q = glm::normalize(rotation);
+
+        uint32_t largest = 0;
+        for (uint32_t c = 1; c < 4; ++c) {
+            if (std::abs(q[c]) > std::abs(q[largest])) largest = c;
+        }
+        if (q[largest] < 0) q = -q;
+
+        std::array<uint16_t, 3> words{};
+        for (uint32_t c = 0, w = 0; c < 4; ++c) {
+            if (c == largest) continue;
+            const float normalized = std::clamp(q[c] / SMALLEST_THREE_RANGE, -1.f, 1.f) * 0.5f + 0.5f;
+            words[w] = static_cast<uint16_t>(std::lround(normalized * COMPONENT_MAX));
+            ++w;
+        }
+        words[0] |= static_cast<uint16_t>((largest & 1) << 15);
+        words[1] |= static_cast<uint16_t>((largest >> 1) << 15);
+        return words;
+    }
+
+    glm::vec4 decodeRotation(const uint16_t* words) {
+        const uint32_t largest = (words[0] >> 15) | ((words[1] >> 15) << 1);
+
+        glm::vec4 q;
+        float sum = 0;
+        for (uint32_t c = 0, w = 0; c < 4; ++c) {
+            if (c == largest) continue;
+            const float normalized = static_cast<float>(words[w] & COMPONENT_MASK) / COMPONENT_MAX;
+            q[c] = (normalized * 2.f - 1.f) * SMALLEST_THREE_RANGE;
+            sum += q[c] * q[c];
+            ++w;
+        }
+        q[largest] = std::sqrt(std::max(0.f, 1.f - sum));
+        return q;
+    }
+}
+
+CompressedAnimation::Hierarchy CompressedAnimation::hierarchyOf(const SkeletonAsset& skeleton) {
+    const auto& order = skeleton.order;
+    const auto& parents = skeleton.orderParent;
+    const size_t count = order.size();
+
+    std::vector<glm::mat4> globals(count);
+    std::vector<uint32_t> depth(count, 0);
+    std::vector<uint32_t> height(count, 0);
+
+    for (size_t i = 0; i < count; ++i) {
+        const auto& bone = skeleton.bones[order[i]];
+        const glm::mat4 local = bone.localTransform.createModel3DSkew(bone.skew);
+        globals[i] = parents[i] < 0 ? local : globals[parents[i]] * local;
+        depth[i] = parents[i] < 0 ? 0 : depth[parents[i]] + 1;
+    }
+    for (size_t i = count; i-- > 0;) {
+        if (parents[i] >= 0) height[parents[i]] = std::max(height[parents[i]], height[i] + 1);
+    }
+
+    Hierarchy hierarchy;
+    for (size_t i = 0; i < count; ++i) {
+        const glm::vec3 origin(globals[i][3]);
+        float extent = 0;
+        for (int d = static_cast<int>(i) + 1; d < skeleton.subtreeEnd[i]; ++d) {
+            extent = std::max(extent, glm::length(glm::vec3(globals[d][3]) - origin));
+        }
+        hierarchy.emplace(skeleton.bones[order[i]].name, Reach{ depth[i] + height[i] + 1, extent });
+    }
+    return hierarchy;
+}
+
+CompressedAnimation::CompressedAnimation(const ModelAnimation& animation, const Settings& settings, const Hierarchy& hierarchy)
+    : duration(static_cast<float>(animation.getDuration()))
+{
+    curves.reserve(animation.getChannels().size() * PROPERTIES);
+
+    for (const AnimationChannel& channel : animation.getChannels()) {
+        Reach reach;
+        if (const auto it = hierarchy.find(channel.target); it != hierarchy.end()) {
+            reach = it->second;
+        }
+        const float lever = reach.extent + settings.shellDistance;
+
+        const std::array<Keys, PROPERTIES> sources = {
+            keysOf(channel.position, settings.resampleRate),
+            keysOf(channel.scale, settings.resampleRate),
+            keysOf(channel.tint, settings.resampleRate),
+            keysOf(channel.rotation, settings.resampleRate)
+        };
+
+        for (uint32_t property = 0; property < PROPERTIES; ++property) {
+            const Keys& source = sources[property];
+            const bool isRotation = property == ROTATION;
+            const float budget = property == TINT ? settings.tintTolerance : settings.tolerance / static_cast<float>(reach.chainLength);
+            const size_t count = source.times.size();
+
+            Curve& curve = curves.emplace_back();
+            curve.firstWord = static_cast<uint32_t>(stream.size());
+            if (count == 0) continue;
+
+            if (!isRotation) {
+                glm::vec3 max(source.values.front());
+                curve.min = max;
+                for (const glm::vec4& value : source.values) {
+                    curve.min = glm::min(curve.min, glm::vec3(value));
+                    max = glm::max(max, glm::vec3(value));
+                }
+                curve.extent = max - curve.min;
+            }
+
+            // quantize every key up front, so the reduction measures the error of what is actually stored
+            std::vector<uint16_t> times(count);
+            std::vector<std::array<uint16_t, 3>> words(count);
+            std::vector<float> decodedTimes(count);
+            std::vector<glm::vec4> decoded(count);
+            for (size_t k = 0; k < count; ++k) {
+                times[k] = duration > 0 ? quantize(source.times[k], 0, duration) : 0;
+                decodedTimes[k] = static_cast<float>(times[k]);
+                if (isRotation) {
+                    words[k] = encodeRotation(source.values[k]);
+                    decoded[k] = decodeRotation(words[k].data());
+                } else {
+                    for (uint32_t c = 0; c < 3; ++c) {
+                        words[k][c] = quantize(source.values[k][c], curve.min[c], curve.extent[c]);
+                        decoded[k][c] = curve.min[c] + curve.extent[c] * (static_cast<float>(words[k][c]) / WORD_MAX);
+                    }
+                    decoded[k].w = 0;
+                }
+            }
+
+            // the error of the line from key a to key b at every original key between them
+            auto spanError = [&](const size_t a, const size_t b) {
+                float error = 0;
+                const float span = decodedTimes[b] - decodedTimes[a];
+                for (size_t k = a + 1; k < b; ++k) {
+                    const float u = span > 0 ? (decodedTimes[k] - decodedTimes[a]) / span : 1.f;
+                    error = std::max(error, errorOf(property, interpolate(decoded[a], decoded[b], u, isRotation), source.values[k], lever));
+                }
+                return error;
+            };
+
+            std::vector<size_t> kept{ 0 };
+            float constantError = 0;
+            for (size_t k = 0; k < count; ++k) {
+                constantError = std::max(constantError, errorOf(property, decoded[0], source.values[k], lever));
+            }
+            if (constantError <= budget) {
+                maxError = std::max(maxError, constantError / budget);
+            } else {
+                // extend each line as far as it stays within the budget, the key before the first miss starts the next
+                size_t anchor = 0;
+                for (size_t k = 2; k < count; ++k) {
+                    if (spanError(anchor, k) > budget) {
+                        kept.push_back(k - 1);
+                        anchor = k - 1;
+                    }
+                }
+                if (count > 1) kept.push_back(count - 1);
+
+                for (size_t i = 0; i + 1 < kept.size(); ++i) {
+                    maxError = std::max(maxError, spanError(kept[i], kept[i + 1]) / budget);
+                }
+                for (const size_t k : kept) {
+                    maxError = std::max(maxError, errorOf(property, decoded[k], source.values[k], lever) / budget);
+                }
+            }
+
+            curve.keyCount = static_cast<uint32_t>(kept.size());
+            for (const size_t k : kept) {
+                stream.push_back(times[k]);
+            }
+            for (const size_t k : kept) {
+                stream.insert(stream.end(), words[k].begin(), words[k].end());
+            }
+        }
+    }
+    stream.shrink_to_fit();
+}
+
+glm::vec4 CompressedAnimation::decode(const Curve& curve, const uint32_t property, const uint32_t key) const {
+    const uint16_t* words = stream.data() + curve.firstWord + curve.keyCount + key * 3;
+    if (property == ROTATION) {
+        return decodeRotation(words);
+    }
+    return pack(curve.min + curve.extent * (glm::vec3(words[0], words[1], words[2]) / WORD_MAX));
+}
+
+glm::vec4 CompressedAnimation::sampleCurve(const uint32_t channel, const uint32_t property, const float time, const glm::vec4& from, uint32_t& cursor) const {
+    const Curve& curve = curves[channel * PROPERTIES + property];
+    if (curve.keyCount == 0 || time <= 0.f) return from;
+
+    const uint16_t* keyTimes = stream.data() + curve.firstWord;
+    const uint32_t last = curve.keyCount - 1;
+    const float at = duration > 0 ? time / duration * WORD_MAX : WORD_MAX;
+
+    if (at >= keyTimes[last]) return decode(curve, property, last);
+
+    // before the first key the segment starts at the pose the track started from
+    const bool beforeFirst = at < keyTimes[0];
+    if (!beforeFirst) {
+        cursor = static_cast<uint32_t>(curves::findSegment(keyTimes, curve.keyCount, at, cursor));
+    }
+    const uint32_t next = beforeFirst ? 0 : cursor + 1;
+
+    const glm::vec4 a = beforeFirst ? from : decode(curve, property, cursor);
+    const float start = beforeFirst ? 0.f : keyTimes[cursor];
+    const glm::vec4 b = decode(curve, property, next);
+
+    const float span = keyTimes[next] - start;
+    if (span <= 0.f) return b;
+    return interpolate(a, b, (at - start) / span, property == ROTATION);
+}
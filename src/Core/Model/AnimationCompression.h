@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <util/stl.h>
+
+#include "ModelAnimation.h"
+
+class SkeletonAsset;
+
+/*
+ * Lossy, error bounded form of a ModelAnimation that is sampled without being unpacked.
+ *
+ * Every curve is reduced to the keys a linear reconstruction needs to stay within its error budget, then
+ * quantized into one stream of 16 bit words: key times relative to the clip duration, translations, scales
+ * and tints relative to the curve's range, and rotations as their smallest three components with the index
+ * of the dropped one in the spare top bits. A key is 4 words.
+ *
+ * Errors are measured where they show: how far a bone moves a point `shellDistance` beyond its farthest
+ * descendant. The tolerance is split evenly along the longest bone chain through a channel, so the errors
+ * of a chain's bones cannot add up past it. Curves that are not linear are resampled first.
+ */
+class CompressedAnimation {
+public:
+    struct Settings {
+        float tolerance = 0.001f;
+        float shellDistance = 0.03f;
+        float tintTolerance = 1.f / 512;
+        /* keys per second for curves with easing or hermite interpolation */
+        float resampleRate = 30;
+    };
+
+    /* how far the errors of a channel reach: the longest bone chain through it, and its farthest descendant */
+    struct Reach {
+        uint32_t chainLength = 1;
+        float extent = 0;
+    };
+
+    using Hierarchy = stl::unordered_stringmap<Reach>;
+
+    /* the bind pose reach of every bone, channels that are not bones reach only themselves */
+    static Hierarchy hierarchyOf(const SkeletonAsset& skeleton);
+
+    CompressedAnimation(const ModelAnimation& animation, const Settings& settings, const Hierarchy& hierarchy = {});
+
+    /* sampled like AnimationClip curves: `from` is a key at time 0, the cursor is the index of the last segment */
+    glm::vec4 sampleCurve(uint32_t channel, uint32_t property, float time, const glm::vec4& from, uint32_t& cursor) const;
+
+    /* the largest error at any of the original keys relative to its curve's budget, above 1 where quantization alone exceeds it */
+    float getMaxError() const {
+        return maxError;
+    }
+
+    size_t byteSize() const {
+        return stream.size() * sizeof(uint16_t) + curves.size() * sizeof(Curve);
+    }
+private:
+    constexpr static uint32_t PROPERTIES = 4;
+
+    struct Curve {
+        uint32_t firstWord = 0;
+        uint32_t keyCount = 0;
+        glm::vec3 min{};
+        glm::vec3 extent{};
+    };
+
+    glm::vec4 decode(const Curve& curve, uint32_t property, uint32_t key) const;
+
+    std::vector<Curve> curves;      /* PROPERTIES per channel */
+    std::vector<uint16_t> stream;   /* per curve all key times, then 3 words per key */
+    float duration = 0;
+    float maxError = 0;
+};
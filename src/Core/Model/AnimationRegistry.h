@@ -1,5 +1,7 @@
 #pragma once
+#include <memory>
 #include "ModelAnimation.h"
+#include "AnimationClip.h"
 #include "ECS/System/ISystem.h"
 
 enum class AnimationKey : unsigned {};
@@ -7,6 +9,8 @@ enum class AnimationKey : unsigned {};
 struct AnimationMetadata {
     ModelAnimation animation;
     AnimationKey key;
+    /* what tracks play; replaced, not modified, when the animation is, so running tracks keep their clip */
+    std::shared_ptr<const AnimationClip> clip;
 
     auto& getChannels() const {
         return animation.getChannels();
@@ -28,12 +32,25 @@ class AnimationRegistry : public ResourceSystem<> {
     unsigned nextKey = 0;
 public:
     void addAnimation(ModelAnimation&& animation) {
+        auto clip = std::make_shared<const AnimationClip>(animation);
+        addAnimation(std::move(animation), std::move(clip));
+    }
+
+    /* tracks sample the packed keys, `hierarchy` is the skeleton the animation targets if any */
+    void addCompressedAnimation(ModelAnimation&& animation, const CompressedAnimation::Settings& settings, const CompressedAnimation::Hierarchy& hierarchy = {}) {
+        auto clip = std::make_shared<const AnimationClip>(animation, settings, hierarchy);
+        addAnimation(std::move(animation), std::move(clip));
+    }
+
+    void addAnimation(ModelAnimation&& animation, std::shared_ptr<const AnimationClip> clip) {
         if (const auto it = animationsByString.find(animation.getName()); it != animationsByString.end()) {
             animations[it->second].animation = std::move(animation);
+            animations[it->second].clip = std::move(clip);
         } else {
-            AnimationKey key = newKey();
-            animations.emplace_back(std::move(animation));
-            animationsByString.emplace(animation.getName(), animations.size() - 1);
+            const AnimationKey key = newKey();
+            std::string name = animation.getName();
+            animations.emplace_back(std::move(animation), key, std::move(clip));
+            animationsByString.emplace(std::move(name), animations.size() - 1);
             animationsByKey.emplace(key, animations.size() - 1);
         }
     }
@@ -1,4 +1,6 @@
 #pragma once
+#include <span>
+#include <vector>
 #include <algorithm>
 #include <glm/fwd.hpp>
 #include <glm/vec4.hpp>
@@ -6,20 +8,21 @@
 
 
 namespace curves {
-    template <typename KFT, typename Precision>
-    struct Keyframe {
-        KFT value;
-        Precision time;
-
-        KFT inTangent;
-        KFT outTangent;
-
-        explicit Keyframe(const std::pair<KFT, Precision> &value)
-        : value(value.first), time(value.second), inTangent(), outTangent() {}
-
-        Keyframe(const KFT val, const KFT in, const KFT out, Precision time)
-            : value(val), time(time), inTangent(in), outTangent(out) {}
-    };
+    constexpr size_t MAX_CURSOR_WALK = 4;
+
+    /*
+     * The segment [i, i + 1] of a key time array containing `time`, which must lie strictly inside it: the first one
+     * whose end is not before `time`. Sequential playback walks forward from the cursor, seeks binary search.
+     */
+    template <typename TimeT>
+    size_t findSegment(const TimeT* times, const size_t count, const float time, const size_t cursor) {
+        if (cursor + 1 < count && times[cursor] < time) {
+            for (size_t i = cursor, step = 0; step < MAX_CURSOR_WALK && i + 1 < count; ++step, ++i) {
+                if (time <= times[i + 1]) return i;
+            }
+        }
+        return static_cast<size_t>(std::lower_bound(times + 1, times + count, time) - times) - 1;
+    }
 
     template <typename KFType, typename Precision>
     struct curve_traits {
@@ -27,17 +30,23 @@ namespace curves {
         using precision = Precision;
     };
 
+    /*
+     * Keys are kept as parallel arrays with float times, so a lookup only touches the times.
+     * `precision_type` is what the curve is sampled and edited with.
+     */
     template <typename traits>
     class Curve {
-        using KeyframeT = Keyframe<typename traits::type, typename traits::precision>;
-
-        std::vector<KeyframeT> keyframes;
-        EasingFunction easing = Easing::linear;
-        InterpolationType interpolation = InterpolationType::LERP;
     public:
         using keyframe_type = typename traits::type;
         using precision_type = typename traits::precision;
-
+    private:
+        std::vector<float> times;
+        std::vector<keyframe_type> values;
+        std::vector<keyframe_type> inTangents;
+        std::vector<keyframe_type> outTangents;
+        EasingFunction easing = Easing::linear;
+        InterpolationType interpolation = InterpolationType::LERP;
+    public:
         Curve() = default;
 
         explicit Curve(const std::initializer_list<std::pair<keyframe_type, precision_type>> kfs) {
@@ -55,137 +64,135 @@ namespace curves {
         }
 
         void generateTangentsHermite() {
-            for (size_t i = 1; i < keyframes.size() - 1; ++i) {
-                const auto& prev = keyframes[i - 1];
-                const auto& next = keyframes[i + 1];
-                const auto& curr = keyframes[i];
-
-                precision_type dt = next.time - prev.time;
-                keyframe_type delta = (next.value - prev.value) / dt;
+            for (size_t i = 1; i + 1 < times.size(); ++i) {
+                const float dt = times[i + 1] - times[i - 1];
+                const keyframe_type delta = (values[i + 1] - values[i - 1]) / dt;
 
-                keyframes[i].inTangent  = delta;
-                keyframes[i].outTangent = delta;
+                inTangents[i] = delta;
+                outTangents[i] = delta;
             }
         }
 
-        typename std::vector<KeyframeT>::iterator nextAt(const precision_type at) {
-            return std::lower_bound(keyframes.begin(), keyframes.end(), at,
-                [](const KeyframeT& kf, const precision_type t) { return kf.time < t; });
+        size_t nextAt(const precision_type at) const {
+            return static_cast<size_t>(std::lower_bound(times.begin(), times.end(), static_cast<float>(at)) - times.begin());
         }
 
         void add(const keyframe_type& value, const precision_type at) {
-            auto pos = nextAt(at);
-            keyframes.emplace(pos, std::make_pair(value, at));
+            add(value, keyframe_type{}, keyframe_type{}, at);
         }
 
         void add(const keyframe_type& value, const keyframe_type& inTangent, const keyframe_type& outTangent, const precision_type at) {
-            auto pos = nextAt(at);
-            keyframes.emplace(pos, Keyframe(value, inTangent, outTangent, at));
+            const auto pos = static_cast<std::ptrdiff_t>(nextAt(at));
+            times.insert(times.begin() + pos, static_cast<float>(at));
+            values.insert(values.begin() + pos, value);
+            inTangents.insert(inTangents.begin() + pos, inTangent);
+            outTangents.insert(outTangents.begin() + pos, outTangent);
         }
 
+        /* random access, binary searches the keys */
         keyframe_type at(const precision_type time) const {
-            static size_t NO_HINT = 0;
+            size_t cursor = 0;
+            return at(time, cursor);
+        }
 
-            if (keyframes.empty()) return keyframe_type{};
+        /* sequential access, `hint` is the cursor of one playback and starts at 0 */
+        keyframe_type at(const precision_type time, size_t& hint) const {
+            if (times.empty()) [[unlikely]] return keyframe_type{};
 
-            if (time <= keyframes.front().time) return keyframes.front().value;
-            if (time >= keyframes.back().time) return keyframes.back().value;
+            const auto t = static_cast<float>(time);
+            if (t <= times.front()) return values.front();
+            if (t >= times.back()) return values.back();
 
-            keyframe_type result;
-            interpolate(0, keyframes.size() - 1, time, NO_HINT, result);
-            return result;
+            hint = findSegment(times.data(), times.size(), t, hint);
+            return evaluate(hint, t);
         }
 
-        keyframe_type at(const precision_type time, size_t& hint) const {
-            if (keyframes.empty()) [[unlikely]] return keyframe_type{};
-            if (time <= keyframes.front().time) return keyframes.front().value;
-            if (time >= keyframes.back().time) return keyframes.back().value;
+        /* samples ascending times in one forward pass over the keys, e.g. when baking the curve */
+        void sample(const std::span<const precision_type> at, const std::span<keyframe_type> out) const {
+            if (times.empty()) [[unlikely]] {
+                std::fill(out.begin(), out.end(), keyframe_type{});
+                return;
+            }
 
-            keyframe_type result;
-            if (interpolate(hint, keyframes.size() - 1, time, hint, result)) [[likely]] return result;
-            interpolate(0, hint, time, hint, result);
-            return result;
+            size_t segment = 0;
+            for (size_t i = 0; i < at.size(); ++i) {
+                const auto t = static_cast<float>(at[i]);
+                if (t <= times.front()) {
+                    out[i] = values.front();
+                } else if (t >= times.back()) {
+                    out[i] = values.back();
+                } else {
+                    while (times[segment + 1] < t) ++segment;
+                    out[i] = evaluate(segment, t);
+                }
+            }
         }
 
         void eraseFrom(const precision_type at) {
-            auto pos = nextAt(at);
-            keyframes.erase(pos, keyframes.end());
+            const size_t pos = nextAt(at);
+            times.resize(pos);
+            values.resize(pos);
+            inTangents.resize(pos);
+            outTangents.resize(pos);
         }
 
         bool empty() const {
-            return keyframes.empty();
+            return times.empty();
         }
 
-        void clear() {
-            keyframes.clear();
+        std::span<const float> getTimes() const {
+            return times;
+        }
+
+        std::span<const keyframe_type> getValues() const {
+            return values;
+        }
+
+        std::span<const keyframe_type> getInTangents() const {
+            return inTangents;
+        }
+
+        std::span<const keyframe_type> getOutTangents() const {
+            return outTangents;
         }
 
-        KeyframeT& first() {
-            return keyframes.front();
+        EasingFunction getEasingFunction() const {
+            return easing;
         }
 
-        KeyframeT& last() {
-            return keyframes.back();
+        InterpolationType getInterpolationType() const {
+            return interpolation;
         }
 
-        const KeyframeT& last() const {
-            return keyframes.back();
+        void clear() {
+            times.clear();
+            values.clear();
+            inTangents.clear();
+            outTangents.clear();
         }
-        
+
         precision_type duration() const {
-            return last().time;
+            return static_cast<precision_type>(times.back());
         }
 
         size_t size() const {
-            return keyframes.size();
+            return times.size();
         }
     private:
-        keyframe_type lerp(const KeyframeT& a, const KeyframeT& b, const precision_type time) const {
-            const precision_type t = easing(
-                (time - a.time) / (b.time - a.time)
-            );
-            if constexpr (std::is_same_v<keyframe_type, glm::quat>) {
-                return slerp(a.value, b.value, static_cast<float>(t));
-            } else {
-                return Interpolate::lerp(a.value, b.value, t);
+        keyframe_type evaluate(const size_t i, const float time) const {
+            const float span = times[i + 1] - times[i];
+            const float u = (time - times[i]) / span;
+
+            if (interpolation == InterpolationType::HERMITE) {
+                return Interpolate::hermite(values[i], values[i + 1], outTangents[i] * span, inTangents[i + 1] * span, u, easing);
             }
-        }
 
-        keyframe_type hermite(const KeyframeT& a, const KeyframeT& b, const precision_type time) const {
-            const precision_type duration = b.time - a.time;
-
-            return Interpolate::hermite(
-                a.value, b.value,
-                a.outTangent * duration,
-                b.inTangent * duration,
-                static_cast<float>((time - a.time) / duration),
-                easing
-            );
-        }
-
-        bool interpolate(const size_t start, const size_t end,
-            const precision_type time, size_t& hint,
-            keyframe_type& outResult) const
-        {
-            for (size_t i = start; i < end; ++i) {
-                const auto& a = keyframes[i];
-                const auto& b = keyframes[i + 1];
-
-                if (time >= a.time && time <= b.time) {
-                    hint = i;
-
-                    switch (interpolation) {
-                        case InterpolationType::LERP:
-                            outResult = lerp(a, b, time);
-                        break;
-                        case InterpolationType::HERMITE:
-                            outResult = hermite(a, b, time);
-                        break;
-                    }
-                    return true;
-                }
+            const double t = easing(u);
+            if constexpr (std::is_same_v<keyframe_type, glm::quat>) {
+                return slerp(values[i], values[i + 1], static_cast<float>(t));
+            } else {
+                return Interpolate::lerp(values[i], values[i + 1], t);
             }
-            return false;
         }
     };
 
@@ -4,6 +4,19 @@
 
 #include "Model.h"
 
+#include <algorithm>
+
+Texture2D MeshMaterial::createDefaultDiffuse() {
+    Texture2D diffuse;
+
+    unsigned char pixels[3] = {255, 255, 255};
+    diffuse.allocate(ColorBufferInternalFormat::RGB_8,
+        ColorBufferFormat::RGB, GLType::UNSIGNED_BYTE, 1, 1, pixels,
+        TextureMinFilter::LINEAR, TextureMagFilter::LINEAR, TextureWrap::REPEAT, false
+    );
+    return diffuse;
+}
+
 Texture2D MeshMaterial::createDefaultEmissive() {
     Texture2D emissive;
 
@@ -12,7 +25,7 @@ Texture2D MeshMaterial::createDefaultEmissive() {
         ColorBufferFormat::RGB, GLType::UNSIGNED_BYTE, 1, 1, pixels,
         TextureMinFilter::LINEAR, TextureMagFilter::LINEAR, TextureWrap::REPEAT, false
     );
-    return std::move(emissive);
+    return emissive;
 }
 
 Texture2D MeshMaterial::createDefaultNormal() {
@@ -25,7 +38,7 @@ Texture2D MeshMaterial::createDefaultNormal() {
         TextureMinFilter::LINEAR, TextureMagFilter::LINEAR, TextureWrap::REPEAT,
         false
     );
-    return std::move(normal);
+    return normal;
 }
 
 Texture2D MeshMaterial::createDefaultRoughnessMetallic() {
@@ -37,9 +50,47 @@ Texture2D MeshMaterial::createDefaultRoughnessMetallic() {
         TextureMinFilter::LINEAR, TextureMagFilter::LINEAR, TextureWrap::REPEAT,
         false
     );
-    return std::move(roughness);
+    return roughness;
 }
 
+Texture2D MeshMaterial::DEFAULT_DIFFUSE;
 Texture2D MeshMaterial::DEFAULT_EMISSIVE;
 Texture2D MeshMaterial::DEFAULT_NORMAL;
-Texture2D MeshMaterial::DEFAULT_ROUGHNESS_METALLIC;
\ No newline at end of file
+Texture2D MeshMaterial::DEFAULT_ROUGHNESS_METALLIC;
+void ModelDefinition::buildTopology() {
+    const size_t count = nodes.size();
+    order.clear();
+    order.reserve(count);
+    orderOf.assign(count, 0);
+    orderParent.assign(count, 0);
+    subtreeEnd.assign(count, 0);
+    if (count == 0) return;
+
+    std::vector<unsigned> parentOf(count, 0);
+    std::vector<unsigned> stack{ 0 };
+    while (!stack.empty()) {
+        const unsigned node = stack.back();
+        stack.pop_back();
+
+        orderOf[node] = static_cast<unsigned>(order.size());
+        order.push_back(node);
+
+        // pushed in reverse so the first child is visited first
+        const MeshNode& current = nodes[node];
+        for (size_t child = current.firstChild + current.childrenCount; child-- > current.firstChild;) {
+            parentOf[child] = node;
+            stack.push_back(static_cast<unsigned>(child));
+        }
+    }
+
+    for (size_t p = order.size(); p-- > 0;) {
+        const unsigned node = order[p];
+        orderParent[p] = parentOf[node];
+
+        size_t end = p + 1;
+        for (const auto child : nodes[node].children()) {
+            end = std::max<size_t>(end, subtreeEnd[orderOf[child]]);
+        }
+        subtreeEnd[p] = static_cast<unsigned>(end);
+    }
+}
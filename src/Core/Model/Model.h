@@ -5,6 +5,8 @@
 #include <ranges>
 #include <glm/fwd.hpp>
 #include <Renderer/Resource/Resource.h>
+#include <memory/vector.h>
+#include <util/enum_bit.h>
 
 #include "ModelPose.h"
 #include "Skeleton.h"
@@ -133,6 +135,7 @@ struct ModelDefinitionBuilder {
 };
 
 class ModelDefinition {
+    void buildTopology();
 public:
     std::string name;
     mem::vector<MeshNode> nodes;
@@ -140,6 +143,15 @@ public:
     std::unordered_map<size_t, unsigned> nameToNode;
     std::vector<MeshDrawParams> nodeDrawParams;
 
+    /*
+     * The nodes in depth first order, so every parent precedes its children and a subtree is the range
+     * [i, subtreeEnd[i]). Derived from the children ranges, `MeshNode::parent` is not used.
+     */
+    std::vector<unsigned> order;        /* node at each position */
+    std::vector<unsigned> orderOf;      /* position of each node */
+    std::vector<unsigned> orderParent;  /* parent node at each position, the root's is itself */
+    std::vector<unsigned> subtreeEnd;
+
     std::vector<Texture2DKey> textures;
     mem::vector<RMeshNode> renderNodes;
     mem::vector<MeshMaterial> materials;
@@ -155,6 +167,7 @@ public:
 
         renderNodes = std::move(builder.renderNodes);
         materials = std::move(builder.materials);
+        buildTopology();
     }
 
     MeshID findMesh(const std::string_view name) const {
@@ -175,19 +188,14 @@ public:
 };
 
 class Model : public PrimaryComponent, public TrackedComponent {
-public:
-    struct Node {
-        Transform* localTransform = nullptr;
-        glm::mat4* finalTransform = nullptr;
-        mem::bit_reference dirtyTransform = nullptr;
-    };
-private:
     struct RuntimeModelHierarchy {
         using Arena = mem::byte_arena<mem::same_alloc_schema, 64>;
         mem::vector<Transform, mem::byte_arena_adaptor<Transform, Arena>> localTransforms;
         mem::vector<glm::mat4, mem::byte_arena_adaptor<glm::mat4, Arena>> finalTransforms;
+        /* indexed by the definition's depth first position, not by node */
         mem::bitset<mem::byte_arena_adaptor<size_t, Arena>> dirtyTransforms;
         Arena nodesArena;
+        glm::mat4 modelTransform = glm::mat4(1.0f);
 
         explicit RuntimeModelHierarchy(const ModelDefinition* definition) : localTransforms(&nodesArena), finalTransforms(&nodesArena), dirtyTransforms(&nodesArena) {
             mem::bytes_required bytes;
@@ -208,34 +216,35 @@ private:
             dirtyTransforms.set_all();
         }
 
-        void buildDirtyNode(const ModelDefinition* definition, const MeshNode& node) {
-            for (size_t i : node.children()) {
-                finalTransforms[i] = finalTransforms[node.parent] * localTransforms[i].createModel3D();
-            }
-
-            for (size_t i : node.children()) {
-                for (size_t j : definition->nodes[i].children()) {
-                    buildDirtyNode(definition, definition->nodes[j]);
-                }
-            }
+        void markDirty(const ModelDefinition* definition, const size_t node) {
+            dirtyTransforms.set(definition->orderOf[node]);
         }
 
+        /* recomposes the subtree of every dirty node once, clean subtrees are never visited */
         void buildDirty(const ModelDefinition* definition) {
-            for (const auto dirty : dirtyTransforms) {
-                auto& node = definition->nodes[dirty];
-                buildDirtyNode(definition, node);
+            const size_t count = definition->size();
+            size_t rebuiltEnd = 0;
+
+            for (const size_t position : dirtyTransforms) {
+                if (position >= count) break;
+                if (position < rebuiltEnd) continue; // a dirty ancestor already covered it
+
+                rebuiltEnd = definition->subtreeEnd[position];
+                for (size_t p = position; p < rebuiltEnd; ++p) {
+                    const unsigned node = definition->order[p];
+                    const glm::mat4 local = localTransforms[node].createModel3D();
+                    finalTransforms[node] = p == 0 ? modelTransform * local : finalTransforms[definition->orderParent[p]] * local;
+                }
             }
+            dirtyTransforms.clear();
         }
 
-        void buildDirty(const glm::mat4& modelTransform, const ModelDefinition* definition) {
-            finalTransforms[0] = modelTransform * localTransforms[0].createModel3D();
-
-            for (size_t i = 0; i < definition->size(); ++i) {
-                for (const auto child : definition->nodes[i].children()) {
-                 //   finalTransforms[child] = finalTransforms[i] * definition->nodes[child].localMatrix;
-                    finalTransforms[child] = definition->nodes[child].finalTransform;
-                }
+        void buildDirty(const glm::mat4& transform, const ModelDefinition* definition) {
+            if (transform != modelTransform) {
+                modelTransform = transform;
+                dirtyTransforms.set(0);
             }
+            buildDirty(definition);
         }
 
         void clearDirtyNodes() {
@@ -266,11 +275,24 @@ public:
         return definition->findMesh(name);
     }
 
-    auto& getMeshNode(this auto&& self, const MeshID id) {
-        if (id == MeshID::INVALID) {
-            cexpr::require(false);
+    const Transform& getLocalTransform(const MeshID id) const {
+        return hierarchy.localTransforms[cexpr::enum_cast(id)];
+    }
+
+    /* takes effect at the next update */
+    void setLocalTransform(const MeshID id, const Transform& transform) {
+        hierarchy.localTransforms[cexpr::enum_cast(id)] = transform;
+        hierarchy.markDirty(definition, cexpr::enum_cast(id));
+    }
+
+    /* the blended mesh poses on top of the bind locals, a mesh whose last pose was removed returns to its bind local */
+    void applyPose(const ModelPoseStack& poses) {
+        for (const unsigned mesh : poses.getBlended(ModelPart::MESH)) {
+            if (mesh >= definition->size()) continue;
+            const Transform& bind = definition->nodes[mesh].localTransform;
+            const auto id = static_cast<MeshID>(mesh);
+            setLocalTransform(id, poses.hasPose(mesh, ModelPart::MESH) ? bind * poses.getFinalPose(mesh, ModelPart::MESH).transform : bind);
         }
-        return self.hierarchy.nodes[cexpr::enum_cast(id)];
     }
 
     const ModelDefinition* asset() const {
@@ -285,6 +307,7 @@ public:
         hierarchy.buildDirty(definition);
     }
 
+    /* a changed model transform rebuilds every node, otherwise only the changed subtrees */
     void update(const glm::mat4& modelTransform) {
         hierarchy.buildDirty(modelTransform, definition);
     }
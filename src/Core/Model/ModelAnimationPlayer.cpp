@@ -1,6 +1,7 @@
 #include "ModelAnimationPlayer.h"
 
 #include <ranges>
+#include <algorithm>
 
 #include "Model.h"
 
@@ -9,68 +10,105 @@
 #include "World/SceneGraph.h"
 #include <ECS/ECS.h>
 
-void AnimationPlayer::setKeyframesToAnimation(Viewable auto& view, AnimationTrack& track, const std::vector<AnimationChannel>& animation, const Entity modelEntity) const {;
-    for (const auto& [target, position, scale, tint, rotation] : animation) {
-        MeshPose pose;
-        unsigned kfIdx = 0;
+uint32_t AnimationPlayer::allocateChannels(const uint32_t count) {
+    if (count == 0) return 0;
+
+    for (size_t i = 0; i < freeChannels.size(); ++i) {
+        if (freeChannels[i].first == count) {
+            const uint32_t reused = freeChannels[i].second;
+            freeChannels[i] = freeChannels.back();
+            freeChannels.pop_back();
+            return reused;
+        }
+    }
+    const auto first = static_cast<uint32_t>(channels.size());
+    channels.resize(first + count);
+    return first;
+}
+
+void AnimationPlayer::releaseChannels(const AnimationTrack& track) {
+    if (track.channelCount != 0) {
+        freeChannels.emplace_back(track.channelCount, track.firstChannel);
+    }
+}
+
+void AnimationPlayer::bindChannels(Viewable auto& view, AnimationTrack& track) {
+    const auto& clipChannels = track.clip->getChannels();
+
+    for (uint32_t c = 0; c < track.channelCount; ++c) {
+        const std::string& target = clipChannels[c].target;
+        uint32_t index = NO_TARGET;
+
         switch (track.target) {
             case AnimationTarget::MODEL: {
-                auto& model = *view.get<Model>(modelEntity);
-                if (model.getMeshPart(target) == MeshID::INVALID) continue;
-                kfIdx = static_cast<unsigned>(model.getMeshPart(target));
-                pose = view.get<ModelPoseStack>(modelEntity)->getFinalPose(kfIdx, ModelPart::MESH);
+                if (const MeshID mesh = view.get<Model>(track.entity)->getMeshPart(target); mesh != MeshID::INVALID) {
+                    index = static_cast<unsigned>(mesh);
+                }
                 break;
             }
             case AnimationTarget::SKELETON: {
-                auto& skeleton = *view.get<Skeleton>(modelEntity);
-                pose.transform = skeleton.getBoneTransform(target);
-                pose.tint = glm::vec3(1);
-                kfIdx = skeleton.getBoneID(target);
+                const auto& skeleton = *view.get<Skeleton>(track.entity);
+                if (skeleton.getSkeletonAsset()->hasBone(target)) {
+                    index = static_cast<uint32_t>(skeleton.getBoneID(target));
+                }
                 break;
             }
-            case AnimationTarget::SCENE_NODE: {
-                pose.transform = *view.get<Transform>(modelEntity);
-                pose.tint = glm::vec3(1);
-                kfIdx = 0;
+            case AnimationTarget::SCENE_NODE:
+                index = 0;
                 break;
-            }
-            default:
-                pose = MeshPose{};
         }
-        auto& kf = track.keyframes.emplace_back(kfIdx, Keyframe(
-            !rotation.empty(),
-            !position.empty(),
-            !scale.empty(),
-            !tint.empty())
-        ).second;
-
-        kf.scale = scale;
-        kf.rotation = rotation;
-        kf.position = position;
-        kf.tint = tint;
-
-        kf.scale.add(pose.transform.scale, 0);
-        kf.rotation.add(pose.transform.rotation, 0);
-        kf.position.add(pose.transform.translation, 0);
-        kf.tint.add(pose.tint, 0);
+        channels[track.firstChannel + c].target = index;
     }
 }
 
-void AnimationPlayer::clearAnimationPoseForEntity(Viewable auto& view, const Entity &entity, std::vector<AnimationTrack>& track, const unsigned index) const {
-    auto& animation = *(track.begin() + index);
+void AnimationPlayer::captureStartPoses(Viewable auto& view, AnimationTrack& track) {
+    for (uint32_t c = 0; c < track.channelCount; ++c) {
+        ChannelState& state = channels[track.firstChannel + c];
+        state.hints = {};
+        if (state.target == NO_TARGET) continue;
 
-    switch (animation.target) {
+        switch (track.target) {
+            case AnimationTarget::MODEL:
+                state.from = view.get<ModelPoseStack>(track.entity)->getFinalPose(state.target, ModelPart::MESH);
+                break;
+            case AnimationTarget::SKELETON:
+                state.from.transform = view.get<Skeleton>(track.entity)->getBoneTransform(static_cast<int>(state.target));
+                state.from.tint = glm::vec3(1);
+                break;
+            case AnimationTarget::SCENE_NODE:
+                state.from.transform = *view.get<Transform>(track.entity);
+                state.from.tint = glm::vec3(1);
+                break;
+        }
+    }
+}
+
+void AnimationPlayer::clearAnimationPose(Viewable auto& view, const AnimationTrack& track) {
+    switch (track.target) {
         case AnimationTarget::SKELETON:
         case AnimationTarget::MODEL: {
-            auto& modelPose = *view.get<ModelPoseStack>(entity);
-            for (const auto& mesh: animation.keyframes | std::views::keys) {
-                modelPose.removePose(mesh, PoseID{static_cast<unsigned long long>(animation.animation)}, static_cast<ModelPart>(animation.target));
+            auto& modelPose = *view.get<ModelPoseStack>(track.entity);
+            for (uint32_t c = 0; c < track.channelCount; ++c) {
+                if (const uint32_t target = channels[track.firstChannel + c].target; target != NO_TARGET) {
+                    modelPose.removePose(target, PoseID{static_cast<unsigned long long>(track.animation)}, static_cast<ModelPart>(track.target));
+                }
             }
         }
         default: break;
     }
 }
 
+AnimationPlayer::AnimationTrack* AnimationPlayer::findTrack(const AnimationKey animation, const Entity& entity) {
+    for (auto& track : tracks) {
+        if (track.animation == animation && track.entity == entity) return &track;
+    }
+    return nullptr;
+}
+
+const AnimationPlayer::AnimationTrack* AnimationPlayer::findTrack(const AnimationKey animation, const Entity& entity) const {
+    return const_cast<AnimationPlayer*>(this)->findTrack(animation, entity);
+}
+
 AnimationStartError AnimationPlayer::play(Viewable auto view, const AnimationStartInfo& info, AnimationTarget target) {
     auto readStartInfoToTrack = [target](AnimationTrack& track, const AnimationStartInfo& animInfo, const AnimationMetadata* animation) {
         track.fadein = animInfo.fadein;
@@ -82,11 +120,12 @@ AnimationStartError AnimationPlayer::play(Viewable auto view, const AnimationSta
         track.duration = animation->duration();
         track.animation = animation->key;
         track.target = target;
+        track.currentTime = 0;
+        track.fadingToIdentity = false;
     };
 
-    AnimationMetadata* animation;
-
-    if (animation = view.get<AnimationRegistry>().findAnimation(info.animationByString); !animation) {
+    const AnimationMetadata* animation = view.get<AnimationRegistry>().findAnimation(info.animationByString);
+    if (!animation) {
         return AnimationStartError::MODEL_ANIMATION_NOT_FOUND;
     }
 
@@ -111,81 +150,79 @@ AnimationStartError AnimationPlayer::play(Viewable auto view, const AnimationSta
         }
     }
 
-    if (isAnimationPlayingFor(animation->key, info.model)) {
-        if (info.overrideExisting) {
-            for (auto& track : tracks[info.model.id()]) {
-                if (track.animation == animation.key) {
-                    readStartInfoToTrack(track, info, animation);
-                    track.keyframes.clear();
-                    track.currentTime = 0;
-                    setKeyframesToAnimation(track, animation->getChannels(), info.model.id());
-                    return AnimationStartError::SUCCESS;
-                }
-            }
+    AnimationTrack* track = findTrack(animation->key, info.model);
+    if (track) {
+        if (!info.overrideExisting) {
+            return AnimationStartError::ANIMATION_ALREADY_PLAYING;
+        }
+        if (track->clip != animation->clip) {
+            // the animation was replaced in the registry since this track started
+            releaseChannels(*track);
+            track->clip = animation->clip;
+            track->channelCount = static_cast<uint32_t>(track->clip->channelCount());
+            track->firstChannel = allocateChannels(track->channelCount);
         }
-        return AnimationStartError::ANIMATION_ALREADY_PLAYING;
+    } else {
+        const auto channelCount = static_cast<uint32_t>(animation->clip->channelCount());
+        const uint32_t firstChannel = allocateChannels(channelCount);
+
+        track = &tracks.emplace_back();
+        track->clip = animation->clip;
+        track->entity = info.model;
+        track->firstChannel = firstChannel;
+        track->channelCount = channelCount;
     }
-    AnimationTrack track;
-    readStartInfoToTrack(track, info, animation);
-    setKeyframesToAnimation(track, animation->getChannels(), info.model);
-    tracks[info.model.id()].emplace_back(std::move(track));
+    readStartInfoToTrack(*track, info, animation);
+    bindChannels(view, *track);
+    captureStartPoses(view, *track);
     return AnimationStartError::SUCCESS;
 }
 
-double AnimationPlayer::cancel(const AnimationKey animation, const Entity &forModel, const AnimationCancel options) {
-    const auto it = tracks.find(forModel);
-
-    if (it == tracks.end()) return 0;
-    auto& track = it->second;
+static MeshPose fadeToIdentity(const MeshPose& from, const double t) {
+    const auto u = static_cast<float>(std::clamp(t, 0.0, 1.0));
 
-    for (int i = 0; i < track.size(); ++i) {
-        if (track[i].animation == animation) {
-            double exitTime = track[i].currentTime;
-
-            if (options & AnimationCancel::IMMEDIATE) {
-                track.erase(track.begin() + i);
-
-                if (track.empty()) tracks.erase(it);
-                return exitTime;
-            }
-            if (options & AnimationCancel::KEEP_FADEOUT) {
-                track[i].duration = track[i].currentTime + track[i].fadeout.duration;
-            }
-            if (options & AnimationCancel::FADE_TO_IDENTITY) {
-                track[i].duration = track[i].currentTime + track[i].fadeout.duration;
-
-                for (auto & keyframe: track[i].keyframes | std::views::values) {
-                    const double fadeOutTime = track[i].currentTime + track[i].fadeout.duration;
-                    const double currentTime = track[i].currentTime;
-
-                    auto rkf = keyframe.rotation.at(currentTime);
-                    auto skf = keyframe.scale.at(currentTime);
-                    auto pkf = keyframe.position.at(currentTime);
-                    auto tkf = keyframe.tint.at(currentTime);
-
-                    keyframe.rotation.clear();
-                    keyframe.scale.clear();
-                    keyframe.position.clear();
-                    keyframe.tint.clear();
-
-                    keyframe.rotation.add(rkf, currentTime);
-                    keyframe.rotation.add(glm::quat(1, 0, 0, 0), fadeOutTime);
+    MeshPose pose;
+    pose.transform.translation = glm::mix(from.transform.translation, glm::vec3(0.f), u);
+    pose.transform.scale = glm::mix(from.transform.scale, glm::vec3(1.f), u);
+    pose.transform.rotation = glm::slerp(from.transform.rotation, glm::quat(1, 0, 0, 0), u);
+    pose.tint = glm::mix(from.tint, glm::vec3(1.f), u);
+    return pose;
+}
 
-                    keyframe.scale.add(skf, currentTime);
-                    keyframe.scale.add(glm::vec3(1.0f), fadeOutTime);
+double AnimationPlayer::cancel(const AnimationKey animation, const Entity &forModel, const AnimationCancel options) {
+    AnimationTrack* track = findTrack(animation, forModel);
+    if (!track) return 0;
 
-                    keyframe.position.add(pkf, currentTime);
-                    keyframe.position.add(glm::vec3(0.0f), fadeOutTime);
+    const double exitTime = track->currentTime;
 
-                    keyframe.tint.add(tkf, currentTime);
-                    keyframe.tint.add(glm::vec3(1.0f), fadeOutTime);
-                }
-            }
-            track[i].repeating = false;
-            return exitTime;
+    if (options & AnimationCancel::IMMEDIATE) {
+        releaseChannels(*track);
+        if (track != &tracks.back()) {
+            *track = std::move(tracks.back());
         }
+        tracks.pop_back();
+        return exitTime;
     }
-    return 0;
+    if (options & AnimationCancel::KEEP_FADEOUT) {
+        track->duration = track->currentTime + track->fadeout.duration;
+    }
+    if (options & AnimationCancel::FADE_TO_IDENTITY) {
+        track->duration = track->currentTime + track->fadeout.duration;
+
+        // freeze the current pose as the start of the fade
+        const auto time = static_cast<float>(track->currentTime);
+        const double fadeProgress = track->fadeout.duration > 0 ? (track->currentTime - track->fadeStart) / track->fadeout.duration : 1.0;
+        for (uint32_t c = 0; c < track->channelCount; ++c) {
+            ChannelState& state = channels[track->firstChannel + c];
+            state.from = track->fadingToIdentity
+                ? fadeToIdentity(state.from, fadeProgress)
+                : track->clip->sample(c, time, state.from, state.hints);
+        }
+        track->fadingToIdentity = true;
+        track->fadeStart = track->currentTime;
+    }
+    track->repeating = false;
+    return exitTime;
 }
 
 double AnimationPlayer::cancel(Viewable auto view, const std::string& animation, const Entity &forModel, const AnimationCancel options) {
@@ -195,126 +232,69 @@ double AnimationPlayer::cancel(Viewable auto view, const std::string& animation,
     return 0;
 }
 
-static void test3(View<ModelPoseStack> view) {
-}
-
-struct LOL : PrimaryComponent {};
-static void test(View<AnimationPlayer> view) {
-   // test3(view);
-}
-
 void AnimationPlayer::onUpdate(LevelUpdateView<AnimationPlayer>& view) {
-    std::vector<std::pair<Entity, unsigned>> tracksToDelete;
-
-    test(view);
-
-    for (auto& [animEntity, track] : tracks) {
-        std::vector<int> tracksToRepeat;
-        auto& poseStack = *view.get<ModelPoseStack>(animEntity);
-
-        auto now = std::chrono::high_resolution_clock::now();
-        for (int trackIndex = 0; trackIndex < track.size(); ++trackIndex) {
-            auto& [keyframes, animation,
-                currTime, duration, speed,
-                weight, blend, fadein,
-                fadeout, repeating, animTarget]
-            = track[trackIndex];
-
-            const double fadeoutDuration = fadeout.duration / speed;
-            const double fadeinDuration = fadein.duration / speed;
-            const double fadeInInfluence = (fadeinDuration > 0.0001 && !repeating) ? Interpolate::lerp(0.0, 1.0, currTime / fadeinDuration, fadein.easing) : 1;
-            const double fadeOutInfluence = (fadeoutDuration > 0.0001 && !repeating) ? Interpolate::lerp(0.0, 1.0, (duration - currTime) / fadeoutDuration, fadeout.easing) : 1;
-            const double fadeInOutWeight = std::clamp(fadeInInfluence, 0.0, 1.0) * std::clamp(fadeOutInfluence, 0.0, 1.0);
-            const double resultWeight = weight * fadeInOutWeight;
-
-            for (auto& [target, frame] : keyframes) {
-                MeshPose pose;
-                pose.transform.translation = frame.position.at(currTime, frame.pHint);
-                pose.transform.scale = frame.scale.at(currTime, frame.sHint);
-                pose.transform.rotation = frame.rotation.at(currTime, frame.rHint);
-                pose.tint = frame.tint.at(currTime, frame.tHint);
-
-                switch (animTarget) {
-                    case AnimationTarget::MODEL: {
-                        auto& model = *view.get<Model>(animEntity);
-                        poseStack.setPose(target, PoseID{static_cast<unsigned long long>(animation)}, pose, MeshAffected{frame.affected}, blend, resultWeight, ModelPart::MESH);
-                     //   if (target == 0)
-                        //    scene.getEntityManager().addState<SceneGraphNodeInvalidated>(animEntity);
-                    //    else
-                       //     scene.getEntityManager().addState<SceneGraphNodeInvalidated>(model.getMeshByMeshID(target));
-                        break;
-                    }
-                    case AnimationTarget::SKELETON: {
-                        poseStack.setPose(target, PoseID{static_cast<unsigned long long>(animation)}, pose, MeshAffected{frame.affected}, blend, resultWeight, ModelPart::BONE);
-                    //    scene.getEntityManager().addState<SceneGraphNodeInvalidated>(animEntity);
-                        break;
-                    }
-                    case AnimationTarget::SCENE_NODE: {
-                        poseStack.setPose(0, PoseID{static_cast<unsigned long long>(animation)}, pose, MeshAffected{frame.affected}, blend, resultWeight, ModelPart::MESH);
-                    //    scene.getEntityManager().addState<SceneGraphNodeInvalidated>(animEntity);
-                        break;
-                    }
-                    default: std::unreachable();
-                }
-            }
-            if (currTime >= duration) {
-                if (repeating) {
-                    tracksToRepeat.emplace_back(trackIndex);
-                } else {
-                    tracksToDelete.emplace_back(animEntity, trackIndex);
+    for (size_t i = 0; i < tracks.size();) {
+        AnimationTrack& track = tracks[i];
+        auto& poseStack = *view.get<ModelPoseStack>(track.entity);
+
+        const double fadeoutDuration = track.fadeout.duration / track.speed;
+        const double fadeinDuration = track.fadein.duration / track.speed;
+        const double fadeInInfluence = (fadeinDuration > 0.0001 && !track.repeating) ? Interpolate::lerp(0.0, 1.0, track.currentTime / fadeinDuration, track.fadein.easing) : 1;
+        const double fadeOutInfluence = (fadeoutDuration > 0.0001 && !track.repeating) ? Interpolate::lerp(0.0, 1.0, (track.duration - track.currentTime) / fadeoutDuration, track.fadeout.easing) : 1;
+        const double fadeInOutWeight = std::clamp(fadeInInfluence, 0.0, 1.0) * std::clamp(fadeOutInfluence, 0.0, 1.0);
+        const double resultWeight = track.weight * fadeInOutWeight;
+
+        const PoseID poseID{static_cast<unsigned long long>(track.animation)};
+        const ModelPart part = track.target == AnimationTarget::SKELETON ? ModelPart::BONE : ModelPart::MESH;
+        const auto& clipChannels = track.clip->getChannels();
+        const auto time = static_cast<float>(track.currentTime);
+        const double fadeProgress = track.fadeout.duration > 0 ? (track.currentTime - track.fadeStart) / track.fadeout.duration : 1.0;
+
+        for (uint32_t c = 0; c < track.channelCount; ++c) {
+            ChannelState& state = channels[track.firstChannel + c];
+            if (state.target == NO_TARGET) continue;
+
+            const MeshPose pose = track.fadingToIdentity
+                ? fadeToIdentity(state.from, fadeProgress)
+                : track.clip->sample(c, time, state.from, state.hints);
+
+            poseStack.setPose(state.target, poseID, pose, clipChannels[c].affected, track.blend, resultWeight, part);
+        }
+
+        if (track.currentTime >= track.duration) {
+            if (track.repeating) {
+                track.currentTime = 0;
+                captureStartPoses(view, track);
+                ++i;
+            } else {
+                clearAnimationPose(view, track);
+                releaseChannels(track);
+                if (&track != &tracks.back()) {
+                    track = std::move(tracks.back());
                 }
+                tracks.pop_back();
             }
-            currTime += 0.016 * speed; // removed deltaTime *;
-        }
-        for (auto& index : tracksToRepeat) {
-            track[index].keyframes.clear();
-            track[index].currentTime = 0;
-            auto animation = track[index].animation;
-            setKeyframesToAnimation(view, track[index], view.get<AnimationRegistry>().findAnimation(animation).getChannels(), animEntity);
-        }
-        tracksToRepeat.clear();
-    }
-    for (auto& [entity, index] : tracksToDelete) {
-        clearAnimationPoseForEntity(view, entity, tracks[entity], index);
-        if (auto& track = tracks[entity]; track.size() == 1) {
-            clearAnimationPoseForEntity(view, entity, track, 0);
-            tracks.erase(entity);
-        } else {
-            clearAnimationPoseForEntity(view, entity, track, index);
-            track.erase(track.begin() + index);
+            continue;
         }
+        track.currentTime += 0.016 * track.speed; // removed deltaTime *;
+        ++i;
     }
 }
 
 bool AnimationPlayer::isAnimationPlayingFor(const AnimationKey animation, const Entity &entity) {
-    const auto it = tracks.find(entity);
-
-    if (it == tracks.end()) {
-        return false;
-    }
-    return std::ranges::any_of(it->second, [&](const AnimationTrack& track) {
-        return track.animation == animation;
-    });
+    return findTrack(animation, entity) != nullptr;
 }
 
 bool AnimationPlayer::isAnimationPlayingFor(Viewable auto view, const std::string& animation, const Entity &forModel) {
-    AnimationMetadata* anim;
-
-    if (anim = view.get<AnimationRegistry>().findAnimation(animation)) {
+    if (const AnimationMetadata* anim = view.get<AnimationRegistry>().findAnimation(animation)) {
         return isAnimationPlayingFor(anim->key, forModel);
     }
     return false;
 }
 
 double AnimationPlayer::getAnimationProgress(const AnimationKey animation, const Entity &forModel) const {
-    const auto it = tracks.find(forModel);
-    if (it == tracks.end()) return 1;
-
-    for (const auto& track : it->second) {
-        if (track.animation== animation) {
-            return track.currentTime / track.duration; // track.duration non-zero
-        }
+    if (const AnimationTrack* track = findTrack(animation, forModel)) {
+        return track->currentTime / track->duration; // track.duration non-zero
     }
     return 1;
 }
-
@@ -79,31 +79,29 @@ struct AnimationStartInfo {
 
 class Skeleton;
 
+/*
+ * Plays AnimationClips shared through the AnimationRegistry. A track only holds its clip, its playback cursor and,
+ * per clip channel, the resolved mesh/bone, the pose it started from and the key hints, so starting or repeating
+ * an animation copies no curves. Channel state lives in one pool; released ranges are reused by later tracks of
+ * the same channel count, so steady state playback does not allocate.
+ */
 class AnimationPlayer : Writes<ModelPoseStack>, Reads<Model, Skeleton, Transform>, ReadsResources<AnimationRegistry>, Stages<DefaultStage> {
     FRIEND_DESCRIPTOR
 
-    struct Keyframe {
-        FCurve3 position, scale, tint;
-        QCurve rotation;
-        size_t pHint = 0, sHint = 0, tHint = 0, rHint = 0;
-        short affected;
-
-        Keyframe() : position(), tint(), rotation(), affected(4) {}
-
-        Keyframe(const bool rotation, const bool moving, const bool scaling, const bool tinting) : position(), scale(),
-            rotation(),
-            affected(0)
-        {
-            affected |= (moving << 0);
-            affected |= (scaling << 1);
-            affected |= (rotation << 2);
-            affected |= (tinting << 3);
-        }
+    constexpr static uint32_t NO_TARGET = ~0u;
+
+    struct ChannelState {
+        MeshPose from;
+        AnimationClip::Hints hints{};
+        uint32_t target = NO_TARGET;
     };
 
     struct AnimationTrack {
-        std::vector<std::pair<unsigned, Keyframe>> keyframes;
+        std::shared_ptr<const AnimationClip> clip;
+        Entity entity;
         AnimationKey animation;
+        uint32_t firstChannel = 0;
+        uint32_t channelCount = 0;
         double currentTime = 0;
         double duration = 0;
         double speed;
@@ -112,16 +110,28 @@ class AnimationPlayer : Writes<ModelPoseStack>, Reads<Model, Skeleton, Transform
         FadeIn fadein;
         FadeOut fadeout;
         bool repeating = false;
+        /* set by cancel(FADE_TO_IDENTITY), the channels' `from` then holds the pose being faded out */
+        bool fadingToIdentity = false;
+        double fadeStart = 0;
         AnimationTarget target;
     };
 
-    void setKeyframesToAnimation(Viewable auto& view,
-                                 AnimationTrack &track, const std::vector<AnimationChannel> &animation, Entity modelEntity
-    ) const;
+    uint32_t allocateChannels(uint32_t count);
+    void releaseChannels(const AnimationTrack& track);
+
+    /* resolves the channel targets and captures the pose each starts from */
+    void bindChannels(Viewable auto& view, AnimationTrack& track);
+    void captureStartPoses(Viewable auto& view, AnimationTrack& track);
+
+    void clearAnimationPose(Viewable auto& view, const AnimationTrack& track);
 
-    void clearAnimationPoseForEntity(Viewable auto& view, const Entity &entity, std::vector<AnimationTrack> &track, unsigned index) const;
+    AnimationTrack* findTrack(AnimationKey animation, const Entity& entity);
+    const AnimationTrack* findTrack(AnimationKey animation, const Entity& entity) const;
 
-    std::unordered_map<Entity, std::vector<AnimationTrack>> tracks;
+    std::vector<AnimationTrack> tracks;
+    std::vector<ChannelState> channels;
+    /* (channel count, first channel) of released ranges */
+    std::vector<std::pair<uint32_t, uint32_t>> freeChannels;
 public:
 
     AnimationStartError play(Viewable auto view, const AnimationStartInfo& info, AnimationTarget target = AnimationTarget::MODEL);
@@ -135,4 +145,8 @@ public:
     bool isAnimationPlayingFor(Viewable auto view, const std::string &animation, const Entity &forModel);
 
     double getAnimationProgress(AnimationKey animation, const Entity &forModel) const;
+
+    size_t trackCount() const {
+        return tracks.size();
+    }
 };
\ No newline at end of file
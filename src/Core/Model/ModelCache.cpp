@@ -0,0 +1,317 @@
+#include "ModelCache.h"
+
+#include <Util/MappedFile.h>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <thread>
+#include <type_traits>
+
+namespace {
+    enum Section : uint32_t {
+        VERTICES, INDICES, NODES, MESH_INDICES, RENDER_NODES, MATERIALS, NAMES, TEXTURE_PATHS, SECTION_COUNT
+    };
+
+    struct SectionEntry {
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t vertexSize;
+        uint32_t sectionCount;
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        SectionEntry sections[SECTION_COUNT];
+    };
+
+    struct NodeRecord {
+        glm::mat4 localMatrix;
+        glm::mat4 finalTransform;
+        glm::quat rotation;
+        glm::vec3 translation;
+        glm::vec3 scale;
+        uint64_t parent;
+        uint64_t firstChild;
+        uint64_t childrenCount;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t firstMeshIndex;
+        uint32_t meshCount;
+    };
+
+    struct MaterialRecord {
+        int32_t diffuse;
+        int32_t metallicRoughness;
+        int32_t normal;
+        int32_t emissive;
+        uint32_t isTransparent;
+    };
+
+    constexpr char MAGIC[4] = { 'K', 'M', 'D', 'L' };
+
+    // records are copied byte for byte, any padding would make the files differ between runs
+    static_assert(sizeof(Vertex) == 22 * sizeof(float));
+    static_assert(sizeof(RMeshNode) == 5 * sizeof(unsigned));
+    static_assert(sizeof(NodeRecord) == 208);
+    static_assert(sizeof(MaterialRecord) == 20);
+    static_assert(std::is_trivially_copyable_v<Vertex> && std::is_trivially_copyable_v<RMeshNode>);
+    static_assert(std::is_trivially_copyable_v<NodeRecord> && std::is_trivially_copyable_v<MaterialRecord>);
+
+    size_t alignUp(const size_t offset) {
+        return (offset + ModelCache::ALIGNMENT - 1) & ~(ModelCache::ALIGNMENT - 1);
+    }
+
+    class Writer {
+        std::vector<std::byte>& out;
+    public:
+        explicit Writer(std::vector<std::byte>& out) : out(out) {}
+
+        template <typename T>
+        SectionEntry section(const T* data, const size_t count) {
+            const size_t offset = alignUp(out.size());
+            out.resize(offset + count * sizeof(T));
+            if (count) std::memcpy(out.data() + offset, data, count * sizeof(T));
+            return { offset, count };
+        }
+    };
+
+    template <typename T>
+    std::span<const T> view(const std::span<const std::byte> bytes, const SectionEntry& entry) {
+        return { reinterpret_cast<const T*>(bytes.data() + entry.offset), static_cast<size_t>(entry.count) };
+    }
+
+    bool fits(const std::span<const std::byte> bytes, const SectionEntry& entry, const size_t elementSize) {
+        if (entry.offset % ModelCache::ALIGNMENT != 0 || entry.offset > bytes.size()) return false;
+        return entry.count <= (bytes.size() - entry.offset) / elementSize;
+    }
+
+    bool within(const uint64_t first, const uint64_t count, const size_t size) {
+        return first <= size && count <= size - first;
+    }
+
+    /* every node but the root is the child of exactly one node before it, so ModelDefinition can walk them as a tree */
+    bool formsTree(const std::span<const NodeRecord> nodes) {
+        std::vector<bool> claimed(nodes.size(), false);
+        size_t children = 0;
+        for (size_t n = 0; n < nodes.size(); ++n) {
+            const NodeRecord& record = nodes[n];
+            if (record.childrenCount == 0) continue;
+            if (record.firstChild <= n || !within(record.firstChild, record.childrenCount, nodes.size())) return false;
+
+            for (uint64_t child = record.firstChild; child < record.firstChild + record.childrenCount; ++child) {
+                if (claimed[child]) return false;
+                claimed[child] = true;
+            }
+            children += record.childrenCount;
+        }
+        return nodes.empty() || children == nodes.size() - 1;
+    }
+}
+
+ModelCache::SourceStamp ModelCache::SourceStamp::of(const std::string& path) {
+    std::error_code error;
+    const auto size = std::filesystem::file_size(path, error);
+    if (error) return {};
+
+    const auto time = std::filesystem::last_write_time(path, error);
+    if (error) return {};
+
+    return { static_cast<uint64_t>(size), static_cast<int64_t>(time.time_since_epoch().count()) };
+}
+
+std::vector<std::byte> ModelCache::serialize(const ModelDefinitionBuilder& model, const SourceStamp& stamp) {
+    std::vector<NodeRecord> nodes;
+    nodes.reserve(model.nodes.size());
+    for (const MeshNode& node : model.nodes) {
+        NodeRecord& record = nodes.emplace_back();
+        std::memset(&record, 0, sizeof(record));
+        record.localMatrix = node.localMatrix;
+        record.finalTransform = node.finalTransform;
+        record.rotation = node.localTransform.rotation;
+        record.translation = node.localTransform.translation;
+        record.scale = node.localTransform.scale;
+        record.parent = node.parent;
+        record.firstChild = node.firstChild;
+        record.childrenCount = node.childrenCount;
+        record.nameOffset = static_cast<uint32_t>(node.name.data() - model.names.data());
+        record.nameLength = static_cast<uint32_t>(node.name.size());
+        record.firstMeshIndex = node.firstMeshIndex;
+        record.meshCount = node.meshCount;
+    }
+
+    std::vector<MaterialRecord> materials;
+    materials.reserve(model.materials.size());
+    for (const MeshMaterial& material : model.materials) {
+        materials.push_back({ material.diffuse, material.metallicRoughness, material.normal, material.emissive, material.isTransparent });
+    }
+
+    std::vector<char> paths;
+    for (const std::string& path : model.texturePaths) {
+        paths.insert(paths.end(), path.begin(), path.end());
+        paths.push_back('\0');
+    }
+
+    std::vector<std::byte> out(sizeof(Header));
+    Writer writer(out);
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.vertexSize = sizeof(Vertex);
+    header.sectionCount = SECTION_COUNT;
+    header.sourceSize = stamp.size;
+    header.sourceTime = stamp.writeTime;
+
+    header.sections[VERTICES] = writer.section(model.vertices.data(), model.vertices.size());
+    header.sections[INDICES] = writer.section(model.indices.data(), model.indices.size());
+    header.sections[NODES] = writer.section(nodes.data(), nodes.size());
+    header.sections[MESH_INDICES] = writer.section(model.meshIndicesArena.data(), model.meshIndicesArena.size());
+    header.sections[RENDER_NODES] = writer.section(model.renderNodes.data(), model.renderNodes.size());
+    header.sections[MATERIALS] = writer.section(materials.data(), materials.size());
+    header.sections[NAMES] = writer.section(model.names.data(), model.names.size());
+    header.sections[TEXTURE_PATHS] = writer.section(paths.data(), paths.size());
+
+    std::memcpy(out.data(), &header, sizeof(header));
+    return out;
+}
+
+std::expected<ModelDefinitionBuilder, ModelLoadError> ModelCache::deserialize(const std::span<const std::byte> bytes, const SourceStamp& stamp) {
+    if (bytes.size() < sizeof(Header)) return std::unexpected(ModelLoadError::CACHE_CORRUPT);
+
+    Header header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) return std::unexpected(ModelLoadError::CACHE_CORRUPT);
+    if (header.version != VERSION || header.vertexSize != sizeof(Vertex) || header.sectionCount != SECTION_COUNT) {
+        return std::unexpected(ModelLoadError::CACHE_VERSION);
+    }
+    if (stamp.exists() && stamp != SourceStamp{ header.sourceSize, header.sourceTime }) {
+        return std::unexpected(ModelLoadError::CACHE_STALE);
+    }
+
+    constexpr std::array<size_t, SECTION_COUNT> elementSizes = {
+        sizeof(Vertex), sizeof(unsigned), sizeof(NodeRecord), sizeof(unsigned),
+        sizeof(RMeshNode), sizeof(MaterialRecord), sizeof(char), sizeof(char)
+    };
+    for (uint32_t s = 0; s < SECTION_COUNT; ++s) {
+        if (!fits(bytes, header.sections[s], elementSizes[s])) return std::unexpected(ModelLoadError::CACHE_CORRUPT);
+    }
+
+    const auto vertices = view<Vertex>(bytes, header.sections[VERTICES]);
+    const auto indices = view<unsigned>(bytes, header.sections[INDICES]);
+    const auto nodes = view<NodeRecord>(bytes, header.sections[NODES]);
+    const auto meshIndices = view<unsigned>(bytes, header.sections[MESH_INDICES]);
+    const auto renderNodes = view<RMeshNode>(bytes, header.sections[RENDER_NODES]);
+    const auto materials = view<MaterialRecord>(bytes, header.sections[MATERIALS]);
+    const auto names = view<char>(bytes, header.sections[NAMES]);
+    const auto paths = view<char>(bytes, header.sections[TEXTURE_PATHS]);
+
+    // a model built from the cache indexes with these without checking, so they are checked here
+    if (!formsTree(nodes)) return std::unexpected(ModelLoadError::CACHE_CORRUPT);
+    for (const NodeRecord& record : nodes) {
+        if (record.parent >= nodes.size() && record.parent != ~uint64_t(0)) return std::unexpected(ModelLoadError::CACHE_CORRUPT);
+        if (!within(record.nameOffset, record.nameLength, names.size())) return std::unexpected(ModelLoadError::CACHE_CORRUPT);
+        if (!within(record.firstMeshIndex, record.meshCount, meshIndices.size())) return std::unexpected(ModelLoadError::CACHE_CORRUPT);
+    }
+    // ModelDefinition drops the arena and draws renderNodes by arena position, so both have to be in range
+    if (meshIndices.size() > renderNodes.size()) return std::unexpected(ModelLoadError::CACHE_CORRUPT);
+    for (const unsigned index : meshIndices) {
+        if (index >= renderNodes.size()) return std::unexpected(ModelLoadError::CACHE_CORRUPT);
+    }
+    for (const RMeshNode& node : renderNodes) {
+        const MeshDrawParams& draw = node.drawParams;
+        if (!within(draw.vertexOffset, draw.vertexCount, vertices.size()) || !within(draw.indexOffset, draw.indexCount, indices.size())
+            || node.materialIndex >= materials.size()) {
+            return std::unexpected(ModelLoadError::CACHE_CORRUPT);
+        }
+    }
+
+    ModelDefinitionBuilder model(nodes.size(), meshIndices.size(), names.size());
+
+    model.vertices.assign(vertices.begin(), vertices.end());
+    model.indices.assign(indices.begin(), indices.end());
+
+    for (const char c : names) {
+        model.names.emplace_back(c);
+    }
+
+    for (const NodeRecord& record : nodes) {
+        MeshNode& node = model.nodes.emplace_back();
+        node.parent = record.parent;
+        node.localTransform.translation = record.translation;
+        node.localTransform.scale = record.scale;
+        node.localTransform.rotation = record.rotation;
+        node.localMatrix = record.localMatrix;
+        node.finalTransform = record.finalTransform;
+        node.name = { model.names.data() + record.nameOffset, record.nameLength };
+        node.firstChild = record.firstChild;
+        node.childrenCount = record.childrenCount;
+        node.firstMeshIndex = record.firstMeshIndex;
+        node.meshCount = record.meshCount;
+
+        model.nameToNode.emplace(std::hash<std::string_view>{}(node.name), static_cast<unsigned>(model.nodes.size() - 1));
+    }
+
+    for (const unsigned index : meshIndices) {
+        model.meshIndicesArena.emplace_back(index);
+    }
+
+    model.renderNodes.reserve(renderNodes.size());
+    for (const RMeshNode& node : renderNodes) {
+        model.renderNodes.emplace_back(node);
+    }
+
+    model.materials.reserve(materials.size());
+    for (const MaterialRecord& record : materials) {
+        MeshMaterial& material = model.materials.emplace_back();
+        material.diffuse = record.diffuse;
+        material.metallicRoughness = record.metallicRoughness;
+        material.normal = record.normal;
+        material.emissive = record.emissive;
+        material.isTransparent = record.isTransparent != 0;
+    }
+
+    if (paths.size() != 0 && paths.back() != '\0') return std::unexpected(ModelLoadError::CACHE_CORRUPT);
+    for (size_t begin = 0; begin < paths.size();) {
+        const std::string_view path(paths.data() + begin);
+        model.texturePaths.emplace_back(path);
+        model.pathToTexture.emplace(std::hash<std::string_view>{}(path), static_cast<unsigned>(model.texturePaths.size() - 1));
+        begin += path.size() + 1;
+    }
+    return model;
+}
+
+std::expected<void, ModelLoadError> ModelCache::write(const std::string& path, const ModelDefinitionBuilder& model, const SourceStamp& stamp) {
+    const std::vector<std::byte> bytes = serialize(model, stamp);
+
+    // one temporary per write, so loads of the same model on different workers never share one
+    static std::atomic<uint64_t> writes = 0;
+    const std::string temporary = path + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()))
+        + "." + std::to_string(writes.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) return std::unexpected(ModelLoadError::CACHE_WRITE_FAILED);
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!file) return std::unexpected(ModelLoadError::CACHE_WRITE_FAILED);
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return std::unexpected(ModelLoadError::CACHE_WRITE_FAILED);
+    }
+    return {};
+}
+
+std::expected<ModelDefinitionBuilder, ModelLoadError> ModelCache::read(const std::string& path, const SourceStamp& stamp) {
+    const MappedFile file(path);
+    if (!file.isOpen()) return std::unexpected(ModelLoadError::CACHE_MISS);
+    return deserialize(file.bytes(), stamp);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include "Model.h"
+#include "ModelLoadError.h"
+
+/*
+ * Binary image of an imported ModelDefinitionBuilder, written next to the source asset on the first import
+ * and memory mapped on the next ones instead of going through Assimp.
+ *
+ * Layout: a fixed Header followed by the sections it points at, each 16 byte aligned. Vertices, indices, render
+ * nodes and names are the in-memory arrays byte for byte, nodes and materials are stored as fixed records
+ * (names become offsets into the names section) and texture paths as consecutive null terminated strings.
+ * The header keeps the source file's size and write time, a cache whose source changed is rejected as stale.
+ */
+class ModelCache {
+public:
+    constexpr static uint32_t VERSION = 1;
+    constexpr static size_t ALIGNMENT = 16;
+
+    struct SourceStamp {
+        uint64_t size = 0;
+        int64_t writeTime = 0;
+
+        /* a zero stamp if the source does not exist */
+        static SourceStamp of(const std::string& path);
+
+        bool exists() const {
+            return size != 0 || writeTime != 0;
+        }
+
+        bool operator==(const SourceStamp&) const = default;
+    };
+
+    static std::string cachePathOf(const std::string& source) {
+        return source + ".kmdl";
+    }
+
+    static std::vector<std::byte> serialize(const ModelDefinitionBuilder& model, const SourceStamp& stamp);
+
+    /* the builder's nodes point into its own names, the input can be unmapped afterwards */
+    static std::expected<ModelDefinitionBuilder, ModelLoadError> deserialize(std::span<const std::byte> bytes, const SourceStamp& stamp);
+
+    /* writes through a temporary file, so a concurrent reader never maps a partial cache */
+    static std::expected<void, ModelLoadError> write(const std::string& path, const ModelDefinitionBuilder& model, const SourceStamp& stamp);
+
+    /* a missing source stamp accepts any cache of the current version, so caches can ship without their sources */
+    static std::expected<ModelDefinitionBuilder, ModelLoadError> read(const std::string& path, const SourceStamp& stamp);
+};
@@ -1,22 +1,79 @@
 #pragma once
+#include <vector>
+
 #include "Model.h"
+#include "ModelPose.h"
+#include "Skeleton.h"
+#include "TransformBatch.h"
+#include "Collision/PhysicsStage.h"
 
-struct ModelGraphUpdateSystem : Writes<Model>, Reads<Transform> {
+struct ModelGraphUpdateSystem : Writes<Model, ModelPoseStack, Skeleton>, Reads<Transform, PreviousTransform> {
     FRIEND_DESCRIPTOR
 
+    /* blends every pose stack once, then hands the changed mesh poses to the models and the bone poses to the skeletons */
+    static void applyPoses(Viewable auto& view, std::vector<Model*>& posed) {
+        std::vector<ModelPoseStack*> stacks;
+        view.query<ModelPoseStack>().forEach([&](const Entity, ModelPoseStack& stack) {
+            stacks.push_back(&stack);
+        });
+        if (stacks.empty()) return;
+        ModelPoseStack::blendAll(stacks);
+
+        view.query<ModelPoseStack, Model>().forEach([&](const Entity, const ModelPoseStack& poses, Model& model) {
+            if (poses.getBlended(ModelPart::MESH).empty()) return;
+            model.applyPose(poses);
+            posed.push_back(&model);
+        });
+
+        view.query<ModelPoseStack, Skeleton>().forEach([&](const Entity, const ModelPoseStack& poses, Skeleton& skeleton) {
+            for (const unsigned bone : poses.getBlended(ModelPart::BONE)) {
+                // a bone whose last pose was removed keeps it
+                if (poses.hasPose(bone, ModelPart::BONE)) {
+                    skeleton.setBoneTransform(static_cast<int>(bone), poses.getFinalPose(bone, ModelPart::BONE).transform);
+                }
+            }
+        });
+    }
+
     static void onLevelLoad(LevelLoadView<ModelGraphUpdateSystem> view) {
         view.enableEventEmission<Model>();
     }
 
     static void onLevelOut(LevelOutView<ModelGraphUpdateSystem> view) {
+        std::vector<Model*> posed;
+        applyPoses(view, posed);
+
+        std::vector<Model*> models;
+        std::vector<Transform> changed;
+        const float alpha = view.getAlpha();
+
         view.query<Model>().forEachNewComponent([&](const Entity e, Model& model) {
+            // interpolated bodies are updated below, new or not
+            if (view.has<PreviousTransform>(e)) return;
             if (auto transform = view.get<Transform>(e)) {
-                model.update(transform->createModel3D());
+                models.push_back(&model);
+                changed.push_back(*transform);
             }
         });
         view.query<Model, Transform>().forEachChanged<Transform>([&](const Entity e, Model& model, const Transform& transform) {
-            model.update(transform.createModel3D());
-            model.clearDirtyNodes();
+            if (view.has<PreviousTransform>(e)) return;
+            models.push_back(&model);
+            changed.push_back(transform);
+        });
+        // interpolated bodies move on frames without a physics step as well
+        view.query<Model, Transform, PreviousTransform>().forEach([&](const Entity e, Model& model, const Transform& transform, const PreviousTransform& previous) {
+            models.push_back(&model);
+            changed.push_back(renderTransform(transform, &previous, alpha));
         });
+
+        std::vector<glm::mat4> matrices(changed.size());
+        transforms::composeMatrices(changed, matrices.data());
+        for (size_t i = 0; i < models.size(); ++i) {
+            models[i]->update(matrices[i]);
+        }
+        // posed models that did not move, the ones that did were rebuilt above and have nothing left dirty
+        for (Model* model : posed) {
+            model->update();
+        }
     }
 };
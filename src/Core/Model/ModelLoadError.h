@@ -0,0 +1,6 @@
+#pragma once
+
+enum class ModelLoadError {
+	SUCCESS, FILE_NOT_FOUND, IMPORT_FAILED,
+	CACHE_MISS, CACHE_STALE, CACHE_VERSION, CACHE_CORRUPT, CACHE_WRITE_FAILED
+};
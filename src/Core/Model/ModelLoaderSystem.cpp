@@ -5,6 +5,7 @@
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include "ModelAnimation.h"
+#include "ModelCache.h"
 
 
 constexpr auto AI_PROCESS_FLAGS = aiProcess_Triangulate |
@@ -38,7 +39,6 @@ void loadAnimations(S &model, const aiScene *scene) {
                 animation.addRotation(chan->mNodeName.C_Str(), posKey.mTime / speed, glm::quat(posKey.mValue.w, posKey.mValue.x, posKey.mValue.y, posKey.mValue.z));
             }
         }
-        std::cout << "Animation Loaded: " << scene->mAnimations[a]->mName.C_Str() << ": " << scene->mAnimations[a]->mDuration << std::endl;
     }
 }
 
@@ -77,8 +77,6 @@ auto& loadTransformNode(ModelDefinitionBuilder& def, const MeshNode* parentNode,
     defNode.finalTransform = (parentNode ? parentNode->finalTransform : glm::mat4(1.f)) * glmTransform;
     defNode.localMatrix = glmTransform;
 
-    std::cout << "Mesh: " << node->mName.C_Str() << ": " << std::endl;
-    std::cout << "  Transform: " << transform << std::endl;
     const char* meshName = node->mName.C_Str();
     const char* firstPtr = def.getNames().data() + def.getNames().size();
 
@@ -138,35 +136,36 @@ MeshDrawParams loadMeshVertices(ModelDefinitionBuilder& model, const aiMesh* mes
     const unsigned indicesOffset = model.indices.size();
     const unsigned vertexOffset = model.vertices.size();
 
+    // value initialized, so the texture coordinates of meshes without any stay zero
+    model.vertices.resize(vertexOffset + mesh->mNumVertices);
+    Vertex* vertices = model.vertices.data() + vertexOffset;
+
     for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
-        Vertex vertex{};
+        Vertex& vertex = vertices[i];
 
         for (int b = 0; b < MAX_BONE_INFLUENCE; b++) {
             vertex.m_BoneIDs[b] = -1;
-            vertex.m_Weights[b] = 0.0f;
         }
         vertex.Position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z); // TODO need to adjust bones to compensate for scaling
-        vertex.Normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);                        // TODO also add Origin/Pivot Offset while am at it
-        vertex.Normal = glm::normalize(vertex.Normal);
+        vertex.Normal = glm::normalize(glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z)); // TODO also add Origin/Pivot Offset while am at it
 
         if (mesh->mTextureCoords[0]) {
-            glm::vec2 vec;
-            vec.x = mesh->mTextureCoords[0][i].x;
-            vec.y = mesh->mTextureCoords[0][i].y;
-            vertex.TexCoords = vec;
+            vertex.TexCoords = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
         }
-        vertex.Tangent = glm::vec3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
-        vertex.Bitangent = glm::vec3(mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z);
-        vertex.Tangent = glm::normalize(vertex.Tangent);
-        vertex.Bitangent = glm::normalize(vertex.Bitangent);
-
-        model.vertices.push_back(vertex);
+        vertex.Tangent = glm::normalize(glm::vec3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z));
+        vertex.Bitangent = glm::normalize(glm::vec3(mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z));
     }
+
+    // aiProcess_Triangulate leaves only triangles
+    model.indices.resize(indicesOffset + mesh->mNumFaces * 3);
+    unsigned* indices = model.indices.data() + indicesOffset;
+
     for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
-        const aiFace face = mesh->mFaces[i];
-        for (unsigned int j = 0; j < face.mNumIndices; j++) {
-            model.indices.push_back(face.mIndices[j]);
-        }
+        const aiFace& face = mesh->mFaces[i];
+        assert(face.mNumIndices == 3);
+        indices[i * 3 + 0] = face.mIndices[0];
+        indices[i * 3 + 1] = face.mIndices[1];
+        indices[i * 3 + 2] = face.mIndices[2];
     }
     return MeshDrawParams(vertexOffset, mesh->mNumVertices, indicesOffset, mesh->mNumFaces * 3);
 }
@@ -204,6 +203,14 @@ void loadModelRenderData(ModelDefinitionBuilder& model, const aiScene& scene, co
     loadedMeshes.reserve(scene.mNumMeshes);
     model.renderNodes.assign(scene.mNumMeshes, {});
 
+    size_t totalVertices = 0, totalIndices = 0;
+    for (unsigned i = 0; i < scene.mNumMeshes; ++i) {
+        totalVertices += scene.mMeshes[i]->mNumVertices;
+        totalIndices += scene.mMeshes[i]->mNumFaces * 3;
+    }
+    model.vertices.reserve(model.vertices.size() + totalVertices);
+    model.indices.reserve(model.indices.size() + totalIndices);
+
     forEachNode(root, [&](const aiNode* node) {
         const unsigned first = model.meshIndicesArena.size();
 
@@ -224,7 +231,7 @@ void loadModelRenderData(ModelDefinitionBuilder& model, const aiScene& scene, co
 
         auto& meshNode = model.nodes[model.aiNodeToMeshNode[node]];
         meshNode.firstMeshIndex = first;
-        meshNode.meshCount = node->mNumMeshes;
+        meshNode.meshCount = model.meshIndicesArena.size() - first;
     });
 
     model.materials.reserve(scene.mNumMaterials);
@@ -333,7 +340,6 @@ bool extractBoneWeightForVertices(S &model, const aiMesh *mesh, std::vector<Vert
             }
         }
     }
-    std::cout << "[BONES] Mesh Bones: " << boneCount << std::endl;
     return boneCount != 0;
 }
 
@@ -392,27 +398,87 @@ Geometry& ModelLoaderSystem::loadModelGeometry(Geometry& geometry) {
     return geometry;
 }
 
-const ModelDefinition* ModelLoaderSystem::loadModel(const ModelLoadParams& params) {
-    assert(_CrtCheckMemory());
+std::expected<ModelDefinitionBuilder, ModelLoadError> ModelLoaderSystem::importModel(const ModelLoadParams& params) {
+    const auto stamp = ModelCache::SourceStamp::of(params.path);
+    const std::string cachePath = ModelCache::cachePathOf(params.path);
+
+    if (params.useCache) {
+        if (auto cached = ModelCache::read(cachePath, stamp)) {
+            return cached;
+        }
+    }
+    if (!stamp.exists()) return std::unexpected(ModelLoadError::FILE_NOT_FOUND);
+
     Assimp::Importer importer;
-    auto scene = importer.ReadFile(params.path, AI_PROCESS_FLAGS);
+    const aiScene* scene = importer.ReadFile(params.path, AI_PROCESS_FLAGS);
+    if (!scene || !scene->mRootNode) return std::unexpected(ModelLoadError::IMPORT_FAILED);
 
     auto def = createDefinitionBuilder(scene);
     loadTransformHierarchy(def, scene);
     loadModelRenderData(def, *scene, params);
+    // keyed by the importer's nodes, which die with it
+    def.aiNodeToMeshNode.clear();
 
-    std::string directory = params.path.substr(0, params.path.find_last_of('/'));
-    for (auto& node : def.linear()) {
-        std::cout << "Node: " << node.name << std::endl;
+    if (params.useCache) {
+        // a failed write only costs the next load another import
+        (void)ModelCache::write(cachePath, def, stamp);
     }
-    ModelDefinition* mdef = modelAssets.emplace(params.name, new ModelDefinition(params.name, def)).first->second;
-    newDefinitions.emplace_back(def, mdef, directory, params.flipTextureUV);
+    return def;
+}
+
+ModelDefinition* ModelLoaderSystem::registerModel(const ModelLoadParams& params, ModelDefinitionBuilder& builder) {
+    std::string directory = params.path.substr(0, params.path.find_last_of('/'));
+
+    ModelDefinition* mdef = modelAssets.emplace(params.name, new ModelDefinition(params.name, builder)).first->second;
+    newDefinitions.emplace_back(builder, mdef, directory, params.flipTextureUV);
     return mdef;
 }
 
+const ModelDefinition* ModelLoaderSystem::loadModel(const ModelLoadParams& params) {
+    assert(_CrtCheckMemory());
+    auto def = importModel(params);
+    if (!def) {
+        failedLoads.emplace(params.name, def.error()).first->second = def.error();
+        return nullptr;
+    }
+    return registerModel(params, *def);
+}
+
+void ModelLoaderSystem::loadModelAsync(const ModelLoadParams& params) {
+    pendingLoads.fetch_add(1, std::memory_order_relaxed);
+
+    loadTasks.run([this, params] {
+        auto loaded = std::make_unique<LoadedModel>(params, importModel(params));
+        loadedModels.push(std::move(loaded));
+    });
+}
+
+void ModelLoaderSystem::collectLoadedModels() {
+    std::unique_ptr<LoadedModel> loaded;
+    while (loadedModels.try_pop(loaded)) {
+        if (loaded->model) {
+            registerModel(loaded->params, *loaded->model);
+        } else {
+            failedLoads.emplace(loaded->params.name, loaded->model.error()).first->second = loaded->model.error();
+        }
+        pendingLoads.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+const ModelDefinition* ModelLoaderSystem::findModel(const std::string_view name) const {
+    const auto it = modelAssets.find(name);
+    return it != modelAssets.end() ? it->second : nullptr;
+}
+
+ModelLoadError ModelLoaderSystem::getLoadError(const std::string_view name) const {
+    const auto it = failedLoads.find(name);
+    return it != failedLoads.end() ? it->second : ModelLoadError::SUCCESS;
+}
+
 std::expected<Geometry, ModelLoadError> ModelLoaderSystem::loadGeometry(std::string_view path) {
     Assimp::Importer importer;
     auto scene = importer.ReadFile(path.data(), AI_PROCESS_FLAGS);
+    if (!scene || !scene->mRootNode) return std::unexpected(ModelLoadError::FILE_NOT_FOUND);
 
     auto def = createDefinitionBuilder(scene);
     loadModelRenderData(def, *scene, {});
@@ -2,10 +2,15 @@
 
 #include <Math/Shapes/AABB.h>
 #include "Model.h"
+#include "ModelLoadError.h"
 #include <memory/hash.h>
 
 #include <ECS/ECS.h>
 #include <expected>
+#include <memory>
+#include <atomic>
+#include <tbb/task_group.h>
+#include <tbb/concurrent_queue.h>
 #include <Renderer/Common.h>
 
 class Texture2D;
@@ -24,22 +29,41 @@ struct RenderModelCache {
 
 namespace Assimp { class Importer;}
 
-enum class ModelLoadError {
-	SUCCESS, FILE_NOT_FOUND
-};
-
 struct ModelLoadParams {
 	std::string path;
 	std::string name;
 	glm::vec3 baseScale = glm::vec3(1);
 	bool flipTextureUV = false;
 	bool bakeTransforms = false;
+	/* load from, or write, the binary cache next to the source, see ModelCache */
+	bool useCache = true;
 };
 
+/*
+ * Imports models into ModelDefinitions and hands them to the renderer through NewModelDefinition.
+ * loadModel imports on the calling thread, loadModelAsync on a worker; finished async loads are registered
+ * and sent at the next onLevelOut, until then findModel returns nullptr for them.
+ */
 class ModelLoaderSystem : ResourceSystem<> {
 	FRIEND_DESCRIPTOR
+	struct LoadedModel {
+		ModelLoadParams params;
+		std::expected<ModelDefinitionBuilder, ModelLoadError> model;
+	};
+
 	mem::unordered_stringmap<ModelDefinition*> modelAssets;
+	mem::unordered_stringmap<ModelLoadError> failedLoads;
 	std::vector<NewModelDefinition> newDefinitions;
+
+	tbb::task_group loadTasks;
+	tbb::concurrent_queue<std::unique_ptr<LoadedModel>> loadedModels;
+	std::atomic<int> pendingLoads = 0;
+
+	/* reads the cache if it is current, otherwise imports the source and rewrites the cache */
+	static std::expected<ModelDefinitionBuilder, ModelLoadError> importModel(const ModelLoadParams& params);
+
+	ModelDefinition* registerModel(const ModelLoadParams& params, ModelDefinitionBuilder& builder);
+	void collectLoadedModels();
 public:
 	ModelLoaderSystem() = default;
 
@@ -48,13 +72,30 @@ public:
 	ModelLoaderSystem& operator=(const ModelLoaderSystem&) = delete;
 	ModelLoaderSystem& operator=(ModelLoaderSystem&&) = delete;
 
+	~ModelLoaderSystem() {
+		loadTasks.wait();
+	}
+
 	static Geometry& loadModelGeometry(Geometry &geometry);
 
+	/* nullptr if the model could not be loaded, see getLoadError */
 	const ModelDefinition* loadModel(const ModelLoadParams& params);
 
+	void loadModelAsync(const ModelLoadParams& params);
+
+	const ModelDefinition* findModel(std::string_view name) const;
+
+	ModelLoadError getLoadError(std::string_view name) const;
+
+	bool isLoading() const {
+		return pendingLoads.load(std::memory_order_acquire) != 0;
+	}
+
 	static std::expected<Geometry, ModelLoadError> loadGeometry( std::string_view path);
 
 	void onLevelOut(LevelOutView<ModelLoaderSystem> view) {
+		collectLoadedModels();
+
 		for (auto& newDef : newDefinitions) {
 			view.send<NewModelDefinition>(std::move(newDef)); // -> @class ModelSystem
 		}
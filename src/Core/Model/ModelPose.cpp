@@ -1,52 +1,57 @@
 #include "ModelPose.h"
 
 #include <iostream>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 
 #include "Model.h"
 #include "Skeleton.h"
 
 
-MeshPose ModelPoseStack::getFinalPose(unsigned boneOrEntity, const ModelPart part) const {
-    MeshPose finalPose{};
+int ModelPoseStack::PartLayers::find(const PoseID id) const {
+    for (uint32_t i = 0; i < count; ++i) {
+        if (ids[i] == id) return static_cast<int>(i);
+    }
+    return -1;
+}
 
-    auto& map = getPoseMap(part);
-    const auto it = map[boneOrEntity];
-    if (it.empty()) return finalPose;
+MeshPose ModelPoseStack::PartLayers::blend() const {
+    MeshPose finalPose{};
 
-    auto& poseEntries = it;
     auto finalRotation = glm::quat(0, 0, 0, 0);
     auto finalPosition = glm::vec3(0);
     auto finalScale    = glm::vec3(0);
     auto finalColor    = glm::vec3(0);
 
-    double positionWeight = 0;
-    double rotationWeight = 0;
-    double scaleWeight = 0;
-    double colorWeight = 0;
+    float positionWeight = 0;
+    float rotationWeight = 0;
+    float scaleWeight = 0;
+    float colorWeight = 0;
 
-    for (const auto& entry : poseEntries) {
+    for (uint32_t i = 0; i < count; ++i) {
+        const MeshPoseEntry& entry = entries[i];
         const auto& [transform, tint] = entry.pose;
-        auto weight = static_cast<float>(entry.influence);
+        const float weight = entry.influence;
 
         switch (entry.blendMode) {
         case BlendMode::OVERRIDE: {
             if (entry.affected & MeshAffected::POSITION) {
                 finalPosition += transform.translation * weight;
-                positionWeight += entry.influence;
+                positionWeight += weight;
             }
             if (entry.affected & MeshAffected::SCALE) {
                 finalScale += transform.scale * weight;
-                scaleWeight += entry.influence;
+                scaleWeight += weight;
             }
             if (entry.affected & MeshAffected::COLOR) {
                 finalColor += tint * weight;
-                colorWeight += entry.influence;
+                colorWeight += weight;
             }
             if (entry.affected & MeshAffected::ROTATION) {
-                if (rotationWeight == 0.0) {
+                if (rotationWeight == 0.f) {
                     finalRotation = transform.rotation;
                 } else {
-                    finalRotation = glm::slerp(finalRotation, transform.rotation, static_cast<float>(weight / (rotationWeight + weight)));
+                    finalRotation = glm::slerp(finalRotation, transform.rotation, weight / (rotationWeight + weight));
                 }
                 rotationWeight += weight;
             }
@@ -92,19 +97,19 @@ MeshPose ModelPoseStack::getFinalPose(unsigned boneOrEntity, const ModelPart par
         }
         }
     }
-    if (positionWeight > 0.0) {
+    if (positionWeight > 0.f) {
         finalPosition /= positionWeight;
         finalPose.transform.translation = finalPosition;
     }
-    if (rotationWeight > 0.0) {
+    if (rotationWeight > 0.f) {
         finalRotation = normalize(finalRotation);
         finalPose.transform.rotation = finalRotation;
     }
-    if (scaleWeight > 0.0) {
+    if (scaleWeight > 0.f) {
         finalScale /= scaleWeight;
         finalPose.transform.scale = finalScale * finalPose.transform.scale;
     }
-    if (colorWeight > 0.0) {
+    if (colorWeight > 0.f) {
         finalColor /= colorWeight;
         finalPose.tint = finalColor;
     }
@@ -112,16 +117,14 @@ MeshPose ModelPoseStack::getFinalPose(unsigned boneOrEntity, const ModelPart par
 }
 
 ModelPoseStack::ModelPoseStack(const ModelDefinition &asset) {
-    meshPoses.assign(asset.size(), {});
-    // if (auto& skeleton = asset.skeleton; skeleton.isValid())
-    //     bonePoses.assign(skeleton.size(), {});
+    meshPoses.resize(asset.size());
 }
 
 ModelPoseStack::ModelPoseStack() {
-    meshPoses.assign(1, {});
+    meshPoses.resize(1);
 }
 
-ModelPoseStack::MeshMap &ModelPoseStack::getPoseMap(const ModelPart part) {
+ModelPoseStack::PartMap &ModelPoseStack::getPoseMap(const ModelPart part) {
     switch (part) {
         case ModelPart::BONE:
             return bonePoses;
@@ -131,7 +134,7 @@ ModelPoseStack::MeshMap &ModelPoseStack::getPoseMap(const ModelPart part) {
     }
 }
 
-const ModelPoseStack::MeshMap &ModelPoseStack::getPoseMap(const ModelPart part) const {
+const ModelPoseStack::PartMap &ModelPoseStack::getPoseMap(const ModelPart part) const {
     switch (part) {
         case ModelPart::BONE:
             return bonePoses;
@@ -141,38 +144,79 @@ const ModelPoseStack::MeshMap &ModelPoseStack::getPoseMap(const ModelPart part)
     }
 }
 
-void ModelPoseStack::setPose(const unsigned boneOrEntity, const PoseID poseID, const MeshPose &pose,
+MeshPose ModelPoseStack::getFinalPose(const unsigned boneOrEntity, const ModelPart part) const {
+    const auto& map = getPoseMap(part);
+    if (boneOrEntity >= map.size() || map[boneOrEntity].count == 0) return MeshPose{};
+    const PartLayers& layers = map[boneOrEntity];
+    return layers.dirty ? layers.blend() : layers.blended;
+}
+
+bool ModelPoseStack::setPose(const unsigned boneOrEntity, const PoseID poseID, const MeshPose &pose,
                              const MeshAffected affected, const BlendMode blendmode,
-                             const double influence, const ModelPart part)
+                             const float influence, const ModelPart part)
 {
-    auto& poseStack = getPoseMap(part)[boneOrEntity];
-
-    const auto it = std::ranges::find_if(poseStack, [poseID](const MeshPoseEntry& entry) {
-        return entry.id == poseID;
-    });
+    auto& map = getPoseMap(part);
+    if (boneOrEntity >= map.size()) {
+        map.resize(boneOrEntity + 1);
+    }
+    PartLayers& layers = map[boneOrEntity];
 
-    if (it != poseStack.end()) {
-        auto& foundPose = *it;
-        foundPose.pose = pose;
-        foundPose.influence = influence;
-        foundPose.blendMode = blendmode;
+    if (const int found = layers.find(poseID); found >= 0) {
+        auto& entry = layers.entries[found];
+        entry.pose = pose;
+        entry.influence = influence;
+        entry.blendMode = blendmode;
     } else {
-        poseStack.emplace_back(pose, poseID, influence, affected, blendmode);
+        if (layers.count == MAX_LAYERS) return false;
+        layers.ids[layers.count] = poseID;
+        layers.entries[layers.count] = { pose, influence, affected, blendmode };
+        ++layers.count;
     }
+    layers.dirty = true;
+    return true;
 }
 
 void ModelPoseStack::removePose(const unsigned boneOrEntity, const PoseID poseID, const ModelPart part) {
-    auto& poseStack = getPoseMap(part)[boneOrEntity];
+    auto& map = getPoseMap(part);
+    if (boneOrEntity >= map.size()) return;
 
-    const auto it = std::ranges::find_if(poseStack, [poseID](const MeshPoseEntry& entry) {
-        return entry.id == poseID;
-    });
+    PartLayers& layers = map[boneOrEntity];
+    const int found = layers.find(poseID);
+    if (found < 0) return;
 
-    if (it != poseStack.end()) {
-        poseStack.erase(it);
+    // shifted, not swapped, the remaining layers keep blending in the order they were set
+    for (uint32_t i = found; i + 1 < layers.count; ++i) {
+        layers.ids[i] = layers.ids[i + 1];
+        layers.entries[i] = layers.entries[i + 1];
     }
+    --layers.count;
+    layers.dirty = true;
+}
+
+bool ModelPoseStack::hasPose(const unsigned boneOrEntity, const ModelPart part) const {
+    const auto& map = getPoseMap(part);
+    return boneOrEntity < map.size() && map[boneOrEntity].count != 0;
 }
 
-bool ModelPoseStack::hasPose(const unsigned boneOrEntity, const ModelPart part) {
-    return !getPoseMap(part)[boneOrEntity].empty();
+void ModelPoseStack::blendAll() {
+    const auto blendChanged = [](PartMap& map, std::vector<unsigned>& blended) {
+        blended.clear();
+        for (unsigned i = 0; i < map.size(); ++i) {
+            PartLayers& layers = map[i];
+            if (!layers.dirty) continue;
+            layers.blended = layers.blend();
+            layers.dirty = false;
+            blended.push_back(i);
+        }
+    };
+    blendChanged(meshPoses, blendedMeshes);
+    blendChanged(bonePoses, blendedBones);
+}
+
+void ModelPoseStack::blendAll(const std::span<ModelPoseStack* const> stacks) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, stacks.size(), 16), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            stacks[i]->blendAll();
+        }
+    });
 }
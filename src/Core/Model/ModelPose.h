@@ -1,4 +1,7 @@
 #pragma once
+#include <span>
+#include <array>
+#include <vector>
 #include <glm/vec3.hpp>
 #include "Transform.h"
 
@@ -54,18 +57,9 @@ enum class BlendMode {
 
 struct MeshPoseEntry {
     MeshPose pose;
-    PoseID id;
-    double influence = 1;
+    float influence = 1;
     MeshAffected affected;
     BlendMode blendMode = BlendMode::ADDITIVE;
-
-    bool operator==(const MeshPoseEntry & other) const {
-        return id == other.id;
-    }
-
-    bool operator == (const PoseID& other) const {
-        return id == other;
-    }
 };
 
 constexpr bool operator&(MeshAffected lhs, MeshAffected rhs) {
@@ -81,20 +75,54 @@ enum class ModelPart {
 class SkeletonAsset;
 
 class ModelPoseStack : public PrimaryComponent {
-    using MeshMap = std::vector<std::vector<MeshPoseEntry>>;
-    MeshMap meshPoses;
-    MeshMap bonePoses;
+public:
+    constexpr static uint32_t MAX_LAYERS = 6;
+private:
+    /*
+     * The poses of one mesh or bone in the order they were set, which is the order they blend in.
+     * Lookups scan the contiguous ids; blendAll keeps the blended pose until a layer changes.
+     */
+    struct PartLayers {
+        std::array<PoseID, MAX_LAYERS> ids{};
+        std::array<MeshPoseEntry, MAX_LAYERS> entries{};
+        uint32_t count = 0;
+        bool dirty = false;
+        MeshPose blended{};
+
+        int find(PoseID id) const;
+        MeshPose blend() const;
+    };
+
+    using PartMap = std::vector<PartLayers>;
+    PartMap meshPoses;
+    PartMap bonePoses;
+    /* the parts the last blendAll blended */
+    std::vector<unsigned> blendedMeshes;
+    std::vector<unsigned> blendedBones;
+
+    PartMap& getPoseMap(ModelPart part);
+    const PartMap& getPoseMap(ModelPart part) const;
 public:
     ModelPoseStack(const ModelDefinition& asset);
     ModelPoseStack();
 
-    MeshMap& getPoseMap(ModelPart part);
-    const MeshMap& getPoseMap(ModelPart part) const;
-
-    void setPose(unsigned boneOrEntity, PoseID poseID, const MeshPose& pose, MeshAffected affected, BlendMode blendmode, double influence, ModelPart part);
+    /* false, leaving the part as it was, if it already holds MAX_LAYERS other poses; parts past the ones allocated are added once */
+    bool setPose(unsigned boneOrEntity, PoseID poseID, const MeshPose& pose, MeshAffected affected, BlendMode blendmode, float influence, ModelPart part);
     void removePose(unsigned boneOrEntity, PoseID poseID, ModelPart part);
 
-    bool hasPose(unsigned boneOrEntity, ModelPart part);
+    bool hasPose(unsigned boneOrEntity, ModelPart part) const;
 
+    /* only reads: the pose cached by blendAll, or a fresh blend if a layer changed since */
     MeshPose getFinalPose(unsigned boneOrEntity, ModelPart part) const;
+
+    /* the write phase, blends and caches every changed mesh and bone */
+    void blendAll();
+
+    /* blendAll of each stack in parallel, a stack must appear only once */
+    static void blendAll(std::span<ModelPoseStack* const> stacks);
+
+    /* the meshes or bones the last blendAll blended, including ones whose last pose was removed */
+    std::span<const unsigned> getBlended(ModelPart part) const {
+        return part == ModelPart::BONE ? blendedBones : blendedMeshes;
+    }
 };
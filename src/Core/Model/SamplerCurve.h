@@ -11,15 +11,15 @@ namespace curves {
             Texture1D texture;
 
             const P step = this->duration() / static_cast<P>(resolution - 1);
-            size_t hint = 0;
-            
-            std::vector<K> sampler(resolution);
 
+            std::vector<P> times(resolution);
             for (int i = 0; i < resolution; ++i) {
-                P t = step * i;
-                sampler[i] = this->at(t, hint);
+                times[i] = step * i;
             }
 
+            std::vector<K> sampler(resolution);
+            this->sample(times, sampler);
+
             ColorBufferInternalFormat iFormat;
 
             if constexpr (std::is_same_v<K, float>) {
@@ -1,7 +1,17 @@
 #include "Skeleton.h"
 
 #include <iostream>
+#include <algorithm>
+#include <bit>
+#include <cassert>
 #include <glm/gtc/type_ptr.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+namespace {
+    /* what the getters return for bones without a transform */
+    const Transform FAILSAFE{};
+}
 
 void SkeletonAsset::renameBone(const std::string_view bone, const std::string_view newName) {
     const auto it = boneNameToID.find(bone);
@@ -34,49 +44,115 @@ SkeletonAsset::SkeletonAsset(const aiScene *aiScene, std::unordered_map<std::str
     bones = new Bone[size];
     boneNameToID.reserve(size);
     loadBoneHierarchy(aiScene->mRootNode, boneMap, -1);
+    buildTopology();
 }
 
-SkeletonAsset::SkeletonAsset(const SkeletonAsset &other) {
-    if (!other.bones) return;
+SkeletonAsset::SkeletonAsset(const std::span<const BoneNode> nodes, const int boneCount) {
+    assert(boneCount >= 0 && boneCount <= static_cast<int>(nodes.size()));
+    const int count = static_cast<int>(nodes.size());
+    bonesCount = boneCount;
+    nonBoneCount = count - boneCount;
+    bones = new Bone[count];
+    boneNameToID.reserve(count);
+
+    for (int id = 0; id < count; ++id) {
+        const BoneNode& node = nodes[id];
+        bones[id] = Bone{
+            .boneID = id,
+            .parentBoneID = node.parent,
+            .name = node.name,
+            .children = {},
+            .localTransform = node.localTransform,
+            .offsetMatrix = node.offset,
+            .skew = node.skew
+        };
+        boneNameToID.emplace(node.name, id);
+    }
+    for (int id = 0; id < count; ++id) {
+        const int parent = nodes[id].parent;
+        assert(parent < count);
+        if (parent >= 0) {
+            bones[parent].children.push_back(id);
+        } else {
+            assert(rootBone == -1 && "a skeleton has one root");
+            rootBone = id;
+        }
+    }
+    buildTopology();
+}
+
+void SkeletonAsset::buildTopology() {
+    const int total = bonesCount + nonBoneCount;
+    order.clear();
+    order.reserve(total);
+    orderOf.assign(total, -1);
+    orderParent.clear();
+    subtreeEnd.clear();
+    if (rootBone == -1) return;
+
+    // iterative preorder; a subtree's end is known once the walk returns to its parent's level
+    std::vector<int> stack{ rootBone };
+    while (!stack.empty()) {
+        const int bone = stack.back();
+        stack.pop_back();
+
+        orderOf[bone] = static_cast<int>(order.size());
+        order.push_back(bone);
+
+        const auto& children = bones[bone].children;
+        for (auto it = children.rbegin(); it != children.rend(); ++it) {
+            stack.push_back(*it);
+        }
+    }
+
+    orderParent.resize(order.size());
+    subtreeEnd.resize(order.size());
+    for (int i = static_cast<int>(order.size()) - 1; i >= 0; --i) {
+        const int parent = bones[order[i]].parentBoneID;
+        orderParent[i] = parent >= 0 ? orderOf[parent] : -1;
+
+        int end = i + 1;
+        for (const int child : bones[order[i]].children) {
+            end = std::max(end, subtreeEnd[orderOf[child]]);
+        }
+        subtreeEnd[i] = end;
+    }
+}
 
+void SkeletonAsset::copyFrom(const SkeletonAsset& other) {
     bonesCount = other.bonesCount;
     nonBoneCount = other.nonBoneCount;
     rootBone = other.rootBone;
+
     const int totalBones = bonesCount + nonBoneCount;
     bones = new Bone[totalBones];
     for (int i = 0; i < totalBones; ++i) {
         bones[i] = other.bones[i];
     }
     boneNameToID = other.boneNameToID;
+    order = other.order;
+    orderOf = other.orderOf;
+    orderParent = other.orderParent;
+    subtreeEnd = other.subtreeEnd;
+}
+
+SkeletonAsset::SkeletonAsset(const SkeletonAsset &other) {
+    if (!other.bones) return;
+    copyFrom(other);
 }
 
 SkeletonAsset &SkeletonAsset::operator=(const SkeletonAsset &other) noexcept {
     if (this == &other) return *this;
-    bonesCount = other.bonesCount;
-    nonBoneCount = other.nonBoneCount;
-    rootBone = other.rootBone;
-    bones = new Bone[bonesCount];
-    const int totalBones = bonesCount + nonBoneCount;
-    bones = new Bone[totalBones];
-    for (int i = 0; i < totalBones; ++i) {
-        bones[i] = other.bones[i];
+    delete[] bones;
+    bones = nullptr;
+    if (other.bones) {
+        copyFrom(other);
     }
-    boneNameToID = other.boneNameToID;
     return *this;
 }
 
 SkeletonAsset::SkeletonAsset(SkeletonAsset&& other) noexcept {
-    bonesCount = other.bonesCount;
-    nonBoneCount = other.nonBoneCount;
-    rootBone = other.rootBone;
-    bones = other.bones;
-    boneNameToID = std::move(other.boneNameToID);
-    bonesCount = other.bonesCount;
-
-    other.bones = nullptr;
-    other.nonBoneCount = 0;
-    other.rootBone = -1;
-    other.bonesCount = 0;
+    *this = std::move(other);
 }
 
 SkeletonAsset &SkeletonAsset::operator=(SkeletonAsset &&other) noexcept {
@@ -88,7 +164,10 @@ SkeletonAsset &SkeletonAsset::operator=(SkeletonAsset &&other) noexcept {
     rootBone = other.rootBone;
     bones = other.bones;
     boneNameToID = std::move(other.boneNameToID);
-    bonesCount = other.bonesCount;
+    order = std::move(other.order);
+    orderOf = std::move(other.orderOf);
+    orderParent = std::move(other.orderParent);
+    subtreeEnd = std::move(other.subtreeEnd);
 
     other.bones = nullptr;
     other.nonBoneCount = 0;
@@ -159,69 +238,82 @@ void SkeletonAsset::loadBoneHierarchy(const aiNode *node, const std::unordered_m
     if (parentID >= 0) {
         bones[parentID].children.push_back(thisBoneID);
     }
-    std::cout << "Bone: " << nodeName << std::endl;
     for (unsigned i = 0; i < node->mNumChildren; i++) {
         loadBoneHierarchy(node->mChildren[i], boneMap, thisBoneID);
     }
 }
 
-void Skeleton::writeHierarchyRecursive(const int boneID, const glm::mat4 &parentMatrix, glm::mat4 *writePointer) {
-    auto& [localTransform, globalTransform] = bones[boneID];
-    globalTransform = parentMatrix * localTransform.createModel3DSkew(skeleton->bones[boneID].skew);
+void Skeleton::markBoneDirty(const int boneID) {
+    const int position = skeleton->orderOf[boneID];
+    if (position < 0) return;
+    dirtyBones[position >> 6] |= uint64_t(1) << (position & 63);
+}
 
-    if (skeleton->bones[boneID].boneID < skeleton->bonesCount) {
-        new (writePointer + skeleton->bones[boneID].boneID) glm::mat4(
-            globalTransform * skeleton->bones[boneID].offsetMatrix
-        );
-    }
+int Skeleton::nextDirty(const int position) const {
+    const int count = static_cast<int>(localTransforms.size());
+    if (position >= count) return count;
 
-    for (const int childID : skeleton->bones[boneID].children) {
-        writeHierarchyRecursive(childID, globalTransform, writePointer);
+    size_t word = position >> 6;
+    uint64_t bits = dirtyBones[word] & (~uint64_t(0) << (position & 63));
+    while (!bits) {
+        if (++word == dirtyBones.size()) return count;
+        bits = dirtyBones[word];
     }
+    return std::min(count, static_cast<int>(word * 64 + std::countr_zero(bits)));
 }
 
-void Skeleton::markBoneDirty(const int boneID) {
-    for (const int existingDirty : dirtyBones) {
-        if (isBoneChildOf(boneID, existingDirty)) return;
+void Skeleton::updateDirty(glm::mat4* palette) {
+    const auto& order = skeleton->order;
+    const auto& parents = skeleton->orderParent;
+    const auto& subtreeEnd = skeleton->subtreeEnd;
+    const int count = static_cast<int>(localTransforms.size());
+
+    // a dirty bone's subtree is contiguous, so everything up to its end is recomputed without looking at the bits
+    for (int i = nextDirty(0); i < count; i = nextDirty(i)) {
+        for (const int end = subtreeEnd[i]; i < end; ++i) {
+            const auto& bone = skeleton->bones[order[i]];
+            const glm::mat4 local = localTransforms[i].createModel3DSkew(bone.skew);
+            globalTransforms[i] = parents[i] < 0 ? local : globalTransforms[parents[i]] * local;
+
+            if (palette && bone.boneID < skeleton->bonesCount) {
+                palette[bone.boneID] = globalTransforms[i] * bone.offsetMatrix;
+            }
+        }
     }
-    std::erase_if(dirtyBones, [&](const int otherBone) {
-        return isBoneChildOf(otherBone, boneID);
-    });
-    dirtyBones.push_back(boneID);
+    std::ranges::fill(dirtyBones, 0);
 }
 
-bool Skeleton::isBoneChildOf(int childBoneID, const int parentBoneID) const {
-    while (childBoneID != -1) {
-        if (childBoneID == parentBoneID) return true;
-        childBoneID = skeleton->bones[childBoneID].parentBoneID;
+void Skeleton::writePalette(glm::mat4* palette) const {
+    for (size_t i = 0; i < globalTransforms.size(); ++i) {
+        const auto& bone = skeleton->bones[skeleton->order[i]];
+        if (bone.boneID < skeleton->bonesCount) {
+            palette[bone.boneID] = globalTransforms[i] * bone.offsetMatrix;
+        }
     }
-    return false;
 }
 
-Skeleton::Skeleton(const SkeletonAsset *asset) {
-    bones = new BoneInstance[asset->bonesCount + asset->nonBoneCount];
-    skeleton = asset;
+Skeleton::Skeleton(const SkeletonAsset *asset) : skeleton(asset) {
+    const size_t count = asset->order.size();
+    localTransforms.reserve(count);
+    for (const int bone : asset->order) {
+        localTransforms.emplace_back(asset->bones[bone].localTransform);
+    }
+    globalTransforms.assign(count, glm::mat4(1.0f));
+    dirtyBones.assign((count + 63) / 64, 0);
 
-    for (int i = 0; i < asset->bonesCount + asset->nonBoneCount; ++i) {
-        bones[i].localTransform = asset->bones[i].localTransform;
-        bones[i].globalTransform = glm::mat4(1.0f);
+    if (count != 0) {
+        markBoneDirty(asset->rootBone);
     }
-    dirtyBones.emplace_back(skeleton->rootBone);
 }
 
-Skeleton::Skeleton(Skeleton &&other) noexcept {
-    bones = other.bones;
-    skeleton = other.skeleton;
-    other.bones = nullptr;
+Transform* Skeleton::localTransformOf(const int boneID) {
+    const int position = skeleton->orderOf[boneID];
+    return position < 0 ? nullptr : &localTransforms[position];
 }
 
-Skeleton& Skeleton::operator=(Skeleton &&other) noexcept {
-    if (this == &other) return *this;
-
-    bones = other.bones;
-    skeleton = other.skeleton;
-    other.bones = nullptr;
-    return *this;
+const Transform* Skeleton::localTransformOf(const int boneID) const {
+    const int position = skeleton->orderOf[boneID];
+    return position < 0 ? nullptr : &localTransforms[position];
 }
 
 void Skeleton::setBoneTransform(const std::string_view bone, const Transform &transform) {
@@ -231,15 +323,16 @@ void Skeleton::setBoneTransform(const std::string_view bone, const Transform &tr
         std::cerr << "Bone " << bone << " not found, Bones: " << skeleton->boneNameToID.size() << std::endl;
         return;
     }
-    bones[it->second].localTransform = transform;
-    markBoneDirty(it->second);
+    setBoneTransform(it->second, transform);
 }
 
 void Skeleton::setBoneTransform(const int boneID, const Transform &transform) {
-    if (boneID > getBoneCount()) std::exit(55);
+    assert(boneID >= 0 && boneID < static_cast<int>(skeleton->orderOf.size()));
 
-    bones[boneID].localTransform = transform;
-    markBoneDirty(boneID);
+    if (Transform* local = localTransformOf(boneID)) {
+        *local = transform;
+        markBoneDirty(boneID);
+    }
 }
 
 void Skeleton::setBonePosition(const std::string_view bone, const glm::vec3 &position) {
@@ -249,8 +342,10 @@ void Skeleton::setBonePosition(const std::string_view bone, const glm::vec3 &pos
         return;
     }
 
-    bones[it->second].localTransform.translation = position;
-    markBoneDirty(it->second);
+    if (Transform* local = localTransformOf(it->second)) {
+        local->translation = position;
+        markBoneDirty(it->second);
+    }
 }
 
 void Skeleton::setBoneRotation(const std::string_view bone, const glm::quat &rotation) {
@@ -260,8 +355,10 @@ void Skeleton::setBoneRotation(const std::string_view bone, const glm::quat &rot
         return;
     }
 
-    bones[it->second].localTransform.rotation = rotation;
-    markBoneDirty(it->second);
+    if (Transform* local = localTransformOf(it->second)) {
+        local->rotation = rotation;
+        markBoneDirty(it->second);
+    }
 }
 
 void Skeleton::setBoneScale(const std::string_view bone, const glm::vec3& scale) {
@@ -270,28 +367,46 @@ void Skeleton::setBoneScale(const std::string_view bone, const glm::vec3& scale)
         std::cerr << "Bone " << bone << " not found, Bones: " << skeleton->boneNameToID.size() << std::endl;
         return;
     }
-    bones[it->second].localTransform.scale = scale;
-    markBoneDirty(it->second);
+    if (Transform* local = localTransformOf(it->second)) {
+        local->scale = scale;
+        markBoneDirty(it->second);
+    }
 }
 
 const Transform & Skeleton::getBoneTransform(const std::string_view bone) const {
     if (const auto it = skeleton->boneNameToID.find(bone); it != skeleton->boneNameToID.end()) {
-        return bones[it->second].localTransform;
+        return getBoneTransform(it->second);
     }
-    static Transform failsafe{};
     // TODO Error message
-    return failsafe;
+    return FAILSAFE;
 }
 
 const Transform & Skeleton::getBoneTransform(const int boneID) const {
-    return bones[boneID].localTransform;
+    assert(boneID >= 0 && boneID < static_cast<int>(skeleton->orderOf.size()));
+
+    // an unreachable bone keeps no transform, it reads as the identity
+    const Transform* local = localTransformOf(boneID);
+    return local ? *local : FAILSAFE;
 }
 
-void Skeleton::writeDirtyBones(glm::mat4 *bufferZeroIndex) {
-    for (const int dirtyBone : dirtyBones) {
-        std::cout << "Dirty Bone: " << dirtyBone << std::endl;
-        glm::mat4 parentMatrix = skeleton->bones[dirtyBone].parentBoneID != -1 ? bones[skeleton->bones[dirtyBone].parentBoneID].globalTransform : glm::mat4(1.0f);
-        writeHierarchyRecursive(dirtyBone, parentMatrix, bufferZeroIndex);
-    }
-    dirtyBones.clear();
+void Skeleton::writeHierarchy(glm::mat4* bufferZeroIndex) {
+    if (localTransforms.empty()) return;
+    markBoneDirty(skeleton->rootBone);
+    updateDirty(bufferZeroIndex);
+}
+
+void Skeleton::writeDirtyBones(glm::mat4* bufferZeroIndex) {
+    updateDirty(bufferZeroIndex);
+}
+
+void Skeleton::writePalettes(const std::span<Skeleton* const> skeletons, const std::span<const uint32_t> offsets, glm::mat4* output) {
+    assert(skeletons.size() == offsets.size());
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, skeletons.size(), 16), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            Skeleton& skeleton = *skeletons[i];
+            skeleton.updateDirty(nullptr);
+            skeleton.writePalette(output + offsets[i]);
+        }
+    });
 }
@@ -1,10 +1,15 @@
 #pragma once
+#include <span>
+#include <vector>
+#include <cstdint>
 #include <assimp/scene.h>
 #include <glm/gtx/matrix_decompose.hpp>
 #include <util/stl.h>
 
 #include "Transform.h"
 
+class Skeleton;
+
 struct BoneInfo {
     std::string boneName;
     int id;
@@ -12,8 +17,18 @@ struct BoneInfo {
     glm::mat4 local;
 };
 
+/* a node of a hierarchy given without Assimp; its index is its id */
+struct BoneNode {
+    std::string name;
+    int parent = -1;
+    Transform localTransform{};
+    glm::mat4 offset = glm::mat4(1.0f);
+    glm::vec3 skew = glm::vec3(0.0f);
+};
+
 class SkeletonAsset {
     friend class Skeleton;
+    friend class CompressedAnimation;
 
     struct Bone {
         int boneID;
@@ -31,11 +46,24 @@ class SkeletonAsset {
     int nonBoneCount = 0;
     stl::unordered_stringmap<int> boneNameToID;
 
+    /*
+     * The hierarchy in depth first order, so every parent precedes its children and a subtree is the range
+     * [i, subtreeEnd[i]). Skeleton instances store their bones in this order.
+     */
+    std::vector<int> order;         /* bone id at each position */
+    std::vector<int> orderOf;       /* position of each bone id, -1 if unreachable from the root */
+    std::vector<int> orderParent;   /* position of the parent, -1 for the root */
+    std::vector<int> subtreeEnd;
+
     void loadBoneHierarchy(const aiNode *node, const std::unordered_map<std::string, BoneInfo> &boneMap, int parentID);
+    void buildTopology();
+    void copyFrom(const SkeletonAsset& other);
     static int getHierarchySize(const aiNode *node);
 public:
     SkeletonAsset() = default;
     SkeletonAsset(const aiScene *aiScene, std::unordered_map<std::string, BoneInfo> boneMap);
+    /* nodes [0, boneCount) are bones with a palette entry, the rest only carry transforms; exactly one has no parent */
+    SkeletonAsset(std::span<const BoneNode> nodes, int boneCount);
     SkeletonAsset(const SkeletonAsset& other);
     SkeletonAsset(SkeletonAsset&& other) noexcept;
     SkeletonAsset& operator=(const SkeletonAsset& other) noexcept;
@@ -56,30 +84,31 @@ public:
     }
 };
 class Skeleton : public PrimaryComponent {
-    struct BoneInstance {
-        Transform localTransform;
-        glm::mat4 globalTransform;
-    };
     const SkeletonAsset* skeleton;
-    BoneInstance* bones;
-    std::vector<int> dirtyBones;
-
-    void writeHierarchyRecursive(int boneID, const glm::mat4& parentMatrix, glm::mat4* writePointer);
-    static int getHierarchySize(const aiNode* node);
+    /* indexed by the asset's topological order, not by bone id */
+    std::vector<Transform> localTransforms;
+    std::vector<glm::mat4> globalTransforms;
+    std::vector<uint64_t> dirtyBones;
 
     void markBoneDirty(int boneID);
-    bool isBoneChildOf(int childBoneID, int parentBoneID) const;
+    int nextDirty(int position) const;
+
+    /* nullptr for bones unreachable from the root, they are never evaluated */
+    Transform* localTransformOf(int boneID);
+    const Transform* localTransformOf(int boneID) const;
+
+    /* recomputes every dirty subtree in one forward pass, writing the recomputed bones' skinning matrices if given */
+    void updateDirty(glm::mat4* palette);
+
+    /* writes every skinning matrix as of the last update, indexed by bone id, without recomputing dirty bones */
+    void writePalette(glm::mat4* palette) const;
 public:
     explicit Skeleton(const SkeletonAsset* asset);
 
     Skeleton(const Skeleton& other) = delete;
-    Skeleton(Skeleton&& other) noexcept;
+    Skeleton(Skeleton&& other) noexcept = default;
     Skeleton& operator=(const Skeleton& other) = delete;
-    Skeleton& operator=(Skeleton&& other) noexcept;
-
-    ~Skeleton() {
-        delete[] bones;
-    }
+    Skeleton& operator=(Skeleton&& other) noexcept = default;
 
     void setBoneTransform(std::string_view bone, const Transform& transform);
 
@@ -92,13 +121,18 @@ public:
     const Transform& getBoneTransform(std::string_view bone) const;
     const Transform& getBoneTransform(int boneID) const;
 
-    void writeHierarchy(glm::mat4* bufferZeroIndex) {
-        writeHierarchyRecursive(skeleton->rootBone, glm::mat4(1), bufferZeroIndex);
-        dirtyBones.clear();
-    }
+    /* recomputes and writes every skinning matrix, indexed by bone id */
+    void writeHierarchy(glm::mat4* bufferZeroIndex);
 
+    /* only writes the matrices of bones whose transform, or an ancestor's, changed since the last write */
     void writeDirtyBones(glm::mat4* bufferZeroIndex);
 
+    /*
+     * Brings every skeleton up to date and writes its full palette to output + offsets[i], spread across worker threads.
+     * The ranges [offsets[i], offsets[i] + getBoneCount()) must not overlap and a skeleton must appear only once.
+     */
+    static void writePalettes(std::span<Skeleton* const> skeletons, std::span<const uint32_t> offsets, glm::mat4* output);
+
     const SkeletonAsset* getSkeletonAsset() const {
         return skeleton;
     }
@@ -46,11 +46,12 @@ void PlayerController::onLevelLoad(LevelLoadView<PlayerController> level) {
     body.onGround = false;
 
     std::cout << "t: " << Transform(position).translation << std::endl;
-    auto [e, player, camera, vel, transform, dynC, aabb, metadata, rb]  = level.createEntityRet(
+    auto [e, player, camera, vel, transform, previous, dynC, aabb, metadata, rb]  = level.createEntityRet(
         PlayerComponent{yaw, pitch},
         CameraComponent(position, yaw, pitch),
         Velocity{},
         Transform{position},
+        PreviousTransform(Transform{position}),
         DynamicCollider(),
         AABBCollision(glm::vec3(0), glm::vec3(0.5, 1.33, 0.5)),
         ColliderMetadata(),
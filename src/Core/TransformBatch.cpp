@@ -0,0 +1,128 @@
+#include "TransformBatch.h"
+
+#include <algorithm>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#else
+#include <xmmintrin.h>
+#endif
+
+namespace {
+#if defined(__AVX__)
+    struct Float8 {
+        __m256 v;
+
+        static Float8 load(const float* p) { return { _mm256_load_ps(p) }; }
+        static Float8 set(const float f) { return { _mm256_set1_ps(f) }; }
+        void store(float* p) const { _mm256_store_ps(p, v); }
+
+        friend Float8 operator + (const Float8 a, const Float8 b) { return { _mm256_add_ps(a.v, b.v) }; }
+        friend Float8 operator - (const Float8 a, const Float8 b) { return { _mm256_sub_ps(a.v, b.v) }; }
+        friend Float8 operator * (const Float8 a, const Float8 b) { return { _mm256_mul_ps(a.v, b.v) }; }
+    };
+#else
+    struct Float8 {
+        __m128 lo, hi;
+
+        static Float8 load(const float* p) { return { _mm_load_ps(p), _mm_load_ps(p + 4) }; }
+        static Float8 set(const float f) { return { _mm_set1_ps(f), _mm_set1_ps(f) }; }
+        void store(float* p) const { _mm_store_ps(p, lo); _mm_store_ps(p + 4, hi); }
+
+        friend Float8 operator + (const Float8 a, const Float8 b) { return { _mm_add_ps(a.lo, b.lo), _mm_add_ps(a.hi, b.hi) }; }
+        friend Float8 operator - (const Float8 a, const Float8 b) { return { _mm_sub_ps(a.lo, b.lo), _mm_sub_ps(a.hi, b.hi) }; }
+        friend Float8 operator * (const Float8 a, const Float8 b) { return { _mm_mul_ps(a.lo, b.lo), _mm_mul_ps(a.hi, b.hi) }; }
+    };
+#endif
+
+    constexpr int LANES = transforms::LANES;
+    static_assert(LANES == 8);
+
+    /* one float per lane for every component, the transforms are transposed in and the matrices out */
+    struct alignas(32) Lanes {
+        float tx[LANES], ty[LANES], tz[LANES];
+        float sx[LANES], sy[LANES], sz[LANES];
+        float qx[LANES], qy[LANES], qz[LANES], qw[LANES];
+        float m[12][LANES]; /* the upper 3 rows of the 4 columns */
+    };
+
+    void gather(Lanes& lanes, const int lane, const Transform& transform) {
+        lanes.tx[lane] = transform.translation.x;
+        lanes.ty[lane] = transform.translation.y;
+        lanes.tz[lane] = transform.translation.z;
+        lanes.sx[lane] = transform.scale.x;
+        lanes.sy[lane] = transform.scale.y;
+        lanes.sz[lane] = transform.scale.z;
+        lanes.qx[lane] = transform.rotation.x;
+        lanes.qy[lane] = transform.rotation.y;
+        lanes.qz[lane] = transform.rotation.z;
+        lanes.qw[lane] = transform.rotation.w;
+    }
+
+    // the rotation of glm::mat4_cast scaled per column, then the translation
+    void compose(Lanes& lanes) {
+        const Float8 x = Float8::load(lanes.qx), y = Float8::load(lanes.qy), z = Float8::load(lanes.qz), w = Float8::load(lanes.qw);
+        const Float8 sx = Float8::load(lanes.sx), sy = Float8::load(lanes.sy), sz = Float8::load(lanes.sz);
+        const Float8 one = Float8::set(1.f), two = Float8::set(2.f);
+
+        const Float8 xx = x * x, yy = y * y, zz = z * z;
+        const Float8 xy = x * y, xz = x * z, yz = y * z;
+        const Float8 wx = w * x, wy = w * y, wz = w * z;
+
+        (sx * (one - two * (yy + zz))).store(lanes.m[0]);
+        (sx * (two * (xy + wz))).store(lanes.m[1]);
+        (sx * (two * (xz - wy))).store(lanes.m[2]);
+
+        (sy * (two * (xy - wz))).store(lanes.m[3]);
+        (sy * (one - two * (xx + zz))).store(lanes.m[4]);
+        (sy * (two * (yz + wx))).store(lanes.m[5]);
+
+        (sz * (two * (xz + wy))).store(lanes.m[6]);
+        (sz * (two * (yz - wx))).store(lanes.m[7]);
+        (sz * (one - two * (xx + yy))).store(lanes.m[8]);
+
+        std::copy_n(lanes.tx, LANES, lanes.m[9]);
+        std::copy_n(lanes.ty, LANES, lanes.m[10]);
+        std::copy_n(lanes.tz, LANES, lanes.m[11]);
+    }
+
+    void scatter(const Lanes& lanes, const int lane, glm::mat4& out) {
+        for (int column = 0; column < 4; ++column) {
+            out[column] = glm::vec4(
+                lanes.m[column * 3 + 0][lane],
+                lanes.m[column * 3 + 1][lane],
+                lanes.m[column * 3 + 2][lane],
+                column == 3 ? 1.f : 0.f);
+        }
+    }
+
+    template <typename At>
+    void composeAll(const size_t count, At&& at, glm::mat4* out) {
+        Lanes lanes;
+        for (size_t first = 0; first < count; first += LANES) {
+            const int width = static_cast<int>(std::min<size_t>(LANES, count - first));
+
+            for (int lane = 0; lane < width; ++lane) {
+                gather(lanes, lane, at(first + lane));
+            }
+            // the lanes past the end compose an identity that is never written
+            static const Transform identity;
+            for (int lane = width; lane < LANES; ++lane) {
+                gather(lanes, lane, identity);
+            }
+
+            compose(lanes);
+            for (int lane = 0; lane < width; ++lane) {
+                scatter(lanes, lane, out[first + lane]);
+            }
+        }
+    }
+}
+
+void transforms::composeMatrices(const std::span<const Transform> transforms, glm::mat4* out) {
+    composeAll(transforms.size(), [&](const size_t i) -> const Transform& { return transforms[i]; }, out);
+}
+
+void transforms::composeMatrices(const std::span<const Transform* const> transforms, glm::mat4* out) {
+    composeAll(transforms.size(), [&](const size_t i) -> const Transform& { return *transforms[i]; }, out);
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <span>
+#include <glm/mat4x4.hpp>
+
+#include "Transform.h"
+
+/*
+ * Transform::createModel3D for many transforms at once. The matrix is written directly from the quaternion,
+ * `T * R * S` without the three 4x4 products, for LANES transforms at a time.
+ */
+namespace transforms {
+    constexpr int LANES = 8;
+
+    /* `out` holds at least as many matrices as there are transforms */
+    void composeMatrices(std::span<const Transform> transforms, glm::mat4* out);
+    void composeMatrices(std::span<const Transform* const> transforms, glm::mat4* out);
+}
@@ -0,0 +1,260 @@
+#include "FrustumCuller.h"
+
+#include <algorithm>
+#include <numeric>
+#include <bit>
+#include <tuple>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#else
+#include <xmmintrin.h>
+#endif
+
+namespace {
+#if defined(__AVX__)
+    struct Float8 {
+        __m256 v;
+
+        static Float8 load(const float* p) { return { _mm256_loadu_ps(p) }; }
+        static Float8 set(const float f) { return { _mm256_set1_ps(f) }; }
+
+        friend Float8 operator + (const Float8 a, const Float8 b) { return { _mm256_add_ps(a.v, b.v) }; }
+        friend Float8 operator - (const Float8 a, const Float8 b) { return { _mm256_sub_ps(a.v, b.v) }; }
+        friend Float8 operator * (const Float8 a, const Float8 b) { return { _mm256_mul_ps(a.v, b.v) }; }
+        friend Float8 min(const Float8 a, const Float8 b) { return { _mm256_min_ps(a.v, b.v) }; }
+        friend Float8 max(const Float8 a, const Float8 b) { return { _mm256_max_ps(a.v, b.v) }; }
+        friend Float8 sqrt(const Float8 a) { return { _mm256_sqrt_ps(a.v) }; }
+
+        friend uint32_t lessThan(const Float8 a, const Float8 b) {
+            return _mm256_movemask_ps(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ));
+        }
+        friend uint32_t lessEqual(const Float8 a, const Float8 b) {
+            return _mm256_movemask_ps(_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ));
+        }
+    };
+#else
+    struct Float8 {
+        __m128 lo, hi;
+
+        static Float8 load(const float* p) { return { _mm_loadu_ps(p), _mm_loadu_ps(p + 4) }; }
+        static Float8 set(const float f) { return { _mm_set1_ps(f), _mm_set1_ps(f) }; }
+
+        friend Float8 operator + (const Float8 a, const Float8 b) { return { _mm_add_ps(a.lo, b.lo), _mm_add_ps(a.hi, b.hi) }; }
+        friend Float8 operator - (const Float8 a, const Float8 b) { return { _mm_sub_ps(a.lo, b.lo), _mm_sub_ps(a.hi, b.hi) }; }
+        friend Float8 operator * (const Float8 a, const Float8 b) { return { _mm_mul_ps(a.lo, b.lo), _mm_mul_ps(a.hi, b.hi) }; }
+        friend Float8 min(const Float8 a, const Float8 b) { return { _mm_min_ps(a.lo, b.lo), _mm_min_ps(a.hi, b.hi) }; }
+        friend Float8 max(const Float8 a, const Float8 b) { return { _mm_max_ps(a.lo, b.lo), _mm_max_ps(a.hi, b.hi) }; }
+        friend Float8 sqrt(const Float8 a) { return { _mm_sqrt_ps(a.lo), _mm_sqrt_ps(a.hi) }; }
+
+        friend uint32_t lessThan(const Float8 a, const Float8 b) {
+            return _mm_movemask_ps(_mm_cmplt_ps(a.lo, b.lo)) | _mm_movemask_ps(_mm_cmplt_ps(a.hi, b.hi)) << 4;
+        }
+        friend uint32_t lessEqual(const Float8 a, const Float8 b) {
+            return _mm_movemask_ps(_mm_cmple_ps(a.lo, b.lo)) | _mm_movemask_ps(_mm_cmple_ps(a.hi, b.hi)) << 4;
+        }
+    };
+#endif
+
+    uint32_t laneMask(const size_t remaining) {
+        return remaining >= FrustumCuller::LANES ? 0xFFu : (1u << remaining) - 1;
+    }
+}
+
+struct FrustumCuller::Planes {
+    Float8 x[6], y[6], z[6], w[6];
+    bool negativeX[6], negativeY[6], negativeZ[6];
+    Float8 originX, originY, originZ;
+    Float8 viewDistance;
+};
+
+bool FrustumCuller::regionOrder(const glm::ivec3& a, const glm::ivec3& b) {
+    static_assert(std::has_single_bit(static_cast<unsigned>(SUPER_REGION)));
+    constexpr int shift = std::countr_zero(static_cast<unsigned>(SUPER_REGION));
+
+    const glm::ivec3 superA(a.x >> shift, a.y >> shift, a.z >> shift);
+    const glm::ivec3 superB(b.x >> shift, b.y >> shift, b.z >> shift);
+    return std::tie(superA.x, superA.y, superA.z, a.x, a.y, a.z) < std::tie(superB.x, superB.y, superB.z, b.x, b.y, b.z);
+}
+
+void FrustumCuller::Boxes::clear() {
+    minX.clear(); minY.clear(); minZ.clear();
+    maxX.clear(); maxY.clear(); maxZ.clear();
+}
+
+void FrustumCuller::Boxes::push(const AABB& box) {
+    push(box.min(), box.max());
+}
+
+void FrustumCuller::Boxes::push(const glm::vec3& min, const glm::vec3& max) {
+    minX.push_back(min.x); minY.push_back(min.y); minZ.push_back(min.z);
+    maxX.push_back(max.x); maxY.push_back(max.y); maxZ.push_back(max.z);
+}
+
+void FrustumCuller::Boxes::pad() {
+    for (int i = 0; i < LANES - 1; ++i) {
+        push(glm::vec3(0.f), glm::vec3(0.f));
+    }
+}
+
+void FrustumCuller::setRegions(const std::span<const glm::ivec3> regions, const std::span<const AABB> bounds) {
+    std::vector<uint32_t> order(regions.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](const uint32_t a, const uint32_t b) {
+        return regionOrder(regions[a], regions[b]);
+    });
+
+    ids.clear();
+    groups.clear();
+    regionBoxes.clear();
+    groupBoxes.clear();
+
+    constexpr int shift = std::countr_zero(static_cast<unsigned>(SUPER_REGION));
+    auto superOf = [](const glm::ivec3& region) {
+        return glm::ivec3(region.x >> shift, region.y >> shift, region.z >> shift);
+    };
+
+    glm::vec3 groupMin{}, groupMax{};
+    for (const uint32_t index : order) {
+        const auto begin = static_cast<uint32_t>(ids.size());
+        const AABB& box = bounds[index];
+
+        if (groups.empty() || superOf(ids.back()) != superOf(regions[index])) {
+            if (!groups.empty()) {
+                groupBoxes.push(groupMin, groupMax);
+            }
+            groups.push_back({ begin, begin });
+            groupMin = box.min();
+            groupMax = box.max();
+        } else {
+            groupMin = glm::min(groupMin, box.min());
+            groupMax = glm::max(groupMax, box.max());
+        }
+
+        ids.push_back(regions[index]);
+        regionBoxes.push(box);
+        groups.back().end = begin + 1;
+    }
+    if (!groups.empty()) {
+        groupBoxes.push(groupMin, groupMax);
+    }
+
+    regionBoxes.pad();
+    groupBoxes.pad();
+    regionPlanes.assign(ids.size(), 0);
+    groupPlanes.assign((groups.size() + LANES - 1) / LANES, 0);
+}
+
+/*
+ * Returns the lanes that pass every plane and the view distance. With Classify it also writes the lanes whose
+ * whole box is inside, for accepting a super region's children without testing them.
+ * The dot products are evaluated in the same order as Frustum::contains so the results are bit-identical.
+ */
+template <bool Classify>
+uint32_t FrustumCuller::testBlock(const Boxes& boxes, const size_t i, const Planes& planes, uint8_t& lastPlane, uint32_t* inside) {
+    const Float8 minX = Float8::load(boxes.minX.data() + i);
+    const Float8 minY = Float8::load(boxes.minY.data() + i);
+    const Float8 minZ = Float8::load(boxes.minZ.data() + i);
+    const Float8 maxX = Float8::load(boxes.maxX.data() + i);
+    const Float8 maxY = Float8::load(boxes.maxY.data() + i);
+    const Float8 maxZ = Float8::load(boxes.maxZ.data() + i);
+    const Float8 zero = Float8::set(0.f);
+
+    uint32_t alive = 0xFF;
+    uint32_t fullyInside = 0xFF;
+
+    const int firstPlane = lastPlane;
+    for (int k = 0; k < 6; ++k) {
+        const int p = (firstPlane + k) % 6;
+
+        const Float8 px = planes.negativeX[p] ? minX : maxX;
+        const Float8 py = planes.negativeY[p] ? minY : maxY;
+        const Float8 pz = planes.negativeZ[p] ? minZ : maxZ;
+        const Float8 d = planes.x[p] * px + planes.y[p] * py + planes.z[p] * pz + planes.w[p];
+
+        if (const uint32_t outside = lessThan(d, zero) & alive) {
+            lastPlane = static_cast<uint8_t>(p);
+            alive &= ~outside;
+            if (!alive) return 0;
+        }
+
+        if constexpr (Classify) {
+            const Float8 nx = planes.negativeX[p] ? maxX : minX;
+            const Float8 ny = planes.negativeY[p] ? maxY : minY;
+            const Float8 nz = planes.negativeZ[p] ? maxZ : minZ;
+            fullyInside &= ~lessThan(planes.x[p] * nx + planes.y[p] * ny + planes.z[p] * nz + planes.w[p], zero);
+        }
+    }
+
+    const Float8 dx = planes.originX - min(max(planes.originX, minX), maxX);
+    const Float8 dy = planes.originY - min(max(planes.originY, minY), maxY);
+    const Float8 dz = planes.originZ - min(max(planes.originZ, minZ), maxZ);
+    alive &= lessEqual(sqrt(dx * dx + dy * dy + dz * dz), planes.viewDistance);
+
+    if constexpr (Classify) {
+        const Float8 fx = max(planes.originX - minX, maxX - planes.originX);
+        const Float8 fy = max(planes.originY - minY, maxY - planes.originY);
+        const Float8 fz = max(planes.originZ - minZ, maxZ - planes.originZ);
+        fullyInside &= lessEqual(sqrt(fx * fx + fy * fy + fz * fz), planes.viewDistance);
+        *inside = fullyInside & alive;
+    }
+    return alive;
+}
+
+void FrustumCuller::cull(const Frustum& frustum, const glm::vec3& origin, const float viewDistance) {
+    visible.clear();
+
+    Planes planes;
+    for (int p = 0; p < 6; ++p) {
+        const glm::vec4& plane = frustum.planes[p];
+        planes.x[p] = Float8::set(plane.x);
+        planes.y[p] = Float8::set(plane.y);
+        planes.z[p] = Float8::set(plane.z);
+        planes.w[p] = Float8::set(plane.w);
+        planes.negativeX[p] = plane.x < 0.0f;
+        planes.negativeY[p] = plane.y < 0.0f;
+        planes.negativeZ[p] = plane.z < 0.0f;
+    }
+    planes.originX = Float8::set(origin.x);
+    planes.originY = Float8::set(origin.y);
+    planes.originZ = Float8::set(origin.z);
+    planes.viewDistance = Float8::set(viewDistance);
+
+    for (size_t g = 0; g < groups.size(); g += LANES) {
+        uint32_t inside = 0;
+        uint32_t hit = testBlock<true>(groupBoxes, g, planes, groupPlanes[g / LANES], &inside) & laneMask(groups.size() - g);
+
+        for (; hit; hit &= hit - 1) {
+            const int lane = std::countr_zero(hit);
+            const auto [begin, end] = groups[g + lane];
+
+            if (inside >> lane & 1) {
+                visible.insert(visible.end(), ids.begin() + begin, ids.begin() + end);
+                continue;
+            }
+
+            for (size_t i = begin; i < end; i += LANES) {
+                uint32_t mask = testBlock<false>(regionBoxes, i, planes, regionPlanes[i], nullptr) & laneMask(end - i);
+                for (; mask; mask &= mask - 1) {
+                    visible.push_back(ids[i + std::countr_zero(mask)]);
+                }
+            }
+        }
+    }
+}
+
+void FrustumCuller::commit(std::vector<Change>& changes) {
+    // entries of `from` missing in `in`, both sorted by regionOrder
+    auto missing = [&](const std::vector<glm::ivec3>& from, const std::vector<glm::ivec3>& in, const bool isVisible) {
+        auto it = in.begin();
+        for (const auto& region : from) {
+            while (it != in.end() && regionOrder(*it, region)) ++it;
+            if (it == in.end() || *it != region) {
+                changes.emplace_back(region, isVisible);
+            }
+        }
+    };
+    missing(committed, visible, false);
+    missing(visible, committed, true);
+    committed = visible;
+}
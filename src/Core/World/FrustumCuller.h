@@ -0,0 +1,161 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <utility>
+
+#include "Math/Shapes/AABB.h"
+
+struct Frustum {
+    glm::vec4 planes[6];
+
+    void extract(const glm::mat4& m) {
+        // Left
+        planes[0] = glm::vec4(
+            m[0][3] + m[0][0],
+            m[1][3] + m[1][0],
+            m[2][3] + m[2][0],
+            m[3][3] + m[3][0]);
+
+        // Right plane = row 3 - row 0
+        planes[1] = glm::vec4(
+            m[0][3] - m[0][0],
+            m[1][3] - m[1][0],
+            m[2][3] - m[2][0],
+            m[3][3] - m[3][0]);
+
+        // Bottom plane = row 3 + row 1
+        planes[2] = glm::vec4(
+            m[0][3] + m[0][1],
+            m[1][3] + m[1][1],
+            m[2][3] + m[2][1],
+            m[3][3] + m[3][1]);
+
+        // Top plane = row 3 - row 1
+        planes[3] = glm::vec4(
+            m[0][3] - m[0][1],
+            m[1][3] - m[1][1],
+            m[2][3] - m[2][1],
+            m[3][3] - m[3][1]);
+
+        // Near plane = row 3 + row 2
+        planes[4] = glm::vec4(
+            m[0][3] + m[0][2],
+            m[1][3] + m[1][2],
+            m[2][3] + m[2][2],
+            m[3][3] + m[3][2]);
+
+        // Far plane = row 3 - row 2
+        planes[5] = glm::vec4(
+            m[0][3] - m[0][2],
+            m[1][3] - m[1][2],
+            m[2][3] - m[2][2],
+            m[3][3] - m[3][2]);
+
+        // Normalize
+        for (int i = 0; i < 6; ++i) {
+            float len = glm::length(glm::vec3(planes[i]));
+            planes[i] /= len;
+        }
+    }
+
+    bool contains(const AABB& box) const {
+        for (int i = 0; i < 6; ++i) {
+            auto& plane = planes[i];
+
+            glm::vec3 axisVert;
+
+            axisVert.x = plane.x < 0.0f ? box.min().x : box.max().x;
+            axisVert.y = plane.y < 0.0f ? box.min().y : box.max().y;
+            axisVert.z = plane.z < 0.0f ? box.min().z : box.max().z;
+
+            if (dot(glm::vec3(plane), axisVert) + plane.w < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool isInsideViewDistance(const glm::vec3& origin, const AABB& box, const float viewDistance) {
+        glm::vec3 clampedPoint = glm::clamp(origin, box.min(), box.max());
+        const float d = glm::length(origin - clampedPoint);
+
+        return d <= viewDistance;
+    }
+
+    /* the scalar test FrustumCuller has to agree with */
+    bool isVisible(const AABB& box, const glm::vec3& origin, const float viewDistance) const {
+        return contains(box) && isInsideViewDistance(origin, box, viewDistance);
+    }
+};
+
+/*
+ * Culls a fixed set of boxes keyed by region coordinates, 8 per step.
+ *
+ * Boxes are stored as SoA min/max arrays ordered by super region (SUPER_REGION^3 regions), and every super region
+ * keeps the union of its children. Super regions are culled first: outside rejects all children, fully inside
+ * (every plane passes the n-vertex and the farthest corner is in range) accepts all of them, and only the ones
+ * straddling a plane test their children. Float arithmetic is monotonic, so the coarse decisions agree exactly
+ * with the per-box scalar test. Each block of 8 remembers the plane that last rejected one of its lanes and starts there.
+ *
+ * The visible list comes out sorted by regionOrder, which also makes the diff against the last commit a linear merge.
+ */
+class FrustumCuller {
+public:
+    constexpr static int LANES = 8;
+    constexpr static int SUPER_REGION = 4;
+
+    using Change = std::pair<glm::ivec3, bool>;
+
+    static bool regionOrder(const glm::ivec3& a, const glm::ivec3& b);
+
+    /* replaces the culled boxes, regions may be given in any order */
+    void setRegions(std::span<const glm::ivec3> regions, std::span<const AABB> bounds);
+
+    void cull(const Frustum& frustum, const glm::vec3& origin, float viewDistance);
+
+    /* appends what changed since the last commit, removals first, and makes the last cull the new baseline */
+    void commit(std::vector<Change>& changes);
+
+    /* sorted by regionOrder */
+    std::span<const glm::ivec3> getVisible() const {
+        return visible;
+    }
+
+    size_t size() const {
+        return ids.size();
+    }
+
+private:
+    struct Boxes {
+        std::vector<float> minX, minY, minZ;
+        std::vector<float> maxX, maxY, maxZ;
+
+        void clear();
+        void push(const AABB& box);
+        void push(const glm::vec3& min, const glm::vec3& max);
+        /* appends LANES - 1 dead boxes so a full-width load from any box stays in bounds */
+        void pad();
+    };
+
+    struct Group {
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    struct Planes;
+
+    template <bool Classify>
+    static uint32_t testBlock(const Boxes& boxes, size_t i, const Planes& planes, uint8_t& lastPlane, uint32_t* inside);
+
+    Boxes regionBoxes;
+    Boxes groupBoxes;
+    std::vector<Group> groups;
+    std::vector<glm::ivec3> ids;
+    std::vector<uint8_t> regionPlanes;
+    std::vector<uint8_t> groupPlanes;
+
+    std::vector<glm::ivec3> visible;
+    std::vector<glm::ivec3> committed;
+};
@@ -5,6 +5,7 @@
 #include <util/glm_double.h>
 
 #include "TerrainWorld.h"
+#include "FrustumCuller.h"
 
 enum class FrustumPlane {
     LEFT, RIGHT,
@@ -12,93 +13,49 @@ enum class FrustumPlane {
     NEAR_PLANE, FAR_PLANE
 };
 
-struct Frustum {
-    glm::vec4 planes[6];
-
-    void extract(const glm::mat4& m) {
-        // Left
-        planes[0] = glm::vec4(
-            m[0][3] + m[0][0],
-            m[1][3] + m[1][0],
-            m[2][3] + m[2][0],
-            m[3][3] + m[3][0]);
-
-        // Right plane = row 3 - row 0
-        planes[1] = glm::vec4(
-            m[0][3] - m[0][0],
-            m[1][3] - m[1][0],
-            m[2][3] - m[2][0],
-            m[3][3] - m[3][0]);
-
-        // Bottom plane = row 3 + row 1
-        planes[2] = glm::vec4(
-            m[0][3] + m[0][1],
-            m[1][3] + m[1][1],
-            m[2][3] + m[2][1],
-            m[3][3] + m[3][1]);
-
-        // Top plane = row 3 - row 1
-        planes[3] = glm::vec4(
-            m[0][3] - m[0][1],
-            m[1][3] - m[1][1],
-            m[2][3] - m[2][1],
-            m[3][3] - m[3][1]);
-
-        // Near plane = row 3 + row 2
-        planes[4] = glm::vec4(
-            m[0][3] + m[0][2],
-            m[1][3] + m[1][2],
-            m[2][3] + m[2][2],
-            m[3][3] + m[3][2]);
-
-        // Far plane = row 3 - row 2
-        planes[5] = glm::vec4(
-            m[0][3] - m[0][2],
-            m[1][3] - m[1][2],
-            m[2][3] - m[2][2],
-            m[3][3] - m[3][2]);
-
-        // Normalize
-        for (int i = 0; i < 6; ++i) {
-            float len = glm::length(glm::vec3(planes[i]));
-            planes[i] /= len;
-        }
-    }
-};
-
 class FrustumCullingSystem : public DefaultStage::Reads<CameraComponent>, public DefaultStage::ReadsResources<TerrainWorld>, public ResourceSystem<>, public Stages<DefaultStage> {
     Frustum frustum{};
-
-    std::unordered_set<glm::ivec3, IVec3Hash> visibleChunks;
-    std::vector<std::pair<glm::ivec3, bool>> chunkChanges;
+    FrustumCuller culler;
+    uint64_t worldVersion = ~0ull;
+
+    std::vector<glm::ivec3> regionIDs;
+    std::vector<AABB> regionBounds;
+    std::vector<FrustumCuller::Change> chunkChanges;
+
+    void gatherRegions(const TerrainWorld& world) {
+        regionIDs.clear();
+        regionBounds.clear();
+        for (auto& [coords, region] : world.getRegions()) {
+            regionIDs.emplace_back(coords);
+            regionBounds.emplace_back(region.bounds());
+        }
+        culler.setRegions(regionIDs, regionBounds);
+        worldVersion = world.getVersion();
+    }
 public:
     void onUpdate(LevelUpdateView<FrustumCullingSystem> view) {
         chunkChanges.clear();
 
+        if (auto& world = view.get<TerrainWorld>(); world.getVersion() != worldVersion) {
+            gatherRegions(world);
+        }
+
+        bool culled = false;
         view.query<CameraComponent>().forEach([&](const Entity e, const CameraComponent& camera) {
             glm::mat4 viewProjection = camera.projection * camera.view;
             frustum.extract(viewProjection);
 
-            for (auto& [coords, chunk] : view.get<TerrainWorld>().getRegions()) {
-                if (isAABBInsideFrustum(chunk.bounds()) && isInsideViewDistance(camera.position, chunk.bounds(), camera.viewDistance)) {
-                    if (visibleChunks.insert(coords).second) {
-                        chunkChanges.emplace_back(coords, true);
-                    }
-                } else if (visibleChunks.erase(coords)) {
-                    chunkChanges.emplace_back(coords, false);
-                }
-            }
-        });
-        std::sort(chunkChanges.begin(), chunkChanges.end(), [](const std::pair<glm::ivec3, bool>& a, const auto& b){
-            return a.second < b.second;
+            culler.cull(frustum, camera.position, camera.viewDistance);
+            culled = true;
         });
+
+        if (culled) {
+            culler.commit(chunkChanges);
+        }
     }
 
     bool isInsideViewDistance(const glm::vec3& origin, const AABB& box, const float viewDistance) {
-        glm::vec3 clampedPoint = glm::clamp(origin, box.min(), box.max());
-        const float d = glm::length(origin - clampedPoint);
-
-        return d <= viewDistance;
+        return Frustum::isInsideViewDistance(origin, box, viewDistance);
     }
 
     bool isFullyInsideViewDistance(const glm::vec3& cameraPos, const AABB& box, float viewDistance) {
@@ -143,27 +100,16 @@ public:
     }
     
     bool isAABBInsideFrustum(const AABB& box) const {
-        for (int i = 0; i < 6; ++i) {
-            auto& plane = frustum.planes[i];
-
-            glm::vec3 axisVert;
-
-            axisVert.x = plane.x < 0.0f ? box.min().x : box.max().x;
-            axisVert.y = plane.y < 0.0f ? box.min().y : box.max().y;
-            axisVert.z = plane.z < 0.0f ? box.min().z : box.max().z;
-
-            if (dot(glm::vec3(plane), axisVert) + plane.w < 0.0f) {
-                return false;
-            }
-        }
-        return true;
+        return frustum.contains(box);
     }
 
-    const std::unordered_set<glm::ivec3, IVec3Hash>& getVisibleChunks() const {
-        return visibleChunks;
+    /* sorted by FrustumCuller::regionOrder */
+    std::span<const glm::ivec3> getVisibleChunks() const {
+        return culler.getVisible();
     }
 
-    const std::vector<std::pair<glm::ivec3, bool>>& getChanges() const {
+    /* removals first */
+    const std::vector<FrustumCuller::Change>& getChanges() const {
         return chunkChanges;
     }
 };
\ No newline at end of file
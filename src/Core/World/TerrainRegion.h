@@ -0,0 +1,132 @@
+#pragma once
+#include <Math/BoundingVolumeHierarchy.h>
+#include "Math/Shapes/AABB.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <unordered_map>
+#include <vector>
+
+template <typename Key>
+struct TerrainRegionEntry {
+    AABB bounds{};
+    Key entity{};
+
+    TerrainRegionEntry() = default;
+
+    TerrainRegionEntry(const AABB& aabb, const Key entity) : bounds(aabb), entity(entity) {}
+    operator const AABB&() const {
+        return bounds;
+    }
+
+    bool operator == (const Key e) const {
+        return entity == e;
+    }
+};
+
+struct RegionBVHMatrices {
+    glm::mat4 worldTransform{};
+    glm::mat4 inverseWorldTransform{};
+    glm::mat4 normalMatrix{};
+};
+
+/*
+ * The static colliders of one terrain region in a BVH. Moved entities refit their leaf, new ones wait in the
+ * stash until update() inserts them into the existing leaves. Neither restructures the tree, so update() rebuilds
+ * it once its SAH cost has grown REBUILD_SAH_RATIO past the cost it was built with.
+ */
+template <typename Key>
+struct TerrainRegion {
+    using Entry = TerrainRegionEntry<Key>;
+
+    /* rebuild once refits and inserts have made the tree this much more expensive than when it was built */
+    constexpr static float REBUILD_SAH_RATIO = 1.3f;
+    constexpr static size_t MAX_LEAF_SIZE = 6;
+
+    RegionBVHMatrices matrices;
+    BVH<Entry> bvh;
+    std::vector<Key> visitors;
+    mem::vector<Entry> stash;
+    std::unordered_map<Key, uint32_t> stashOf;
+    std::unordered_map<Key, uint32_t> primitiveOf;
+    std::vector<uint32_t> dirtyLeaves;
+    float builtCost = 0.f;
+    /* how often update() restructured the tree, for tests and benchmarks */
+    uint64_t rebuilds = 0;
+
+    TerrainRegion() = default;
+
+    TerrainRegion(const glm::ivec3 local, const int regionSize) {
+        matrices.worldTransform = glm::translate(glm::mat4(1.0f), glm::vec3(local) * static_cast<float>(regionSize));
+        matrices.inverseWorldTransform = glm::inverse(matrices.worldTransform);
+        matrices.normalMatrix = glm::transpose(glm::inverse(glm::mat3(matrices.worldTransform)));
+    }
+
+    void addEntity(const Key& entity, const AABB& aabb) {
+        updateEntity(entity, aabb);
+    }
+
+    void updateEntity(const Key& entity, const AABB& aabb) {
+        if (const auto it = primitiveOf.find(entity); it != primitiveOf.end()) {
+            bvh.primitive(it->second).bounds = aabb;
+            dirtyLeaves.push_back(bvh.leafOf(it->second));
+            return;
+        }
+        if (const auto [it, added] = stashOf.try_emplace(entity, static_cast<uint32_t>(stash.size())); !added) {
+            stash[it->second].bounds = aabb;
+            return;
+        }
+        stash.emplace_back(aabb, entity);
+    }
+
+    void update() {
+        if (!dirtyLeaves.empty()) {
+            bvh.refit(dirtyLeaves);
+            dirtyLeaves.clear();
+        }
+        if (stash.size() != 0) {
+            if (bvh.empty()) {
+                return rebuild();
+            }
+            bvh.insert(stash);
+            clearStash();
+            indexPrimitives();
+        }
+
+        if (bvh.sahCost() > builtCost * REBUILD_SAH_RATIO) {
+            rebuild();
+        }
+    }
+
+    void rebuild() {
+        if (stash.size() == 0) {
+            bvh.rebuild(MAX_LEAF_SIZE);
+        } else {
+            bvh.rebuildWith(stash, MAX_LEAF_SIZE);
+            clearStash();
+        }
+        dirtyLeaves.clear();
+        indexPrimitives();
+        builtCost = bvh.sahCost();
+        ++rebuilds;
+    }
+
+    bool hasChanges() const {
+        return stash.size() != 0 || !dirtyLeaves.empty();
+    }
+
+    AABB bounds() const {
+        return bvh.bounds();
+    }
+
+private:
+    void clearStash() {
+        stash.clear();
+        stashOf.clear();
+    }
+
+    /* entities are only ever added, so the keys stay and only their indices move */
+    void indexPrimitives() {
+        bvh.forEachPrimitive([&](const uint32_t index, const Entry& entry) {
+            primitiveOf[entry.entity] = index;
+        });
+    }
+};
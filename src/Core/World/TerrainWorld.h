@@ -1,5 +1,5 @@
 #pragma once
-#include <Math/BoundingVolumeHierarchy.h>
+#include "TerrainRegion.h"
 #include "Worlds.h"
 #include "ECS/Entity/Entity.h"
 #include "ECS/Level/Views/LevelUpdateView.h"
@@ -17,47 +17,8 @@ struct TerrainWorld : Reads<StaticCollider, DynamicCollider, Transform, AABBColl
 
     constexpr static auto REGION_SIZE = 64;
 
-    struct WorldEntry {
-        AABB bounds{};
-        Entity entity{};
-
-        WorldEntry() = default;
-
-        WorldEntry(const AABB& aabb, const Entity entity) : bounds(aabb), entity(entity) {}
-        operator const AABB&() const { 
-            return bounds; 
-        }
-
-        bool operator == (const Entity e) const {
-            return entity == e;
-        }
-    };
-    
-    struct RegionBVHMatrices {
-        glm::mat4 worldTransform{};
-        glm::mat4 inverseWorldTransform{};
-        glm::mat4 normalMatrix{};
-    };
-
-    struct Region {
-        RegionBVHMatrices matrices;
-        BVH<WorldEntry> bvh;
-        std::vector<Entity> visitors;
-        mem::vector<WorldEntry> stash;
-        int changes = 0;
-
-        Region() = default;
-        Region(glm::ivec3 local);
-
-        void addEntity(const Entity& entity, const AABB& aabb);
-        void updateEntity(const Entity& entity, const AABB& aabb);
-        void build();
-        void refit();
-
-        AABB bounds() const {
-            return bvh.bounds();
-        }
-    };
+    using WorldEntry = TerrainRegionEntry<Entity>;
+    using Region = TerrainRegion<Entity>;
 
 private:
     Region& getRegion(const glm::vec3& worldPos);
@@ -65,6 +26,7 @@ private:
 
     std::unordered_map<WorldRegionID, Region> regions;
     std::vector<WorldRegionID> dirtyRegions;
+    uint64_t version = 0;
 public:
     TerrainWorld() = default;
     TerrainWorld(const TerrainWorld&) = delete;
@@ -87,6 +49,11 @@ public:
         return regions;
     }
 
+    /* bumped whenever a region is added or its bounds may have changed */
+    uint64_t getVersion() const {
+        return version;
+    }
+
     static auto getRegionSize() {
         return REGION_SIZE;
     }
@@ -0,0 +1,269 @@
+#include "TransformHierarchy.h"
+#include "TransformBatch.h"
+
+#include <algorithm>
+#include <bit>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+namespace {
+    /* calls `fn(word, mask)` for every word of the bits in [begin, end) */
+    template <typename Fn>
+    void forEachWord(const uint32_t begin, const uint32_t end, Fn&& fn) {
+        for (uint32_t bit = begin; bit < end;) {
+            const uint32_t count = std::min<uint32_t>(64 - (bit & 63), end - bit);
+            const uint64_t ones = count == 64 ? ~uint64_t(0) : (uint64_t(1) << count) - 1;
+            fn(bit >> 6, ones << (bit & 63));
+            bit += count;
+        }
+    }
+}
+
+HierarchyNode TransformHierarchy::add(const HierarchyNode parent, const Transform& local, const glm::vec3& offset) {
+    HierarchyNode node;
+    if (!freeHandles.empty()) {
+        node = freeHandles.back();
+        freeHandles.pop_back();
+    } else {
+        node = static_cast<HierarchyNode>(slotOf.size());
+        slotOf.push_back(NO_SLOT);
+        parentOf.push_back(HierarchyNode::INVALID);
+        firstChildOf.push_back(HierarchyNode::INVALID);
+        nextSiblingOf.push_back(HierarchyNode::INVALID);
+        previousSiblingOf.push_back(HierarchyNode::INVALID);
+    }
+
+    const auto slot = static_cast<uint32_t>(handles.size());
+    slotOf[static_cast<uint32_t>(node)] = slot;
+    handles.push_back(node);
+    parents.push_back(slot);
+    firstChild.push_back(0);
+    childCount.push_back(0);
+    locals.push_back(local);
+    offsets.push_back(offset);
+    worlds.emplace_back();
+    matrices.emplace_back(1.0f);
+
+    link(node, parent);
+    layoutDirty = true;
+    return node;
+}
+
+void TransformHierarchy::remove(const HierarchyNode node) {
+    unlink(node);
+
+    // the removed slots are left behind and dropped by the next layout
+    std::vector<HierarchyNode> stack{ node };
+    while (!stack.empty()) {
+        const auto current = static_cast<uint32_t>(stack.back());
+        stack.pop_back();
+
+        for (auto child = firstChildOf[current]; child != HierarchyNode::INVALID; child = nextSiblingOf[static_cast<uint32_t>(child)]) {
+            stack.push_back(child);
+        }
+        slotOf[current] = NO_SLOT;
+        parentOf[current] = HierarchyNode::INVALID;
+        firstChildOf[current] = HierarchyNode::INVALID;
+        nextSiblingOf[current] = HierarchyNode::INVALID;
+        previousSiblingOf[current] = HierarchyNode::INVALID;
+        freeHandles.push_back(static_cast<HierarchyNode>(current));
+    }
+    layoutDirty = true;
+}
+
+void TransformHierarchy::reparent(const HierarchyNode node, const HierarchyNode parent) {
+    if (parentOf[static_cast<uint32_t>(node)] == parent) return;
+
+    unlink(node);
+    link(node, parent);
+    layoutDirty = true;
+}
+
+void TransformHierarchy::setLocal(const HierarchyNode node, const Transform& local) {
+    const uint32_t slot = slotOf[static_cast<uint32_t>(node)];
+    locals[slot] = local;
+    markDirty(slot);
+}
+
+void TransformHierarchy::setLocal(const HierarchyNode node, const Transform& local, const glm::vec3& offset) {
+    const uint32_t slot = slotOf[static_cast<uint32_t>(node)];
+    locals[slot] = local;
+    offsets[slot] = offset;
+    markDirty(slot);
+}
+
+void TransformHierarchy::link(const HierarchyNode node, const HierarchyNode parent) {
+    const auto handle = static_cast<uint32_t>(node);
+    HierarchyNode& head = parent == HierarchyNode::INVALID ? firstRoot : firstChildOf[static_cast<uint32_t>(parent)];
+
+    parentOf[handle] = parent;
+    previousSiblingOf[handle] = HierarchyNode::INVALID;
+    nextSiblingOf[handle] = head;
+    if (head != HierarchyNode::INVALID) {
+        previousSiblingOf[static_cast<uint32_t>(head)] = node;
+    }
+    head = node;
+}
+
+void TransformHierarchy::unlink(const HierarchyNode node) {
+    const auto handle = static_cast<uint32_t>(node);
+    const HierarchyNode previous = previousSiblingOf[handle];
+    const HierarchyNode next = nextSiblingOf[handle];
+
+    if (previous != HierarchyNode::INVALID) {
+        nextSiblingOf[static_cast<uint32_t>(previous)] = next;
+    } else if (const HierarchyNode parent = parentOf[handle]; parent != HierarchyNode::INVALID) {
+        firstChildOf[static_cast<uint32_t>(parent)] = next;
+    } else {
+        firstRoot = next;
+    }
+    if (next != HierarchyNode::INVALID) {
+        previousSiblingOf[static_cast<uint32_t>(next)] = previous;
+    }
+    parentOf[handle] = HierarchyNode::INVALID;
+    previousSiblingOf[handle] = HierarchyNode::INVALID;
+    nextSiblingOf[handle] = HierarchyNode::INVALID;
+}
+
+void TransformHierarchy::markDirty(const uint32_t slot) {
+    // until the next layout every slot is composed anyway
+    if (layoutDirty) return;
+
+    const auto level = static_cast<size_t>(std::ranges::upper_bound(levels, slot) - levels.begin()) - 1;
+    markDirty(level, slot, slot + 1);
+}
+
+void TransformHierarchy::markDirty(const size_t level, const uint32_t begin, const uint32_t end) {
+    dirty[level].grow(begin, end);
+    forEachWord(begin, end, [&](const size_t word, const uint64_t mask) { dirtySlots[word] |= mask; });
+}
+
+uint32_t TransformHierarchy::takeDirtyRuns(const size_t level) {
+    const DirtyRange bounds = dirty[level];
+    dirty[level] = DirtyRange{};
+    runs.clear();
+
+    // the first set bit from `from`, then the first clear one after it, both capped at the bounds
+    const auto next = [&](const uint32_t from, const uint64_t flip) {
+        size_t word = from >> 6;
+        uint64_t bits = (dirtySlots[word] ^ flip) & (~uint64_t(0) << (from & 63));
+        while (!bits && (word + 1) * 64 < bounds.end) bits = dirtySlots[++word] ^ flip;
+        return bits ? std::min(static_cast<uint32_t>(word * 64 + std::countr_zero(bits)), bounds.end) : bounds.end;
+    };
+
+    uint32_t count = 0;
+    for (uint32_t slot = bounds.begin; slot < bounds.end;) {
+        const uint32_t begin = next(slot, 0);
+        if (begin == bounds.end) break;
+        const uint32_t end = next(begin, ~uint64_t(0));
+
+        forEachWord(begin, end, [&](const size_t word, const uint64_t mask) { dirtySlots[word] &= ~mask; });
+        for (uint32_t piece = begin; piece < end; piece += PARALLEL_GRAIN) {
+            runs.push_back({ piece, std::min(piece + PARALLEL_GRAIN, end) });
+        }
+        count += end - begin;
+        slot = end;
+    }
+    return count;
+}
+
+void TransformHierarchy::layout() {
+    const auto count = static_cast<uint32_t>(slotOf.size() - freeHandles.size());
+
+    std::vector<HierarchyNode> order;
+    std::vector<uint32_t> newParents;
+    std::vector<uint32_t> newFirstChild;
+    std::vector<uint32_t> newChildCount;
+    order.reserve(count);
+    newParents.reserve(count);
+    newFirstChild.reserve(count);
+    newChildCount.reserve(count);
+
+    for (auto root = firstRoot; root != HierarchyNode::INVALID; root = nextSiblingOf[static_cast<uint32_t>(root)]) {
+        newParents.push_back(static_cast<uint32_t>(order.size()));
+        order.push_back(root);
+    }
+
+    // the order is its own queue, a level ends where the children of the level above it end
+    levels.assign(1, 0);
+    auto levelEnd = static_cast<uint32_t>(order.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        if (i == levelEnd) {
+            levels.push_back(i);
+            levelEnd = static_cast<uint32_t>(order.size());
+        }
+
+        newFirstChild.push_back(static_cast<uint32_t>(order.size()));
+        uint32_t children = 0;
+        for (auto child = firstChildOf[static_cast<uint32_t>(order[i])]; child != HierarchyNode::INVALID; child = nextSiblingOf[static_cast<uint32_t>(child)]) {
+            newParents.push_back(i);
+            order.push_back(child);
+            ++children;
+        }
+        newChildCount.push_back(children);
+    }
+    levels.push_back(static_cast<uint32_t>(order.size()));
+
+    std::vector<Transform> newLocals(order.size());
+    std::vector<glm::vec3> newOffsets(order.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        const uint32_t slot = slotOf[static_cast<uint32_t>(order[i])];
+        newLocals[i] = locals[slot];
+        newOffsets[i] = offsets[slot];
+        slotOf[static_cast<uint32_t>(order[i])] = i;
+    }
+
+    handles = std::move(order);
+    parents = std::move(newParents);
+    firstChild = std::move(newFirstChild);
+    childCount = std::move(newChildCount);
+    locals = std::move(newLocals);
+    offsets = std::move(newOffsets);
+    worlds.resize(handles.size());
+    matrices.resize(handles.size());
+
+    // every node may have moved, so the whole hierarchy is composed again
+    dirty.assign(levels.size() - 1, DirtyRange{});
+    dirtySlots.assign((handles.size() + 63) / 64, 0);
+    markDirty(0, levels[0], levels[1]);
+}
+
+void TransformHierarchy::update() {
+    if (layoutDirty) {
+        layout();
+        layoutDirty = false;
+    }
+
+    for (size_t level = 0; level + 1 < levels.size(); ++level) {
+        if (dirty[level].empty()) continue;
+        const uint32_t count = takeDirtyRuns(level);
+
+        // the children of a run of parents are a run of the next level, possibly empty
+        if (level + 2 < levels.size()) {
+            for (const DirtyRange& run : runs) {
+                const uint32_t last = run.end - 1;
+                if (const uint32_t childrenEnd = firstChild[last] + childCount[last]; firstChild[run.begin] < childrenEnd) {
+                    markDirty(level + 1, firstChild[run.begin], childrenEnd);
+                }
+            }
+        }
+
+        if (count < PARALLEL_GRAIN) {
+            for (const DirtyRange& run : runs) compose(run.begin, run.end);
+        } else {
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, runs.size()), [&](const tbb::blocked_range<size_t>& r) {
+                for (size_t i = r.begin(); i < r.end(); ++i) compose(runs[i].begin, runs[i].end);
+            });
+        }
+    }
+}
+
+void TransformHierarchy::compose(const uint32_t begin, const uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i) {
+        const uint32_t parent = parents[i];
+        Transform world = parent == i ? locals[i] : worlds[parent] * locals[i];
+        world.translation += world.rotation * offsets[i];
+        worlds[i] = world;
+    }
+    transforms::composeMatrices(std::span(worlds).subspan(begin, end - begin), matrices.data() + begin);
+}
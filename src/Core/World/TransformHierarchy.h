@@ -0,0 +1,131 @@
+#pragma once
+
+#include <span>
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <glm/mat4x4.hpp>
+
+#include "Transform.h"
+
+enum class HierarchyNode : uint32_t {
+    INVALID = std::numeric_limits<uint32_t>::max()
+};
+
+/*
+ * Flattened transform hierarchy. Nodes are stored breadth first in parallel arrays, so every level is a
+ * contiguous range and the children of a contiguous range of parents are a contiguous range of the next level.
+ * An update walks the levels top down and composes only the dirty runs of each level: the nodes edited on it
+ * and the children of the runs composed above it, a level at a time in parallel when enough of it is dirty.
+ *
+ * Nodes are addressed by handles that stay valid across layout changes. Adding, removing and reparenting only
+ * relink the handles, the arrays are laid out again at the next update.
+ *
+ * A world transform is `parentWorld * local`, then moved by `offset` along its own rotated axes.
+ */
+class TransformHierarchy {
+public:
+    /* levels narrower than this are composed on the calling thread */
+    static constexpr uint32_t PARALLEL_GRAIN = 1024;
+
+    HierarchyNode add(HierarchyNode parent, const Transform& local, const glm::vec3& offset = glm::vec3(0));
+
+    /* removes the node and its subtree */
+    void remove(HierarchyNode node);
+
+    /* `parent` may be INVALID to make the node a root, it may not be in the node's own subtree */
+    void reparent(HierarchyNode node, HierarchyNode parent);
+
+    void setLocal(HierarchyNode node, const Transform& local);
+    void setLocal(HierarchyNode node, const Transform& local, const glm::vec3& offset);
+
+    /* lays out the nodes again if the structure changed, then composes the dirty runs */
+    void update();
+
+    bool contains(HierarchyNode node) const {
+        const auto handle = static_cast<uint32_t>(node);
+        return handle < slotOf.size() && slotOf[handle] != NO_SLOT;
+    }
+
+    HierarchyNode getParent(const HierarchyNode node) const {
+        return parentOf[static_cast<uint32_t>(node)];
+    }
+
+    const Transform& getLocal(const HierarchyNode node) const {
+        return locals[slotOf[static_cast<uint32_t>(node)]];
+    }
+
+    /* as of the last update */
+    const Transform& getWorldTransform(const HierarchyNode node) const {
+        return worlds[slotOf[static_cast<uint32_t>(node)]];
+    }
+
+    const glm::mat4& getWorld(const HierarchyNode node) const {
+        return matrices[slotOf[static_cast<uint32_t>(node)]];
+    }
+
+    /* the world matrices of the last update in breadth first order, `nodes()` holds the handle at each index */
+    std::span<const glm::mat4> getWorldMatrices() const {
+        return matrices;
+    }
+
+    std::span<const HierarchyNode> nodes() const {
+        return handles;
+    }
+
+    size_t size() const {
+        return handles.size();
+    }
+private:
+    static constexpr uint32_t NO_SLOT = std::numeric_limits<uint32_t>::max();
+
+    /* a run of consecutive slots, also the bounds of a level's dirty slots */
+    struct DirtyRange {
+        uint32_t begin = NO_SLOT;
+        uint32_t end = 0;
+
+        bool empty() const {
+            return begin >= end;
+        }
+
+        void grow(const uint32_t from, const uint32_t to) {
+            begin = std::min(begin, from);
+            end = std::max(end, to);
+        }
+    };
+
+    void link(HierarchyNode node, HierarchyNode parent);
+    void unlink(HierarchyNode node);
+    void markDirty(uint32_t slot);
+    void markDirty(size_t level, uint32_t begin, uint32_t end);
+    /* the runs of dirty slots within the level's bounds, cleared, split so none is wider than PARALLEL_GRAIN */
+    uint32_t takeDirtyRuns(size_t level);
+    void layout();
+    void compose(uint32_t begin, uint32_t end);
+
+    /* per handle, the structure the layout is built from */
+    std::vector<uint32_t> slotOf;
+    std::vector<HierarchyNode> parentOf;
+    std::vector<HierarchyNode> firstChildOf;
+    std::vector<HierarchyNode> nextSiblingOf;
+    std::vector<HierarchyNode> previousSiblingOf;
+    std::vector<HierarchyNode> freeHandles;
+    HierarchyNode firstRoot = HierarchyNode::INVALID;
+
+    /* per slot, breadth first once laid out, new nodes are appended until then */
+    std::vector<HierarchyNode> handles;
+    std::vector<uint32_t> parents;      /* a root is its own parent */
+    std::vector<uint32_t> firstChild;   /* where its children start in the next level, also for leaves */
+    std::vector<uint32_t> childCount;
+    std::vector<Transform> locals;
+    std::vector<glm::vec3> offsets;
+    std::vector<Transform> worlds;
+    std::vector<glm::mat4> matrices;
+
+    std::vector<uint32_t> levels;       /* first slot of every level, then the end */
+    std::vector<DirtyRange> dirty;      /* per level, bounds the level's bits in dirtySlots */
+    std::vector<uint64_t> dirtySlots;   /* a bit per slot */
+    std::vector<DirtyRange> runs;       /* the level being composed */
+    bool layoutDirty = false;
+};
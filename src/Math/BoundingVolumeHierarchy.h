@@ -3,11 +3,15 @@
 #include "Shapes/AABB.h"
 #include "Shapes/geom.h"
 #include <algorithm>
-#include <stack>
+#include <optional>
+#include <span>
 #include <memory/Span.h>
 #include "Shapes/Ray.h"
 #include <memory/vector.h>
-#include <memory/byte_arena.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_invoke.h>
+#include <tbb/parallel_reduce.h>
 
 template <typename Primitive>
 struct BVHRayResult : public RayResult {
@@ -33,366 +37,711 @@ template <typename Primitive> requires (!std::is_same_v<primitive_type_t<Primiti
 class BoundingVolumeHierarchy {
 public:
     using const_ref_primitive_type_t = const primitive_type_t<Primitive>&;
-    using primitive_arena = mem::byte_arena<mem::same_alloc_schema, alignof(Primitive)>;
-    using primitive_vector = mem::vector<Primitive, mem::byte_arena_adaptor<Primitive, primitive_arena>>;
+
+    static constexpr uint32_t NONE = ~0u;
+    static constexpr int MAX_DEPTH = 60;
+    static constexpr int STACK_SIZE = MAX_DEPTH + 4;
+    static constexpr int MAX_BINS = 64;
+    static constexpr uint32_t PARALLEL_GRAIN = 4096;
+
+    struct BuildOptions {
+        size_t maxLeafSize = 4;
+        int binCount = 12;
+        /* subtrees over at least this many primitives are built as separate tasks */
+        uint32_t taskThreshold = 4096;
+        /* nodes over at least this many primitives compute bounds and bins with a parallel reduction */
+        uint32_t parallelBinThreshold = 1 << 16;
+
+        BuildOptions() = default;
+        BuildOptions(const size_t maxLeafSize) : maxLeafSize(maxLeafSize) {}
+    };
 
     static const_ref_primitive_type_t primitive_cast(const Primitive& primitive) {
         return static_cast<const_ref_primitive_type_t>(primitive);
     }
 
+    /*
+     * Nodes are laid out depth-first: an interior node's first child is the next node and `offset` is the second.
+     * A leaf owns primitives [offset, offset + count), primitives are stored contiguously in leaf order.
+     */
     struct BVHNode {
-        AABB bounds;
-        BVHNode* parent = nullptr;
-        BVHNode* left = nullptr;
-        BVHNode* right = nullptr;
-        primitive_vector primitives;
-
-        BVHNode() = default;
-        BVHNode(auto& arena) : primitives(&arena) {}
+        glm::vec3 min = glm::vec3(0);
+        uint32_t offset = 0;
+        glm::vec3 max = glm::vec3(0);
+        uint32_t count = 0;
 
         bool isLeaf() const {
-            return !left;
+            return count != 0;
         }
+
+        AABB bounds() const {
+            return AABB::fromTo(min, max);
+        }
+    };
+    static_assert(sizeof(BVHNode) == 32);
+private:
+    struct RayTraversal {
+        glm::vec3 origin;
+        glm::vec3 invDirection;
     };
-    template <typename CB>
-    void forEachIntersects(const AABB& aabb, CB&& cb, const BVHNode* node) const {
-        if (!geom::intersects(aabb, node->bounds)) return;
-
-        if (node->isLeaf()) {
-            for (const auto& primitive : node->primitives) {
-                if (geom::intersects(aabb, primitive)) {
-                    if (cb(primitive)) return;
+
+    static float entryDistance(const RayTraversal& ray, const BVHNode& node, const float maxDistance) {
+        const glm::vec3 t0 = (node.min - ray.origin) * ray.invDirection;
+        const glm::vec3 t1 = (node.max - ray.origin) * ray.invDirection;
+        const glm::vec3 tMin = glm::min(t0, t1);
+        const glm::vec3 tMax = glm::max(t0, t1);
+
+        const float tNear = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.f));
+        const float tFar = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+        return tNear <= tFar ? tNear : std::numeric_limits<float>::infinity();
+    }
+
+    static bool overlaps(const BVHNode& node, const glm::vec3& min, const glm::vec3& max) {
+        return !(min.x > node.max.x || max.x < node.min.x ||
+                 min.y > node.max.y || max.y < node.min.y ||
+                 min.z > node.max.z || max.z < node.min.z);
+    }
+
+    /*
+     * Iterative front-to-back traversal, the nearer child is descended first and the other pushed.
+     * OnLeaf: float(const BVHNode& leaf, float cutoff) -> new cutoff, negative to stop.
+     * Subtrees entered beyond the cutoff are skipped.
+     */
+    template <typename OnLeaf>
+    void traverseRay(const Ray& ray, OnLeaf&& onLeaf) const {
+        if (nodes.size() == 0) return;
+
+        const RayTraversal traversal{ ray.origin, 1.0f / ray.direction };
+        float cutoff = ray.length;
+
+        struct Entry {
+            uint32_t node;
+            float distance;
+        };
+        Entry stack[STACK_SIZE];
+        int top = 0;
+
+        const float rootDistance = entryDistance(traversal, nodes[0], cutoff);
+        if (rootDistance == std::numeric_limits<float>::infinity()) return;
+        stack[top++] = { 0, rootDistance };
+
+        while (top) {
+            const Entry entry = stack[--top];
+            if (entry.distance > cutoff) continue;
+
+            uint32_t index = entry.node;
+            while (true) {
+                const BVHNode& node = nodes[index];
+                if (node.isLeaf()) {
+                    cutoff = onLeaf(node, cutoff);
+                    if (cutoff < 0) return;
+                    break;
+                }
+                uint32_t closer = index + 1;
+                uint32_t further = node.offset;
+                float tCloser = entryDistance(traversal, nodes[closer], cutoff);
+                float tFurther = entryDistance(traversal, nodes[further], cutoff);
+
+                if (tFurther < tCloser) {
+                    std::swap(closer, further);
+                    std::swap(tCloser, tFurther);
                 }
+                if (tCloser == std::numeric_limits<float>::infinity()) break;
+                if (tFurther != std::numeric_limits<float>::infinity()) {
+                    stack[top++] = { further, tFurther };
+                }
+                index = closer;
             }
+        }
+    }
+
+    template <bool Transform>
+    static BVHRayResult<Primitive> makeRayResult(const RayResult& result, const Primitive& primitive,
+        const glm::mat4& bvhWorldTransform, const glm::mat3& normalMatrix)
+    {
+        BVHRayResult<Primitive> bvhResult;
+        bvhResult.distance = result.distance;
+        if constexpr (Transform) {
+            bvhResult.hitPos = glm::vec3(bvhWorldTransform * glm::vec4(result.hitPos, 1.0f));
+            bvhResult.normal = glm::normalize(normalMatrix * result.normal);
         } else {
-            forEachIntersects(aabb, std::forward<CB>(cb), node->left);
-            forEachIntersects(aabb, std::forward<CB>(cb), node->right);
+            bvhResult.hitPos = result.hitPos;
+            bvhResult.normal = result.normal;
         }
+        bvhResult.primitive = &primitive;
+        return bvhResult;
     }
 
     template <bool Transform, typename Callable>
-    bool forEachRayIntersects(const Ray& ray, const glm::mat4& bvhWorldTransform,
-        const glm::mat3& normalMatrix, Callable&& callable, const BVHNode* node) const
+    void forEachRayIntersects(const Ray& ray, const glm::mat4& bvhWorldTransform,
+        const glm::mat3& normalMatrix, Callable&& callable) const
     {
-        if (RayResult hit = ray.intersects(node->bounds); !hit.hasHit()) return false;
-
-        if (node->isLeaf()) {
-            for (const auto& primitive : node->primitives) {
+        traverseRay(ray, [&](const BVHNode& leaf, const float cutoff) {
+            for (uint32_t i = leaf.offset; i < leaf.offset + leaf.count; ++i) {
+                const Primitive& primitive = primitives[i];
                 if (RayResult result = ray.intersects(primitive_cast(primitive)); result.hasHit()) {
-                    BVHRayResult<Primitive> bvhResult;
-                    if constexpr (Transform) {
-                        glm::vec3 worldHitPos = glm::vec3(bvhWorldTransform * glm::vec4(result.hitPos, 1.0f));
-                        glm::vec3 worldNormal = glm::normalize(normalMatrix * result.normal);
-
-                        bvhResult.distance = result.distance;
-                        bvhResult.hitPos = worldHitPos;
-                        bvhResult.normal = worldNormal;
-                        bvhResult.primitive = &primitive;
-                    } else {
-                        bvhResult.distance = result.distance;
-                        bvhResult.hitPos = result.hitPos;
-                        bvhResult.normal = result.normal;
-                        bvhResult.primitive = &primitive;
+                    if (callable(makeRayResult<Transform>(result, primitive, bvhWorldTransform, normalMatrix))) {
+                        return -1.0f;
                     }
-                    if (callable(bvhResult)) return true;
                 }
             }
-        } else {
-            if (forEachRayIntersects<Transform>(ray, bvhWorldTransform, normalMatrix, callable, node->left)) return true;
-            return forEachRayIntersects<Transform>(ray, bvhWorldTransform, normalMatrix, callable, node->right);
-        }
+            return cutoff;
+        });
+    }
+
+    template <bool Transform>
+    std::optional<BVHRayResult<Primitive>> closestRayIntersection(const Ray& ray, const glm::mat4& bvhWorldTransform,
+        const glm::mat3& normalMatrix) const
+    {
+        const Primitive* closest = nullptr;
+        RayResult closestResult;
+
+        traverseRay(ray, [&](const BVHNode& leaf, float cutoff) {
+            for (uint32_t i = leaf.offset; i < leaf.offset + leaf.count; ++i) {
+                if (RayResult result = ray.intersects(primitive_cast(primitives[i])); result.hasHit() && result.distance <= cutoff) {
+                    cutoff = result.distance;
+                    closestResult = result;
+                    closest = &primitives[i];
+                }
+            }
+            return cutoff;
+        });
+
+        if (!closest) return std::nullopt;
+        return makeRayResult<Transform>(closestResult, *closest, bvhWorldTransform, normalMatrix);
     }
 
-    AABB computeCentroidBounds(Primitive* primitives, const size_t start, const size_t end) {
-        glm::vec3 min = glm::vec3(FLT_MAX);
-        glm::vec3 max = glm::vec3(-FLT_MAX);
+    struct Bounds {
+        glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+        void grow(const glm::vec3& lo, const glm::vec3& hi) {
+            min = glm::min(min, lo);
+            max = glm::max(max, hi);
+        }
 
-        for (auto i = start; i < end; ++i) {
-            auto& primitive = primitives[i];
-            glm::vec3 centroid = geom::centroid(primitive_cast(primitive));
+        void grow(const glm::vec3& point) {
+            grow(point, point);
+        }
 
-            if (centroid.x < min.x) min.x = centroid.x;
-            if (centroid.y < min.y) min.y = centroid.y;
-            if (centroid.z < min.z) min.z = centroid.z;
+        void grow(const Bounds& other) {
+            grow(other.min, other.max);
+        }
 
-            if (centroid.x > max.x) max.x = centroid.x;
-            if (centroid.y > max.y) max.y = centroid.y;
-            if (centroid.z > max.z) max.z = centroid.z;
+        float area() const {
+            if (min.x > max.x) return 0.f;
+            const glm::vec3 e = max - min;
+            return 2.f * (e.x * e.y + e.y * e.z + e.z * e.x);
         }
-        return AABB::fromTo(min, max);
+    };
+
+    static Bounds primitiveBounds(const Primitive& primitive) {
+        const AABB& aabb = primitive;
+        return { aabb.min(), aabb.max() };
     }
-private:
-    static size_t nodesReserve(const size_t forNodes, const size_t maxLeafSize) {
-        return 3 * static_cast<size_t>(ceil(forNodes / maxLeafSize + 1)) + 1;
+
+    static glm::vec3 primitiveCentroid(const Primitive& primitive) {
+        return geom::centroid(primitive_cast(primitive));
     }
 
-    BVHNode* build(Primitive* primitives, const size_t start, const size_t end, const size_t maxLeafSize, BVHNode* parent = nullptr) {
-        BVHNode* node = &nodes.emplace_back();
-        node->bounds = primitives[start];
-        node->parent = parent;
+    struct BucketInfo {
+        uint32_t count = 0;
+        Bounds bounds;
+    };
+
+    struct Bins {
+        BucketInfo buckets[MAX_BINS];
 
-        for (auto i = start + 1; i < end; ++i) {
-            node->bounds = geom::merge(node->bounds, primitives[i]);
+        void join(const Bins& other) {
+            for (int i = 0; i < MAX_BINS; ++i) {
+                buckets[i].count += other.buckets[i].count;
+                buckets[i].bounds.grow(other.buckets[i].bounds);
+            }
         }
+    };
 
-        size_t count = end - start;
-        if (count <= maxLeafSize) {
-            node->primitives = mem::make_vector_like<primitive_vector>(
-                primitives + start, count, count,
-                mem::make_byte_arena_adaptor<Primitive>(primitivesArena)
-            );
-            return node;
+    struct RangeBounds {
+        Bounds bounds;
+        Bounds centroids;
+
+        void grow(const Primitive& primitive) {
+            bounds.grow(primitiveBounds(primitive));
+            centroids.grow(primitiveCentroid(primitive));
+        }
+
+        void join(const RangeBounds& other) {
+            bounds.grow(other.bounds);
+            centroids.grow(other.centroids);
+        }
+    };
+
+    RangeBounds computeBounds(const uint32_t start, const uint32_t end, const bool parallel) const {
+        if (!parallel) {
+            RangeBounds result;
+            for (auto i = start; i < end; ++i) {
+                result.grow(primitives[i]);
+            }
+            return result;
+        }
+        return tbb::parallel_reduce(tbb::blocked_range<uint32_t>(start, end, PARALLEL_GRAIN), RangeBounds{},
+            [&](const tbb::blocked_range<uint32_t>& range, RangeBounds result) {
+                for (auto i = range.begin(); i != range.end(); ++i) {
+                    result.grow(primitives[i]);
+                }
+                return result;
+            },
+            [](RangeBounds a, const RangeBounds& b) {
+                a.join(b);
+                return a;
+            });
+    }
+
+    template <typename BinOf>
+    Bins computeBins(const uint32_t start, const uint32_t end, const bool parallel, BinOf&& binOf) const {
+        auto accumulate = [&](Bins& bins, const uint32_t from, const uint32_t to) {
+            for (auto i = from; i < to; ++i) {
+                BucketInfo& bucket = bins.buckets[binOf(primitives[i])];
+                ++bucket.count;
+                bucket.bounds.grow(primitiveBounds(primitives[i]));
+            }
+        };
+        if (!parallel) {
+            Bins bins;
+            accumulate(bins, start, end);
+            return bins;
+        }
+        return tbb::parallel_reduce(tbb::blocked_range<uint32_t>(start, end, PARALLEL_GRAIN), Bins{},
+            [&](const tbb::blocked_range<uint32_t>& range, Bins bins) {
+                accumulate(bins, range.begin(), range.end());
+                return bins;
+            },
+            [](Bins a, const Bins& b) {
+                a.join(b);
+                return a;
+            });
+    }
+
+    static void makeLeaf(BVHNode& node, const uint32_t start, const uint32_t count) {
+        node.offset = start;
+        node.count = count;
+    }
+
+    /*
+     * Builds the subtree over primitives [start, end) into sparse[index...]. A subtree over n primitives
+     * has at most 2n - 1 nodes, so the left child gets [index + 1, index + 2 * nLeft) and the right child
+     * starts after it; subtrees never share slots and can be built as independent tasks.
+     * Splits only depend on exact min/max/count reductions, so the tree is the same however it is scheduled.
+     */
+    void buildNode(BVHNode* sparse, const uint32_t index, const uint32_t start, const uint32_t end, const int depth, const BuildOptions& options) {
+        const uint32_t count = end - start;
+        BVHNode& node = sparse[index];
+
+        const RangeBounds rangeBounds = computeBounds(start, end, count >= options.parallelBinThreshold);
+        node.min = rangeBounds.bounds.min;
+        node.max = rangeBounds.bounds.max;
+
+        if (count <= options.maxLeafSize || depth >= MAX_DEPTH) {
+            return makeLeaf(node, start, count);
         }
 
-        AABB centroidBounds = computeCentroidBounds(primitives, start, end);
-        glm::vec3 extent = centroidBounds.max() - centroidBounds.min();
+        const Bounds& centroidBounds = rangeBounds.centroids;
+        const glm::vec3 extent = centroidBounds.max - centroidBounds.min;
 
         int axis = 0;
         if (extent.y > extent.x) axis = 1;
         if (extent.z > extent[axis]) axis = 2;
 
-        constexpr int bucketCount = 12;
+        if (extent[axis] <= 0.f) {
+            return makeLeaf(node, start, count);
+        }
+
+        const int binCount = std::clamp(options.binCount, 2, MAX_BINS);
+        const float axisMin = centroidBounds.min[axis];
+        const float scale = binCount / extent[axis];
 
-        struct BucketInfo {
-            int count = 0;
-            AABB bounds;
+        auto binOf = [&](const Primitive& p) {
+            const int b = static_cast<int>((primitiveCentroid(p)[axis] - axisMin) * scale);
+            return std::min(b, binCount - 1);
         };
-        BucketInfo buckets[bucketCount];
 
-        for (size_t i = start; i < end; ++i) {
-            float centroidAxis = geom::centroid(primitives[i])[axis];
-            int b = static_cast<int>(bucketCount * (centroidAxis - centroidBounds.min()[axis]) / (extent[axis] + 1e-5f));
-            if (b == bucketCount) b = bucketCount - 1;
-            ++buckets[b].count;
-            buckets[b].bounds = geom::merge(buckets[b].bounds, primitives[i]);
+        const Bins bins = computeBins(start, end, count >= options.parallelBinThreshold, binOf);
+        const BucketInfo* buckets = bins.buckets;
+
+        float rightArea[MAX_BINS];
+        uint32_t rightCount[MAX_BINS];
+        {
+            Bounds b;
+            uint32_t c = 0;
+            for (int i = binCount - 1; i > 0; --i) {
+                b.grow(buckets[i].bounds);
+                c += buckets[i].count;
+                rightArea[i] = b.area();
+                rightCount[i] = c;
+            }
         }
+
         float minCost = std::numeric_limits<float>::max();
         int minCostSplit = -1;
+        {
+            Bounds b;
+            uint32_t c = 0;
+            const float invArea = 1.f / std::max(rangeBounds.bounds.area(), 1e-12f);
+            for (int i = 1; i < binCount; ++i) {
+                b.grow(buckets[i - 1].bounds);
+                c += buckets[i - 1].count;
+                if (c == 0 || rightCount[i] == 0) continue;
+
+                const float cost = 1 + (c * b.area() + rightCount[i] * rightArea[i]) * invArea;
+                if (cost < minCost) {
+                    minCost = cost;
+                    minCostSplit = i;
+                }
+            }
+        }
+        if (minCostSplit < 0 || minCost >= count) {
+            return makeLeaf(node, start, count);
+        }
 
-        for (int i = 1; i < bucketCount; ++i) {
-            AABB b0, b1;
-            int count0 = 0, count1 = 0;
+        const auto first = primitives.data();
+        const auto mid = static_cast<uint32_t>(std::partition(first + start, first + end, [&](const Primitive& p) {
+            return binOf(p) < minCostSplit;
+        }) - first);
 
-            for (int j = 0; j < i; ++j) {
-                b0 = geom::merge(b0, buckets[j].bounds);
-                count0 += buckets[j].count;
-            }
-            for (int j = i; j < bucketCount; ++j) {
-                b1 = geom::merge(b1, buckets[j].bounds);
-                count1 += buckets[j].count;
+        const uint32_t left = index + 1;
+        const uint32_t right = index + 2 * (mid - start);
+
+        node.offset = right;
+        node.count = 0;
+
+        if (count >= options.taskThreshold) {
+            tbb::parallel_invoke(
+                [&] { buildNode(sparse, left, start, mid, depth + 1, options); },
+                [&] { buildNode(sparse, right, mid, end, depth + 1, options); }
+            );
+        } else {
+            buildNode(sparse, left, start, mid, depth + 1, options);
+            buildNode(sparse, right, mid, end, depth + 1, options);
+        }
+    }
+
+    /* removes the unused slots of the reserved layout while keeping it depth-first, and fills in parents */
+    void compactNodes(const mem::vector<BVHNode>& sparse) {
+        nodes.clear();
+        parents.clear();
+
+        struct Pending {
+            uint32_t node;
+            uint32_t parent;
+            bool isSecondChild;
+        };
+        Pending stack[STACK_SIZE];
+        int top = 0;
+        stack[top++] = { 0, NONE, false };
+
+        while (top) {
+            const Pending pending = stack[--top];
+            const auto index = static_cast<uint32_t>(nodes.size());
+            if (pending.isSecondChild) {
+                nodes[pending.parent].offset = index;
             }
 
-            float cost = 1 + (count0 * geom::surface_area(b0) + count1 * geom::surface_area(b1)) / geom::surface_area(node->bounds);
-            if (cost < minCost) {
-                minCost = cost;
-                minCostSplit = i;
+            const BVHNode& node = sparse[pending.node];
+            nodes.emplace_back(node);
+            parents.emplace_back(pending.parent);
+
+            if (node.isLeaf()) {
+                std::fill_n(primitiveLeaves.data() + node.offset, node.count, index);
+            } else {
+                stack[top++] = { node.offset, index, true };
+                stack[top++] = { pending.node + 1, index, false };
             }
         }
-        if (minCost >= count) {
-            node->primitives = mem::make_vector_like<primitive_vector>(
-                primitives + start, count, count, /* this was the end-start */
-                mem::make_byte_arena_adaptor<Primitive>(primitivesArena)
-            );
-            return node;
+    }
+
+    void buildNodes(const BuildOptions& options) {
+        nodes.clear();
+        parents.clear();
+        if (primitives.size() == 0) {
+            rootBounds = AABB{};
+            return;
         }
+        const size_t maxNodes = 2 * primitives.size() - 1;
 
-        auto midIter = std::partition(primitives + start, primitives + end,
-            [&](const Primitive& p) {
-                const float centroidAxis = geom::centroid(primitive_cast(p))[axis];
-                int b = static_cast<int>(bucketCount * (centroidAxis - centroidBounds.min()[axis]) / (extent[axis] + 1e-5f));
-                if (b == bucketCount) b = bucketCount - 1;
-                return b < minCostSplit;
-            });
+        mem::vector<BVHNode> sparse;
+        sparse.assign(maxNodes, BVHNode{});
+        buildNode(sparse.data(), 0, 0, static_cast<uint32_t>(primitives.size()), 0, options);
 
-        size_t mid = midIter - primitives;
+        nodes.reserve(maxNodes);
+        parents.reserve(maxNodes);
+        primitiveLeaves.assign(primitives.size(), NONE);
+        compactNodes(sparse);
+        rootBounds = nodes[0].bounds();
+
+        costSum = 0.f;
+        for (const auto& node : nodes) {
+            costSum += nodeArea(node) * costWeight(node);
+        }
+        refitMarks.assign(nodes.size(), 0);
+    }
 
-        node->left = build(primitives, start, mid, maxLeafSize, node);
-        node->right = build(primitives, mid, end, maxLeafSize, node);
-        return node;
+    static float nodeArea(const BVHNode& node) {
+        return Bounds{ node.min, node.max }.area();
     }
 
-    static void replaceChild(BVHNode* parent, BVHNode* oldChild, BVHNode* newChild) {
-        if (parent->left == oldChild) {
-            parent->left = newChild;
-        } else if (parent->right == oldChild) {
-            parent->right = newChild;
-        }
-        newChild->parent = parent;
-        parent->bounds = geom::merge(parent->left->bounds, parent->right->bounds);
+    static float costWeight(const BVHNode& node) {
+        return node.isLeaf() ? static_cast<float>(node.count) : 1.f;
     }
 
-    BVHNode* findBestSibling(const AABB& newBounds, BVHNode* current) {
-        BVHNode* best = nullptr;
-        float bestCost = std::numeric_limits<float>::infinity();
+    /* returns whether the bounds changed, keeping the SAH sum current */
+    bool setBounds(BVHNode& node, const glm::vec3& min, const glm::vec3& max) {
+        if (node.min == min && node.max == max) return false;
 
-        std::stack<BVHNode*> stack;
-        stack.push(current);
+        const float before = nodeArea(node);
+        node.min = min;
+        node.max = max;
+        costSum += (nodeArea(node) - before) * costWeight(node);
+        return true;
+    }
 
-        while (!stack.empty()) {
-            BVHNode* node = stack.top();
-            stack.pop();
-            AABB combined = geom::merge(node->bounds, newBounds);
-            float cost = geom::surface_area(combined);
+    bool refitInterior(const uint32_t index) {
+        BVHNode& node = nodes[index];
+        const BVHNode& left = nodes[index + 1];
+        const BVHNode& right = nodes[node.offset];
+        return setBounds(node, glm::min(left.min, right.min), glm::max(left.max, right.max));
+    }
 
-            if (node->isLeaf()) {
-                if (cost < bestCost) {
-                    best = node;
-                    bestCost = cost;
-                }
-            } else {
-                stack.push(node->left);
-                stack.push(node->right);
-            }
+    /* SAH growth of a node taking `bounds`, the smaller node wins ties so nested boxes go to the tighter subtree */
+    static std::pair<float, float> insertionCost(const BVHNode& node, const Bounds& bounds) {
+        Bounds grown{ node.min, node.max };
+        const float area = grown.area();
+        grown.grow(bounds);
+        return { grown.area() - area, area };
+    }
+
+    uint32_t chooseLeaf(const Bounds& bounds) const {
+        uint32_t index = 0;
+        while (!nodes[index].isLeaf()) {
+            const uint32_t left = index + 1;
+            const uint32_t right = nodes[index].offset;
+            index = insertionCost(nodes[left], bounds) <= insertionCost(nodes[right], bounds) ? left : right;
+        }
+        return index;
+    }
+
+    template <typename Range>
+    void appendPrimitives(Range&& range) {
+        for (const Primitive& primitive : range) {
+            primitives.emplace_back(primitive);
         }
-        return best;
     }
 
     mem::vector<BVHNode> nodes;
-    primitive_arena primitivesArena;
-    BVHNode* _root = nullptr;
+    mem::vector<uint32_t> parents;
+    mem::vector<Primitive> primitives;
+    mem::vector<uint32_t> primitiveLeaves;
+    mem::vector<uint8_t> refitMarks;
+    std::vector<uint32_t> refitQueue;
+    AABB rootBounds;
+    float costSum = 0.f;
 public:
     BoundingVolumeHierarchy() = default;
 
     template <typename Range>
-    BoundingVolumeHierarchy(Range&& range, const size_t maxLeafSize) {
-        build(range, maxLeafSize);
+    BoundingVolumeHierarchy(Range&& range, const BuildOptions& options) {
+        build(range, options);
     }
 
-    BoundingVolumeHierarchy(mem::range<Primitive> primitives, const size_t maxLeafSize) {
-        build(primitives, maxLeafSize);
+    BoundingVolumeHierarchy(mem::range<Primitive> primitives, const BuildOptions& options) {
+        build(primitives, options);
     }
 
     template <typename Range>
-    void build(Range&& primitives, const size_t maxLeafSize) {
-        if (_root) {
-            clear();
-        }
-        if (!primitivesArena.has_for(mem::type_info_of<Primitive>, primitives.size())) {
-            primitivesArena.initialize(mem::type_info_of<Primitive>, primitives.size());
-        }
-
-        nodes = nodesReserve(primitives.size(), maxLeafSize);
-
-        auto ptr = primitivesArena.allocate<Primitive>(primitives.size());
+    void build(Range&& range, const BuildOptions& options) {
+        primitives.clear();
+        primitives.reserve(range.size());
+        appendPrimitives(range);
+        buildNodes(options);
+    }
 
-        if constexpr (std::is_trivially_copyable_v<Primitive>) {
-            memcpy(ptr, primitives.data(), sizeof(Primitive) * primitives.size());
-        } else {
-            static_assert(false, "Not supported yet or never");
-        }
-        _root = build(ptr, 0, primitives.size(), maxLeafSize);
+    /* rebuilds over the current primitives, permuting them in place */
+    void rebuild(const BuildOptions& options) {
+        buildNodes(options);
     }
 
-    BoundingVolumeHierarchy rebuild(const size_t maxLeafSize) {
-        const size_t size = primitivesArena.bytes_used() / sizeof(Primitive);
-        BoundingVolumeHierarchy bvh;
+    template <typename Range>
+    void rebuildWith(Range&& added, const BuildOptions& options) {
+        primitives.reserve(primitives.size() + added.size());
+        appendPrimitives(added);
+        buildNodes(options);
+    }
 
-        bvh.primitivesArena.initialize(mem::type_info_of<Primitive>, size);
-        bvh.nodes.reserve(nodesReserve(size, maxLeafSize));
-        auto ptr = bvh.primitivesArena.allocate_or_fail<Primitive>(size);
+    /*
+     * Adds primitives without restructuring: each goes to the leaf whose bounds grow least, leaves are allowed to
+     * outgrow maxLeafSize and the touched leaves are refit. Moves the primitive array once, O(n + k log n) for k
+     * primitives, and invalidates primitive indices. The tree degrades as leaves grow, which sahCost() reflects,
+     * so callers rebuild once it has grown too far.
+     */
+    template <typename Range>
+    void insert(Range&& added) {
+        if (added.size() == 0) return;
+        if (nodes.size() == 0) {
+            build(added, BuildOptions{});
+            return;
+        }
 
-        cexpr::require(ptr);
+        struct Pending {
+            uint32_t leaf;
+            const Primitive* primitive;
+        };
+        std::vector<Pending> pending;
+        pending.reserve(added.size());
+        for (const Primitive& primitive : added) {
+            pending.push_back({ chooseLeaf(primitiveBounds(primitive)), &primitive });
+        }
+        // leaves are in primitive order by node index, so sorted pending entries merge in a single pass
+        std::ranges::stable_sort(pending, {}, &Pending::leaf);
+
+        mem::vector<Primitive> merged;
+        merged.reserve(primitives.size() + pending.size());
+        std::vector<uint32_t> touched;
+        auto next = pending.begin();
+        for (uint32_t n = 0; n < nodes.size(); ++n) {
+            BVHNode& node = nodes[n];
+            if (!node.isLeaf()) continue;
+
+            const auto start = static_cast<uint32_t>(merged.size());
+            for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+                merged.emplace_back(primitives[i]);
+            }
+            const uint32_t before = node.count;
+            for (; next != pending.end() && next->leaf == n; ++next) {
+                merged.emplace_back(*next->primitive);
+            }
+            node.offset = start;
+            node.count = static_cast<uint32_t>(merged.size()) - start;
+            if (node.count != before) {
+                costSum += nodeArea(node) * static_cast<float>(node.count - before);
+                touched.push_back(n);
+            }
+        }
+        primitives = std::move(merged);
 
-        if constexpr (std::is_trivially_copyable_v<Primitive>) {
-            bvh.primitivesArena.copy_all_memory_to(ptr, mem::type_info_of<Primitive>);
-        } else {
-            static_assert(false, "Not supported yet or never");
+        primitiveLeaves.resize(primitives.size());
+        for (uint32_t n = 0; n < nodes.size(); ++n) {
+            const BVHNode& node = nodes[n];
+            if (node.isLeaf()) {
+                std::fill_n(primitiveLeaves.data() + node.offset, node.count, n);
+            }
         }
-        bvh.build(ptr, 0, size, maxLeafSize);
-        return std::move(bvh);
+        refit(touched);
     }
 
-    BoundingVolumeHierarchy rebuildWith(mem::range<Primitive> primitives, const size_t maxLeafSize) {
-        const size_t size = primitives.size() + primitivesArena.bytes_used() / sizeof(Primitive);
-
-        BoundingVolumeHierarchy bvh;
-        bvh.primitivesArena.initialize(mem::type_info_of<Primitive>, size);
-        auto ptr = bvh.primitivesArena.allocate_or_fail<Primitive>(size);
+    void insert(const Primitive& primitive) {
+        insert(std::span(&primitive, 1));
+    }
 
-        cexpr::require(ptr);
+    /* SAH cost relative to the root's area, interior nodes cost 1 and leaves 1 per primitive. Kept current by refits */
+    float sahCost() const {
+        if (nodes.size() == 0) return 0.f;
+        return costSum / std::max(nodeArea(nodes[0]), 1e-12f);
+    }
 
-        if constexpr (std::is_trivially_copyable_v<Primitive>) {
-            void* remaining = bvh.primitivesArena.copy_all_memory_to(ptr, mem::type_info_of<Primitive>);
-            mem::copy(mem::type_info_of<Primitive>, remaining, primitives.data(), primitives.size());
-        } else {
-            static_assert(false, "Not supported yet or never");
+    void refitUpwards(uint32_t node) {
+        while (node != NONE) {
+            if (!nodes[node].isLeaf()) {
+                refitInterior(node);
+            }
+            node = parents[node];
         }
-        bvh.build(ptr, 0, size, maxLeafSize);
-        return std::move(bvh);
+        rootBounds = nodes[0].bounds();
     }
 
-    void insert(const Primitive& primitive) {
-        insert(_root, primitive, primitive);
+    bool updateBounds(const uint32_t node) {
+        BVHNode& leaf = nodes[node];
+        Bounds bounds;
+        for (uint32_t i = leaf.offset; i < leaf.offset + leaf.count; ++i) {
+            bounds.grow(primitiveBounds(primitives[i]));
+        }
+        return setBounds(leaf, bounds.min, bounds.max);
     }
 
-    void insert(BVHNode*& root, const AABB& newBounds, const Primitive& payload) {
-        BVHNode* leaf = &nodes.emplace_back(primitivesArena);
-        leaf->bounds = newBounds;
-
-        leaf->primitives.emplace_back(payload);
+    /*
+     * Refits the given leaves after their primitives changed, then each affected ancestor once.
+     * Parents always precede their children, so popping the highest index first is bottom-up;
+     * a node whose bounds did not change stops propagating.
+     */
+    void refit(const std::span<const uint32_t> leaves) {
+        if (nodes.size() == 0) return;
+
+        refitQueue.clear();
+        auto enqueueParent = [&](const uint32_t node) {
+            const uint32_t parent = parents[node];
+            if (parent == NONE || refitMarks[parent]) return;
+            refitMarks[parent] = 1;
+            refitQueue.push_back(parent);
+            std::push_heap(refitQueue.begin(), refitQueue.end());
+        };
 
-        if (!root) {
-            root = leaf;
-            return;
+        for (const uint32_t leaf : leaves) {
+            if (updateBounds(leaf)) {
+                enqueueParent(leaf);
+            }
+        }
+        while (!refitQueue.empty()) {
+            std::pop_heap(refitQueue.begin(), refitQueue.end());
+            const uint32_t node = refitQueue.back();
+            refitQueue.pop_back();
+            refitMarks[node] = 0;
+
+            if (refitInterior(node)) {
+                enqueueParent(node);
+            }
         }
+        rootBounds = nodes[0].bounds();
+    }
 
-        BVHNode* sibling = findBestSibling(newBounds, root);
-        BVHNode* newParent = &nodes.emplace_back(primitivesArena);
-        newParent->bounds = geom::merge(sibling->bounds, newBounds);
-  
-        newParent->left = sibling;
-        newParent->right = leaf;
-              
-        BVHNode* oldParent = sibling->parent;
+    uint32_t leafOf(const uint32_t primitive) const {
+        return primitiveLeaves[primitive];
+    }
 
-        if (oldParent) {
-            replaceChild(oldParent, sibling, newParent);
-            newParent->parent = oldParent;
-        } else {
-            root = newParent;
-            newParent->parent = nullptr;
-        }
-        sibling->parent = newParent;
-        leaf->parent = newParent;
-        refitUpwards(newParent);
+    Primitive& primitive(const uint32_t index) {
+        return primitives[index];
     }
 
-    void refitUpwards(BVHNode* node) {
-        while (node) {
-            if (!node->isLeaf()) {
-                node->bounds = geom::merge(node->left->bounds, node->right->bounds);
-            }
-            node = node->parent;
-        }
+    const Primitive& primitive(const uint32_t index) const {
+        return primitives[index];
     }
 
-    void updateBounds(BVHNode* node) {
-        AABB newBounds{};
-        for (const auto& prim : node->primitives) {
-            newBounds = geom::merge(newBounds, prim);
+    /* void(uint32_t index, const Primitive&), indices are stable until the next (re)build */
+    template <typename Callable>
+    void forEachPrimitive(Callable&& callable) const {
+        for (uint32_t i = 0; i < primitives.size(); ++i) {
+            callable(i, primitives[i]);
         }
-        node->bounds = newBounds;
     }
 
     struct FindResult {
-        BVHNode* node = nullptr;
+        uint32_t node = NONE;
         Primitive* primitive = nullptr;
 
         FindResult() = default;
-        FindResult(BVHNode* node, Primitive* primitive) : node(node), primitive(primitive) {}
+        FindResult(const uint32_t node, Primitive* primitive) : node(node), primitive(primitive) {}
 
         operator bool() const {
-            return node;
+            return primitive;
         }
     };
 
     template <typename T>
     FindResult find(const T& item) {
-        for (auto& node : nodes) {
-            for (auto& prim : node.primitives) {
-                if (prim == item) {
-                    return FindResult(&node, &prim);
-                }                
+        for (uint32_t n = 0; n < nodes.size(); ++n) {
+            const BVHNode& node = nodes[n];
+            if (!node.isLeaf()) continue;
+
+            for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+                if (primitives[i] == item) {
+                    return FindResult(n, &primitives[i]);
+                }
             }
         }
         return {};
@@ -402,26 +751,48 @@ public:
     /* bool(const Primitive&) -> return true to early exit */
     requires std::is_invocable_r_v<bool, Callable, const Primitive&>
     void forEachIntersects(const AABB& aabb, Callable&& callable) const {
-        if (!_root) return;
-        forEachIntersects(aabb, std::forward<Callable>(callable), _root);
+        if (nodes.size() == 0) return;
+
+        const glm::vec3 min = aabb.min();
+        const glm::vec3 max = aabb.max();
+
+        uint32_t stack[STACK_SIZE];
+        int top = 0;
+        stack[top++] = 0;
+
+        while (top) {
+            const uint32_t index = stack[--top];
+            const BVHNode& node = nodes[index];
+            if (!overlaps(node, min, max)) continue;
+
+            if (node.isLeaf()) {
+                for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+                    if (geom::intersects(aabb, primitives[i])) {
+                        if (callable(primitives[i])) return;
+                    }
+                }
+            } else {
+                stack[top++] = node.offset;
+                stack[top++] = index + 1;
+            }
+        }
     }
 
     template <typename Callable>
-    /* bool(const Primitive&) -> return true to early exit*/
+    /* bool(const Primitive&) -> return true to early exit, hits are reported roughly front to back */
     void forEachRayIntersects(const Ray& ray, const glm::mat4& bvhWorldTransform, Callable&& callable) const {
-        if (!_root) return;
+        if (nodes.size() == 0) return;
         glm::mat4 bvhLocalTransform = glm::inverse(bvhWorldTransform);
         glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(bvhWorldTransform)));
         Ray localRay = geom::transform(ray, bvhLocalTransform);
 
-        forEachRayIntersects<true>(localRay, bvhWorldTransform, normalMatrix, std::forward<Callable>(callable), _root);
+        forEachRayIntersects<true>(localRay, bvhWorldTransform, normalMatrix, std::forward<Callable>(callable));
     }
 
     template <typename Callable>
     void forEachRayIntersects(const Ray& ray, Callable&& callable) const {
-        if (!_root) return;
         static glm::mat4 identity{};
-        forEachRayIntersects<false>(ray, identity, identity, std::forward<Callable>(callable), _root);
+        forEachRayIntersects<false>(ray, identity, identity, std::forward<Callable>(callable));
     }
 
     template <typename Callable>
@@ -430,8 +801,20 @@ public:
      * @param callable bool(const Primitive&) -> return true to early exit
      */
     void forEachRayIntersects(const Ray& localRay, const glm::mat4& bvhWorldTransform, const glm::mat3& normalMatrix, Callable&& callable) const {
-        if (!_root) return;
-        forEachRayIntersects<true>(localRay, bvhWorldTransform, normalMatrix, std::forward<Callable>(callable), _root);
+        forEachRayIntersects<true>(localRay, bvhWorldTransform, normalMatrix, std::forward<Callable>(callable));
+    }
+
+    std::optional<BVHRayResult<Primitive>> raycast(const Ray& ray) const {
+        static glm::mat4 identity{};
+        return closestRayIntersection<false>(ray, identity, identity);
+    }
+
+    std::optional<BVHRayResult<Primitive>> raycast(const Ray& ray, const glm::mat4& bvhWorldTransform) const {
+        if (nodes.size() == 0) return std::nullopt;
+        glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(bvhWorldTransform)));
+        Ray localRay = geom::transform(ray, glm::inverse(bvhWorldTransform));
+
+        return closestRayIntersection<true>(localRay, bvhWorldTransform, normalMatrix);
     }
 
     template <typename Callable>
@@ -443,24 +826,20 @@ public:
         }
     }
 
-    BVHNode* root() {
-        return _root;
-    }
-
     const BVHNode* root() const {
-        return _root;
+        return nodes.size() == 0 ? nullptr : &nodes[0];
     }
 
     const AABB& bounds() const {
-        return root()->bounds;
+        return rootBounds;
     }
 
     size_t nodeCount() const {
-        return nodes.count();
+        return nodes.size();
     }
 
     size_t size() const {
-        return primitivesArena.bytes_used() / sizeof(Primitive);
+        return primitives.size();
     }
 
     bool empty() const {
@@ -469,10 +848,14 @@ public:
 
     void clear() {
         nodes.clear();
-        primitivesArena.reset_shrink();
-        _root = nullptr;
+        parents.clear();
+        primitives.clear();
+        primitiveLeaves.clear();
+        refitMarks.clear();
+        costSum = 0.f;
+        rootBounds = AABB{};
     }
 };
 
 template <typename P>
-using BVH = BoundingVolumeHierarchy<P>;
\ No newline at end of file
+using BVH = BoundingVolumeHierarchy<P>;
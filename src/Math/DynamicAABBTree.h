@@ -1,87 +1,441 @@
 #pragma once
 
+#include <vector>
+#include <algorithm>
+
+#include "Shapes/AABB.h"
+#include "Shapes/geom.h"
+
+/*
+ * Incrementally updated AABB tree for moving objects.
+ *
+ * Leaves store a fattened box: the object's box grown by a margin and stretched along its last displacement,
+ * so small moves don't touch the tree at all. Nodes live in a pool with an intrusive free list, proxy ids are
+ * node indices and stay valid until removed. Insertion picks the sibling with a branch and bound search over
+ * the SAH cost, and every ancestor touched by an insert or remove is AVL-balanced with single rotations.
+ */
 template <typename T>
 class DynamicAABBTree {
+public:
+    using ProxyID = int;
+
+    constexpr static ProxyID NONE = -1;
+    constexpr static float DEFAULT_MARGIN = 0.1f;
+    /* how far ahead of its displacement a moved proxy is fattened */
+    constexpr static float DISPLACEMENT_MULTIPLIER = 4.0f;
+    /* traversal stack entries kept on the call stack, a taller tree spills the rest to the heap */
+    constexpr static int STACK_SIZE = 256;
+
+private:
+    template <typename> friend class DynamicAABBTree;
+
     struct Node {
         AABB box;
-        int parent = -1;
-        int left = -1;
-        int right = -1;
+        int parent = NONE; // next free node while on the free list
+        int left = NONE;
+        int right = NONE;
+        int height = 0; // -1 while on the free list
 
         T data{};
 
         bool isLeaf() const {
-            return left == -1;
+            return left == NONE;
+        }
+    };
+
+    template <typename E>
+    class Stack {
+        E local[STACK_SIZE];
+        std::vector<E> spilled;
+        E* entries = local;
+        int capacity = STACK_SIZE;
+        int top = 0;
+
+    public:
+        Stack() = default;
+        Stack(const Stack&) = delete;
+        Stack& operator = (const Stack&) = delete;
+
+        void push(const E& entry) {
+            if (top == capacity) {
+                if (entries == local) spilled.assign(local, local + top);
+                capacity *= 2;
+                spilled.resize(capacity);
+                entries = spilled.data();
+            }
+            entries[top++] = entry;
+        }
+
+        E pop() {
+            return entries[--top];
+        }
+
+        bool empty() const {
+            return top == 0;
         }
     };
+
+    struct Candidate {
+        int node;
+        float inheritedCost;
+
+        bool operator < (const Candidate& other) const {
+            return inheritedCost > other.inheritedCost;
+        }
+    };
+
     std::vector<Node> nodes;
-    int root = -1;
+    std::vector<Candidate> candidates;
+    int root = NONE;
+    int freeList = NONE;
+    size_t proxies = 0;
+    float margin = DEFAULT_MARGIN;
 
-public:
-    void build(const std::vector<AABB>& objectBoxes) {
-        nodes.clear();
-        root = -1;
+    static float area(const AABB& box) {
+        const glm::vec3 e = box.halfSize;
+        return 8.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+    }
+
+    AABB fatten(const AABB& box, const glm::vec3& displacement) const {
+        glm::vec3 min = box.min() - glm::vec3(margin);
+        glm::vec3 max = box.max() + glm::vec3(margin);
 
-        for (int i = 0; i < objectBoxes.size(); ++i) {
-            insert(i, objectBoxes[i]);
+        const glm::vec3 d = displacement * DISPLACEMENT_MULTIPLIER;
+        min += glm::min(d, glm::vec3(0.f));
+        max += glm::max(d, glm::vec3(0.f));
+        return AABB::fromTo(min, max);
+    }
+
+    int allocateNode() {
+        if (freeList == NONE) {
+            nodes.emplace_back();
+            return static_cast<int>(nodes.size()) - 1;
         }
+        const int index = freeList;
+        freeList = nodes[index].parent;
+        nodes[index] = Node{};
+        return index;
     }
 
-    void insert(T data, const AABB& box) {
-        Node leaf;
-        leaf.box = box;
-        leaf.objectID = data;
-        leaf.left = leaf.right = -1;
-        int leafIndex = nodes.size();
-        nodes.push_back(leaf);
+    void freeNode(const int index) {
+        nodes[index].parent = freeList;
+        nodes[index].height = -1;
+        nodes[index].data = T{};
+        freeList = index;
+    }
 
-        if (root == -1) {
-            root = leafIndex;
+    void replaceChild(const int parent, const int oldChild, const int newChild) {
+        if (parent == NONE) {
+            root = newChild;
+        } else if (nodes[parent].left == oldChild) {
+            nodes[parent].left = newChild;
+        } else {
+            nodes[parent].right = newChild;
+        }
+    }
+
+    /*
+     * Branch and bound over the cost of making each node the new leaf's sibling: the merged box's area plus
+     * the growth inherited by every ancestor. A subtree is skipped once even a zero-area merge below it could
+     * not beat the best found so far.
+     */
+    int findBestSibling(const AABB& box) {
+        const float boxArea = area(box);
+
+        int best = root;
+        float bestCost = area(geom::merge(nodes[root].box, box));
+
+        candidates.clear();
+        candidates.push_back({ root, 0.f });
+
+        while (!candidates.empty()) {
+            std::pop_heap(candidates.begin(), candidates.end());
+            const auto [index, inheritedCost] = candidates.back();
+            candidates.pop_back();
+
+            if (inheritedCost + boxArea >= bestCost) break;
+
+            const Node& node = nodes[index];
+            const float directCost = area(geom::merge(node.box, box));
+            const float cost = directCost + inheritedCost;
+            if (cost < bestCost) {
+                best = index;
+                bestCost = cost;
+            }
+
+            if (node.isLeaf()) continue;
+
+            const float childInherited = inheritedCost + directCost - area(node.box);
+            if (childInherited + boxArea < bestCost) {
+                candidates.push_back({ node.left, childInherited });
+                std::push_heap(candidates.begin(), candidates.end());
+                candidates.push_back({ node.right, childInherited });
+                std::push_heap(candidates.begin(), candidates.end());
+            }
+        }
+        return best;
+    }
+
+    void insertLeaf(const int leaf) {
+        if (root == NONE) {
+            root = leaf;
+            nodes[leaf].parent = NONE;
             return;
         }
 
-        int sibling = findBestSibling(leaf.box, root);
+        const int sibling = findBestSibling(nodes[leaf].box);
+        const int oldParent = nodes[sibling].parent;
+        const int newParent = allocateNode();
 
-        Node parent;
+        Node& parent = nodes[newParent];
+        parent.parent = oldParent;
         parent.left = sibling;
-        parent.right = leafIndex;
-        parent.box = geom::merge(leaf.box, nodes[sibling].box);
-        parent.parent = nodes[sibling].parent;
-
-        int parentIndex = nodes.size();
-        nodes.push_back(parent);
-
-        if (nodes[sibling].parent != -1) {
-            if (nodes[nodes[sibling].parent].left == sibling)
-                nodes[nodes[sibling].parent].left = parentIndex;
-            else
-                nodes[nodes[sibling].parent].right = parentIndex;
+        parent.right = leaf;
+        parent.box = geom::merge(nodes[sibling].box, nodes[leaf].box);
+        parent.height = nodes[sibling].height + 1;
+
+        replaceChild(oldParent, sibling, newParent);
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+
+        // a tall sibling can leave the new parent itself unbalanced
+        refitAndBalance(newParent);
+    }
+
+    void removeLeaf(const int leaf) {
+        if (leaf == root) {
+            root = NONE;
+            return;
+        }
+
+        const int parent = nodes[leaf].parent;
+        const int grandParent = nodes[parent].parent;
+        const int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+        replaceChild(grandParent, parent, sibling);
+        nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        refitAndBalance(grandParent);
+    }
+
+    void refitAndBalance(int index) {
+        while (index != NONE) {
+            index = balance(index);
+
+            Node& node = nodes[index];
+            const Node& left = nodes[node.left];
+            const Node& right = nodes[node.right];
+            node.height = 1 + std::max(left.height, right.height);
+            node.box = geom::merge(left.box, right.box);
+
+            index = node.parent;
+        }
+    }
+
+    /* promotes the taller grandchild side of A when its children's heights differ by more than one, returns the subtree root */
+    int balance(const int iA) {
+        Node& A = nodes[iA];
+        if (A.isLeaf()) return iA;
+
+        const int iB = A.left;
+        const int iC = A.right;
+        const int diff = nodes[iC].height - nodes[iB].height;
+
+        if (diff > 1) return rotateUp(iA, iC, iB, true);
+        if (diff < -1) return rotateUp(iA, iB, iC, false);
+        return iA;
+    }
+
+    /* lifts `up` (a child of A) above A; `other` is A's remaining child, `upIsRight` which side `up` was on */
+    int rotateUp(const int iA, const int iUp, const int iOther, const bool upIsRight) {
+        Node& A = nodes[iA];
+        Node& up = nodes[iUp];
+
+        const int iF = up.left;
+        const int iG = up.right;
+
+        up.left = iA;
+        up.parent = A.parent;
+        A.parent = iUp;
+        replaceChild(up.parent, iA, iUp);
+
+        // the taller grandchild stays under `up`, the shorter one takes `up`'s old place under A
+        const bool keepF = nodes[iF].height > nodes[iG].height;
+        const int iKeep = keepF ? iF : iG;
+        const int iMove = keepF ? iG : iF;
+
+        up.right = iKeep;
+        if (upIsRight) {
+            A.right = iMove;
         } else {
-            root = parentIndex;
+            A.left = iMove;
         }
+        nodes[iMove].parent = iA;
 
-        nodes[sibling].parent = parentIndex;
-        nodes[leafIndex].parent = parentIndex;
+        A.box = geom::merge(nodes[iOther].box, nodes[iMove].box);
+        A.height = 1 + std::max(nodes[iOther].height, nodes[iMove].height);
 
-        refit(nodes[parentIndex].parent);
+        // when `other` was far shorter A is still lopsided, e.g. a leaf paired with the old root; rotate it down too
+        const int iLower = balance(iA);
+        up.box = geom::merge(nodes[iLower].box, nodes[iKeep].box);
+        up.height = 1 + std::max(nodes[iLower].height, nodes[iKeep].height);
+        return iUp;
     }
 
-private:
-    int findBestSibling(const AABB& box, int start) {
-        if (nodes[start].isLeaf()) return start;
+public:
+    DynamicAABBTree() = default;
+
+    explicit DynamicAABBTree(const float margin) : margin(margin) {}
+
+    ProxyID insert(const AABB& box, const T& data) {
+        const int leaf = allocateNode();
+        nodes[leaf].box = fatten(box, glm::vec3(0.f));
+        nodes[leaf].data = data;
+        insertLeaf(leaf);
+        ++proxies;
+        return leaf;
+    }
+
+    void remove(const ProxyID proxy) {
+        removeLeaf(proxy);
+        freeNode(proxy);
+        --proxies;
+    }
+
+    /* returns false, leaving the tree untouched, while the fat box still contains `box` */
+    bool move(const ProxyID proxy, const AABB& box, const glm::vec3& displacement = glm::vec3(0.f)) {
+        if (nodes[proxy].box.contains(box)) return false;
+
+        removeLeaf(proxy);
+        nodes[proxy].box = fatten(box, displacement);
+        insertLeaf(proxy);
+        return true;
+    }
+
+    const AABB& getFatAABB(const ProxyID proxy) const {
+        return nodes[proxy].box;
+    }
+
+    T& getData(const ProxyID proxy) {
+        return nodes[proxy].data;
+    }
+
+    const T& getData(const ProxyID proxy) const {
+        return nodes[proxy].data;
+    }
 
-        const float leftCost = geom::surface_area(geom::merge(box, nodes[nodes[start].left].box));
-        const float rightCost = geom::surface_area(geom::merge(box, nodes[nodes[start].right].box));
-        if (leftCost < rightCost)
-            return findBestSibling(box, nodes[start].left);
-        return findBestSibling(box, nodes[start].right);
+    /* bool(ProxyID, const T&), return true to stop */
+    template <typename Callable>
+    void forEachIntersects(const AABB& box, Callable&& callable) const {
+        if (root == NONE) return;
+
+        Stack<int> stack;
+        stack.push(root);
+
+        while (!stack.empty()) {
+            const int index = stack.pop();
+            const Node& node = nodes[index];
+            if (!node.box.intersects(box)) continue;
+
+            if (node.isLeaf()) {
+                if (callable(index, node.data)) return;
+            } else {
+                stack.push(node.left);
+                stack.push(node.right);
+            }
+        }
+    }
+
+    /* bool(ProxyID a, ProxyID b) for every pair of overlapping fat boxes within this tree, a < b; return true to stop */
+    template <typename Callable>
+    void forEachPair(Callable&& callable) const {
+        if (root == NONE) return;
+
+        // a pair of equal indices stands for the pairs within that subtree
+        Stack<std::pair<int, int>> stack;
+        stack.push({ root, root });
+
+        while (!stack.empty()) {
+            const auto [a, b] = stack.pop();
+            const Node& A = nodes[a];
+            const Node& B = nodes[b];
+
+            if (a == b) {
+                if (A.isLeaf()) continue;
+                stack.push({ A.left, A.left });
+                stack.push({ A.right, A.right });
+                stack.push({ A.left, A.right });
+                continue;
+            }
+            if (!A.box.intersects(B.box)) continue;
+
+            if (A.isLeaf() && B.isLeaf()) {
+                if (callable(std::min(a, b), std::max(a, b))) return;
+            } else if (B.isLeaf() || (!A.isLeaf() && A.height >= B.height)) {
+                stack.push({ A.left, b });
+                stack.push({ A.right, b });
+            } else {
+                stack.push({ a, B.left });
+                stack.push({ a, B.right });
+            }
+        }
     }
 
-    void refit(int nodeIndex) {
-        while (nodeIndex != -1) {
-            Node& n = nodes[nodeIndex];
-            n.box = geom::merge(nodes[n.left].box, nodes[n.right].box);
-            nodeIndex = n.parent;
+    /* bool(ProxyID mine, ProxyID theirs) for every overlap between this tree and `other`; return true to stop */
+    template <typename U, typename Callable>
+    void forEachPair(const DynamicAABBTree<U>& other, Callable&& callable) const {
+        if (root == NONE || other.root == NONE) return;
+
+        Stack<std::pair<int, int>> stack;
+        stack.push({ root, other.root });
+
+        while (!stack.empty()) {
+            const auto [a, b] = stack.pop();
+            const Node& A = nodes[a];
+            const auto& B = other.nodes[b];
+            if (!A.box.intersects(B.box)) continue;
+
+            if (A.isLeaf() && B.isLeaf()) {
+                if (callable(a, b)) return;
+            } else if (B.isLeaf() || (!A.isLeaf() && A.height >= B.height)) {
+                stack.push({ A.left, b });
+                stack.push({ A.right, b });
+            } else {
+                stack.push({ a, B.left });
+                stack.push({ a, B.right });
+            }
+        }
+    }
+
+    void clear() {
+        nodes.clear();
+        candidates.clear();
+        root = NONE;
+        freeList = NONE;
+        proxies = 0;
+    }
+
+    size_t size() const {
+        return proxies;
+    }
+
+    bool empty() const {
+        return proxies == 0;
+    }
+
+    int height() const {
+        return root == NONE ? 0 : nodes[root].height;
+    }
+
+    /* sum of interior areas over the root's, the SAH quality of the tree */
+    float areaRatio() const {
+        if (root == NONE) return 0.f;
+
+        float total = 0.f;
+        for (const Node& node : nodes) {
+            if (node.height > 0) total += area(node.box);
         }
+        return total / std::max(area(nodes[root].box), 1e-12f);
     }
-};
\ No newline at end of file
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include <array>
 #include <glm/fwd.hpp>
 #include <glm/vec3.hpp>
 #include <glm/mat3x3.hpp>
@@ -3,6 +3,7 @@
 #include "OOBB.h"
 #include "AABB.h"
 #include "Ray.h"
+#include <cstring>
 
 namespace geom {
     struct MTVResult {
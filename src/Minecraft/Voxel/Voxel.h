@@ -1,6 +1,11 @@
 #pragma once
 #include <openGL/BufferObjects/ShaderStorageBuffer.h>
 
+#include <bit>
+#include <cstring>
+#include <expected>
+#include <span>
+
 #include "ECS/Component/Component.h"
 
 struct VoxelFaceData {
@@ -45,46 +50,88 @@ struct VoxelFaceData {
                posY == 0 && negY == 0 &&
                posZ == 0 && negZ == 0;
     }
+
+    bool operator == (const VoxelFaceData& other) const {
+        return memcmp(faces, other.faces, sizeof(faces)) == 0;
+    }
+};
+
+enum class VoxelDecodeError {
+    TRUNCATED, BAD_PALETTE, BAD_RUN
 };
 
+/*
+ * 16^3 voxels stored as a palette of distinct VoxelFaceData and a packed index per voxel.
+ * Index width is 0 (uniform chunk, no index storage), 1, 2, 4, 8 or 16 bits, always a power of two
+ * so an index never straddles a word. The palette only grows on edits; compact() trims it.
+ */
 struct VoxelVolume : PrimaryComponent {
     using voxel_type = VoxelFaceData;
-    voxel_type voxels[16 * 16 * 16];
 
-    VoxelVolume() {
-        memset(voxels, 0, sizeof(voxels));
+    static constexpr int SIZE = 16;
+    static constexpr int VOLUME = SIZE * SIZE * SIZE;
+
+    VoxelVolume() = default;
+
+    static int index(const int x, const int y, const int z) {
+        return x + y * SIZE + z * SIZE * SIZE;
     }
 
-    voxel_type at(const int x, const int y, const int z) const /* in local space of 0-16 */ {
-        return voxels[x + y * 16 + z * 16 * 16];
+    uint16_t paletteIndex(const int i) const {
+        if (bits == 0) return 0;
+        const int word = i >> (6 - log2Bits);
+        const int shift = (i & ((64 >> log2Bits) - 1)) << log2Bits;
+        return static_cast<uint16_t>((indices[word] >> shift) & mask());
     }
 
-    unsigned at(const int x, const int y, const int z, const int face) const {
-        return voxels[x + y * 16 + z * 16 * 16].faces[face];
+    voxel_type at(const int x, const int y, const int z) const /* in local space of 0-16 */ {
+        return palette[paletteIndex(index(x, y, z))];
     }
 
-    voxel_type& at(const int x, const int y, const int z) /* in local space of 0-16 */ {
-        return voxels[x + y * 16 + z * 16 * 16];
+    unsigned at(const int x, const int y, const int z, const int face) const {
+        return palette[paletteIndex(index(x, y, z))].faces[face];
     }
 
     static voxel_type air() {
         return voxel_type::Air();
     }
 
+    void set(const int x, const int y, const int z, const voxel_type& voxel) {
+        const int i = index(x, y, z);
+        const uint16_t previous = paletteIndex(i);
+        if (palette[previous] == voxel) return;
+
+        const uint16_t next = findOrAddPalette(voxel);
+        --counts[previous];
+        ++counts[next];
+
+        if (counts[next] == VOLUME) {
+            makeUniform(palette[next]);
+            return;
+        }
+        setPaletteIndex(i, next);
+    }
+
     void addVoxel(const int x, const int y, const int z, const uint16_t tex) {
-        auto& faces = at(x, y, z).faces;
+        voxel_type voxel;
         for (int i = 0; i < 6; ++i) {
-            faces[i] = tex;
+            voxel.faces[i] = tex;
         }
+        set(x, y, z, voxel);
     }
 
     void addVoxel(const int x, const int y, const int z, const uint16_t* tex) {
-        auto& faces = at(x, y, z).faces;
-        memcpy(faces, tex, sizeof(voxel_type));
+        voxel_type voxel;
+        memcpy(voxel.faces, tex, sizeof(voxel_type));
+        set(x, y, z, voxel);
     }
 
     void removeVoxel(const int x, const int y, const int z) /* in local space of 0-16 */ {
-        memset(&at(x, y, z), 0, sizeof(voxel_type));
+        set(x, y, z, air());
+    }
+
+    void fill(const voxel_type& voxel) {
+        makeUniform(voxel);
     }
 
     static bool isOutsideBounds(const int x, const int y, const int z) {
@@ -95,6 +142,204 @@ struct VoxelVolume : PrimaryComponent {
         if (isOutsideBounds(x, y, z)) return {};
         return at(x, y, z);
     }
+
+    bool isUniform() const { return bits == 0; }
+
+    bool isEmpty() const { return bits == 0 && palette[0].isAir(); }
+
+    const std::vector<voxel_type>& getPalette() const { return palette; }
+
+    int getIndexBits() const { return bits; }
+
+    /* writes all VOLUME palette indices in x, y, z order, a word at a time */
+    void unpack(uint16_t* out) const {
+        if (bits == 0) {
+            std::fill_n(out, VOLUME, uint16_t(0));
+            return;
+        }
+        const int perWord = 64 >> log2Bits;
+        for (size_t w = 0; w < indices.size(); ++w) {
+            uint64_t word = indices[w];
+            for (int k = 0; k < perWord; ++k, word >>= bits) {
+                *out++ = static_cast<uint16_t>(word & mask());
+            }
+        }
+    }
+
+    /* drops unused palette entries and shrinks the index width to fit */
+    void compact() {
+        if (bits == 0) return;
+
+        std::vector<uint16_t> remap(palette.size(), 0);
+        std::vector<voxel_type> livePalette;
+        std::vector<uint16_t> liveCounts;
+        for (size_t p = 0; p < palette.size(); ++p) {
+            if (counts[p] == 0) continue;
+            remap[p] = static_cast<uint16_t>(livePalette.size());
+            livePalette.push_back(palette[p]);
+            liveCounts.push_back(counts[p]);
+        }
+
+        if (livePalette.size() == 1) {
+            makeUniform(livePalette[0]);
+            return;
+        }
+
+        uint16_t unpacked[VOLUME];
+        unpack(unpacked);
+
+        palette = std::move(livePalette);
+        counts = std::move(liveCounts);
+        setIndexBits(bitsFor(palette.size()));
+        for (int i = 0; i < VOLUME; ++i) {
+            setPaletteIndex(i, remap[unpacked[i]]);
+        }
+    }
+
+    size_t memoryFootprint() const {
+        return sizeof(VoxelVolume)
+            + palette.capacity() * sizeof(voxel_type)
+            + counts.capacity() * sizeof(uint16_t)
+            + indices.capacity() * sizeof(uint64_t);
+    }
+
+    /*
+     * Serialized form: u16 palette size, the live palette entries, then (u16 run length, u16 palette index)
+     * pairs in x, y, z order covering all VOLUME voxels. Host byte order.
+     */
+    std::vector<uint8_t> encodeRLE() const {
+        VoxelVolume compacted = *this;
+        compacted.compact();
+
+        std::vector<uint8_t> out;
+        auto write = [&](const void* data, const size_t bytes) {
+            const auto* ptr = static_cast<const uint8_t*>(data);
+            out.insert(out.end(), ptr, ptr + bytes);
+        };
+
+        const auto paletteSize = static_cast<uint16_t>(compacted.palette.size());
+        write(&paletteSize, sizeof(paletteSize));
+        write(compacted.palette.data(), compacted.palette.size() * sizeof(voxel_type));
+
+        int i = 0;
+        while (i < VOLUME) {
+            const uint16_t value = compacted.paletteIndex(i);
+            uint16_t run = 1;
+            while (i + run < VOLUME && compacted.paletteIndex(i + run) == value) ++run;
+
+            write(&run, sizeof(run));
+            write(&value, sizeof(value));
+            i += run;
+        }
+        return out;
+    }
+
+    static std::expected<VoxelVolume, VoxelDecodeError> decodeRLE(const std::span<const uint8_t> data) {
+        size_t offset = 0;
+        auto read = [&](void* dst, const size_t bytes) {
+            if (offset + bytes > data.size()) return false;
+            memcpy(dst, data.data() + offset, bytes);
+            offset += bytes;
+            return true;
+        };
+
+        uint16_t paletteSize = 0;
+        if (!read(&paletteSize, sizeof(paletteSize))) return std::unexpected(VoxelDecodeError::TRUNCATED);
+        if (paletteSize == 0 || paletteSize > VOLUME) return std::unexpected(VoxelDecodeError::BAD_PALETTE);
+
+        VoxelVolume volume;
+        volume.palette.resize(paletteSize);
+        if (!read(volume.palette.data(), paletteSize * sizeof(voxel_type))) return std::unexpected(VoxelDecodeError::TRUNCATED);
+
+        volume.counts.assign(paletteSize, 0);
+        volume.setIndexBits(bitsFor(paletteSize));
+
+        int i = 0;
+        while (i < VOLUME) {
+            uint16_t run, value;
+            if (!read(&run, sizeof(run)) || !read(&value, sizeof(value))) return std::unexpected(VoxelDecodeError::TRUNCATED);
+            if (run == 0 || i + run > VOLUME) return std::unexpected(VoxelDecodeError::BAD_RUN);
+            if (value >= paletteSize) return std::unexpected(VoxelDecodeError::BAD_PALETTE);
+
+            volume.counts[value] += run;
+            if (volume.bits != 0) {
+                for (const int end = i + run; i < end; ++i) {
+                    volume.setPaletteIndex(i, value);
+                }
+            } else {
+                i += run;
+            }
+        }
+        return volume;
+    }
+private:
+    std::vector<voxel_type> palette{ voxel_type{} };
+    std::vector<uint16_t> counts{ uint16_t(VOLUME) };
+    std::vector<uint64_t> indices;
+    uint8_t bits = 0;
+    uint8_t log2Bits = 0;
+
+    uint64_t mask() const {
+        return (uint64_t(1) << bits) - 1;
+    }
+
+    static int bitsFor(const size_t paletteSize) {
+        if (paletteSize <= 1) return 0;
+        if (paletteSize <= 2) return 1;
+        if (paletteSize <= 4) return 2;
+        if (paletteSize <= 16) return 4;
+        if (paletteSize <= 256) return 8;
+        return 16;
+    }
+
+    void setPaletteIndex(const int i, const uint16_t value) {
+        const int word = i >> (6 - log2Bits);
+        const int shift = (i & ((64 >> log2Bits) - 1)) << log2Bits;
+        indices[word] = (indices[word] & ~(mask() << shift)) | (uint64_t(value) << shift);
+    }
+
+    /* resizes the index storage, every index reads as 0 afterwards */
+    void setIndexBits(const int newBits) {
+        bits = static_cast<uint8_t>(newBits);
+        log2Bits = static_cast<uint8_t>(newBits ? std::countr_zero(unsigned(newBits)) : 0);
+        indices.assign(newBits ? VOLUME * newBits / 64 : 0, 0);
+    }
+
+    void makeUniform(const voxel_type& voxel) {
+        palette.assign(1, voxel);
+        counts.assign(1, uint16_t(VOLUME));
+        indices.clear();
+        indices.shrink_to_fit();
+        bits = 0;
+        log2Bits = 0;
+    }
+
+    uint16_t findOrAddPalette(const voxel_type& voxel) {
+        const auto it = std::ranges::find(palette, voxel);
+        if (it != palette.end()) {
+            return static_cast<uint16_t>(it - palette.begin());
+        }
+
+        const auto unused = std::ranges::find(counts, uint16_t(0));
+        if (unused != counts.end()) {
+            const auto slot = static_cast<uint16_t>(unused - counts.begin());
+            palette[slot] = voxel;
+            return slot;
+        }
+
+        const int newBits = bitsFor(palette.size() + 1);
+        if (newBits != bits) {
+            uint16_t unpacked[VOLUME];
+            unpack(unpacked);
+            setIndexBits(newBits);
+            for (int i = 0; i < VOLUME; ++i) {
+                setPaletteIndex(i, unpacked[i]);
+            }
+        }
+        palette.push_back(voxel);
+        counts.push_back(0);
+        return static_cast<uint16_t>(palette.size() - 1);
+    }
 };
 
 #include "VoxelConstants.h"
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <vector>
 
 #include "openGL/BufferObjects/ShaderStorageBuffer.h"
+#include "openGL/Texture/TextureLoader.h"
 #include <memory/hash.h>
 
 
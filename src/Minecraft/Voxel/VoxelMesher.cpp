@@ -0,0 +1,138 @@
+#include "VoxelMesher.h"
+
+#include <bit>
+
+std::vector<Quad> VoxelMesher::greedyMesh(const VoxelVolume& volume, const Neighbors& neighbors) {
+    std::vector<Quad> quads;
+    greedyMesh(volume, neighbors, quads);
+    return quads;
+}
+
+void VoxelMesher::greedyMesh(const VoxelVolume& volume, const Neighbors& neighbors, std::vector<Quad>& quads) {
+    static_assert(SIZE == VoxelVolume::SIZE);
+    constexpr Column interior = ((Column(1) << SIZE) - 1) << 1;
+
+    if (volume.isEmpty()) return;
+
+    const auto& palette = volume.getPalette();
+    uint16_t indices[VoxelVolume::VOLUME];
+    volume.unpack(indices);
+
+    Column solid[6][SIZE * SIZE]{};
+
+    for (int z = 0; z < SIZE; ++z) {
+        for (int y = 0; y < SIZE; ++y) {
+            for (int x = 0; x < SIZE; ++x) {
+                const auto& voxel = palette[indices[x + y * SIZE + z * SIZE * SIZE]];
+                if (voxel.isAir()) continue;
+
+                const glm::ivec3 p(x, y, z);
+                for (int d = 0; d < 3; ++d) {
+                    const int cell = p[(d + 1) % 3] + p[(d + 2) % 3] * SIZE;
+                    const Column bit = Column(1) << (p[d] + 1);
+
+                    if (voxel.faces[d * 2 + 0]) solid[d * 2 + 0][cell] |= bit;
+                    if (voxel.faces[d * 2 + 1]) solid[d * 2 + 1][cell] |= bit;
+                }
+            }
+        }
+    }
+
+    for (int d = 0; d < 3; ++d) {
+        for (int dir = 0; dir < 2; ++dir) {
+            const VoxelVolume* neighbor = neighbors[d * 2 + dir];
+            if (!neighbor) continue;
+
+            // only the facing side of the border layer can hide one of our faces
+            const int face = d * 2 + (1 - dir);
+            const Column bit = dir ? Column(1) << (SIZE + 1) : Column(1);
+
+            glm::ivec3 p{};
+            p[d] = dir ? 0 : SIZE - 1;
+
+            for (p[(d + 2) % 3] = 0; p[(d + 2) % 3] < SIZE; ++p[(d + 2) % 3]) {
+                for (p[(d + 1) % 3] = 0; p[(d + 1) % 3] < SIZE; ++p[(d + 1) % 3]) {
+                    if (neighbor->at(p.x, p.y, p.z, face)) {
+                        solid[face][p[(d + 1) % 3] + p[(d + 2) % 3] * SIZE] |= bit;
+                    }
+                }
+            }
+        }
+    }
+
+    for (int d = 0; d < 3; ++d) {
+        const int u = (d + 1) % 3;
+        const int v = (d + 2) % 3;
+
+        for (int dir = 0; dir < 2; ++dir) {
+            const Face face = static_cast<Face>(d * 2 + dir);
+            const Column* self = solid[d * 2 + dir];
+            const Column* other = solid[d * 2 + (1 - dir)];
+
+            Row planes[SIZE + 1][SIZE]{};
+
+            for (int cell = 0; cell < SIZE * SIZE; ++cell) {
+                const Column visible = dir
+                    ? self[cell] & ~(other[cell] >> 1)
+                    : self[cell] & ~(other[cell] << 1);
+
+                const int cu = cell % SIZE;
+                const int cv = cell / SIZE;
+
+                for (Column bits = visible & interior; bits; bits &= bits - 1) {
+                    const int depth = std::countr_zero(bits);
+                    planes[dir ? depth : depth - 1][cv] |= Row(1) << cu;
+                }
+            }
+
+            for (int plane = 0; plane <= SIZE; ++plane) {
+                glm::ivec3 x{};
+                x[d] = dir ? plane - 1 : plane;
+
+                auto texture = [&](const int i, const int j) {
+                    x[u] = i;
+                    x[v] = j;
+                    return unsigned(palette[indices[x.x + x.y * SIZE + x.z * SIZE * SIZE]].faces[int(face)]);
+                };
+
+                Row* rows = planes[plane];
+                for (int j = 0; j < SIZE; ++j) {
+                    while (rows[j]) {
+                        const int i = std::countr_zero(rows[j]);
+                        const unsigned tex = texture(i, j);
+
+                        const int run = std::countr_one(rows[j] >> i);
+                        int w = 1;
+                        while (w < run && texture(i + w, j) == tex) ++w;
+
+                        const Row mask = ((Row(1) << w) - 1) << i;
+
+                        int h = 1;
+                        for (; j + h < SIZE; ++h) {
+                            if ((rows[j + h] & mask) != mask) break;
+
+                            int k = 0;
+                            while (k < w && texture(i + k, j + h) == tex) ++k;
+                            if (k != w) break;
+                        }
+
+                        for (int l = 0; l < h; ++l) {
+                            rows[j + l] &= ~mask;
+                        }
+
+                        glm::ivec3 min{};
+                        min[d] = plane;
+                        min[u] = i;
+                        min[v] = j;
+
+                        glm::ivec3 axis{};
+                        axis[u] = w;
+                        axis[v] = h;
+
+                        quads.emplace_back(face, AABB::fromTo(min, min + axis), tex);
+                    }
+                }
+            }
+        }
+    }
+}
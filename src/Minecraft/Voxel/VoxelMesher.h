@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <Math/Shapes/AABB.h>
+#include "Voxel.h"
+
+enum class Face {
+    X_NEG = 0,
+    X_POS = 1,
+    Y_NEG = 2,
+    Y_POS = 3,
+    Z_NEG = 4,
+    Z_POS = 5
+};
+
+struct Quad {
+    AABB aabb;
+    Face face;
+    unsigned texture;
+
+    Quad(Face axis, const AABB& aabb, unsigned texture)
+        : aabb(aabb), face(axis), texture(texture) {}
+};
+
+/*
+ * Greedy meshing of a single VoxelVolume. Has no GL or ECS state so it can run on worker threads
+ * and headlessly.
+ *
+ * The bitmask mesher stores one Column per (u, v) cell of every axis, bit i being the voxel at depth i - 1,
+ * so face culling is `solid & ~neighbor` on whole columns. Bits 0 and SIZE + 1 are the apron, sampled from
+ * the border layer of the adjacent chunks; a missing neighbor reads as air.
+ */
+class VoxelMesher {
+public:
+    static constexpr int SIZE = 16;
+
+    using Column = uint64_t;
+    using Row = uint32_t;
+
+    static_assert(SIZE + 2 <= sizeof(Column) * 8);
+    static_assert(SIZE <= sizeof(Row) * 8);
+
+    /* indexed by Face, X_NEG being the chunk at coords - (1, 0, 0) */
+    using Neighbors = std::array<const VoxelVolume*, 6>;
+
+    static std::vector<Quad> greedyMesh(const VoxelVolume& volume, const Neighbors& neighbors = {});
+
+    static void greedyMesh(const VoxelVolume& volume, const Neighbors& neighbors, std::vector<Quad>& quads);
+};
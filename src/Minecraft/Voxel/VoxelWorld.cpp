@@ -8,6 +8,8 @@
 
 #include <ECS/ECS.h>
 
+#include <tbb/parallel_for.h>
+
 const char* VoxelConstants::NULL_FACE = "__NULL__";
 const char* VoxelConstants::ACACIA_LEAVES = "ACACIA_LEAVES";
 const char* VoxelConstants::ACACIA_LOG = "ACACIA_LOG";
@@ -276,104 +278,6 @@ BVH<BVHCollisionNode<AABB>> VoxelWorldSystem::buildCollisionMesh(Chunk &chunk)
     return BVH<BVHCollisionNode<AABB>>(chunk.quads, 4);
 }
 
-std::vector<Quad> VoxelWorldSystem::greedyMesh(const VoxelVolume &volume, glm::ivec3 dims)
-{
-    auto f = [&](int x, int y, int z, Face f) {
-        if (x < 0 || y < 0 || z < 0 || x >= dims.x || y >= dims.y || z >= dims.z)
-            return 0u;
-        return volume.at(x, y, z, int(f));
-    };
-
-    std::vector<Quad> quads;
-    quads.reserve(32);
-
-    for (int d = 0; d < 3; ++d) {
-        int u = (d + 1) % 3;
-        int v = (d + 2) % 3;
-        glm::ivec3 x{};
-        glm::ivec3 q{};
-        q[d] = 1;
-
-        Face posFace = static_cast<Face>(d * 2 + 1);
-        Face negFace = static_cast<Face>(d * 2 + 0);
-
-        bool dirMask[256];
-        unsigned textureMask[256];
-
-        for (x[d] = -1; x[d] < dims[d]; ) {
-            int n = 0;
-
-            for (x[v] = 0; x[v] < dims[v]; ++x[v]) {
-                for (x[u] = 0; x[u] < dims[u]; ++x[u]) {
-                    glm::vec3 neightbor = x + q;
-                    unsigned a = f(x.x, x.y, x.z, posFace);
-                    unsigned b = f(neightbor.x, neightbor.y, neightbor.z, negFace);
-                    dirMask[n] = (a && !b);
-                    unsigned currentTex = 0;
-                    if (a == 0 && b > 0) {
-                        currentTex = b;
-                    } else if (a > 0 && b == 0) {
-                        currentTex = a;
-                    } else {
-                        currentTex = 0;
-                    }
-                    textureMask[n] = currentTex;
-                    ++n;
-                }
-            }
-            
-            ++x[d];
-            n = 0;
-            for (int j = 0; j < dims[v]; ++j) {
-                for (int i = 0; i < dims[u]; ) {
-                    if (textureMask[n]) {
-                        const bool currentDir = dirMask[n];
-                        const unsigned currentTex = textureMask[n];
-                        int w;
-                        for (w = 1; i + w < dims[u] && currentTex == textureMask[n + w] && textureMask[n + w] != 0 && dirMask[n + w] == currentDir; ++w);
-
-                        int h;
-                        for (h = 1; j + h < dims[v]; ++h) {
-                            int hIdx = n + h * dims[u];
-                            for (int k = 0; k < w; ++k) {
-                                int idx = hIdx + k;
-                                if (dirMask[idx] != currentDir || currentTex != textureMask[idx]) {
-                                    goto Done;
-                                }
-                            }
-                        }
-                    Done:
-                        x[u] = i;
-                        x[v] = j;
-
-                        glm::ivec3 axis{}; 
-                        axis[u] = w;
-                        axis[v] = h;
-
-                        Face face = static_cast<Face>(d * 2 + (currentDir ? 1 : 0));
-                        quads.emplace_back(face, AABB::fromTo(x, x + axis), currentTex);
-
-                        for (int l = 0; l < h; ++l) {
-                            int idx = n + l * dims[u];
-                            for (int k = 0; k < w; ++k) {
-                                textureMask[idx + k] = 0;
-                                dirMask[idx + k] = false;
-                            }
-                        }
-                            
-                        i += w;
-                        n += w;
-                    } else {
-                        ++i;
-                        ++n;
-                    }
-                }
-            }
-        }
-    }
-    return quads;
-}
-
 AABB quadToAABB(const std::array<glm::ivec3, 4>& corners) {
     glm::ivec3 minCorner = corners[0];
     glm::ivec3 maxCorner = corners[0];
@@ -477,17 +381,17 @@ glm::mat4 createInstanceModel(const Quad& q,glm::vec3 position, glm::vec3 min, g
 
 void VoxelWorldSystem::buildChunkMesh(const VoxelVolume& volume, Chunk &mesh)
 {
-    auto now = std::chrono::high_resolution_clock::now();
-    auto quads = greedyMesh(volume, glm::ivec3(16));
-    auto end = std::chrono::high_resolution_clock::now();
-    std::cout << "Greedy meshing took " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - now).count() << " seconds" << std::endl;
+    uploadChunkMesh(VoxelMesher::greedyMesh(volume), mesh);
+}
 
+void VoxelWorldSystem::uploadChunkMesh(const std::vector<Quad>& quads, Chunk &mesh)
+{
     mesh.drawCommands.clear();
     mesh.quads.clear();
 
     auto ptr = vertexPool.vInstancePtr;
     if (mesh.commands > 0) {
-        vertexPool.free(mesh.startingIndex, mesh.commands);
+        vertexPool.retire(mesh.startingIndex, mesh.commands);
     }
     auto idx = vertexPool.allocate(quads.size());
 
@@ -513,15 +417,53 @@ void VoxelWorldSystem::buildVolume(const VoxelVolume& volume, Chunk& chunk) {
 }
 
 void VoxelWorldSystem::onUpdate(LevelUpdateView<VoxelWorldSystem>& view) {
-    for (const auto& dirty : dirtyChunks) {
-        auto& chunk = chunks[dirty];
-        auto& volume = *view.get<VoxelVolume>(chunk.voxelVolumeEntity);
-        buildVolume(volume, chunk);
+    for (const auto& [coords, local, voxel] : pendingEdits) {
+        const auto it = chunks.find(coords);
+        if (it == chunks.end()) continue;
+
+        view.get<VoxelVolume>(it->second.voxelVolumeEntity)->set(local.x, local.y, local.z, voxel);
+        onVoxelChanged(coords, local);
+    }
+    pendingEdits.clear();
+
+    if (dirtyChunks.empty()) return;
+
+    std::ranges::sort(dirtyChunks, [](const glm::ivec3& a, const glm::ivec3& b) {
+        return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+    });
+    dirtyChunks.erase(std::ranges::unique(dirtyChunks).begin(), dirtyChunks.end());
+
+    std::vector<const VoxelVolume*> volumes(dirtyChunks.size());
+    std::vector<VoxelMesher::Neighbors> neighbors(dirtyChunks.size());
+    std::vector<std::vector<Quad>> meshes(dirtyChunks.size());
+
+    for (size_t i = 0; i < dirtyChunks.size(); ++i) {
+        const glm::ivec3 coords = dirtyChunks[i];
+        volumes[i] = view.get<VoxelVolume>(chunks[coords].voxelVolumeEntity);
+
+        for (int f = 0; f < 6; ++f) {
+            const auto it = chunks.find(coords + neighborOffset(Face(f)));
+            neighbors[i][f] = it != chunks.end() ? view.get<VoxelVolume>(it->second.voxelVolumeEntity) : nullptr;
+        }
+    }
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, dirtyChunks.size()), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t i = range.begin(); i != range.end(); ++i) {
+            VoxelMesher::greedyMesh(*volumes[i], neighbors[i], meshes[i]);
+        }
+    });
+
+    // vertex pool allocation stays on this thread, in coordinate order, so offsets are reproducible
+    for (size_t i = 0; i < dirtyChunks.size(); ++i) {
+        auto& chunk = chunks[dirtyChunks[i]];
+        uploadChunkMesh(meshes[i], chunk);
+        buildCollisionMesh(chunk);
+        chunk.dirty = true;
     }
     dirtyChunks.clear();
 }
 
-RenderPassContext VoxelWorldSystem::onRenderNew(RenderInfo& info, RenderScene &rScene, const std::unordered_set<glm::ivec3, IVec3Hash> &visibleChunks)
+RenderPassContext VoxelWorldSystem::onRenderNew(RenderInfo& info, RenderScene &rScene, std::span<const glm::ivec3> visibleChunks)
 {
     RenderPassContext voxelCtx;
     voxelCtx.shader = "VoxelShader";
@@ -557,6 +499,7 @@ RenderPassContext VoxelWorldSystem::onRenderNew(RenderInfo& info, RenderScene &r
     }
 
     voxelCtx.buffers.push_back(BufferHandle(BufferHandleTarget::SSBO, vertexPool.instancePool.id(), 3));
+    vertexPool.endFrame();
 
     voxelCtx.isSorted = true;
     return voxelCtx;
@@ -6,6 +6,8 @@
 #include <Core/Model/Model.h>
 #include <Math/Shapes/geom.h>
 #include "Voxel.h"
+#include "VoxelMesher.h"
+#include <span>
 #include <openGL/BufferObjects/PersistentBuffer.h>
 #include <opengl/BufferObjects/ShaderStorageBuffer.h>
 #include "Collision/CollisionComponents.h"
@@ -14,15 +16,6 @@
 
 #include <ECS/ECS.h>
 
-enum class Face {
-    X_NEG = 0,
-    X_POS = 1,
-    Y_NEG = 2,
-    Y_POS = 3,
-    Z_NEG = 4,
-    Z_POS = 5
-};
-
 struct QuadVertex {
     glm::vec3 localOffset;
     glm::vec2 uvSize;
@@ -40,16 +33,7 @@ struct alignas(16) QuadDrawInstance {
         : model(model), textureID(textureID), aFace(int(face)), uv(uv) {}
 };
 
-struct Quad {
-    AABB aabb;
-    Face face;
-    unsigned texture;
-
-    Quad(Face axis, const AABB& aabb, unsigned texture)
-        : face(axis), aabb(aabb), texture(texture) {}
-};
-
-class VoxelWorldSystem : Reads<VoxelVolume> {
+class VoxelWorldSystem : Writes<VoxelVolume> {
     FRIEND_DESCRIPTOR
 
     static glm::ivec3 worldPosToVoxelChunk(const glm::vec3& pos) {
@@ -146,6 +130,13 @@ class VoxelWorldSystem : Reads<VoxelVolume> {
     FaceTBNUV faces[6];
     ShaderStorageBuffer FacesUBO;
     std::vector<glm::ivec3> dirtyChunks;
+
+    struct VoxelEdit {
+        glm::ivec3 chunk;
+        glm::ivec3 local;
+        VoxelFaceData voxel;
+    };
+    std::vector<VoxelEdit> pendingEdits;
     struct VertexPool {
         PersistentBuffer<GL_SHADER_STORAGE_BUFFER> instancePool;
         VertexBufferObject vertexPool;
@@ -155,6 +146,16 @@ class VoxelWorldSystem : Reads<VoxelVolume> {
         QuadDrawInstance* vInstancePtr = nullptr;
         std::map<unsigned, unsigned> freeBlocks;
 
+        /* freed blocks wait here until the frames that may still draw them finished */
+        struct RetiredBlock {
+            uint64_t frame;
+            unsigned offset;
+            unsigned count;
+        };
+        inline static GLFenceBackend fenceBackend;
+        FrameFences fences{fenceBackend};
+        std::vector<RetiredBlock> retiredBlocks;
+
         VertexPool() {}
 
         void initialize() {
@@ -212,6 +213,25 @@ class VoxelWorldSystem : Reads<VoxelVolume> {
 
             freeBlocks[offset] = count;
         }
+
+        /*
+         * Frees a block once the GPU can no longer read it. The pool's fence goes in when the chunks are collected,
+         * ahead of the frame's draws, so a block also waits for the fence after its last frame.
+         */
+        void retire(const unsigned offset, const unsigned count) {
+            retiredBlocks.push_back({ fences.getFrame() + 1, offset, count });
+        }
+
+        /* once per frame, after the frame's chunks were collected */
+        void endFrame() {
+            fences.endFrame();
+            const uint64_t completed = fences.poll();
+            std::erase_if(retiredBlocks, [&](const RetiredBlock& block) {
+                if (block.frame > completed) return false;
+                free(block.offset, block.count);
+                return true;
+            });
+        }
     } vertexPool;
 
     ShaderStorageBuffer instanceSSBO;
@@ -225,15 +245,59 @@ public:
 
     BVH<BVHCollisionNode<AABB>> buildCollisionMesh(Chunk& chunk);
 
+    static glm::ivec3 neighborOffset(const Face face) {
+        glm::ivec3 offset{};
+        offset[int(face) / 2] = int(face) % 2 ? 1 : -1;
+        return offset;
+    }
+
+    void markDirty(const glm::ivec3 coords) {
+        if (chunks.contains(coords)) {
+            dirtyChunks.push_back(coords);
+        }
+    }
+
+    /* a new chunk can hide the border faces of all six neighbors */
     void addVolume(const glm::ivec3 localCoords, const Entity entity) {
         const auto it = chunks.find(localCoords);
         Chunk& chunk = it != chunks.end() ? it->second : chunks.emplace(localCoords, localCoords).first->second;
         chunk.voxelVolumeEntity = entity;
+
+        dirtyChunks.push_back(localCoords);
+        for (int f = 0; f < 6; ++f) {
+            markDirty(localCoords + neighborOffset(Face(f)));
+        }
     }
 
-    void onUpdate(LevelUpdateView<VoxelWorldSystem>& view);
+    /* edits land in onUpdate, ahead of the remesh they cause; voxels of chunks that are not loaded are dropped */
+    void setVoxel(const glm::ivec3 worldVoxel, const VoxelFaceData& voxel) {
+        const glm::ivec3 chunk = worldVoxelToChunk(worldVoxel);
+        pendingEdits.push_back({ chunk, worldVoxel - chunk * VoxelMesher::SIZE, voxel });
+    }
+
+    void removeVoxel(const glm::ivec3 worldVoxel) {
+        setVoxel(worldVoxel, VoxelVolume::air());
+    }
 
-    std::vector<Quad> greedyMesh(const VoxelVolume& volume, glm::ivec3 dims);
+    static glm::ivec3 worldVoxelToChunk(const glm::ivec3 worldVoxel) {
+        // rounds towards negative infinity, -1 belongs to chunk -1
+        glm::ivec3 chunk;
+        for (int d = 0; d < 3; ++d) {
+            chunk[d] = (worldVoxel[d] >= 0 ? worldVoxel[d] : worldVoxel[d] - (VoxelMesher::SIZE - 1)) / VoxelMesher::SIZE;
+        }
+        return chunk;
+    }
+
+    /* an edit remeshes its own chunk and only the neighbors whose apron contains the voxel */
+    void onVoxelChanged(const glm::ivec3 chunkCoords, const glm::ivec3 local) {
+        markDirty(chunkCoords);
+        for (int d = 0; d < 3; ++d) {
+            if (local[d] == 0) markDirty(chunkCoords + neighborOffset(Face(d * 2)));
+            if (local[d] == VoxelMesher::SIZE - 1) markDirty(chunkCoords + neighborOffset(Face(d * 2 + 1)));
+        }
+    }
+
+    void onUpdate(LevelUpdateView<VoxelWorldSystem>& view);
 
     static void ensureCorrectWinding(std::array<glm::ivec3,4>& corners, const int d, const bool facePositive) {
         const auto edge1 = glm::vec3(corners[1] - corners[0]);
@@ -250,7 +314,9 @@ public:
 
     void buildChunkMesh(const VoxelVolume& volume, Chunk& mesh);
 
+    void uploadChunkMesh(const std::vector<Quad>& quads, Chunk& mesh);
+
     void buildVolume(const VoxelVolume &volume, Chunk &chunk);
 
-    RenderPassContext onRenderNew(RenderInfo& info, RenderScene& rScene, const std::unordered_set<glm::ivec3, IVec3Hash> & visibleChunks);
+    RenderPassContext onRenderNew(RenderInfo& info, RenderScene& rScene, std::span<const glm::ivec3> visibleChunks);
 };
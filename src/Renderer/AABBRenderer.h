@@ -23,9 +23,12 @@ struct AABBRenderer :
     ShaderStorageBuffer aabbs;
     size_t aabbsCount = 0;
 
+    GeometryKey cube;
+    ShaderKey aabbShader;
+
     void onRendererLoad(RendererLoadView<AABBRenderer> level) {
-        level.loadGeometry("assets/geometry/Cube.gltf", "Cube");
-        level.loadShader("shaders/Debug/AABB/aabb_vertex.glsl", "shaders/Debug/AABB/aabb_frag.glsl", "AABBShader");
+        cube = level.loadGeometry("assets/geometry/Cube.gltf", "Cube");
+        aabbShader = level.loadShader("shaders/Debug/AABB/aabb_vertex.glsl", "shaders/Debug/AABB/aabb_frag.glsl", "AABBShader");
     }
 
     void onRendererIn(RendererInView<AABBRenderer> level) {
@@ -55,11 +58,11 @@ struct AABBRenderer :
             return;
         }
 
-        Shader& shader = view.setActiveShader("AABBShader");
+        Shader& shader = view.setActiveShader(aabbShader);
 
         UniformData Uniforms(shader.id());
 
-        auto& geometry = view.getGeometry("Cube");
+        auto& geometry = view.getGeometry(cube);
         geometry.VAO.bind();
         aabbs.setToBindingPoint(1);
         glLineWidth(3.0f);
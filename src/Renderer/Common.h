@@ -1,5 +1,6 @@
 #pragma once
 #include <Collision/CollisionComponents.h>
+#include <Collision/FixedTimestep.h>
 #include <ECS/ECS.h>
 
 class LevelConnectionStream {
@@ -159,8 +160,10 @@ struct LevelOutStage : Stage<LevelOutStage> {
 
     RendererProxy* proxy;
     Level* level;
+    /* the physics clock of the level this stage belongs to, if it has one */
+    const FixedTimestep* timestep;
 
-    LevelOutStage(RendererProxy* proxy, Level* level) : proxy(proxy), level(level) {}
+    LevelOutStage(RendererProxy* proxy, Level* level, const FixedTimestep* timestep = nullptr) : proxy(proxy), level(level), timestep(timestep) {}
 
     void onStageBegin(Level& level) {
         level.synchronize();
@@ -217,4 +220,9 @@ public:
     S& getRendererSystem() {
         return this->stage->level->template getSystem<S>();
     }
+
+    /* how far this frame is from the previous physics step to the last one, 1 without a physics clock */
+    float getAlpha() const {
+        return this->stage->timestep ? this->stage->timestep->getAlpha() : 1.f;
+    }
 };
\ No newline at end of file
@@ -6,10 +6,9 @@
 #include <ECS/ECS.h>
 
 #include "Model/ModelLoaderSystem.h"
+#include "Resource/HandlePool.h"
 
-enum class GeometryKey : size_t {
-    INVALID = std::numeric_limits<size_t>::max()
-};
+using GeometryKey = Handle<struct GeometryTag>;
 
 struct PendingLoadGeometry {
     std::string file;
@@ -22,8 +21,7 @@ struct PendingLoadGeometryFromGeometry {
 };
 
 class GeometrySystem {
-    mem::vector<Geometry> geometries;
-    mem::unordered_stringmap<size_t> geometryKeys;
+    HandlePool<GeometryTag, Geometry> geometries;
 public:
     GeometrySystem() {}
 
@@ -31,31 +29,23 @@ public:
     GeometrySystem& operator=(const GeometrySystem&) = delete;
 
     GeometryKey loadGeometry(Geometry& geometry, std::string_view as) {
-        geometries.emplace_back(std::move(geometry));
-        geometryKeys.emplace(as, geometries.size() - 1);
-        return GeometryKey{geometries.size() - 1};
+        return geometries.insert(as, std::move(geometry));
     }
 
     GeometryKey loadGeometry(const std::string_view file, std::string as) {
         if (auto geometry = ModelLoaderSystem::loadGeometry(file); geometry.has_value()) {
-            geometries.emplace_back(std::move(geometry.value()));
-            geometryKeys.emplace(as, geometries.size() - 1);
-            return GeometryKey{geometries.size() - 1};
+            return geometries.insert(as, std::move(geometry.value()));
         }
         std::cout << "Failed to load geometry: " << file << std::endl;
-        return GeometryKey::INVALID;
+        return GeometryKey{};
     }
 
     GeometryKey getGeometryKey(const std::string_view str) const {
-        const auto it = geometryKeys.find(str);
-        return it == geometryKeys.end() ? GeometryKey::INVALID : GeometryKey{it->second};
+        return geometries.find(str);
     }
 
     const Geometry& getGeometry(const GeometryKey key) const {
-        if (key == GeometryKey::INVALID) {
-            cexpr::require(false);
-        }
-        return geometries[cexpr::enum_cast(key)];
+        return geometries[key];
     }
 
     const Geometry& getGeometry(const std::string_view str) const {
@@ -0,0 +1,85 @@
+#include "ModelBatch.h"
+
+#include <cassert>
+#include <algorithm>
+
+void ModelBatch::add(const ModelDefinition& definition, const std::span<const glm::mat4> nodeMatrices, Skeleton* skeleton) {
+    assert(nodeMatrices.size() >= definition.nodes.size());
+
+    uint32_t palette = NO_PALETTE;
+    if (skeleton) {
+        palette = static_cast<uint32_t>(palettes.size());
+        palettes.resize(palettes.size() + skeleton->getBoneCount());
+        skeletons.push_back(skeleton);
+        paletteOffsets.push_back(palette);
+    }
+
+    instances.push_back({ &definition, static_cast<uint32_t>(matrices.size()), palette });
+    matrices.insert(matrices.end(), nodeMatrices.begin(), nodeMatrices.end());
+}
+
+MaterialHandle ModelBatch::materialOf(const ModelDefinition& definition, const MeshMaterial& material,
+                                      const TextureResolver& textureOf, const DefaultTextures& defaults)
+{
+    // a texture still streaming in has no id yet
+    const auto texture = [&](const int index, const unsigned fallback) {
+        if (index < 0 || static_cast<size_t>(index) >= definition.textures.size()) return fallback;
+        const unsigned id = textureOf(definition.textures[index]);
+        return id != 0 ? id : fallback;
+    };
+
+    using Type = MaterialHandle::Material::Type;
+    MaterialHandle handle;
+    handle.materials = {
+        { "diffuse", texture(material.diffuse, defaults.diffuse), Type::TEXTURE_2D },
+        { "normal", texture(material.normal, defaults.normal), Type::TEXTURE_2D },
+        { "emissive", texture(material.emissive, defaults.emissive), Type::TEXTURE_2D },
+        { "roughness", texture(material.metallicRoughness, defaults.roughness), Type::TEXTURE_2D },
+    };
+    return handle;
+}
+
+void ModelBatch::build(RenderPassContext& ctx, const TextureResolver& textureOf, const DefaultTextures& defaults) {
+    Skeleton::writePalettes(skeletons, paletteOffsets, palettes.data());
+
+    instanceData.clear();
+    instanceData.reserve(matrices.size());
+
+    // instances of a definition become adjacent and keep the order they were added in
+    std::ranges::stable_sort(instances, std::ranges::less{}, &Instance::definition);
+
+    for (size_t first = 0; first < instances.size();) {
+        const ModelDefinition& definition = *instances[first].definition;
+        size_t last = first + 1;
+        while (last < instances.size() && instances[last].definition == &definition) ++last;
+        const auto count = static_cast<unsigned>(last - first);
+
+        for (size_t node = 0; node < definition.nodes.size(); ++node) {
+            for (const unsigned mesh : definition.nodes[node].meshes()) {
+                const auto& [drawParams, materialIndex] = definition.renderNodes[mesh];
+
+                Renderable& renderable = ctx.instances.emplace_back();
+                renderable.VAO = definition.geometry.VAO.id();
+                renderable.materials = materialOf(definition, definition.materials[materialIndex], textureOf, defaults);
+                renderable.cmd = {
+                    drawParams.indexCount, count, drawParams.indexOffset, drawParams.vertexOffset,
+                    static_cast<unsigned>(instanceData.size())
+                };
+
+                for (size_t i = first; i < last; ++i) {
+                    instanceData.push_back({ instances[i].firstMatrix + static_cast<uint32_t>(node), instances[i].palette });
+                }
+            }
+        }
+        first = last;
+    }
+}
+
+void ModelBatch::clear() {
+    instances.clear();
+    matrices.clear();
+    palettes.clear();
+    skeletons.clear();
+    paletteOffsets.clear();
+    instanceData.clear();
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <glm/mat4x4.hpp>
+#include <Core/Model/Model.h>
+
+#include "RenderQueue.h"
+
+/*
+ * One frame of model instances, drawn with one indirect command per mesh rather than per mesh and instance.
+ * Every added instance appends its node matrices, and its bone palette if skinned, to flat arrays. build() groups
+ * the instances by definition and emits a renderable per mesh whose command draws all of them; instance i of that
+ * command reads InstanceData[baseInstance + i] to find its matrix and palette. Palettes are only reserved by add();
+ * build() brings all of the frame's skeletons up to date and writes them in one Skeleton::writePalettes pass.
+ */
+class ModelBatch {
+public:
+    constexpr static uint32_t NO_PALETTE = ~0u;
+
+    /* std430 element of the instance buffer */
+    struct InstanceData {
+        uint32_t matrix;
+        uint32_t palette;
+    };
+
+    /* bound for the material slots a mesh leaves empty */
+    struct DefaultTextures {
+        unsigned diffuse = 0;
+        unsigned normal = 0;
+        unsigned emissive = 0;
+        unsigned roughness = 0;
+    };
+
+    using TextureResolver = std::function<unsigned(Texture2DKey)>;
+
+    /*
+     * `nodeMatrices` are the instance's world matrices indexed by node. The definition and skeleton must outlive the
+     * frame, and a skeleton is added at most once per frame.
+     */
+    void add(const ModelDefinition& definition, std::span<const glm::mat4> nodeMatrices, Skeleton* skeleton = nullptr);
+
+    /* appends a renderable per mesh and instanced definition to `ctx`, and fills the instance data they index */
+    void build(RenderPassContext& ctx, const TextureResolver& textureOf, const DefaultTextures& defaults);
+
+    void clear();
+
+    bool empty() const {
+        return instances.empty();
+    }
+
+    size_t size() const {
+        return instances.size();
+    }
+
+    std::span<const glm::mat4> getMatrices() const {
+        return matrices;
+    }
+
+    std::span<const glm::mat4> getPalettes() const {
+        return palettes;
+    }
+
+    std::span<const InstanceData> getInstanceData() const {
+        return instanceData;
+    }
+
+private:
+    struct Instance {
+        const ModelDefinition* definition;
+        uint32_t firstMatrix;
+        uint32_t palette;
+    };
+
+    static MaterialHandle materialOf(const ModelDefinition& definition, const MeshMaterial& material,
+                                     const TextureResolver& textureOf, const DefaultTextures& defaults);
+
+    std::vector<Instance> instances;
+    std::vector<glm::mat4> matrices;
+    std::vector<glm::mat4> palettes;
+    std::vector<Skeleton*> skeletons;
+    std::vector<uint32_t> paletteOffsets;
+    std::vector<InstanceData> instanceData;
+};
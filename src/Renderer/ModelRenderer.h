@@ -1,26 +1,42 @@
 #pragma once
+#include <span>
+#include <memory>
+#include <optional>
+#include <openGL/BufferObjects/PersistentBuffer.h>
 #include "Resource/Resource.h"
+#include "ModelBatch.h"
+#include "RenderQueue.h"
+#include "RenderDevice.h"
 
 struct ModelGraphUpdateSystem;
 
-class ModelUploadSystem : RendererInStage::WritesResources<BufferSystem, ModelSystem> {
+class ModelUploadSystem : RendererInStage::WritesResources<ModelSystem, TextureSystem> {
     FRIEND_DESCRIPTOR
 
-    BufferKey buffer;
-    BufferView<glm::mat4> matrices{};
-
     ShaderKey modelShader;
 
-    const ModelDefinition* def = nullptr;
-    const Model* model;
+    /* the instances sent this frame, drawn and cleared by onRender */
+    ModelBatch batch;
+    RenderQueue queue;
+    GLRenderDevice device;
+
+    /* the matrix, instance and palette storage of the frames in flight */
+    std::optional<PersistentRing> frameBuffers;
+    constexpr static size_t FRAME_BYTES = 256 * 1024;
+    /* of texture mips uploaded per frame */
+    constexpr static size_t TEXTURE_UPLOAD_BYTES = 8 << 20;
+
+    template <typename T>
+    BufferHandle upload(const std::span<const T> data, const unsigned binding) {
+        const auto allocation = frameBuffers->upload(data);
+        return { BufferHandleTarget::SSBO, allocation.buffer, binding, allocation.offset, allocation.bytes };
+    }
 public:
     ModelUploadSystem() = default;
 
     void onRendererLoad(RendererLoadView<ModelUploadSystem> view) {
-        buffer = view.createBuffer(sizeof(glm::mat4) * 128);
-        matrices = view.getBuffer<glm::mat4>(buffer);
-
         modelShader = view.loadShader("shaders/Mesh/mesh_vertex.glsl", "shaders/Mesh/mesh_frag.glsl", "MeshShader");
+        frameBuffers.emplace(std::make_unique<GLPersistentBackend>(GL_SHADER_STORAGE_BUFFER), FRAME_BYTES);
 
         MeshMaterial::createDefaultEmissive();
         MeshMaterial::createDefaultRoughnessMetallic();
@@ -31,77 +47,53 @@ public:
         for (auto& def : view.read<NewModelDefinition>()) {
             view.loadModel(def);
         }
+        view.streamTextures(TEXTURE_UPLOAD_BYTES);
     }
 
-    void onUpload(const Model& model) {
-        auto finalTransforms = model.getFinalTransforms();
-        memcpy(matrices.data(), finalTransforms.data(), finalTransforms.size() * sizeof(glm::mat4));
-        def = model.asset();
-        this->model = &model;
+    void onUpload(const Model& model, Skeleton* skeleton = nullptr) {
+        const auto finalTransforms = model.getFinalTransforms();
+        batch.add(*model.asset(), { finalTransforms.data(), finalTransforms.size() }, skeleton);
     }
 
     void onRender(ForwardRenderView<ModelUploadSystem> view) {
-        if (!def) return;
-        const auto& shader = view.setActiveShader("MeshShader");
-
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, view.getBufferID(buffer));
-
-        def->geometry.VAO.bind();
-
-        UniformData uniforms(shader.id());
-
-        GLuint loc = glGetUniformLocation(shader.id(), "matrices");
-
-        glUniformMatrix4fv(
-            loc,
-            6,
-            GL_FALSE,
-            (float*)model->getFinalTransforms().data()
-        );
-
-
-        int i = 0;
-        for (auto& node : def->nodes) {
-            for (auto meshIndex : node.meshes()) {
-                auto& [drawParams, materialIndex] = def->renderNodes[meshIndex];
-                auto& material = def->materials[materialIndex];
-
-                Texture2D& texture = view.getTexture(def->textures[material.diffuse]);
-
-                texture.bind(0);
-
-                MeshMaterial::DEFAULT_NORMAL.bind(1);
-                MeshMaterial::DEFAULT_EMISSIVE.bind(2);
-                MeshMaterial::DEFAULT_ROUGHNESS_METALLIC.bind(3);
-
-                uniforms.upload_nowrite("diffuse", 0);
-                uniforms.upload_nowrite("normal", 1);
-                uniforms.upload_nowrite("emissive", 2);
-                uniforms.upload_nowrite("roughness", 3);
-
-                uniforms.upload_nowrite("index", i);
-                i++;
-
-                glDrawElementsBaseVertex(
-                    GL_TRIANGLES, drawParams.indexCount,
-                    GL_UNSIGNED_INT, (void*)(drawParams.indexOffset * sizeof(unsigned int)),
-                    drawParams.vertexOffset
-                );
-            }
-
-        }
-        def = nullptr;
+        if (batch.empty()) return;
+
+        RenderPassContext ctx;
+        ctx.shader = "MeshShader";
+
+        const ModelBatch::DefaultTextures defaults = {
+            MeshMaterial::DEFAULT_DIFFUSE.id(),
+            MeshMaterial::DEFAULT_NORMAL.id(),
+            MeshMaterial::DEFAULT_EMISSIVE.id(),
+            MeshMaterial::DEFAULT_ROUGHNESS_METALLIC.id()
+        };
+        batch.build(ctx, [&](const Texture2DKey key) { return view.getTexture(key).id(); }, defaults);
+
+        frameBuffers->beginFrame();
+        ctx.buffers.push_back(upload(batch.getMatrices(), 1));
+        ctx.buffers.push_back(upload(batch.getInstanceData(), 2));
+        if (!batch.getPalettes().empty()) ctx.buffers.push_back(upload(batch.getPalettes(), 3));
+
+        device.setShaderResolver([&](const std::string&) {
+            return static_cast<unsigned>(view.setActiveShader(modelShader).id());
+        });
+        queue.add(ctx);
+        queue.submit(device);
+        queue.clear();
+        frameBuffers->endFrame();
+        batch.clear();
     }
 };
 
 
-class ModelSendSystem : Reads<Model>, Dependencies<ModelGraphUpdateSystem> {
+class ModelSendSystem : Reads<Model>, Writes<Skeleton>, Dependencies<ModelGraphUpdateSystem> {
 public:
     FRIEND_DESCRIPTOR
 
     static void onLevelOut(LevelOutView<ModelSendSystem> view) {
-        view.query<Model>().forEach([&](const Model& model) {
-            view.getRendererSystem<ModelUploadSystem>().onUpload(model);
+        auto& upload = view.getRendererSystem<ModelUploadSystem>();
+        view.query<Model>().forEach([&](const Entity e, const Model& model) {
+            upload.onUpload(model, view.get<Skeleton>(e));
         });
     }
 };
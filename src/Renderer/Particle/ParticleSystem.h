@@ -41,11 +41,27 @@ class ParticleSystem_ {
     bool InOutSSBO = 0;
 
     std::vector<GPUParticle> newParticleBuffer;
+
+    struct Shaders {
+        ShaderKey clear, eval, append, appendCounts, scale, color, force, draw;
+    } shaders;
 public:
     ParticleSystem_() = default;
 
     ParticleSystem_(const size_t max);
 
+    /* the shaders are loaded by RenderingSystem, their handles are looked up once here */
+    void findShaders(auto& view) {
+        shaders.clear = view.getShaderKey("ParticleClearShader");
+        shaders.eval = view.getShaderKey("ParticleEvalShader");
+        shaders.append = view.getShaderKey("ParticleBufferAppendShader");
+        shaders.appendCounts = view.getShaderKey("ParticleBufferAppendCountsShader");
+        shaders.scale = view.getShaderKey("ParticleScaleShader");
+        shaders.color = view.getShaderKey("ParticleColorShader");
+        shaders.force = view.getShaderKey("ParticleForceShader");
+        shaders.draw = view.getShaderKey("ParticleShader");
+    }
+
     void render(Viewable<ForwardRenderStage> auto view, const Geometry& geom) {
         auto now = std::chrono::high_resolution_clock::now();
 
@@ -56,13 +72,13 @@ public:
         indirectDispatch.setToBindingPoint(5);
         // 6 reserved
 
-        ComputeShader *shader = &view.setActiveComputeShader("ParticleClearShader");
+        ComputeShader *shader = &view.setActiveComputeShader(shaders.clear);
         UniformData uniforms(shader->id());
         uniforms.upload_nowrite("u_count", static_cast<int>(geom.indices.size()));
         glDispatchCompute(1, 1, 1);
         glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
-        shader = &view.setActiveComputeShader("ParticleEvalShader");
+        shader = &view.setActiveComputeShader(shaders.eval);
         uniforms.setProgram(shader->id());
         indirectDispatch.bind();
         glDispatchComputeIndirect(0);
@@ -72,7 +88,7 @@ public:
             newParticles.overwrite(newParticleBuffer.size() * sizeof(GPUParticle), BufferUsage::STREAM, newParticleBuffer.data());
             newParticles.setToBindingPoint(6);
 
-            shader = &view.setActiveComputeShader("ParticleBufferAppendShader");
+            shader = &view.setActiveComputeShader(shaders.append);
             uniforms.setProgram(shader->id());
             uniforms.upload_nowrite("particleCount", (int)newParticleBuffer.size());
             uniforms.upload_nowrite("maxParticles", (int)maxParticles);
@@ -80,7 +96,7 @@ public:
             glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
 
-            shader = &view.setActiveComputeShader("ParticleBufferAppendCountsShader");
+            shader = &view.setActiveComputeShader(shaders.appendCounts);
             uniforms.setProgram(shader->id());
             uniforms.upload_nowrite("particleCount", (int)newParticleBuffer.size());
             glDispatchCompute(1, 1, 1);
@@ -90,7 +106,7 @@ public:
             newParticleBuffer.clear();
         }
 
-        shader = &view.setActiveComputeShader("ParticleScaleShader");
+        shader = &view.setActiveComputeShader(shaders.scale);
         uniforms.setProgram(shader->id());
         uniforms.upload_nowrite("SCALE_TYPE", 1);
         uniforms.upload_nowrite("minScale", 1.f);
@@ -106,7 +122,7 @@ public:
         auto tex = color.toTexture(256);
         glBindTexture(GL_TEXTURE_1D, tex.id());
 
-        shader = &view.setActiveComputeShader("ParticleColorShader");
+        shader = &view.setActiveComputeShader(shaders.color);
         uniforms.setProgram(shader->id());
         uniforms.upload_nowrite("COLOR_TYPE", 1);
         uniforms.upload_nowrite("colorSampler", 0);
@@ -114,7 +130,7 @@ public:
         glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
 
 
-        shader = &view.setActiveComputeShader("ParticleForceShader");
+        shader = &view.setActiveComputeShader(shaders.force);
         uniforms.setProgram(shader->id());
         uniforms.upload_nowrite("FORCE_TYPE", 1);
         uniforms.upload_nowrite("minVelocity", glm::vec3(-10));
@@ -129,7 +145,7 @@ public:
 
 
         InOutSSBO = !InOutSSBO;
-        view.setActiveShader("ParticleShader");
+        view.setActiveShader(shaders.draw);
         buffer[InOutSSBO].setToBindingPoint(PARTICLE_IN_INDEX);
         geom.VAO.bind();
         indirectDraw.bind();
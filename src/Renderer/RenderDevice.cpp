@@ -0,0 +1,78 @@
+#include "RenderDevice.h"
+
+#include <gl/glew.h>
+#include <algorithm>
+
+GLRenderDevice::~GLRenderDevice() {
+    if (commandBuffer) glDeleteBuffers(1, &commandBuffer);
+}
+
+void GLRenderDevice::useShader(const std::string& shader) {
+    program = programOf(shader);
+    locations = &programLocations[program];
+}
+
+int GLRenderDevice::uniformLocation(const std::string& name) {
+    const auto [it, inserted] = locations->try_emplace(name);
+    if (inserted) {
+        it->second.location = glGetUniformLocation(program, name.c_str());
+    }
+    return it->second.location;
+}
+
+void GLRenderDevice::uploadUniforms(UniformData& uniforms) {
+    uniforms.setProgram(program);
+    for (const auto& [name, uniform] : uniforms) {
+        UniformData::upload(uniformLocation(name), uniform);
+    }
+}
+
+void GLRenderDevice::bindBuffer(const BufferHandle& buffer) {
+    const GLenum target = buffer.target == BufferHandleTarget::SSBO ? GL_SHADER_STORAGE_BUFFER : GL_UNIFORM_BUFFER;
+    if (buffer.bytes) {
+        glBindBufferRange(target, buffer.location, buffer.handle, static_cast<GLintptr>(buffer.offset), static_cast<GLsizeiptr>(buffer.bytes));
+    } else {
+        glBindBufferBase(target, buffer.location, buffer.handle);
+    }
+}
+
+void GLRenderDevice::bindVertexArray(const unsigned VAO) {
+    glBindVertexArray(VAO);
+}
+
+void GLRenderDevice::bindMaterials(const MaterialHandle& materials, const unsigned firstUnit) {
+    unsigned unit = firstUnit;
+    for (const auto& material : materials.materials) {
+        const GLenum target = material.type == MaterialHandle::Material::Type::TEXTURE_ARRAY_2D ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, material.texture);
+
+        // a sampler keeps its unit in the program, so it is only set when it moves
+        Location& sampler = (*locations)[material.material];
+        if (sampler.location == Location::UNKNOWN) {
+            sampler.location = glGetUniformLocation(program, material.material.c_str());
+        }
+        if (sampler.value != static_cast<int>(unit)) {
+            glProgramUniform1i(program, sampler.location, static_cast<int>(unit));
+            sampler.value = static_cast<int>(unit);
+        }
+        ++unit;
+    }
+}
+
+void GLRenderDevice::uploadCommands(const std::span<const DrawElementsIndirectCommand> commands) {
+    if (!commandBuffer) glGenBuffers(1, &commandBuffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+
+    const size_t bytes = commands.size_bytes();
+    if (bytes > commandCapacity) {
+        commandCapacity = std::max(bytes, commandCapacity * 2);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(commandCapacity), nullptr, GL_DYNAMIC_DRAW);
+    }
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, static_cast<GLsizeiptr>(bytes), commands.data());
+}
+
+void GLRenderDevice::multiDrawIndirect(const uint32_t firstCommand, const uint32_t count) {
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+        reinterpret_cast<const void*>(firstCommand * sizeof(DrawElementsIndirectCommand)), static_cast<GLsizei>(count), 0);
+}
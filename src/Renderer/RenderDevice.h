@@ -0,0 +1,143 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <utility>
+#include <unordered_map>
+#include "RenderQueue.h"
+
+/*
+ * The GL calls RenderQueue::submit makes. GLRenderDevice forwards them to the driver, RecordingRenderDevice
+ * only records them so batching and state changes can be checked without a context.
+ */
+class RenderDevice {
+public:
+    virtual ~RenderDevice() = default;
+
+    virtual void useShader(const std::string& shader) = 0;
+    virtual void uploadUniforms(UniformData& uniforms) = 0;
+    virtual void bindBuffer(const BufferHandle& buffer) = 0;
+    virtual void bindVertexArray(unsigned VAO) = 0;
+    /* binds the textures to consecutive units starting at `firstUnit`, pointing the named samplers at them */
+    virtual void bindMaterials(const MaterialHandle& materials, unsigned firstUnit) = 0;
+    virtual void uploadCommands(std::span<const DrawElementsIndirectCommand> commands) = 0;
+    virtual void multiDrawIndirect(uint32_t firstCommand, uint32_t count) = 0;
+};
+
+class GLRenderDevice : public RenderDevice {
+    /* a uniform's location in one program, and for samplers the unit last set */
+    struct Location {
+        constexpr static int UNKNOWN = -2;
+
+        int location = UNKNOWN;
+        int value = -1;
+    };
+    using ProgramLocations = std::unordered_map<std::string, Location>;
+
+    std::function<unsigned(const std::string&)> programOf;
+    unsigned program = 0;
+    std::unordered_map<unsigned, ProgramLocations> programLocations;
+    ProgramLocations* locations = nullptr;
+    unsigned commandBuffer = 0;
+    size_t commandCapacity = 0;
+
+    int uniformLocation(const std::string& name);
+public:
+    GLRenderDevice() = default;
+
+    GLRenderDevice(const GLRenderDevice&) = delete;
+    GLRenderDevice& operator=(const GLRenderDevice&) = delete;
+
+    GLRenderDevice(GLRenderDevice&& other) noexcept
+        : programOf(std::move(other.programOf)), program(other.program),
+          programLocations(std::move(other.programLocations)), locations(std::exchange(other.locations, nullptr)),
+          commandBuffer(std::exchange(other.commandBuffer, 0)), commandCapacity(std::exchange(other.commandCapacity, 0)) {}
+
+    ~GLRenderDevice() override;
+
+    /*
+     * Resolves shader names to program ids and makes the program current, e.g. through ShaderSystem's setActiveShader.
+     * Uniform locations are cached per program id, so programs must not be relinked while the device is in use.
+     */
+    void setShaderResolver(std::function<unsigned(const std::string&)> resolver) {
+        programOf = std::move(resolver);
+    }
+
+    void useShader(const std::string& shader) override;
+    void uploadUniforms(UniformData& uniforms) override;
+    void bindBuffer(const BufferHandle& buffer) override;
+    void bindVertexArray(unsigned VAO) override;
+    void bindMaterials(const MaterialHandle& materials, unsigned firstUnit) override;
+    void uploadCommands(std::span<const DrawElementsIndirectCommand> commands) override;
+    void multiDrawIndirect(uint32_t firstCommand, uint32_t count) override;
+};
+
+class RecordingRenderDevice : public RenderDevice {
+public:
+    enum class CallType {
+        USE_SHADER,
+        UPLOAD_UNIFORMS,
+        BIND_BUFFER,
+        BIND_VERTEX_ARRAY,
+        BIND_MATERIALS,
+        UPLOAD_COMMANDS,
+        MULTI_DRAW_INDIRECT
+    };
+
+    struct Call {
+        CallType type;
+        uint32_t first = 0;
+        uint32_t second = 0;
+    };
+
+    std::vector<Call> calls;
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<std::string> shaders;
+
+    void useShader(const std::string& shader) override {
+        calls.push_back({ CallType::USE_SHADER, static_cast<uint32_t>(shaders.size()) });
+        shaders.push_back(shader);
+    }
+
+    void uploadUniforms(UniformData&) override {
+        calls.push_back({ CallType::UPLOAD_UNIFORMS });
+    }
+
+    void bindBuffer(const BufferHandle& buffer) override {
+        calls.push_back({ CallType::BIND_BUFFER, buffer.handle, buffer.location });
+    }
+
+    void bindVertexArray(const unsigned VAO) override {
+        calls.push_back({ CallType::BIND_VERTEX_ARRAY, VAO });
+    }
+
+    void bindMaterials(const MaterialHandle& materials, const unsigned firstUnit) override {
+        calls.push_back({ CallType::BIND_MATERIALS, static_cast<uint32_t>(materials.hash()), firstUnit });
+    }
+
+    void uploadCommands(const std::span<const DrawElementsIndirectCommand> uploaded) override {
+        calls.push_back({ CallType::UPLOAD_COMMANDS, static_cast<uint32_t>(uploaded.size()) });
+        commands.assign(uploaded.begin(), uploaded.end());
+    }
+
+    void multiDrawIndirect(const uint32_t firstCommand, const uint32_t count) override {
+        calls.push_back({ CallType::MULTI_DRAW_INDIRECT, firstCommand, count });
+    }
+
+    size_t count(const CallType type) const {
+        size_t n = 0;
+        for (const auto& call : calls) {
+            n += call.type == type;
+        }
+        return n;
+    }
+
+    void clear() {
+        calls.clear();
+        commands.clear();
+        shaders.clear();
+    }
+};
@@ -0,0 +1,188 @@
+#include "RenderQueue.h"
+#include "RenderDevice.h"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+
+std::optional<uint64_t> RenderQueue::encode(const uint32_t pass, const uint32_t context, const uint32_t vao, const uint32_t material, const uint32_t depthBucket) {
+    if (pass >> PASS_BITS || context >> CONTEXT_BITS || vao >> VAO_BITS || material >> MATERIAL_BITS || depthBucket >> DEPTH_BITS) {
+        return std::nullopt;
+    }
+
+    return uint64_t(pass) << PASS_SHIFT
+         | uint64_t(context) << CONTEXT_SHIFT
+         | uint64_t(vao) << VAO_SHIFT
+         | uint64_t(material) << MATERIAL_SHIFT
+         | uint64_t(depthBucket) << DEPTH_SHIFT;
+}
+
+void RenderQueue::clear() {
+    contexts.clear();
+    vaos.clear();
+    vaoIndices.clear();
+    materials.clear();
+    materialIndices.clear();
+    keys.clear();
+    queuedCommands.clear();
+    commands.clear();
+    batches.clear();
+    built = false;
+    dropped = 0;
+}
+
+uint32_t RenderQueue::internVAO(const unsigned VAO) {
+    const auto [it, inserted] = vaoIndices.try_emplace(VAO, static_cast<uint32_t>(vaos.size()));
+    if (inserted) {
+        vaos.push_back(VAO);
+    }
+    return it->second;
+}
+
+uint32_t RenderQueue::internMaterial(const MaterialHandle& handle) {
+    const auto [it, inserted] = materialIndices.try_emplace(handle, static_cast<uint32_t>(materials.size()));
+    if (inserted) {
+        materials.push_back(&it->first);
+    }
+    return it->second;
+}
+
+void RenderQueue::add(const RenderPassContext& ctx) {
+    if (ctx.instances.empty()) return;
+    if (contexts.size() >> CONTEXT_BITS) {
+        std::cerr << "[ERROR] RenderQueue: more than " << (1u << CONTEXT_BITS) << " contexts this frame, dropping "
+                  << ctx.instances.size() << " draws of " << ctx.shader << std::endl;
+        dropped += ctx.instances.size();
+        return;
+    }
+
+    const auto context = static_cast<uint32_t>(contexts.size());
+    contexts.emplace_back(ctx.shader, ctx.uniforms, ctx.materials, ctx.buffers);
+    built = false;
+
+    constexpr uint32_t maxPass = (1u << PASS_BITS) - 1;
+    const uint32_t pass = std::min<uint32_t>(ctx.pass, maxPass);
+    constexpr uint32_t maxBucket = (1u << DEPTH_BITS) - 1;
+    const float depthScale = maxDepth > 0.f ? static_cast<float>(maxBucket) / maxDepth : 0.f;
+
+    keys.reserve(keys.size() + ctx.instances.size());
+    queuedCommands.reserve(queuedCommands.size() + ctx.instances.size());
+
+    size_t overflowed = 0;
+    for (const Renderable& renderable : ctx.instances) {
+        // also catches NaN depths, which clamp would pass through
+        const float bucket = renderable.depth * depthScale > 0.f ? std::min(renderable.depth * depthScale, static_cast<float>(maxBucket)) : 0.f;
+
+        const auto key = encode(pass, context, internVAO(renderable.VAO), internMaterial(renderable.materials), static_cast<uint32_t>(bucket));
+        if (!key) {
+            ++overflowed;
+            continue;
+        }
+
+        keys.push_back({ *key, static_cast<uint32_t>(queuedCommands.size()) });
+        queuedCommands.push_back(renderable.cmd);
+    }
+
+    if (overflowed) {
+        std::cerr << "[ERROR] RenderQueue: more than " << (1u << VAO_BITS) << " VAOs or " << (1u << MATERIAL_BITS)
+                  << " materials this frame, dropping " << overflowed << " draws of " << ctx.shader << std::endl;
+        dropped += overflowed;
+    }
+    if (ctx.pass > maxPass) {
+        std::cerr << "[ERROR] RenderQueue: pass " << unsigned(ctx.pass) << " of " << ctx.shader << " drawn as pass " << maxPass << std::endl;
+    }
+}
+
+/* LSD radix sort on 8 bit digits, skipping digits every key shares. Stable, so equal keys keep submission order */
+void RenderQueue::radixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch) {
+    constexpr int DIGITS = sizeof(uint64_t);
+    std::array<std::array<uint32_t, 256>, DIGITS> histograms{};
+
+    for (const SortItem& item : items) {
+        for (int d = 0; d < DIGITS; ++d) {
+            ++histograms[d][item.key >> (d * 8) & 0xFF];
+        }
+    }
+
+    scratch.resize(items.size());
+    for (int d = 0; d < DIGITS; ++d) {
+        auto& histogram = histograms[d];
+        if (histogram[items[0].key >> (d * 8) & 0xFF] == items.size()) continue;
+
+        uint32_t offset = 0;
+        for (auto& count : histogram) {
+            const uint32_t c = count;
+            count = offset;
+            offset += c;
+        }
+        for (const SortItem& item : items) {
+            scratch[histogram[item.key >> (d * 8) & 0xFF]++] = item;
+        }
+        items.swap(scratch);
+    }
+}
+
+void RenderQueue::build() {
+    commands.clear();
+    batches.clear();
+    built = true;
+    if (keys.empty()) return;
+
+    radixSort(keys, scratch);
+
+    commands.reserve(keys.size());
+    for (const auto& [key, index] : keys) {
+        if (batches.empty() || batches.back().key >> MATERIAL_SHIFT != key >> MATERIAL_SHIFT) {
+            batches.push_back({ key, static_cast<uint32_t>(commands.size()), 0 });
+        }
+        commands.push_back(queuedCommands[index]);
+        ++batches.back().commandCount;
+    }
+}
+
+void RenderQueue::submit(RenderDevice& device) {
+    if (!built) build();
+    if (commands.empty()) return;
+
+    device.uploadCommands(commands);
+
+    constexpr uint32_t NONE = ~0u;
+    uint32_t context = NONE, vao = NONE, material = NONE;
+    const std::string* shader = nullptr;
+
+    for (const auto& [key, firstCommand, commandCount] : batches) {
+        const uint32_t batchContext = field(key, CONTEXT_SHIFT, CONTEXT_BITS);
+        Context& ctx = contexts[batchContext];
+
+        if (batchContext != context) {
+            if (!shader || *shader != ctx.shader) {
+                device.useShader(ctx.shader);
+                shader = &ctx.shader;
+            }
+            device.uploadUniforms(ctx.uniforms);
+            for (const auto& buffer : ctx.buffers) {
+                device.bindBuffer(buffer);
+            }
+            if (!ctx.materials.empty()) {
+                device.bindMaterials(ctx.materials, 0);
+            }
+            context = batchContext;
+            // per draw materials are bound after the context's own, so they move with it
+            material = NONE;
+        }
+
+        if (const uint32_t batchVAO = field(key, VAO_SHIFT, VAO_BITS); batchVAO != vao) {
+            device.bindVertexArray(vaos[batchVAO]);
+            vao = batchVAO;
+        }
+
+        if (const uint32_t batchMaterial = field(key, MATERIAL_SHIFT, MATERIAL_BITS); batchMaterial != material) {
+            if (!materials[batchMaterial]->empty()) {
+                device.bindMaterials(*materials[batchMaterial], static_cast<unsigned>(ctx.materials.materials.size()));
+            }
+            material = batchMaterial;
+        }
+
+        device.multiDrawIndirect(firstCommand, commandCount);
+    }
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <openGL/shaders/UniformData.h>
+#include "RenderingDetails.h"
+
+class RenderDevice;
+
+struct MaterialHandle {
+    struct Material {
+        enum class Type {
+            TEXTURE_2D, TEXTURE_ARRAY_2D
+        };
+        std::string material;
+        unsigned texture;
+        Type type;
+    };
+    std::vector<Material> materials;
+    bool operator==(const MaterialHandle& other) const {
+        if (materials.size() != other.materials.size()) return false;
+        for (size_t i = 0; i < materials.size(); ++i) {
+            if (materials[i].texture != other.materials[i].texture)
+                return false;
+        }
+        return true;
+    }
+
+    size_t hash() const {
+        size_t hashValue = 0;
+        for (const auto& mat : materials) {
+            hashValue ^= std::hash<unsigned>()(mat.texture) + 0x9e3779b9 + (hashValue << 6) + (hashValue >> 2);
+        }
+        return hashValue;
+    }
+
+    bool empty() const {
+        return materials.empty();
+    }
+};
+
+enum class BufferHandleTarget {
+    SSBO, UBO
+};
+
+struct BufferHandle {
+    BufferHandleTarget target;
+    unsigned handle;
+    unsigned location;
+    /* the range bound, the whole buffer if `bytes` is 0 */
+    size_t offset = 0;
+    size_t bytes = 0;
+};
+
+struct Renderable {
+    unsigned VAO;
+    MaterialHandle materials;
+    DrawElementsIndirectCommand cmd;
+    /* view distance, only used to order draws within the same state */
+    float depth = 0.f;
+};
+
+struct RenderPassContext {
+    std::string shader;
+    UniformData uniforms;
+    MaterialHandle materials;
+    std::vector<BufferHandle> buffers;
+    std::vector<Renderable> instances;
+    bool isSorted = false;
+    /* passes draw in ascending order */
+    uint8_t pass = 0;
+};
+
+/*
+ * Sorts a frame's renderables by GL state and submits them as multi-draw-indirect ranges.
+ *
+ * Every renderable is encoded once into a 64-bit key, most significant first:
+ *   pass | context (its shader, uniforms and buffers) | VAO | material | depth bucket
+ * VAOs and materials are interned per frame, so a material is hashed once instead of on every comparison.
+ * The keys are radix sorted and each run of keys that only differ in depth becomes one indirect draw.
+ *
+ * Depths past maxDepth and passes past the last one are clamped. Contexts, VAOs and materials past what their
+ * fields index in a frame cannot be told apart, so their draws are dropped and reported.
+ */
+class RenderQueue {
+public:
+    constexpr static int PASS_BITS = 4;
+    constexpr static int CONTEXT_BITS = 12;
+    constexpr static int VAO_BITS = 16;
+    constexpr static int MATERIAL_BITS = 20;
+    constexpr static int DEPTH_BITS = 12;
+
+    static_assert(PASS_BITS + CONTEXT_BITS + VAO_BITS + MATERIAL_BITS + DEPTH_BITS == 64);
+
+    constexpr static int DEPTH_SHIFT = 0;
+    constexpr static int MATERIAL_SHIFT = DEPTH_SHIFT + DEPTH_BITS;
+    constexpr static int VAO_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+    constexpr static int CONTEXT_SHIFT = VAO_SHIFT + VAO_BITS;
+    constexpr static int PASS_SHIFT = CONTEXT_SHIFT + CONTEXT_BITS;
+
+    struct Batch {
+        uint64_t key;
+        uint32_t firstCommand;
+        uint32_t commandCount;
+    };
+
+    /* nothing if a field does not fit its bits */
+    static std::optional<uint64_t> encode(uint32_t pass, uint32_t context, uint32_t vao, uint32_t material, uint32_t depthBucket);
+
+    static uint32_t field(const uint64_t key, const int shift, const int bits) {
+        return static_cast<uint32_t>(key >> shift & ((uint64_t(1) << bits) - 1));
+    }
+
+    /* quantizes [0, maxDepth] to the depth bucket, front to back */
+    void setMaxDepth(float depth) {
+        maxDepth = depth;
+    }
+
+    void clear();
+
+    /* encodes the context's instances; the pass state is copied, the instances are not kept */
+    void add(const RenderPassContext& ctx);
+
+    /* sorts and merges the queued draws, done by submit if needed */
+    void build();
+
+    void submit(RenderDevice& device);
+
+    const std::vector<Batch>& getBatches() const {
+        return batches;
+    }
+
+    const std::vector<DrawElementsIndirectCommand>& getCommands() const {
+        return commands;
+    }
+
+    size_t size() const {
+        return keys.size();
+    }
+
+    /* draws added since the last clear that did not fit the key */
+    size_t getDropped() const {
+        return dropped;
+    }
+
+private:
+    struct Context {
+        std::string shader;
+        UniformData uniforms;
+        MaterialHandle materials;
+        std::vector<BufferHandle> buffers;
+    };
+
+    struct SortItem {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    struct MaterialHash {
+        size_t operator()(const MaterialHandle& handle) const {
+            return handle.hash();
+        }
+    };
+
+    static void radixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch);
+
+    uint32_t internVAO(unsigned VAO);
+    uint32_t internMaterial(const MaterialHandle& materials);
+
+    std::vector<Context> contexts;
+    std::vector<unsigned> vaos;
+    std::unordered_map<unsigned, uint32_t> vaoIndices;
+    std::vector<const MaterialHandle*> materials;
+    std::unordered_map<MaterialHandle, uint32_t, MaterialHash> materialIndices;
+
+    std::vector<SortItem> keys;
+    std::vector<SortItem> scratch;
+    std::vector<DrawElementsIndirectCommand> queuedCommands;
+
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<Batch> batches;
+    bool built = false;
+    size_t dropped = 0;
+    float maxDepth = 1024.f;
+};
@@ -7,19 +7,24 @@
 #include "Resource/BufferSystem.h"
 
 struct ShaderBindingsAccess {
-    void setActiveShader(this auto&& self, ShaderKey key) {
-        self.template getSystem<ShaderSystem>().getShader(key).setActiveShader();
+    Shader& setActiveShader(this auto&& self, const ShaderKey key) {
+        auto& shader = self.template getSystem<ShaderSystem>().getShader(key);
+        shader.setActiveShader();
+        return shader;
     }
 
     Shader& setActiveShader(this auto&& self, const std::string_view name) {
-        auto& shaderSystem = self.template getSystem<ShaderSystem>();
-        auto& shader = shaderSystem.getShader(shaderSystem.getShaderKey(name.data()));
+        return self.setActiveShader(self.template getSystem<ShaderSystem>().getShaderKey(name));
+    }
+
+    ComputeShader& setActiveComputeShader(this auto&& self, const ShaderKey key) {
+        auto& shader = self.template getSystem<ShaderSystem>().getComputeShader(key);
         shader.setActiveShader();
         return shader;
     }
 
     ComputeShader& setActiveComputeShader(this auto&& self, const std::string_view name) {
-        return static_cast<ComputeShader&>(self.setActiveShader(name));
+        return self.setActiveComputeShader(self.template getSystem<ShaderSystem>().getShaderKey(name));
     }
 };
 
@@ -45,6 +50,10 @@ struct RenderResourceLoadAccess {
         return self.template getSystem<ModelSystem>().loadModel(definition, self.template getSystem<TextureSystem>());
     }
 
+    void streamTextures(this auto&& self, const size_t byteBudget) requires TextureAccess {
+        self.template getSystem<TextureSystem>().updateStreaming(byteBudget);
+    }
+
     BufferKey createBuffer(this auto&& self, const size_t capacity) requires BufferAccess {
         return self.template getSystem<BufferSystem>().create(capacity);
     }
@@ -56,6 +65,15 @@ struct RenderResourceLoadAccess {
 
 
 struct RenderResourceGetAccess {
+    /* names are for looking handles up once, when loading, draws should keep the handle */
+    ShaderKey getShaderKey(this auto&& self, const std::string_view name) {
+        return self.template getSystem<ShaderSystem>().getShaderKey(name);
+    }
+
+    GeometryKey getGeometryKey(this auto&& self, const std::string_view name) {
+        return self.template getSystem<GeometrySystem>().getGeometryKey(name);
+    }
+
     const Geometry& getGeometry(this auto&& self, GeometryKey key) {
         return self.template getSystem<GeometrySystem>().getGeometry(key);
     }
@@ -125,19 +143,24 @@ class RendererLoadView :
 public:
     using LevelSerialView<RendererLoadResources, S>::LevelSerialView;
 
-    void setActiveShader(this auto&& self, ShaderKey key) {
-        self.template getSystem<ShaderSystem>().getShader(key).setActiveShader();
+    Shader& setActiveShader(this auto&& self, const ShaderKey key) {
+        auto& shader = self.template getSystem<ShaderSystem>().getShader(key);
+        shader.setActiveShader();
+        return shader;
     }
 
     Shader& setActiveShader(this auto&& self, const std::string_view name) {
-        auto& shaderSystem = self.template getSystem<ShaderSystem>();
-        auto& shader = shaderSystem.getShader(shaderSystem.getShaderKey(name.data()));
+        return self.setActiveShader(self.template getSystem<ShaderSystem>().getShaderKey(name));
+    }
+
+    ComputeShader& setActiveComputeShader(this auto&& self, const ShaderKey key) {
+        auto& shader = self.template getSystem<ShaderSystem>().getComputeShader(key);
         shader.setActiveShader();
         return shader;
     }
 
     ComputeShader& setActiveComputeShader(this auto&& self, const std::string_view name) {
-        return static_cast<ComputeShader&>(self.setActiveShader(name));
+        return self.setActiveComputeShader(self.template getSystem<ShaderSystem>().getShaderKey(name));
     }
 };
 
@@ -248,19 +271,24 @@ public:
         return this->template getSystem<GeometrySystem>().getGeometry(name);
     }
 
-    void setActiveShader(this auto&& self, ShaderKey key) {
-        self.template getSystem<ShaderSystem>().getShader(key).setActiveShader();
+    Shader& setActiveShader(this auto&& self, const ShaderKey key) {
+        auto& shader = self.template getSystem<ShaderSystem>().getShader(key);
+        shader.setActiveShader();
+        return shader;
     }
 
     Shader& setActiveShader(this auto&& self, const std::string_view name) {
-        auto& shaderSystem = self.template getSystem<ShaderSystem>();
-        auto& shader = shaderSystem.getShader(shaderSystem.getShaderKey(name.data()));
+        return self.setActiveShader(self.template getSystem<ShaderSystem>().getShaderKey(name));
+    }
+
+    ComputeShader& setActiveComputeShader(this auto&& self, const ShaderKey key) {
+        auto& shader = self.template getSystem<ShaderSystem>().getComputeShader(key);
         shader.setActiveShader();
         return shader;
     }
 
     ComputeShader& setActiveComputeShader(this auto&& self, const std::string_view name) {
-        return static_cast<ComputeShader&>(self.setActiveShader(name));
+        return self.setActiveComputeShader(self.template getSystem<ShaderSystem>().getShaderKey(name));
     }
 
     unsigned getBufferID(const BufferKey key) {
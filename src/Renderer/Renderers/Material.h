@@ -2,10 +2,12 @@
 #include <openGL/Texture/Texture2D.h>
 
 struct MeshMaterial {
+    static Texture2D createDefaultDiffuse();
     static Texture2D createDefaultEmissive();
     static Texture2D createDefaultNormal();
     static Texture2D createDefaultRoughnessMetallic();
 
+    static Texture2D DEFAULT_DIFFUSE;
     static Texture2D DEFAULT_EMISSIVE;
     static Texture2D DEFAULT_NORMAL;
     static Texture2D DEFAULT_ROUGHNESS_METALLIC;
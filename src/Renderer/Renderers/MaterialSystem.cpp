@@ -27,7 +27,7 @@ Texture2D MaterialLoader::loadTexture(const char *file, TextureLoadParams params
         data.height, data.pixels, pattern.minFilter,
         pattern.magFilter, pattern.wrap, pattern.generateMipmaps, pattern.anisotropic
     );
-    return std::move(texture);
+    return texture;
 }
 
 Texture2D MaterialLoader::loadFile(const char *file, const TexturePattern *pat, const TextureLoadParams params) const {
@@ -96,7 +96,7 @@ TextureArray2D MaterialLoader::loadFolderArray(const char *path, const TextureLo
     if (result) {
         result->textures = std::move(textures);
     }
-    return std::move(array);
+    return array;
 }
 
 MaterialSystem::MaterialSystem() : textureArrays(10), texture2Ds(10) {
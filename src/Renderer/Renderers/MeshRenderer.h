@@ -404,7 +404,7 @@ public:
         glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
     }
 
-    RenderPassContext onRenderNew(const std::unordered_set<glm::ivec3, IVec3Hash> & visibleChunks) {
+    RenderPassContext onRenderNew(std::span<const glm::ivec3> visibleChunks) {
         RenderPassContext ctx;
         ctx.buffers.emplace_back(BufferHandleTarget::SSBO, meshModels.id(), 1);
         ctx.shader = "MeshShader";
@@ -3,6 +3,7 @@
 #include <openGL/DataTypeEnum.h>
 #include <iostream>
 #include <cassert>
+#include <cstring>
 #include <vector>
 #include <memory>
 
@@ -157,13 +157,17 @@ void RenderingSystem::initializeLightVolume() {
     lightConeVAO.addAttribute(3, 3, 0);
 }
 
-void RenderingSystem::readShaderBatch(RenderPassContext& ctx) {}
+void RenderingSystem::readShaderBatch(RenderPassContext& ctx) {
+    renderQueue.add(ctx);
+}
 
 void RenderingSystem::onRendererLoad(RendererLoadView<RenderingSystem> view) {
     particleSystem = ParticleSystem_(400);
     loadShaders(view);
+    particleSystem.findShaders(view);
     globalUniformsBuffer.allocate(sizeof(globalTransforms), BufferUsage::DYNAMIC);
 
+    MeshMaterial::DEFAULT_DIFFUSE = MeshMaterial::createDefaultDiffuse();
     MeshMaterial::DEFAULT_NORMAL = MeshMaterial::createDefaultNormal();
     MeshMaterial::DEFAULT_EMISSIVE = MeshMaterial::createDefaultEmissive();
     MeshMaterial::DEFAULT_ROUGHNESS_METALLIC = MeshMaterial::createDefaultRoughnessMetallic();
@@ -273,12 +277,20 @@ void RenderingSystem::onRender(ForwardRenderView<RenderingSystem> view) {
     glEnable(GL_CULL_FACE);
     glDisable(GL_BLEND);
     glDepthMask(GL_TRUE);
-    // render batches here
+
+    renderDevice.setShaderResolver([&](const std::string& shader) {
+        return static_cast<unsigned>(view.setActiveShader(shader).id());
+    });
+    renderQueue.setMaxDepth(currentCamera->viewDistance);
+    renderQueue.submit(renderDevice);
+    renderQueue.clear();
 
     // forwardBuffer.bind();
     // clear(ClearTarget::COLOR | ClearTarget::DEPTH);
     // glBindFramebuffer(GL_READ_FRAMEBUFFER, geometryBuffer.id());
     // glBindFramebuffer(GL_DRAW_FRAMEBUFFER, forwardBuffer.id());
     // glBlitFramebuffer(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, GL_DEPTH_BUFFER_BIT, GL_NEAREST);/
-    particleSystem.render(view, view.getGeometry("Icosahedron"));
+    // registered by the application after the renderer loaded
+    if (!icosahedron.isValid()) icosahedron = view.getGeometryKey("Icosahedron");
+    particleSystem.render(view, view.getGeometry(icosahedron));
 }
\ No newline at end of file
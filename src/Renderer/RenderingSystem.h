@@ -23,6 +23,8 @@
 #include <Core/World/FrustumCulling.h>
 
 #include "RendererOps.h"
+#include "RenderQueue.h"
+#include "RenderDevice.h"
 #include "Renderers/RenderInfo.h"
 
 class IRenderingSubsystem;
@@ -32,97 +34,14 @@ template <typename T>
 class Octree;
 struct OctreeNode;
 
-struct MaterialHandle {
-    struct Material {
-        enum class Type {
-            TEXTURE_2D, TEXTURE_ARRAY_2D
-        };
-        std::string material;
-        unsigned texture;
-        Type type;
-    };
-    std::vector<Material> materials;
-    bool operator==(const MaterialHandle& other) const {
-        if (materials.size() != other.materials.size()) return false;
-        for (size_t i = 0; i < materials.size(); ++i) {
-            if (materials[i].texture != other.materials[i].texture)
-                return false;
-        }
-        return true;
-    }
-
-    size_t hash() const {
-        size_t hashValue = 0;
-        for (const auto& mat : materials) {
-            hashValue ^= std::hash<unsigned>()(mat.texture) + 0x9e3779b9 + (hashValue << 6) + (hashValue >> 2);
-        }
-        return hashValue;
-    }
-
-    bool empty() const {
-        return materials.empty();
-    }
-};
-
-enum class BufferHandleTarget {
-    SSBO, UBO
-};
-
-struct BufferHandle {
-    BufferHandleTarget target;
-    unsigned handle;
-    unsigned location;
-};
-
-struct Renderable {
-    unsigned VAO;
-    MaterialHandle materials;
-    DrawElementsIndirectCommand cmd;
-};
-
-struct RenderPassContext {
-    std::string shader;
-    UniformData uniforms;
-    MaterialHandle materials;
-    std::vector<BufferHandle> buffers;
-    std::vector<Renderable> instances;
-    bool isSorted = false;
-};
-
 struct RenderScene {
     MaterialSystem& materials;
 };
 
-inline bool operator<(const Renderable& a, const Renderable& b) {
-    if (a.VAO != b.VAO)
-        return a.VAO < b.VAO;
-    return a.materials.hash() < b.materials.hash();
-}
-
 enum class RenderTarget {
     GEOMETRY_BUFFER, POST_PROCESSING
 };
 
-struct RenderBatch {
-    unsigned offset = -1;
-    unsigned count = 0;
-    std::vector<MaterialHandle::Material> materials;
-};
-
-struct GeometryBatch {
-    /* material hash */
-    unsigned VAO;
-    MemorySlice<RenderBatch> batches;
-};
-
-struct ShaderBatch {
-    MemorySlice<GeometryBatch> geometries; /* by VAO */
-    std::vector<BufferHandle> buffers;
-    std::vector<MaterialHandle::Material> materials; /* shared material per shader */
-    IndirectDrawBuffer drawBuffer; /* Final Sorted Traversable command */
-    GLDrawPrimitive drawPrimitive;
-};
-
 class AppSystem;
 
 struct RenderingSystem :
@@ -131,7 +50,8 @@ struct RenderingSystem :
     ResourceSystem<ConflictMode::SHARED>
 {
 private:
-    std::unordered_map<std::string, ShaderBatch> batches;
+    RenderQueue renderQueue;
+    GLRenderDevice renderDevice;
 
     void setGlobalTransformsBuffer(const CameraComponent &camera);
 
@@ -183,12 +103,8 @@ private:
 
     const CameraComponent* currentCamera;
 
-    MemoryArena<DrawElementsIndirectCommand> commandBufferArena;
-    MemoryArena<GeometryBatch> geometryBatchArena;
-    MemoryArena<RenderBatch> renderBatchArena;
-    MemoryArena<Renderable> renderableArena;
-
     ParticleSystem_ particleSystem;
+    GeometryKey icosahedron;
 
     friend struct ForwardPassPrepare;
     friend struct NewFrameBegin;
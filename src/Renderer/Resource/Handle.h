@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+
+/*
+ * 32 bit reference into a HandlePool, the low 24 bits index a slot and the high 8 count, modulo 256, how often the slot was
+ * handed out before. A released slot bumps its count, so a handle kept past the release no longer matches and is
+ * caught rather than reading whatever reused the slot. `Tag` only keeps handles of different resources from
+ * converting into each other.
+ */
+template <typename Tag>
+class Handle {
+public:
+    constexpr static int INDEX_BITS = 24;
+    constexpr static uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+    constexpr static uint32_t GENERATION_MASK = 0xffu;
+    constexpr static uint32_t INVALID = ~0u;
+
+    constexpr Handle() = default;
+    constexpr Handle(const uint32_t index, const uint32_t generation) : bits((generation & GENERATION_MASK) << INDEX_BITS | (index & INDEX_MASK)) {}
+
+    constexpr uint32_t index() const {
+        return bits & INDEX_MASK;
+    }
+
+    constexpr uint32_t generation() const {
+        return bits >> INDEX_BITS;
+    }
+
+    constexpr uint32_t raw() const {
+        return bits;
+    }
+
+    constexpr bool isValid() const {
+        return bits != INVALID;
+    }
+
+    constexpr bool operator==(const Handle&) const = default;
+private:
+    uint32_t bits = INVALID;
+};
+
+template <typename Tag>
+struct std::hash<Handle<Tag>> {
+    size_t operator()(const Handle<Tag>& handle) const noexcept {
+        return std::hash<uint32_t>{}(handle.raw());
+    }
+};
@@ -0,0 +1,102 @@
+#pragma once
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+#include <iostream>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <memory/hash.h>
+
+#include "Handle.h"
+
+/*
+ * Dense storage for resources addressed by Handle. A name is hashed once, when the resource is registered under
+ * it, and everything after goes through the handle, an index into the slots. Released slots are reused with the
+ * next generation; registering a name again replaces the resource in its slot, so handles to it stay valid.
+ */
+template <typename Tag, typename T>
+class HandlePool {
+public:
+    using Key = Handle<Tag>;
+
+    HandlePool() = default;
+
+    HandlePool(const HandlePool&) = delete;
+    HandlePool& operator=(const HandlePool&) = delete;
+
+    Key insert(T&& value) {
+        uint32_t index;
+        if (!freeSlots.empty()) {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            index = static_cast<uint32_t>(values.size());
+            // the last index with the last generation would be Key::INVALID
+            assert(index < Key::INDEX_MASK);
+            values.emplace_back();
+            generations.push_back(0);
+        }
+        values[index].emplace(std::move(value));
+        return Key(index, generations[index]);
+    }
+
+    Key insert(const std::string_view name, T&& value) {
+        if (const Key existing = find(name); existing.isValid()) {
+            values[existing.index()].emplace(std::move(value));
+            return existing;
+        }
+        const Key key = insert(std::move(value));
+        names.emplace(name, key);
+        return key;
+    }
+
+    /* an invalid handle if nothing was registered under `name` */
+    Key find(const std::string_view name) const {
+        const auto it = names.find(name);
+        return it == names.end() ? Key{} : it->second;
+    }
+
+    bool contains(const Key key) const {
+        return key.isValid() && key.index() < values.size() && generations[key.index()] == key.generation() && values[key.index()].has_value();
+    }
+
+    T& operator[](const Key key) {
+        return *values[require(key)];
+    }
+
+    const T& operator[](const Key key) const {
+        return *values[require(key)];
+    }
+
+    /* destroys the resource and drops any names pointing at it, the handle and its copies go stale */
+    void release(const Key key) {
+        if (!contains(key)) return;
+
+        values[key.index()].reset();
+        generations[key.index()] = (generations[key.index()] + 1) & Key::GENERATION_MASK;
+        freeSlots.push_back(key.index());
+        for (auto it = names.begin(); it != names.end();) {
+            it = it->second == key ? names.erase(it) : std::next(it);
+        }
+    }
+
+    size_t size() const {
+        return values.size() - freeSlots.size();
+    }
+private:
+    /* checked in every build, a stale handle would otherwise read whatever reused its slot */
+    uint32_t require(const Key key) const {
+        if (!contains(key)) [[unlikely]] {
+            std::cerr << "[ERROR]: stale or invalid handle, slot " << key.index() << " generation " << key.generation() << std::endl;
+            std::abort();
+        }
+        return key.index();
+    }
+
+    std::vector<std::optional<T>> values;
+    std::vector<uint8_t> generations;
+    std::vector<uint32_t> freeSlots;
+    mem::unordered_stringmap<Key> names;
+};
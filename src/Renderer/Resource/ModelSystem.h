@@ -1,11 +1,12 @@
 #pragma once
 #include "Resource.h"
 #include "TextureSystem.h"
+#include "HandlePool.h"
 
 class ModelSystem {
-    std::vector<const ModelDefinition*> models;
+    HandlePool<ModelTag, const ModelDefinition*> models;
 
-    std::unordered_map<const ModelDefinition*, size_t> defToKey;
+    std::unordered_map<const ModelDefinition*, ModelKey> defToKey;
 public:
     ModelSystem() = default;
 
@@ -16,26 +17,21 @@ public:
         ModelLoaderSystem::loadModelGeometry(model.definition->geometry);
 
         for (const auto& path : model.texturePaths) {
-            std::string fullPath = model.directory + "/" + path;
-            std::cout << "Directory: " << model.directory << std::endl;
-            std::cout << "Path: " << fullPath << std::endl;
-            std::cout << "Texture: " << path << std::endl;
-            Texture2D texture(fullPath.c_str(), model.flip);
             model.definition->textures.emplace_back(
-                textureSystem.loadTexture(std::move(texture))
+                textureSystem.streamTexture({ model.directory + "/" + path, model.flip })
             );
         }
-        models.emplace_back(model.definition);
-        return ModelKey{models.size() - 1};
+        const ModelKey key = models.insert(model.definition);
+        defToKey.emplace(model.definition, key);
+        return key;
     }
 
     ModelKey getModelKey(const ModelDefinition* def) {
         const auto it = defToKey.find(def);
-        return it != defToKey.end() ? ModelKey{it->second} : ModelKey{0};
+        return it != defToKey.end() ? it->second : ModelKey{};
     }
 
     const ModelDefinition& getModel(ModelKey key) const {
-        cexpr::require(static_cast<size_t>(key) != 0);
-        return *models[static_cast<size_t>(key)];
+        return *models[key];
     }
 };
@@ -1,13 +1,14 @@
 #pragma once
 #include <limits>
+#include "Handle.h"
 
-enum class Texture2DKey : size_t {};
+using Texture2DKey = Handle<struct Texture2DTag>;
 enum class Texture3DKey : size_t {};
 enum class TextureArray2DKey : size_t {};
 enum class TextureCubeMapKey : size_t {};
 
-enum class ModelKey : size_t {};
-enum class ShaderKey : size_t {};
+using ModelKey = Handle<struct ModelTag>;
+using ShaderKey = Handle<struct ShaderTag>;
 
 struct GPUBufferTraits {
     uint16_t bufferIndex;
@@ -1,41 +1,10 @@
 #pragma once
+#include <variant>
 #include "Resource.h"
-
-enum class ShaderType {
-    VERTEX_FRAGMENT, COMPUTE
-};
+#include "HandlePool.h"
 
 class ShaderSystem {
-    union ShaderUnion {
-        Shader shader;
-        ComputeShader computeShader;
-
-        explicit ShaderUnion(Shader&& shader) : shader(std::move(shader)) {}
-        explicit ShaderUnion(ComputeShader&& computeShader) : computeShader(std::move(computeShader)) {}
-
-        ShaderUnion(const ShaderUnion&) = delete;
-        ShaderUnion& operator=(const ShaderUnion& other) = delete;
-
-        ShaderUnion& operator=(ShaderUnion&& other) noexcept {
-            if (this != &other) {
-                memcpy(this, &other, sizeof(*this));
-                memset(&other, 0, sizeof(*this));
-            }
-            return *this;
-        }
-
-        ShaderUnion(ShaderUnion&& other) noexcept {
-            std::memcpy(this, &other, sizeof(*this));
-            std::memset(&other, 0, sizeof(*this));
-        }
-
-        ~ShaderUnion() {
-            Shader::destroy(shader);
-        }
-    };
-    std::vector<ShaderUnion> shaders;
-
-    std::unordered_map<std::string, std::pair<ShaderType, size_t>> shaderByString;
+    HandlePool<ShaderTag, std::variant<Shader, ComputeShader>> shaders;
 public:
     ShaderSystem() = default;
 
@@ -44,38 +13,33 @@ public:
 
     ShaderKey loadShader(const char* vertex, const char* fragment, const char* as) {
         if (auto shader = Shader::load(vertex, fragment); shader.has_value()) {
-            shaders.emplace_back(std::move(shader.value()));
-            shaderByString.emplace(as, std::make_pair(ShaderType::VERTEX_FRAGMENT, shaders.size() - 1));
-            return ShaderKey{shaders.size() - 1};
+            return shaders.insert(as, std::move(shader.value()));
         } else {
             std::cout << shader.error() << std::endl;
         }
-        return ShaderKey{0};
+        return ShaderKey{};
     }
 
     ShaderKey loadComputeShader(const char* compute, const glm::vec3 threads, const char* as) {
         if (auto shader = ComputeShader::load(compute, threads)) {
-            shaders.emplace_back(std::move(shader.value()));
-            shaderByString.emplace(as, std::make_pair(ShaderType::COMPUTE, shaders.size() - 1));
-            return ShaderKey{shaders.size() - 1};
+            return shaders.insert(as, std::move(shader.value()));
         } else {
             std::cout << shader.error() << std::endl;
         }
-        return ShaderKey{0};
+        return ShaderKey{};
     }
 
-    ShaderKey getShaderKey(const char* as) {
-        const auto it = shaderByString.find(as);
-        return it != shaderByString.end() ? ShaderKey{it->second.second} : ShaderKey{0};
+    ShaderKey getShaderKey(const std::string_view as) const {
+        return shaders.find(as);
     }
 
-    Shader& getShader(ShaderKey key) {
-        cexpr::require(static_cast<size_t>(key) != 0);
-        return shaders[static_cast<size_t>(key)].shader;
+    Shader& getShader(const ShaderKey key) {
+        return std::visit([](Shader& shader) -> Shader& { return shader; }, shaders[key]);
     }
 
-    ComputeShader& getComputeShader(ShaderKey key) {
-        cexpr::require(static_cast<size_t>(key) != 0);
-        return shaders[static_cast<size_t>(key)].computeShader;
+    ComputeShader& getComputeShader(const ShaderKey key) {
+        auto* shader = std::get_if<ComputeShader>(&shaders[key]);
+        assert(shader && "not a compute shader");
+        return *shader;
     }
-};
\ No newline at end of file
+};
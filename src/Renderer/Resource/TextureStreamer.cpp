@@ -0,0 +1,75 @@
+#include "TextureStreamer.h"
+
+#include <iostream>
+#include <algorithm>
+
+void TextureStreamer::request(const Texture2DKey key, TextureStreamParams params) {
+    pending.push({ key, std::move(params), nextOrder++ });
+    pendingDecodes.fetch_add(1, std::memory_order_acq_rel);
+
+    // a task takes whichever request is most urgent when it starts, not necessarily the one that queued it
+    decodeTasks.run([this] {
+        Request next;
+        if (!pending.try_pop(next)) return;
+
+        TextureData image = TextureLoader::load(next.params.path.c_str(), next.params.flip, next.params.channels);
+        if (image) {
+            decoded.push({ next.key, next.params.priority, MipChain::generate(std::move(image), next.params.filter) });
+        } else {
+            // the texture stays id 0, so the meshes using it keep drawing their material's default
+            std::cerr << "[ERROR] Failed to stream texture: " << next.params.path << ", keeping the default texture" << std::endl;
+        }
+        pendingDecodes.fetch_sub(1, std::memory_order_acq_rel);
+    });
+}
+
+TextureFormat TextureStreamer::storageFormatOf(const int channels) {
+    switch (channels) {
+        case 1: return TextureFormat::R8;
+        case 2: return TextureFormat::RG8;
+        case 3: return TextureFormat::RGB8;
+        default: return TextureFormat::RGBA8;
+    }
+}
+
+void TextureStreamer::update(const TextureResolver& textureOf, const size_t byteBudget) {
+    for (Decoded next; decoded.try_pop(next);) {
+        uploads.push_back(std::move(next));
+    }
+    // the most urgent textures get the budget first
+    std::ranges::stable_sort(uploads, std::ranges::greater{}, &Decoded::priority);
+
+    size_t spent = 0;
+    bool uploaded = false;
+    for (Decoded& upload : uploads) {
+        Texture2D* texture = textureOf(upload.key);
+        if (!texture) {
+            upload.level = 0;
+            continue;
+        }
+
+        const MipChain& chain = upload.chain;
+        if (upload.level < 0) {
+            const MipChain::Level& base = chain.level(0);
+            texture->allocateStorage(storageFormatOf(chain.getChannels()), base.width, base.height, chain.levels());
+            texture->setFilter(TextureMinFilter::NEAREST_MIPMAP_NEAREST, TextureMagFilter::NEAREST);
+            texture->setWrap(TextureWrap::REPEAT, TextureWrap::REPEAT);
+            upload.level = chain.levels();
+        }
+
+        while (upload.level > 0) {
+            const int level = upload.level - 1;
+            const auto pixels = chain.pixels(level);
+            if (uploaded && spent + pixels.size() > byteBudget) break;
+
+            const MipChain::Level& info = chain.level(level);
+            texture->uploadLevel(level, info.width, info.height, chain.getImage().format, pixels.data());
+            spent += pixels.size();
+            uploaded = true;
+            upload.level = level;
+        }
+        if (spent >= byteBudget) break;
+    }
+
+    std::erase_if(uploads, [](const Decoded& upload) { return upload.level == 0; });
+}
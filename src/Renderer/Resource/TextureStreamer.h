@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <tbb/task_group.h>
+#include <tbb/concurrent_queue.h>
+#include <tbb/concurrent_priority_queue.h>
+#include <openGL/Texture/MipChain.h>
+#include <openGL/Texture/Texture2D.h>
+
+#include "Resource.h"
+
+enum class TexturePriority : uint8_t {
+    LOW, NORMAL, HIGH
+};
+
+struct TextureStreamParams {
+    std::string path;
+    bool flip = false;
+    /* RGBA keeps rows aligned and takes the SIMD mip path */
+    int channels = 4;
+    MipFilter filter = MipFilter::BOX;
+    TexturePriority priority = TexturePriority::NORMAL;
+};
+
+/*
+ * Loads textures off the render thread. Workers decode the requested files, highest priority first, and build
+ * their mip chains on the CPU. update() then allocates each decoded texture's storage and uploads its levels
+ * coarsest first, within a byte budget per call. The texture is sampled from the finest level uploaded so far, so
+ * it shows up blurry and sharpens over the next frames instead of stalling one.
+ */
+class TextureStreamer {
+public:
+    constexpr static size_t DEFAULT_UPLOAD_BUDGET = 8 << 20;
+
+    /* null if the texture was released while it streamed */
+    using TextureResolver = std::function<Texture2D*(Texture2DKey)>;
+
+    TextureStreamer() = default;
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    ~TextureStreamer() {
+        decodeTasks.wait();
+    }
+
+    /* streams into the texture behind `key`, which stays empty, id 0, until its first level arrives */
+    void request(Texture2DKey key, TextureStreamParams params);
+
+    /* on the render thread; always uploads at least one level, so a level above the budget still arrives */
+    void update(const TextureResolver& textureOf, size_t byteBudget = DEFAULT_UPLOAD_BUDGET);
+
+    bool isStreaming() const {
+        return pendingDecodes.load(std::memory_order_acquire) != 0 || !uploads.empty();
+    }
+
+private:
+    struct Request {
+        Texture2DKey key;
+        TextureStreamParams params;
+        uint64_t order;
+    };
+
+    /* higher priority first, then in request order */
+    struct RequestOrder {
+        bool operator()(const Request& a, const Request& b) const {
+            if (a.params.priority != b.params.priority) return a.params.priority < b.params.priority;
+            return a.order > b.order;
+        }
+    };
+
+    struct Decoded {
+        Texture2DKey key;
+        TexturePriority priority;
+        MipChain chain;
+        /* the next level to upload, counting down to 0 */
+        int level = -1;
+    };
+
+    static TextureFormat storageFormatOf(int channels);
+
+    tbb::task_group decodeTasks;
+    tbb::concurrent_priority_queue<Request, RequestOrder> pending;
+    tbb::concurrent_queue<Decoded> decoded;
+    std::atomic<int> pendingDecodes = 0;
+    uint64_t nextOrder = 0;
+
+    /* render thread only */
+    std::vector<Decoded> uploads;
+};
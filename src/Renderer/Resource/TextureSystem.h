@@ -1,8 +1,11 @@
 #pragma once
 #include "Resource.h"
+#include "HandlePool.h"
+#include "TextureStreamer.h"
 
 class TextureSystem {
-    std::vector<Texture2D> textures2Ds;
+    HandlePool<Texture2DTag, Texture2D> textures2Ds;
+    TextureStreamer streamer;
 public:
     TextureSystem() = default;
 
@@ -12,12 +15,34 @@ public:
     TextureSystem& operator=(TextureSystem&&) = delete;
 
     Texture2DKey loadTexture(Texture2D&& texture) {
-        textures2Ds.emplace_back(std::move(texture));
-        return Texture2DKey{textures2Ds.size() - 1};
+        return textures2Ds.insert(std::move(texture));
     }
 
+    /* the key is usable at once, its texture reads as id 0 until the first mip arrives; a path is streamed once */
+    Texture2DKey streamTexture(TextureStreamParams params) {
+        if (const Texture2DKey existing = textures2Ds.find(params.path); existing.isValid()) {
+            return existing;
+        }
+        const Texture2DKey key = textures2Ds.insert(params.path, Texture2D{});
+        streamer.request(key, std::move(params));
+        return key;
+    }
+
+    void updateStreaming(const size_t byteBudget = TextureStreamer::DEFAULT_UPLOAD_BUDGET) {
+        streamer.update([this](const Texture2DKey key) {
+            return textures2Ds.contains(key) ? &textures2Ds[key] : nullptr;
+        }, byteBudget);
+    }
+
+    bool isStreaming() const {
+        return streamer.isStreaming();
+    }
 
     Texture2D& getTexture(const Texture2DKey key) {
-        return textures2Ds[static_cast<size_t>(key)];
+        return textures2Ds[key];
+    }
+
+    void releaseTexture(const Texture2DKey key) {
+        textures2Ds.release(key);
     }
-};
\ No newline at end of file
+};
@@ -1,9 +1,10 @@
 #pragma once
 #include <Transform.h>
+#include <Collision/MovementSystem.h>
 
 struct UpdateConnection {};
 
-struct ChangeListener : LevelOutStage::Reads<CameraComponent>, Stages<LevelOutStage> {
+struct ChangeListener : LevelOutStage::Reads<CameraComponent>, Dependencies<CameraMovementSystem>, Stages<LevelOutStage> {
     void onLevelLoad(LevelLoadView<ChangeListener> level) {
         level.enableEventEmission<CameraComponent>();
     }
@@ -244,6 +244,9 @@ struct SkyboxChangeListener : ReadsResources<EntityMapper>, Writes<SkyboxRendera
 
 struct SkyboxRenderer : ReadsResources<RenderingSystem, GeometrySystem>, Writes<SkyboxRenderable>, Dependencies<RenderingSystem> {
     Entity activeSkybox = NullEntity;
+    GeometryKey cubemap;
+    ShaderKey skyboxShader;
+
     static constexpr DrawArrays drawArrays = {
         .function = GLDrawFunction::ARRAYS,
         .primitive = GLDrawPrimitive::TRIANGLES,
@@ -252,7 +255,12 @@ struct SkyboxRenderer : ReadsResources<RenderingSystem, GeometrySystem>, Writes<
     };
 
     void onRender(ForwardRenderView<SkyboxRenderer> view) {
-        auto& cubemapGeometry = view.getGeometry(GeometryConstants::CUBEMAP);
+        // both are registered by SkyboxInitializer, looked up on the first frame
+        if (!cubemap.isValid()) {
+            cubemap = view.getGeometryKey(GeometryConstants::CUBEMAP);
+            skyboxShader = view.getShaderKey("SkyboxShader");
+        }
+        auto& cubemapGeometry = view.getGeometry(cubemap);
 
         view.query<SkyboxRenderable>().forEachChangedOrNew<SkyboxRenderable>([&](const Entity e, SkyboxRenderable& skybox) {
             if (skybox.hdriFile == skybox.loadedFile) return;
@@ -264,7 +272,7 @@ struct SkyboxRenderer : ReadsResources<RenderingSystem, GeometrySystem>, Writes<
         if (activeSkybox == NullEntity) return;
 
         auto& skybox = *view.get<SkyboxRenderable>(activeSkybox);
-        auto& shader = view.setActiveShader("SkyboxShader");
+        auto& shader = view.setActiveShader(skyboxShader);
         UniformData uniforms(shader.id());
         glDepthFunc(GL_LEQUAL);
         glDepthMask(GL_FALSE);
@@ -0,0 +1,72 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& path) {
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return;
+    file = handle;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0) {
+        close();
+        return;
+    }
+
+    mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        close();
+        return;
+    }
+
+    mapped = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!mapped) {
+        close();
+        return;
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+}
+
+void MappedFile::close() {
+    if (mapped) UnmapViewOfFile(mapped);
+    if (mapping) CloseHandle(mapping);
+    if (file) CloseHandle(file);
+    mapped = nullptr;
+    mapping = nullptr;
+    file = nullptr;
+    length = 0;
+}
+#else
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat info{};
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED) {
+            mapped = static_cast<const std::byte*>(view);
+            length = static_cast<size_t>(info.st_size);
+        }
+    }
+    // the mapping keeps the file alive
+    ::close(fd);
+}
+
+void MappedFile::close() {
+    if (mapped) munmap(const_cast<std::byte*>(mapped), length);
+    mapped = nullptr;
+    length = 0;
+}
+#endif
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <cstddef>
+#include <utility>
+
+/*
+ * Read only memory mapping of a whole file. The pages are faulted in lazily by the OS,
+ * so opening a large file costs nothing until its bytes are touched.
+ */
+class MappedFile {
+    const std::byte* mapped = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+    void close();
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+        : mapped(std::exchange(other.mapped, nullptr)), length(std::exchange(other.length, 0))
+#ifdef _WIN32
+        , file(std::exchange(other.file, nullptr)), mapping(std::exchange(other.mapping, nullptr))
+#endif
+    {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            mapped = std::exchange(other.mapped, nullptr);
+            length = std::exchange(other.length, 0);
+#ifdef _WIN32
+            file = std::exchange(other.file, nullptr);
+            mapping = std::exchange(other.mapping, nullptr);
+#endif
+        }
+        return *this;
+    }
+
+    ~MappedFile() {
+        close();
+    }
+
+    bool isOpen() const {
+        return mapped != nullptr;
+    }
+
+    std::span<const std::byte> bytes() const {
+        return { mapped, length };
+    }
+
+    size_t size() const {
+        return length;
+    }
+};
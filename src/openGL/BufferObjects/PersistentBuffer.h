@@ -1,5 +1,15 @@
 #pragma once
 #include <gl/glew.h>
+#include <span>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
 
 template <GLenum Buffer>
 class PersistentBuffer {
@@ -23,7 +33,7 @@ public:
     }
 
     void setToBindingPoint(unsigned loc) {
-        glBindBufferBase(Buffer, loc);
+        glBindBufferBase(Buffer, loc, buffer);
     }
     template <typename T>
     T* get() {
@@ -33,4 +43,382 @@ public:
     unsigned id() const {
         return buffer;
     }
-};
\ No newline at end of file
+};
+
+/* GPU fences, which complete in the order they were inserted. 0 is never a fence */
+class FenceBackend {
+public:
+    using Fence = uint64_t;
+
+    virtual ~FenceBackend() = default;
+
+    /* fences the commands issued so far */
+    virtual Fence insertFence() = 0;
+    /* does not block */
+    virtual bool isSignaled(Fence fence) = 0;
+    virtual void wait(Fence fence) = 0;
+    virtual void releaseFence(Fence fence) = 0;
+};
+
+/* persistently mapped, coherent storage on top of the fences */
+class PersistentBackend : public FenceBackend {
+public:
+    struct Storage {
+        unsigned id = 0;
+        std::byte* data = nullptr;
+        size_t bytes = 0;
+    };
+
+    virtual Storage createStorage(size_t bytes) = 0;
+    virtual void destroyStorage(const Storage& storage) = 0;
+    /* the offset alignment a binding into the storage needs */
+    virtual size_t alignment() const = 0;
+};
+
+class GLFenceBackend : public FenceBackend {
+public:
+    Fence insertFence() override {
+        return reinterpret_cast<uintptr_t>(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    }
+
+    bool isSignaled(const Fence fence) override {
+        const GLenum status = glClientWaitSync(sync(fence), 0, 0);
+        return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+    }
+
+    void wait(const Fence fence) override {
+        // the first wait flushes, or a fence still in the command queue would never signal
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        while (glClientWaitSync(sync(fence), flags, 1'000'000) == GL_TIMEOUT_EXPIRED) {
+            flags = 0;
+        }
+    }
+
+    void releaseFence(const Fence fence) override {
+        glDeleteSync(sync(fence));
+    }
+private:
+    static GLsync sync(const Fence fence) {
+        return reinterpret_cast<GLsync>(static_cast<uintptr_t>(fence));
+    }
+};
+
+class GLPersistentBackend final : public PersistentBackend {
+    GLenum target;
+    GLFenceBackend fences;
+public:
+    explicit GLPersistentBackend(const GLenum target) : target(target) {}
+
+    Fence insertFence() override { return fences.insertFence(); }
+    bool isSignaled(const Fence fence) override { return fences.isSignaled(fence); }
+    void wait(const Fence fence) override { fences.wait(fence); }
+    void releaseFence(const Fence fence) override { fences.releaseFence(fence); }
+
+    Storage createStorage(const size_t bytes) override {
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        Storage storage;
+        storage.bytes = bytes;
+        glGenBuffers(1, &storage.id);
+        glBindBuffer(target, storage.id);
+        glBufferStorage(target, static_cast<GLsizeiptr>(bytes), nullptr, flags);
+        storage.data = static_cast<std::byte*>(glMapBufferRange(target, 0, static_cast<GLsizeiptr>(bytes), flags));
+        return storage;
+    }
+
+    void destroyStorage(const Storage& storage) override {
+        glBindBuffer(target, storage.id);
+        glUnmapBuffer(target);
+        glDeleteBuffers(1, &storage.id);
+    }
+
+    size_t alignment() const override {
+        GLint alignment = 16;
+        if (target == GL_SHADER_STORAGE_BUFFER) glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        else if (target == GL_UNIFORM_BUFFER) glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        return static_cast<size_t>(std::max(alignment, 1));
+    }
+};
+
+/*
+ * Host memory and a GPU that only finishes work when told to, so the allocators over it can be driven frame by
+ * frame without a context. Waiting on a fence completes everything up to it and counts as a stall.
+ */
+class SimulatedPersistentBackend final : public PersistentBackend {
+    std::unordered_map<unsigned, std::unique_ptr<std::byte[]>> storages;
+    unsigned nextStorage = 1;
+    Fence lastFence = 0;
+    Fence completed = 0;
+    size_t liveFences = 0;
+    size_t stalls = 0;
+    size_t offsetAlignment;
+public:
+    explicit SimulatedPersistentBackend(const size_t offsetAlignment = 256) : offsetAlignment(offsetAlignment) {}
+
+    Fence insertFence() override {
+        ++liveFences;
+        return ++lastFence;
+    }
+
+    bool isSignaled(const Fence fence) override {
+        return fence <= completed;
+    }
+
+    void wait(const Fence fence) override {
+        if (fence <= completed) return;
+        ++stalls;
+        completed = fence;
+    }
+
+    void releaseFence(Fence) override {
+        --liveFences;
+    }
+
+    Storage createStorage(const size_t bytes) override {
+        const unsigned id = nextStorage++;
+        auto& memory = storages[id] = std::make_unique<std::byte[]>(bytes);
+        return { id, memory.get(), bytes };
+    }
+
+    void destroyStorage(const Storage& storage) override {
+        storages.erase(storage.id);
+    }
+
+    size_t alignment() const override {
+        return offsetAlignment;
+    }
+
+    /* the GPU finishes every command before `fence` was inserted */
+    void complete(const Fence fence) {
+        completed = std::max(completed, std::min(fence, lastFence));
+    }
+
+    void completeAll() {
+        completed = lastFence;
+    }
+
+    Fence getLastFence() const {
+        return lastFence;
+    }
+
+    size_t getStalls() const {
+        return stalls;
+    }
+
+    size_t getLiveStorages() const {
+        return storages.size();
+    }
+
+    size_t getLiveFences() const {
+        return liveFences;
+    }
+};
+
+/*
+ * Numbers frames from 1 and fences each one when it ends, so memory the GPU read during frame n can be reused once
+ * getCompleted() >= n. Signaled fences are only collected by poll() and waitFor(), neither of which runs by itself.
+ */
+class FrameFences {
+    struct Pending {
+        uint64_t frame;
+        FenceBackend::Fence fence;
+    };
+
+    FenceBackend* backend;
+    std::deque<Pending> pending;
+    uint64_t frame = 1;
+    uint64_t completed = 0;
+public:
+    explicit FrameFences(FenceBackend& backend) : backend(&backend) {}
+
+    FrameFences(const FrameFences&) = delete;
+    FrameFences& operator=(const FrameFences&) = delete;
+
+    FrameFences(FrameFences&& other) noexcept
+        : backend(other.backend), pending(std::move(other.pending)), frame(other.frame), completed(other.completed)
+    {
+        other.pending.clear();
+    }
+
+    ~FrameFences() {
+        for (const Pending& entry : pending) backend->releaseFence(entry.fence);
+    }
+
+    /* fences the current frame's commands and starts the next frame */
+    void endFrame() {
+        pending.push_back({ frame++, backend->insertFence() });
+    }
+
+    /* collects the frames the GPU finished, without blocking */
+    uint64_t poll() {
+        while (!pending.empty() && backend->isSignaled(pending.front().fence)) retireFront();
+        return completed;
+    }
+
+    /* blocks until the GPU finished `until` and every frame before it */
+    void waitFor(const uint64_t until) {
+        while (completed < until && !pending.empty()) {
+            backend->wait(pending.front().fence);
+            retireFront();
+        }
+    }
+
+    uint64_t getFrame() const {
+        return frame;
+    }
+
+    uint64_t getCompleted() const {
+        return completed;
+    }
+private:
+    void retireFront() {
+        completed = pending.front().frame;
+        backend->releaseFence(pending.front().fence);
+        pending.pop_front();
+    }
+};
+
+/*
+ * Per-frame transient GPU memory: one persistently mapped buffer split into `frames` regions, used round robin and
+ * bump allocated. A region is written again only after the fence of the frame that last used it signaled, which
+ * with three regions rarely blocks. A frame that outgrows its region moves to storage twice the size, the old
+ * storage is destroyed once the frames reading it finished.
+ *
+ *   ring.beginFrame();
+ *   const auto matrices = ring.upload(std::span(transforms));
+ *   ... bind matrices.buffer at matrices.offset, submit the draws ...
+ *   ring.endFrame();
+ */
+class PersistentRing {
+public:
+    constexpr static uint32_t DEFAULT_FRAMES = 3;
+
+    struct Allocation {
+        unsigned buffer = 0;
+        size_t offset = 0;
+        size_t bytes = 0;
+        std::byte* data = nullptr;
+
+        template <typename T>
+        T* as() const {
+            return reinterpret_cast<T*>(data);
+        }
+
+        explicit operator bool() const {
+            return data != nullptr;
+        }
+    };
+
+    PersistentRing(std::unique_ptr<PersistentBackend> backend, const size_t frameBytes, const uint32_t frames = DEFAULT_FRAMES)
+        : backend(std::move(backend)), fences(*this->backend), baseAlignment(this->backend->alignment()), frames(frames)
+    {
+        assert(frames > 0);
+        resize(frameBytes);
+    }
+
+    PersistentRing(const PersistentRing&) = delete;
+    PersistentRing& operator=(const PersistentRing&) = delete;
+
+    ~PersistentRing() {
+        backend->destroyStorage(storage);
+        for (const Retired& retired : retiredStorages) backend->destroyStorage(retired.storage);
+    }
+
+    /* blocks only if the GPU is still reading the region this frame reuses */
+    void beginFrame() {
+        assert(!inFrame);
+        inFrame = true;
+
+        const uint64_t frame = fences.getFrame();
+        fences.poll();
+        if (frame >= storageFirstFrame + frames) fences.waitFor(frame - frames);
+
+        std::erase_if(retiredStorages, [&](const Retired& retired) {
+            if (retired.lastFrame > fences.getCompleted()) return false;
+            backend->destroyStorage(retired.storage);
+            return true;
+        });
+
+        regionBase = (frame % frames) * frameBytes;
+        head = 0;
+    }
+
+    /* `alignment` adds to the backend's binding alignment, the memory stays valid until endFrame */
+    Allocation allocate(const size_t bytes, const size_t alignment = 1) {
+        assert(inFrame && "allocations belong to a frame");
+        const size_t align = std::max(alignment, baseAlignment);
+
+        size_t offset = alignUp(regionBase + head, align);
+        if (offset + bytes > regionBase + frameBytes) {
+            grow(bytes + align);
+            offset = alignUp(regionBase, align);
+        }
+        head = offset + bytes - regionBase;
+        return { storage.id, offset, bytes, storage.data + offset };
+    }
+
+    template <typename T>
+    Allocation upload(const std::span<const T> data, const size_t alignment = alignof(T)) {
+        const Allocation allocation = allocate(data.size_bytes(), alignment);
+        if (!data.empty()) std::memcpy(allocation.data, data.data(), data.size_bytes());
+        return allocation;
+    }
+
+    /* fences the frame's allocations; they must not be written after this */
+    void endFrame() {
+        assert(inFrame);
+        inFrame = false;
+        fences.endFrame();
+    }
+
+    size_t getFrameCapacity() const {
+        return frameBytes;
+    }
+
+    size_t getFrameUsage() const {
+        return head;
+    }
+
+    unsigned getBuffer() const {
+        return storage.id;
+    }
+private:
+    struct Retired {
+        PersistentBackend::Storage storage;
+        uint64_t lastFrame;
+    };
+
+    static size_t alignUp(const size_t value, const size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    void resize(const size_t bytes) {
+        frameBytes = alignUp(std::max<size_t>(bytes, 1), baseAlignment);
+        storage = backend->createStorage(frameBytes * frames);
+    }
+
+    /* moves the current frame to new storage, the frame's earlier allocations stay valid in the old one */
+    void grow(const size_t atLeast) {
+        retiredStorages.push_back({ storage, fences.getFrame() });
+        resize(std::max(frameBytes * 2, atLeast));
+
+        const uint64_t frame = fences.getFrame();
+        storageFirstFrame = frame;
+        regionBase = (frame % frames) * frameBytes;
+        head = 0;
+    }
+
+    std::unique_ptr<PersistentBackend> backend;
+    FrameFences fences;
+    size_t baseAlignment;
+    uint32_t frames;
+
+    PersistentBackend::Storage storage;
+    std::vector<Retired> retiredStorages;
+    /* the regions of the current storage are unused before this frame */
+    uint64_t storageFirstFrame = 1;
+    size_t frameBytes = 0;
+    size_t regionBase = 0;
+    size_t head = 0;
+    bool inFrame = false;
+};
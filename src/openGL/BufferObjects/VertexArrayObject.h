@@ -31,7 +31,7 @@ public:
     }
 
     ~VertexArrayObject() {
-        glDeleteVertexArrays(1, &VAO);
+        if (VAO) glDeleteVertexArrays(1, &VAO);
     }
 
     void discard() {
@@ -0,0 +1,262 @@
+#include "MipChain.h"
+
+#include <array>
+#include <cmath>
+#include <cassert>
+#include <numbers>
+#include <algorithm>
+#include <emmintrin.h>
+
+namespace {
+    int halved(const int size) {
+        return std::max(size / 2, 1);
+    }
+
+    /* the source rows or columns averaged into output `i`, a trailing odd one joins the last output */
+    struct Taps {
+        int first;
+        int count;
+    };
+
+    Taps tapsOf(const int i, const int size, const int outSize) {
+        if (size == 1) return { 0, 1 };
+        return { 2 * i, i == outSize - 1 && size % 2 ? 3 : 2 };
+    }
+
+    void boxPixel(const unsigned char* source, const int width, const int channels, const Taps rows, const Taps cols, unsigned char* out) {
+        const int n = rows.count * cols.count;
+        for (int c = 0; c < channels; ++c) {
+            int sum = 0;
+            for (int y = rows.first; y < rows.first + rows.count; ++y) {
+                for (int x = cols.first; x < cols.first + cols.count; ++x) {
+                    sum += source[(static_cast<size_t>(y) * width + x) * channels + c];
+                }
+            }
+            out[c] = static_cast<unsigned char>((sum + n / 2) / n);
+        }
+    }
+
+    /* two RGBA outputs from 4x2 source pixels per iteration, `count` outputs in total */
+    int boxRowRGBA(const unsigned char* row0, const unsigned char* row1, const int count, unsigned char* out) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i rounding = _mm_set1_epi16(2);
+
+        int x = 0;
+        for (; x + 2 <= count; x += 2) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 8 * x));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 8 * x));
+
+            // vertical sums widened to 16 bits, pixels 0 and 1 in lo, 2 and 3 in hi
+            const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+            const __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+            const __m128i average = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 2);
+
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 4 * x), _mm_packus_epi16(average, average));
+        }
+        return x;
+    }
+
+    constexpr int KAISER_RADIUS = 6;
+    constexpr int KAISER_TAPS = 2 * KAISER_RADIUS;
+    constexpr double KAISER_ALPHA = 4.0;
+
+    double besselI0(const double x) {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 32; ++k) {
+            term *= x * x / (4.0 * k * k);
+            sum += term;
+        }
+        return sum;
+    }
+
+    /*
+     * Weights of the source taps 2i - RADIUS + 1 ... 2i + RADIUS around output i. The kernel is sinc in output
+     * pixels, windowed to RADIUS / 2 of them; the taps sit at half pixel offsets from the output's center.
+     */
+    const std::array<float, KAISER_TAPS>& kaiserWeights() {
+        static const auto weights = [] {
+            std::array<double, KAISER_TAPS> raw{};
+            const double width = KAISER_RADIUS / 2.0;
+            for (int i = 0; i < KAISER_TAPS; ++i) {
+                const double t = (i - KAISER_RADIUS + 0.5) / 2.0;
+                const double sinc = std::sin(std::numbers::pi * t) / (std::numbers::pi * t);
+                const double r = t / width;
+                raw[i] = sinc * besselI0(KAISER_ALPHA * std::sqrt(std::max(0.0, 1.0 - r * r))) / besselI0(KAISER_ALPHA);
+            }
+            double total = 0.0;
+            for (const double w : raw) total += w;
+
+            std::array<float, KAISER_TAPS> weights{};
+            for (int i = 0; i < KAISER_TAPS; ++i) weights[i] = static_cast<float>(raw[i] / total);
+            return weights;
+        }();
+        return weights;
+    }
+
+    int clampTap(const int i, const int size) {
+        return std::clamp(i, 0, size - 1);
+    }
+
+    /* filters columns: every output row is a weighted sum of whole source rows, 4 floats at a time */
+    void kaiserVertical(const float* source, const int rowFloats, const int height, float* out) {
+        const auto& weights = kaiserWeights();
+        const int outHeight = halved(height);
+        for (int y = 0; y < outHeight; ++y) {
+            const float* rows[KAISER_TAPS];
+            for (int i = 0; i < KAISER_TAPS; ++i) {
+                rows[i] = source + static_cast<size_t>(clampTap(2 * y + i - KAISER_RADIUS + 1, height)) * rowFloats;
+            }
+            float* destination = out + static_cast<size_t>(y) * rowFloats;
+
+            int j = 0;
+            for (; j + 4 <= rowFloats; j += 4) {
+                __m128 sum = _mm_setzero_ps();
+                for (int i = 0; i < KAISER_TAPS; ++i) {
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[i]), _mm_loadu_ps(rows[i] + j)));
+                }
+                _mm_storeu_ps(destination + j, sum);
+            }
+            for (; j < rowFloats; ++j) {
+                float sum = 0.f;
+                for (int i = 0; i < KAISER_TAPS; ++i) sum += weights[i] * rows[i][j];
+                destination[j] = sum;
+            }
+        }
+    }
+
+    /* filters rows: an RGBA pixel is one 4 float vector */
+    void kaiserHorizontal(const float* source, const int width, const int height, const int channels, float* out) {
+        const auto& weights = kaiserWeights();
+        const int outWidth = halved(width);
+        for (int y = 0; y < height; ++y) {
+            const float* row = source + static_cast<size_t>(y) * width * channels;
+            float* destination = out + static_cast<size_t>(y) * outWidth * channels;
+
+            for (int x = 0; x < outWidth; ++x) {
+                const int first = 2 * x - KAISER_RADIUS + 1;
+                if (channels == 4) {
+                    __m128 sum = _mm_setzero_ps();
+                    for (int i = 0; i < KAISER_TAPS; ++i) {
+                        const float* pixel = row + clampTap(first + i, width) * 4;
+                        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[i]), _mm_loadu_ps(pixel)));
+                    }
+                    _mm_storeu_ps(destination + x * 4, sum);
+                } else {
+                    for (int c = 0; c < channels; ++c) {
+                        float sum = 0.f;
+                        for (int i = 0; i < KAISER_TAPS; ++i) sum += weights[i] * row[clampTap(first + i, width) * channels + c];
+                        destination[x * channels + c] = sum;
+                    }
+                }
+            }
+        }
+    }
+
+    void quantize(const std::span<const float> source, unsigned char* out) {
+        size_t i = 0;
+        const __m128 low = _mm_setzero_ps(), high = _mm_set1_ps(255.f);
+        for (; i + 8 <= source.size(); i += 8) {
+            // cvtps rounds to nearest, packus saturates to [0, 255] after the clamp keeps the 16 bit pack exact
+            const __m128i a = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(source.data() + i), low), high));
+            const __m128i b = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(source.data() + i + 4), low), high));
+            const __m128i words = _mm_packs_epi32(a, b);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(words, words));
+        }
+        for (; i < source.size(); ++i) {
+            out[i] = static_cast<unsigned char>(std::clamp(std::lround(source[i]), 0l, 255l));
+        }
+    }
+}
+
+int MipChain::levelCount(const int width, const int height) {
+    int levels = 1;
+    for (int size = std::max(width, height); size > 1; size /= 2) ++levels;
+    return levels;
+}
+
+void MipChain::downsampleBox(const unsigned char* source, const int width, const int height, const int channels, unsigned char* destination) {
+    const int outWidth = halved(width), outHeight = halved(height);
+    const size_t rowBytes = static_cast<size_t>(width) * channels;
+
+    for (int y = 0; y < outHeight; ++y) {
+        const Taps rows = tapsOf(y, height, outHeight);
+        unsigned char* out = destination + static_cast<size_t>(y) * outWidth * channels;
+
+        int x = 0;
+        if (channels == 4 && rows.count == 2 && width > 1) {
+            // the SIMD pass stops before a 3 wide last column
+            const int pairs = width % 2 ? outWidth - 1 : outWidth;
+            x = boxRowRGBA(source + rows.first * rowBytes, source + (rows.first + 1) * rowBytes, pairs, out);
+        }
+        for (; x < outWidth; ++x) {
+            boxPixel(source, width, channels, rows, tapsOf(x, width, outWidth), out + x * channels);
+        }
+    }
+}
+
+MipChain MipChain::generate(TextureData&& image, const MipFilter filter) {
+    assert(image.pixels && "mip chains are built from 8 bit images");
+
+    MipChain chain;
+    chain.image = std::move(image);
+    const int channels = chain.image.channels;
+    int width = chain.image.width, height = chain.image.height;
+
+    const int levels = levelCount(width, height);
+    chain.levelInfo.push_back({ width, height, 0 });
+    size_t total = 0;
+    for (int level = 1, w = width, h = height; level < levels; ++level) {
+        w = halved(w);
+        h = halved(h);
+        chain.levelInfo.push_back({ w, h, total });
+        total += static_cast<size_t>(w) * h * channels;
+    }
+    chain.mips.resize(total);
+
+    if (filter == MipFilter::BOX) {
+        const unsigned char* source = chain.image.pixels;
+        for (int level = 1; level < levels; ++level) {
+            unsigned char* destination = chain.mips.data() + chain.levelInfo[level].offset;
+            downsampleBox(source, width, height, channels, destination);
+            source = destination;
+            width = halved(width);
+            height = halved(height);
+        }
+        return chain;
+    }
+
+    // every level is filtered from the unquantized one above, so rounding does not accumulate down the chain
+    std::vector<float> current(chain.image.pixels, chain.image.pixels + chain.image.bytes());
+    std::vector<float> vertical, next;
+    for (int level = 1; level < levels; ++level) {
+        const int outWidth = halved(width), outHeight = halved(height);
+        const int rowFloats = width * channels;
+
+        const float* columns = current.data();
+        if (height > 1) {
+            vertical.resize(static_cast<size_t>(outHeight) * rowFloats);
+            kaiserVertical(current.data(), rowFloats, height, vertical.data());
+            columns = vertical.data();
+        }
+        if (width > 1) {
+            next.resize(static_cast<size_t>(outWidth) * outHeight * channels);
+            kaiserHorizontal(columns, width, outHeight, channels, next.data());
+        } else {
+            next.assign(columns, columns + static_cast<size_t>(outHeight) * rowFloats);
+        }
+
+        quantize(next, chain.mips.data() + chain.levelInfo[level].offset);
+        std::swap(current, next);
+        width = outWidth;
+        height = outHeight;
+    }
+    return chain;
+}
+
+std::span<const unsigned char> MipChain::pixels(const int level) const {
+    const Level& info = levelInfo[level];
+    const size_t bytes = static_cast<size_t>(info.width) * info.height * image.channels;
+    if (level == 0) return { image.pixels, bytes };
+    return { mips.data() + info.offset, bytes };
+}
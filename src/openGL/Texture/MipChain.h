@@ -0,0 +1,70 @@
+#pragma once
+#include <span>
+#include <vector>
+#include <cstddef>
+
+#include "TextureLoader.h"
+
+enum class MipFilter {
+    /* 2x2 average of the level above, an odd last row or column is folded into its neighbour */
+    BOX,
+    /* Kaiser windowed sinc over 12 taps per axis, sharper than BOX and with less aliasing, at about 20 times its cost */
+    KAISER
+};
+
+/*
+ * The full mip chain of an 8 bit texture, built on the CPU so a loader thread can prepare it and the levels can be
+ * uploaded one at a time. Level 0 is the decoded image itself; every further level halves both sides, rounding down
+ * and stopping at 1, which is the chain glTexStorage2D allocates.
+ */
+class MipChain {
+public:
+    struct Level {
+        int width;
+        int height;
+        size_t offset; /* into the generated levels, unused for level 0 */
+    };
+
+    MipChain() = default;
+
+    MipChain(const MipChain&) = delete;
+    MipChain& operator=(const MipChain&) = delete;
+    MipChain(MipChain&&) noexcept = default;
+    MipChain& operator=(MipChain&&) noexcept = default;
+
+    /* takes over the 8 bit pixels of `image` as level 0 */
+    static MipChain generate(TextureData&& image, MipFilter filter = MipFilter::BOX);
+
+    static int levelCount(int width, int height);
+
+    /* one level down; `destination` holds max(width / 2, 1) * max(height / 2, 1) * channels bytes */
+    static void downsampleBox(const unsigned char* source, int width, int height, int channels, unsigned char* destination);
+
+    int levels() const {
+        return static_cast<int>(levelInfo.size());
+    }
+
+    const Level& level(const int index) const {
+        return levelInfo[index];
+    }
+
+    std::span<const unsigned char> pixels(int level) const;
+
+    int getChannels() const {
+        return image.channels;
+    }
+
+    const TextureData& getImage() const {
+        return image;
+    }
+
+    /* of every level */
+    size_t bytes() const {
+        return image.bytes() + mips.size();
+    }
+
+private:
+    TextureData image;
+    std::vector<unsigned char> mips;
+    std::vector<Level> levelInfo;
+};
@@ -191,6 +191,28 @@ public:
         texture = 0;
     }
 
+    /* immutable storage for `levels` mips, sampled from none of them until uploadLevel fills the coarsest */
+    void allocateStorage(const TextureFormat internalFormat, const int width, const int height, const int levels) {
+        this->width = width;
+        this->height = height;
+        this->format = internalFormat;
+
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexStorage2D(GL_TEXTURE_2D, levels, static_cast<GLenum>(internalFormat), width, height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, levels - 1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    }
+
+    /* levels arrive coarsest first, each one becomes the finest sampled */
+    void uploadLevel(const int level, const int width, const int height, const TextureFormat format, const void* pixels) const {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, static_cast<GLenum>(format), GL_UNSIGNED_BYTE, pixels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+    }
+
     void allocate(const unsigned char* pixels, TextureFormat format, const int width, const int height, GLType type = GLType::UNSIGNED_BYTE, const int unit = 0) {
         this->width = width;
         this->height = height;
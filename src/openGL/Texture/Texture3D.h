@@ -65,7 +65,7 @@ public:
         return *this;
     }
 
-    Texture3D& allocate(TextureData texData, TextureFormat format, GLType type, const int unit = 0) {
+    Texture3D& allocate(const TextureData& texData, TextureFormat format, GLType type, const int unit = 0) {
         width  = texData.width;
         height = texData.height;
         depth  = texData.depth;
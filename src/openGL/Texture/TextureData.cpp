@@ -0,0 +1,79 @@
+#include "TextureLoader.h"
+
+#include <cassert>
+
+TextureFormat TextureData::formatOf(const int channels) {
+    switch (channels) {
+        case 4: return TextureFormat::RGBA;
+        case 3: return TextureFormat::RGB;
+        case 2: return TextureFormat::RG;
+        default: return TextureFormat::R;
+    }
+}
+
+TextureData::TextureData(std::string path, const unsigned char *pixels, const int width, const int height, const int channels)
+    : path(std::move(path)), width(width), height(height), channels(channels), format(formatOf(channels))
+{
+    this->pixels = new unsigned char[width * height * channels];
+    memcpy(this->pixels, pixels, width * height * channels * sizeof(unsigned char));
+}
+
+TextureData::TextureData(const float *pixels, const int width, const int height, const int channels)
+    : width(width), height(height), channels(channels), format(formatOf(channels))
+{
+    this->floatPixels = new float[width * height * channels];
+    memcpy(this->floatPixels, pixels, width * height * channels * sizeof(float));
+}
+
+
+TextureData::TextureData(const int width, const int height, const int channels, const TextureFormat format)
+    : width(width), height(height), channels(channels), format(format)
+{
+    assert(width * height * channels); // no char[0]
+    pixels = new unsigned char[width * height * channels];
+}
+
+TextureData::TextureData(TextureData&& other) noexcept
+    : release(other.release), path(std::move(other.path)), pixels(other.pixels), floatPixels(other.floatPixels),
+      width(other.width), height(other.height), depth(other.depth), channels(other.channels), format(other.format)
+{
+    other.pixels = nullptr;
+    other.floatPixels = nullptr;
+    other.release = nullptr;
+}
+
+TextureData& TextureData::operator=(TextureData&& other) noexcept {
+    if (this != &other) {
+        reset();
+        release     = other.release;
+        pixels      = other.pixels;
+        floatPixels = other.floatPixels;
+        width       = other.width;
+        height      = other.height;
+        depth       = other.depth;
+        channels    = other.channels;
+        format      = other.format;
+        path        = std::move(other.path);
+
+        other.pixels      = nullptr;
+        other.floatPixels = nullptr;
+        other.release     = nullptr;
+    }
+    return *this;
+}
+
+TextureData::~TextureData() {
+    reset();
+}
+
+void TextureData::reset() {
+    if (release) {
+        release(pixels ? static_cast<void*>(pixels) : floatPixels);
+    } else {
+        delete[] pixels;
+        delete[] floatPixels;
+    }
+    pixels = nullptr;
+    floatPixels = nullptr;
+    release = nullptr;
+}
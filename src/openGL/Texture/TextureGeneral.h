@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <utility>
+
 enum class ColorBufferFormat {
     RGBA = GL_RGBA,
     RGB = GL_RGB,
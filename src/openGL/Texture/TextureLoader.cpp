@@ -7,134 +7,71 @@
 #include <filesystem>
 #include <unordered_map>
 #include <fstream>
+#include <type_traits>
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb/stb_image_write.h"
 
-TextureData::TextureData(std::string path, const unsigned char *pixels, const int width, const int height, const int channels)
-    : width(width), height(height), channels(channels), path(std::move(path))
-{
-    this->pixels = new unsigned char[width * height * channels];
-    memcpy(this->pixels, pixels, width * height * channels * sizeof(unsigned char));
-
-    if (channels == 4)
-        format = TextureFormat::RGBA;
-    else if (channels == 3)
-        format = TextureFormat::RGB;
-    else if (channels == 2)
-        format = TextureFormat::RG;
-    else
-        format = TextureFormat::R;
-}
-
-TextureData::TextureData(const float *pixels, const int width, const int height, const int channels)
-    : width(width), height(height), channels(channels) {
-    this->floatPixels = new float[width * height * channels];
-    memcpy(this->floatPixels, pixels, width * height * channels * sizeof(float));
-    if (channels == 4)
-        format = TextureFormat::RGBA;
-    else if (channels == 3)
-        format = TextureFormat::RGB;
-    else if (channels == 2)
-        format = TextureFormat::RG;
-    else
-        format = TextureFormat::R;
-}
-
-
-TextureData::TextureData(const int width, const int height, const int channels, const TextureFormat format)
-    : width(width), height(height), channels(channels), format(format)
-{
-    assert(width * height * channels); // no char[0]
-    pixels = new unsigned char[width * height * channels];
-}
-
-TextureData::TextureData(const TextureData &other)
-    : width(other.width), height(other.height), channels(other.channels), format(other.format), path(other.path)
-{
-    if (other.pixels) {
-        pixels = new unsigned char[width * height * channels];
-        std::memcpy(pixels, other.pixels, width * height * channels);
-    } else {
-        pixels = nullptr;
+void TextureLoader::flipRows(void* pixels, const size_t rowBytes, const int height) {
+    auto* bytes = static_cast<unsigned char*>(pixels);
+    for (int y = 0; y < height / 2; ++y) {
+        std::swap_ranges(bytes + y * rowBytes, bytes + (y + 1) * rowBytes, bytes + (height - 1 - y) * rowBytes);
     }
 }
 
-TextureData& TextureData::operator=(const TextureData& other) {
-    if (this != &other) {
-        delete[] pixels;
-
-        width    = other.width;
-        height   = other.height;
-        channels = other.channels;
-        format   = other.format;
-        path     = other.path;
-
-        if (other.pixels) {
-            pixels = new unsigned char[width * height * channels];
-            std::memcpy(pixels, other.pixels, width * height * channels);
-        } else {
-            pixels = nullptr;
-        }
+namespace {
+    /* takes the decoder's buffer as is; stb's global flip flag is left alone, so decoding is thread safe */
+    template <typename T>
+    TextureData adopt(T* image, std::string path, const int width, const int height, const int channels) {
+        TextureData data;
+        if constexpr (std::is_same_v<T, float>) data.floatPixels = image;
+        else data.pixels = image;
+        data.path = std::move(path);
+        data.width = width;
+        data.height = height;
+        data.channels = channels;
+        data.format = TextureData::formatOf(channels);
+        return data;
     }
-    return *this;
 }
 
-TextureData::TextureData(TextureData&& other) noexcept
-    : pixels(other.pixels), width(other.width), height(other.height),
-      channels(other.channels), format(other.format), path(std::move(other.path))
+TextureData TextureLoader::load(const char* file, const bool flip, const int forcedChannels)
 {
-    other.pixels = nullptr;
-}
-
-TextureData& TextureData::operator=(TextureData&& other) noexcept {
-    if (this != &other) {
-        pixels   = other.pixels;
-        width    = other.width;
-        height   = other.height;
-        channels = other.channels;
-        format   = other.format;
-        path     = std::move(other.path);
-
-        other.pixels   = nullptr;
+    int width, height, channels;
+    unsigned char* image = stbi_load(file, &width, &height, &channels, forcedChannels);
+    if (!image) {
+        std::cerr << "[ERROR] Failed to load texture: " << file << std::endl;
+        return {};
     }
-    return *this;
-}
 
-TextureData::~TextureData() {
-    delete[] pixels;
+    if (forcedChannels) {
+        channels = forcedChannels;
+    }
+    TextureData data = adopt(image, file, width, height, channels);
+    data.release = stbi_image_free;
+    if (flip) flipRows(data.pixels, data.bytes() / height, height);
+    return data;
 }
 
-
-
-
-
-TextureData TextureLoader::load(const char* file, bool flip, const int forcedChannels)
+TextureData TextureLoader::decode(const std::span<const unsigned char> encoded, const bool flip, const int forcedChannels, std::string path)
 {
     int width, height, channels;
-
-    if (flip)
-        stbi_set_flip_vertically_on_load(1);
-    unsigned char* image = stbi_load(file, &width, &height, &channels, forcedChannels);
+    unsigned char* image = stbi_load_from_memory(encoded.data(), static_cast<int>(encoded.size()), &width, &height, &channels, forcedChannels);
     if (!image) {
-        std::cerr << "[ERROR] Failed to load texture: " << file << std::endl;
+        std::cerr << "[ERROR] Failed to decode texture: " << path << ": " << stbi_failure_reason() << std::endl;
         return {};
     }
 
     if (forcedChannels) {
         channels = forcedChannels;
     }
-    TextureData data(file, image, width, height, channels);
-
-    stbi_image_free(image);
-    stbi_set_flip_vertically_on_load(0);
+    TextureData data = adopt(image, std::move(path), width, height, channels);
+    data.release = stbi_image_free;
+    if (flip) flipRows(data.pixels, data.bytes() / height, height);
     return data;
 }
 
 TextureData TextureLoader::loadf(const char *file, bool flip, const int forcedChannels) {
     int width, height, channels;
-
-    if (flip)
-        stbi_set_flip_vertically_on_load(1);
     float* image = stbi_loadf(file, &width, &height, &channels, forcedChannels);
     if (!image) {
         std::cerr << "[ERROR] Failed to load texture: " << file << std::endl;
@@ -148,45 +85,11 @@ TextureData TextureLoader::loadf(const char *file, bool flip, const int forcedCh
     if (forcedChannels) {
         channels = forcedChannels;
     }
-    TextureData data(image, width, height, channels);
-    data.path = file;
-
-    stbi_image_free(image);
-    stbi_set_flip_vertically_on_load(0);
+    TextureData data = adopt(image, file, width, height, channels);
+    data.release = stbi_image_free;
+    if (flip) flipRows(data.floatPixels, data.bytes() / height * sizeof(float), height);
     return data;
 }
-#include <ImfRgbaFile.h>   // for Imf::Rgba, Imf::RgbaInputFile
-#include <ImfArray.h>      // for Imf::Array2D
-#include <half.h>
-using namespace OPENEXR_IMF_NAMESPACE;
-using namespace IMATH_NAMESPACE;
-
-
-HDRTextureData<half> TextureLoader::loadEXR16F(const char *path, bool flip, int forcedChannels) {
-    try {
-        RgbaInputFile file(path);
-        Box2i dw = file.dataWindow();
-
-        int width  = dw.max.x - dw.min.x + 1;
-        int height = dw.max.y - dw.min.y + 1;
-
-        Array2D<Rgba> pixels;
-        pixels.resizeErase(height, width);
-
-        file.setFrameBuffer(&pixels[0][0] - dw.min.x - dw.min.y * width, 1, width);
-        file.readPixels(dw.min.y, dw.max.y);
-
-        half* rawData = reinterpret_cast<half*>(&pixels[0][0]);
-
-        std::cout << "Loaded: " << width << " x " << height << std::endl;
-
-        return {rawData, width, height, 4};
-    } catch (std::exception& e) {
-        std::cerr << "Failed to load EXR file: " << path << std::endl;
-        std::cerr << e.what() << std::endl;
-        return {};
-    }
-}
 
 std::vector<TextureData> TextureLoader::loadSpritesheet(const char *file)
 {
@@ -274,7 +177,7 @@ std::vector<TextureData> TextureLoader::loadFolder(const char* directory, bool f
         TextureData data = load(filename.c_str(), flip, channels);
         data.path = filename;
         std::cout << "data.path: " << data.path << std::endl;
-        textures.push_back(data);
+        textures.push_back(std::move(data));
     }
     return textures;
 }
@@ -310,7 +213,7 @@ std::array<TextureData, 6> TextureLoader::loadCubemap(const char *directory) {
     });
 
     for (size_t i = 0; i < tempFiles.size(); i++) {
-        cubemap[i] = tempFiles[i].second;
+        cubemap[i] = std::move(tempFiles[i].second);
     }
 
     std::cout << "Cubemap Loaded: " << directory << std::endl;
@@ -321,13 +224,13 @@ std::array<TextureData, 6> TextureLoader::loadCubemap(const char *directory) {
 TextureData TextureLoader::fromSpecularToPBR(const char *file, bool flip) {
     int width, height, channels;
 
-    stbi_set_flip_vertically_on_load(flip);
     unsigned char* specularData = stbi_load(file, &width, &height, &channels, 1);
 
     if (!specularData) {
         std::cerr << "Failed to load image: " << file << std::endl;
         return {};
     }
+    if (flip) flipRows(specularData, width, height);
 
     std::vector<unsigned char> pbrData(width * height * 3);
 
@@ -344,9 +247,7 @@ TextureData TextureLoader::fromSpecularToPBR(const char *file, bool flip) {
         pbrData[i * 3 + 2] = metallic;
     }
 
-    stbi_write_png("metallicRoughness.png", width, height, 3, pbrData.data(), width * 3);
     stbi_image_free(specularData);
-    stbi_set_flip_vertically_on_load(0);
 
     return TextureData(file, pbrData.data(), width, height, 3);
 }
@@ -2,15 +2,25 @@
 
 #include <openGL/Texture/TextureEnum.h>
 #include <array>
+#include <cstring>
 #include <half.h>
+#include <span>
 #include <string>
 #include <vector>
 #include <glm/vec2.hpp>
 #include <algorithm>
 
+/*
+ * Decoded pixels, move only. Pixels the decoder allocated are adopted instead of copied and given back to it
+ * on destruction.
+ */
 class TextureData {
     friend class TextureLoader;
 
+    /* frees decoder owned pixels, delete[] is used when null */
+    void (*release)(void*) = nullptr;
+
+    void reset();
 public:
     std::string path;
     unsigned char* pixels = nullptr;
@@ -24,13 +34,24 @@ public:
     TextureData() : width(0), height(0), channels(0), format(TextureFormat::RGBA) {}
     TextureData(int width, int height, int channels, TextureFormat format);
 
-    TextureData(const TextureData& other);
-    TextureData& operator=(const TextureData& other);
+    TextureData(const TextureData& other) = delete;
+    TextureData& operator=(const TextureData& other) = delete;
 
     TextureData(TextureData&& other) noexcept;
-    TextureData& operator=(TextureData&& other) noexcept ;
+    TextureData& operator=(TextureData&& other) noexcept;
 
     ~TextureData();
+
+    static TextureFormat formatOf(int channels);
+
+    /* of the 8 bit pixels */
+    size_t bytes() const {
+        return static_cast<size_t>(width) * height * channels;
+    }
+
+    explicit operator bool() const {
+        return pixels || floatPixels;
+    }
 };
 
 template <typename F>
@@ -89,8 +110,12 @@ struct HDRTextureData<float> {
 
 
 class TextureLoader {
+    static void flipRows(void* pixels, size_t rowBytes, int height);
 public:
+    /* the loaders are safe to call from several threads at once */
     static TextureData load(const char* file, bool flip = false, int forcedChannels = 0);
+    /* `encoded` is a whole image file in memory */
+    static TextureData decode(std::span<const unsigned char> encoded, bool flip = false, int forcedChannels = 0, std::string path = {});
     static TextureData loadf(const char* file, bool flip = false, int forcedChannels = 0);
     static HDRTextureData<half> loadEXR16F(const char* file, bool flip = false, int forcedChannels = 0);
     static std::vector<TextureData> loadSpritesheet(const char* file);
@@ -0,0 +1,34 @@
+#include "TextureLoader.h"
+#include <iostream>
+
+#include <ImfRgbaFile.h>   // for Imf::Rgba, Imf::RgbaInputFile
+#include <ImfArray.h>      // for Imf::Array2D
+#include <half.h>
+using namespace OPENEXR_IMF_NAMESPACE;
+using namespace IMATH_NAMESPACE;
+
+HDRTextureData<half> TextureLoader::loadEXR16F(const char *path, bool flip, int forcedChannels) {
+    try {
+        RgbaInputFile file(path);
+        Box2i dw = file.dataWindow();
+
+        int width  = dw.max.x - dw.min.x + 1;
+        int height = dw.max.y - dw.min.y + 1;
+
+        Array2D<Rgba> pixels;
+        pixels.resizeErase(height, width);
+
+        file.setFrameBuffer(&pixels[0][0] - dw.min.x - dw.min.y * width, 1, width);
+        file.readPixels(dw.min.y, dw.max.y);
+
+        half* rawData = reinterpret_cast<half*>(&pixels[0][0]);
+
+        std::cout << "Loaded: " << width << " x " << height << std::endl;
+
+        return {rawData, width, height, 4};
+    } catch (std::exception& e) {
+        std::cerr << "Failed to load EXR file: " << path << std::endl;
+        std::cerr << e.what() << std::endl;
+        return {};
+    }
+}
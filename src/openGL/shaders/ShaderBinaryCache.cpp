@@ -0,0 +1,123 @@
+#include "ShaderBinaryCache.h"
+#include "ShaderPreprocessor.h"
+
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+
+namespace {
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t format;
+        uint32_t reserved;
+        uint64_t key;
+        uint64_t size;
+    };
+
+    constexpr char MAGIC[4] = { 'K', 'S', 'H', 'B' };
+
+    static_assert(sizeof(Header) == 32);
+
+    std::string_view bytesOf(const auto& value) {
+        return { reinterpret_cast<const char*>(&value), sizeof(value) };
+    }
+}
+
+std::optional<std::vector<std::byte>> DiskShaderBinaryStore::load(const std::string_view name) {
+    std::ifstream file(std::filesystem::path(directory) / name, std::ios::binary);
+    if (!file) return std::nullopt;
+
+    std::vector<std::byte> bytes;
+    std::error_code error;
+    bytes.resize(std::filesystem::file_size(std::filesystem::path(directory) / name, error));
+    if (error || !file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+        return std::nullopt;
+    }
+    return bytes;
+}
+
+bool DiskShaderBinaryStore::store(const std::string_view name, const std::span<const std::byte> bytes) {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) return false;
+
+    const std::filesystem::path path = std::filesystem::path(directory) / name;
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!file) return false;
+    }
+
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+uint64_t ShaderBinaryCache::keyOf(const std::string_view driver, const std::span<const Stage> stages) {
+    uint64_t key = ShaderPreprocessor::hash(bytesOf(VERSION));
+    key = ShaderPreprocessor::hash(driver, key);
+    for (const Stage& stage : stages) {
+        key = ShaderPreprocessor::hash(bytesOf(stage.type), key);
+        key = ShaderPreprocessor::hash(bytesOf(stage.sourceHash), key);
+    }
+    return key;
+}
+
+std::string ShaderBinaryCache::nameOf(const uint64_t key) {
+    constexpr char DIGITS[] = "0123456789abcdef";
+    std::string name(16, '0');
+    for (int i = 0; i < 16; ++i) {
+        name[15 - i] = DIGITS[(key >> (i * 4)) & 0xf];
+    }
+    return name + ".bin";
+}
+
+std::vector<std::byte> ShaderBinaryCache::serialize(const uint64_t key, const Binary& binary) {
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.format = binary.format;
+    header.key = key;
+    header.size = binary.bytes.size();
+
+    std::vector<std::byte> bytes(sizeof(Header) + binary.bytes.size());
+    std::memcpy(bytes.data(), &header, sizeof(Header));
+    std::ranges::copy(binary.bytes, bytes.begin() + sizeof(Header));
+    return bytes;
+}
+
+std::expected<ShaderBinaryCache::Binary, ShaderCacheError> ShaderBinaryCache::deserialize(const uint64_t key, const std::span<const std::byte> bytes) {
+    if (bytes.size() < sizeof(Header)) return std::unexpected(ShaderCacheError::CACHE_CORRUPT);
+
+    Header header;
+    std::memcpy(&header, bytes.data(), sizeof(Header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) return std::unexpected(ShaderCacheError::CACHE_CORRUPT);
+    if (header.version != VERSION) return std::unexpected(ShaderCacheError::CACHE_VERSION);
+    if (header.key != key || header.size != bytes.size() - sizeof(Header)) return std::unexpected(ShaderCacheError::CACHE_CORRUPT);
+
+    return Binary{ header.format, std::vector(bytes.begin() + sizeof(Header), bytes.end()) };
+}
+
+std::expected<ShaderBinaryCache::Binary, ShaderCacheError> ShaderBinaryCache::find(const uint64_t key) const {
+    if (!store) return std::unexpected(ShaderCacheError::CACHE_MISS);
+
+    const auto bytes = store->load(nameOf(key));
+    if (!bytes) return std::unexpected(ShaderCacheError::CACHE_MISS);
+    return deserialize(key, *bytes);
+}
+
+std::expected<void, ShaderCacheError> ShaderBinaryCache::insert(const uint64_t key, const Binary& binary) {
+    if (!store || !store->store(nameOf(key), serialize(key, binary))) {
+        return std::unexpected(ShaderCacheError::CACHE_WRITE_FAILED);
+    }
+    return {};
+}
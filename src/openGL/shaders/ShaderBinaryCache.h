@@ -0,0 +1,72 @@
+#pragma once
+#include <span>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <string_view>
+
+enum class ShaderCacheError {
+    CACHE_MISS, CACHE_VERSION, CACHE_CORRUPT, CACHE_WRITE_FAILED
+};
+
+/* where cached programs are kept, by the name ShaderBinaryCache gives them */
+class ShaderBinaryStore {
+public:
+    virtual ~ShaderBinaryStore() = default;
+
+    virtual std::optional<std::vector<std::byte>> load(std::string_view name) = 0;
+    virtual bool store(std::string_view name, std::span<const std::byte> bytes) = 0;
+};
+
+class DiskShaderBinaryStore final : public ShaderBinaryStore {
+    std::string directory;
+public:
+    explicit DiskShaderBinaryStore(std::string directory) : directory(std::move(directory)) {}
+
+    std::optional<std::vector<std::byte>> load(std::string_view name) override;
+
+    /* writes through a temporary file, a program loading at the same time never reads half a binary */
+    bool store(std::string_view name, std::span<const std::byte> bytes) override;
+};
+
+/*
+ * Linked program binaries keyed by the driver and the hashes of the preprocessed stages. Any change to a stage or
+ * one of its includes, or a driver update, changes the key, so entries are never invalidated, only no longer asked
+ * for. Each entry repeats its key in a small header, a colliding or truncated file is rejected rather than loaded.
+ */
+class ShaderBinaryCache {
+public:
+    constexpr static uint32_t VERSION = 1;
+
+    struct Stage {
+        uint32_t type;
+        uint64_t sourceHash;
+    };
+
+    struct Binary {
+        uint32_t format = 0;
+        std::vector<std::byte> bytes;
+    };
+
+    /* the driver string is whatever identifies the driver that produced a binary, vendor, renderer and version for GL */
+    static uint64_t keyOf(std::string_view driver, std::span<const Stage> stages);
+    static std::string nameOf(uint64_t key);
+
+    static std::vector<std::byte> serialize(uint64_t key, const Binary& binary);
+    static std::expected<Binary, ShaderCacheError> deserialize(uint64_t key, std::span<const std::byte> bytes);
+
+    explicit ShaderBinaryCache(std::unique_ptr<ShaderBinaryStore> store) : store(std::move(store)) {}
+
+    std::expected<Binary, ShaderCacheError> find(uint64_t key) const;
+    std::expected<void, ShaderCacheError> insert(uint64_t key, const Binary& binary);
+
+    bool isEnabled() const {
+        return store != nullptr;
+    }
+private:
+    std::unique_ptr<ShaderBinaryStore> store;
+};
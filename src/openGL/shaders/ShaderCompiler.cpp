@@ -1,90 +1,149 @@
 #include "ShaderCompiler.h"
 
-#include <filesystem>
-#include <fstream>
+#include <array>
+#include <algorithm>
+#include <span>
+#include <vector>
 #include <gl/glew.h>
-#include <sstream>
-#include <regex>
 
-std::unordered_map<std::string, std::string> ShaderCompiler::imports;
-
-void ShaderCompiler::loadImports(const char *file) {
-    const std::ifstream fileStream(file);
+ShaderPreprocessor ShaderCompiler::preprocessor;
+ShaderBinaryCache ShaderCompiler::binaryCache(std::make_unique<DiskShaderBinaryStore>(CACHE_DIRECTORY));
+
+namespace {
+    struct Stage {
+        const char* path;
+        GLenum type;
+    };
+
+    std::string shaderLog(const GLuint shader) {
+        GLint length = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+        std::string log(std::max(length, 1), '\0');
+        glGetShaderInfoLog(shader, length, nullptr, log.data());
+        return log;
+    }
 
-    if (!file) {
-        std::cerr << "Error opening file " << file << std::endl;
-        return;
+    std::string programLog(const GLuint program) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        std::string log(std::max(length, 1), '\0');
+        glGetProgramInfoLog(program, length, nullptr, log.data());
+        return log;
     }
 
-    std::string line;
+    /* empty when the driver cannot hand out program binaries, which turns the cache off */
+    const std::string& driver() {
+        static const std::string name = [] {
+            GLint formats = 0;
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            if (formats <= 0) return std::string();
+
+            std::string name;
+            for (const GLenum string : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+                if (const auto* value = glGetString(string)) name += reinterpret_cast<const char*>(value);
+                name += '\n';
+            }
+            return name;
+        }();
+        return name;
+    }
 
-    static std::regex lookup(R"(export\s+?(.*\s*?)\{\s*([\s\S]*)\s*\})");
+    GLuint loadBinary(const ShaderBinaryCache::Binary& binary) {
+        const GLuint program = glCreateProgram();
+        glProgramBinary(program, binary.format, binary.bytes.data(), static_cast<GLsizei>(binary.bytes.size()));
 
-    std::stringstream ss;
-    ss << fileStream.rdbuf();
+        // a driver may still refuse a binary it wrote, the program is compiled again then
+        GLint success;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            glDeleteProgram(program);
+            return 0;
+        }
+        return program;
+    }
 
-    line = ss.str();
+    void storeBinary(const GLuint program, const uint64_t key) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return;
 
-    auto begin = std::sregex_iterator(line.begin(), line.end(), lookup);
-    auto end = std::sregex_iterator();
+        ShaderBinaryCache::Binary binary;
+        binary.bytes.resize(length);
+        GLenum format;
+        glGetProgramBinary(program, length, nullptr, &format, binary.bytes.data());
+        binary.format = format;
 
-    std::cout << "File: " << line << std::endl;
-    for (auto it = begin; it != end; ++it) {
-        std::smatch match = *it;
-        std::string codeInsideBraces = match[2].str();
-        std::cout << "Key: " << match[1].str() << std::endl;
-        std::cout << "Matched code: " << codeInsideBraces << std::endl;
+        if (!ShaderCompiler::binaryCache.insert(key, binary)) {
+            std::cerr << "Failed to cache shader program " << ShaderBinaryCache::nameOf(key) << std::endl;
+        }
     }
-}
 
-std::string ShaderCompiler::readFile(const std::string &filePath)
-{
-    std::ifstream file(filePath);
-    if (!file) {
-        std::cerr << "File not found: " << filePath << std::endl;
-        return "";
-    }
+    GLuint createProgram(const std::span<const Stage> stages) {
+        std::vector<ShaderSource> sources;
+        std::vector<ShaderBinaryCache::Stage> hashes;
+        for (const Stage& stage : stages) {
+            auto source = ShaderCompiler::preprocessor.preprocess(stage.path);
+            if (!source) {
+                std::cerr << "ERROR::SHADER::PREPROCESSING_FAILED\n" << source.error() << std::endl;
+                return 0;
+            }
+            hashes.push_back({ stage.type, source->hash });
+            sources.push_back(std::move(*source));
+        }
+
+        const bool cached = ShaderCompiler::binaryCache.isEnabled() && !driver().empty();
+        const uint64_t key = cached ? ShaderBinaryCache::keyOf(driver(), hashes) : 0;
+        if (cached) {
+            if (const auto binary = ShaderCompiler::binaryCache.find(key)) {
+                if (const GLuint program = loadBinary(*binary)) return program;
+            }
+        }
+
+        std::vector<GLuint> shaders;
+        for (size_t i = 0; i < stages.size(); ++i) {
+            shaders.push_back(ShaderCompiler::compileShader(sources[i], stages[i].type));
+        }
 
-    std::stringstream buffer;
-    std::string line;
-    std::string result;
-    std::filesystem::path basePath = std::filesystem::path(filePath).parent_path();
-
-    while (std::getline(file, line)) {
-        if (line.starts_with("#include")) {
-            // Parse the include path
-            size_t firstQuote = line.find_first_of("\"<");
-            size_t lastQuote  = line.find_last_of("\">");
-
-            if (firstQuote != std::string::npos && lastQuote != std::string::npos && lastQuote > firstQuote) {
-                std::string includePath = line.substr(firstQuote + 1, lastQuote - firstQuote - 1);
-                std::filesystem::path fullIncludePath = basePath / includePath;
-                std::cout << "Reading File: " << fullIncludePath.string() << std::endl;
-                result += readFile(fullIncludePath.string());  // Recursive include
+        GLuint program = 0;
+        if (std::ranges::find(shaders, 0u) == shaders.end()) {
+            program = glCreateProgram();
+            if (cached) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            for (const GLuint shader : shaders) glAttachShader(program, shader);
+            glLinkProgram(program);
+
+            GLint success;
+            glGetProgramiv(program, GL_LINK_STATUS, &success);
+            if (!success) {
+                std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED " << stages.front().path << "\n" << programLog(program);
+                glDeleteProgram(program);
+                program = 0;
             }
-        } else {
-            result += line + "\n";
         }
+
+        for (const GLuint shader : shaders) {
+            if (!shader) continue;
+            if (program) glDetachShader(program, shader);
+            glDeleteShader(shader);
+        }
+
+        if (program && cached) storeBinary(program, key);
+        return program;
     }
-    return result;
 }
 
-GLuint ShaderCompiler::compileShader(const char *source, const GLenum shaderType)
+GLuint ShaderCompiler::compileShader(const ShaderSource& source, const GLenum shaderType)
 {
-    GLuint shader = glCreateShader(shaderType);
-    const char* src = source;
+    const GLuint shader = glCreateShader(shaderType);
+    const char* src = source.text.c_str();
     glShaderSource(shader, 1, &src, nullptr);
     glCompileShader(shader);
 
     int success;
     glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
     if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
-        std::cerr << "Failed to Compile: " << source << std::endl;
-        std::cerr <<  "ERROR::SHADER::COMPILATION_FAILED\n" + std::string(infoLog);
-        std::exit(-1);
-        shader = 0;
+        std::cerr << "ERROR::SHADER::COMPILATION_FAILED " << source.files.front() << "\n" << source.mapLog(shaderLog(shader)) << std::endl;
+        glDeleteShader(shader);
+        return 0;
     }
 
     return shader;
@@ -92,65 +151,28 @@ GLuint ShaderCompiler::compileShader(const char *source, const GLenum shaderType
 
 GLuint ShaderCompiler::createShaderProgram(const char *vertex_shader, const char *frag_shader)
 {
-    const std::string vertexShaderSource = readFile(vertex_shader);
-    const std::string fragmentShaderSource = readFile(frag_shader);
-
-    const GLuint vertexShader = compileShader(vertexShaderSource.c_str(), GL_VERTEX_SHADER);
-    const GLuint fragmentShader = compileShader(fragmentShaderSource.c_str(), GL_FRAGMENT_SHADER);
-
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-
-    int success;
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-        std::cerr << "ERROR::SHADER::PROGRAM::VALIDATION_FAILED\n" + std::string(infoLog);
-        shaderProgram = 0;
-    } else {
+    const std::array<Stage, 2> stages = {{
+        { vertex_shader, GL_VERTEX_SHADER },
+        { frag_shader, GL_FRAGMENT_SHADER }
+    }};
+    GLuint shaderProgram = createProgram(stages);
+
+    if (shaderProgram) {
+        int success;
         glValidateProgram(shaderProgram);
         glGetProgramiv(shaderProgram, GL_VALIDATE_STATUS, &success);
         if (!success) {
-            char infoLog[512];
-            glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-            std::cerr << "ERROR::SHADER::PROGRAM::INVALID_VALUE\n" + std::string(infoLog);
+            std::cerr << "ERROR::SHADER::PROGRAM::INVALID_VALUE\n" + programLog(shaderProgram);
+            glDeleteProgram(shaderProgram);
             shaderProgram = 0;
         }
     }
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
     return shaderProgram;
 }
 
-GLuint ShaderCompiler::linkComputeShader(GLuint computeShader)
-{
-    const GLuint program = glCreateProgram();
-    glAttachShader(program, computeShader);
-    glLinkProgram(program);
-
-    // Check for linking errors
-    GLint success;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success) {
-        char log[512];
-        glGetProgramInfoLog(program, 512, nullptr, log);
-        std::cerr << "Compute Shader Program Linking Failed:\n" << log << std::endl;
-        return 0;
-    }
-
-    return program;
-}
-
 GLuint ShaderCompiler::createComputeShader(const char *src)
 {
-    const std::string shaderSource = readFile(src);
-
-    return linkComputeShader(compileShader(shaderSource.c_str(), GL_COMPUTE_SHADER));
+    const std::array<Stage, 1> stages = {{ { src, GL_COMPUTE_SHADER } }};
+    return createProgram(stages);
 }
-
@@ -2,20 +2,25 @@
 #include <iostream>
 #include <unordered_map>
 
+#include "ShaderPreprocessor.h"
+#include "ShaderBinaryCache.h"
+
+/*
+ * Builds programs from shader files. Stages go through the shared ShaderPreprocessor, and linked programs are
+ * kept in the ShaderBinaryCache, so a program whose sources and driver did not change since the last run is
+ * loaded from its binary instead of compiled. Failures are logged with the include file and line and give 0.
+ */
 class ShaderCompiler {
 public:
-    static std::unordered_map<std::string, std::string> imports;
+    constexpr static auto CACHE_DIRECTORY = "shaders/.cache";
 
-    static void loadImports(const char* file);
+    static ShaderPreprocessor preprocessor;
+    static ShaderBinaryCache binaryCache;
 
-    static std::string readFile(const std::string& filePath);
-
-    static unsigned compileShader(const char* source, unsigned shaderType);
+    static unsigned compileShader(const ShaderSource& source, unsigned shaderType);
 
     static unsigned createShaderProgram(const char* vertex_shader, const char* frag_shader);
 
-    static unsigned linkComputeShader(unsigned computeShader);
-
     static unsigned createComputeShader(const char* src);
 
 };
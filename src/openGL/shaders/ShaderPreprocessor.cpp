@@ -0,0 +1,201 @@
+#include "ShaderPreprocessor.h"
+
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+
+namespace {
+    std::string_view trim(std::string_view text) {
+        while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) text.remove_prefix(1);
+        while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) text.remove_suffix(1);
+        return text;
+    }
+
+    /* the directive name of `#name rest`, with `line` left at the rest */
+    std::string_view directive(std::string_view& line) {
+        if (!line.starts_with('#')) return {};
+        line = trim(line.substr(1));
+        const size_t end = std::min(line.find_first_of(" \t"), line.size());
+        const std::string_view name = line.substr(0, end);
+        line = trim(line.substr(end));
+        return name;
+    }
+
+    std::string normalize(const std::filesystem::path& path) {
+        return path.lexically_normal().generic_string();
+    }
+}
+
+uint64_t ShaderPreprocessor::hash(const std::string_view bytes, uint64_t seed) {
+    for (const char c : bytes) {
+        seed ^= static_cast<unsigned char>(c);
+        seed *= 1099511628211ull;
+    }
+    return seed;
+}
+
+std::expected<ShaderSource, std::string> ShaderPreprocessor::preprocess(const std::string& path) {
+    checked.clear();
+
+    ShaderSource source;
+    std::vector<std::string> stack;
+    if (auto expanded = expand(normalize(path), source, stack); !expanded) {
+        return std::unexpected(std::move(expanded.error()));
+    }
+    source.hash = hash(source.text);
+    return source;
+}
+
+const ShaderPreprocessor::File* ShaderPreprocessor::load(const std::string& path, std::string& error) {
+    auto it = files.find(path);
+    // stat once per stage, a file reparsed halfway through would pull its text from under the includes expanding it
+    if (it != files.end() && !checked.emplace(path).second) return &it->second;
+
+    std::error_code code;
+    const auto size = std::filesystem::file_size(path, code);
+    const auto time = code ? std::filesystem::file_time_type{} : std::filesystem::last_write_time(path, code);
+    if (code) {
+        if (it != files.end()) files.erase(it);
+        error = "cannot open " + path;
+        return nullptr;
+    }
+
+    const Stamp stamp{ static_cast<uint64_t>(size), static_cast<int64_t>(time.time_since_epoch().count()) };
+    if (it != files.end() && it->second.stamp == stamp) return &it->second;
+
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) {
+        error = "cannot open " + path;
+        return nullptr;
+    }
+    std::stringstream buffer;
+    buffer << stream.rdbuf();
+
+    checked.emplace(path);
+    File& file = files[path];
+    file.stamp = stamp;
+    file.text = std::move(buffer).str();
+    parse(path, file);
+    return &file;
+}
+
+void ShaderPreprocessor::parse(const std::string& path, File& file) {
+    if (!file.text.empty() && file.text.back() != '\n') file.text += '\n';
+    file.segments.clear();
+    file.once = false;
+
+    const std::filesystem::path base = std::filesystem::path(path).parent_path();
+    const std::string_view text = file.text;
+
+    // the first two and the last significant lines, for spotting a guard around the whole file
+    std::string_view first, second, last;
+    size_t significant = 0;
+
+    uint32_t number = 1;
+    for (size_t begin = 0; begin < text.size(); ++number) {
+        const size_t end = text.find('\n', begin) + 1;
+        const std::string_view line = text.substr(begin, end - begin);
+        begin = end;
+
+        std::string_view rest = trim(line);
+        if (!rest.empty() && !rest.starts_with("//")) {
+            if (significant == 0) first = rest;
+            else if (significant == 1) second = rest;
+            last = rest;
+            ++significant;
+        }
+
+        const std::string_view name = directive(rest);
+        if (name == "include" && rest.size() > 2) {
+            const char close = rest.front() == '<' ? '>' : '"';
+            if (const size_t end = rest.find(close, 1); (rest.front() == '"' || rest.front() == '<') && end != std::string_view::npos) {
+                file.segments.push_back({ number, 1, {}, normalize(base / rest.substr(1, end - 1)) });
+                continue;
+            }
+        } else if (name == "pragma" && rest == "once") {
+            file.once = true;
+            continue;
+        }
+
+        if (!file.segments.empty() && file.segments.back().include.empty()) {
+            Segment& run = file.segments.back();
+            run.text = std::string_view(run.text.data(), run.text.size() + line.size());
+            ++run.lineCount;
+        } else {
+            file.segments.push_back({ number, 1, line, {} });
+        }
+    }
+
+    if (significant >= 3 && !file.once) {
+        std::string_view guard = first, define = second, endif = last;
+        if (directive(guard) == "ifndef" && directive(define) == "define" && directive(endif) == "endif") {
+            file.once = !guard.empty() && guard == define;
+        }
+    }
+}
+
+std::expected<void, std::string> ShaderPreprocessor::expand(const std::string& path, ShaderSource& out, std::vector<std::string>& stack) {
+    if (std::ranges::find(stack, path) != stack.end()) {
+        return std::unexpected("include cycle through " + path);
+    }
+
+    std::string error;
+    const File* file = load(path, error);
+    if (!file) return std::unexpected(std::move(error));
+
+    const auto known = std::ranges::find(out.files, path);
+    if (known != out.files.end() && file->once) return {};
+
+    const auto index = static_cast<uint32_t>(known - out.files.begin());
+    if (known == out.files.end()) out.files.push_back(path);
+
+    stack.push_back(path);
+    for (const Segment& segment : file->segments) {
+        if (!segment.include.empty()) {
+            if (auto included = expand(segment.include, out, stack); !included) {
+                return std::unexpected(path + ":" + std::to_string(segment.firstLine) + ": " + included.error());
+            }
+            continue;
+        }
+
+        out.text.append(segment.text);
+        for (uint32_t line = 0; line < segment.lineCount; ++line) {
+            out.lines.push_back({ index, segment.firstLine + line });
+        }
+    }
+    stack.pop_back();
+    return {};
+}
+
+std::string ShaderSource::mapLog(const std::string_view log) const {
+    std::string mapped;
+    mapped.reserve(log.size());
+
+    for (size_t i = 0; i < log.size();) {
+        // source string 0, then the line either in parentheses or after a colon
+        const bool position = log[i] == '0' && (i == 0 || !std::isalnum(static_cast<unsigned char>(log[i - 1])))
+            && i + 2 < log.size() && (log[i + 1] == '(' || log[i + 1] == ':') && std::isdigit(static_cast<unsigned char>(log[i + 2]));
+
+        if (position) {
+            size_t end = i + 2;
+            size_t number = 0;
+            while (end < log.size() && std::isdigit(static_cast<unsigned char>(log[end]))) {
+                number = number * 10 + (log[end++] - '0');
+            }
+
+            const bool parenthesized = log[i + 1] == '(';
+            if ((!parenthesized || (end < log.size() && log[end] == ')')) && number >= 1 && number <= lines.size()) {
+                const Line& origin = lines[number - 1];
+                mapped += files[origin.file];
+                mapped += ':';
+                mapped += std::to_string(origin.line);
+                i = parenthesized ? end + 1 : end;
+                continue;
+            }
+        }
+        mapped += log[i++];
+    }
+    return mapped;
+}
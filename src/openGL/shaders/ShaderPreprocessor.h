@@ -0,0 +1,77 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <expected>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+/* a shader stage with its includes expanded, every line remembers where it came from */
+struct ShaderSource {
+    struct Line {
+        uint32_t file;
+        uint32_t line;
+    };
+
+    std::string text;
+    std::vector<std::string> files;     /* files[0] is the root */
+    std::vector<Line> lines;
+    uint64_t hash = 0;
+
+    /* rewrites the positions of a driver log, 0(12) or 0:12 depending on the vendor, to the file and line they came from */
+    std::string mapLog(std::string_view log) const;
+};
+
+/*
+ * Expands `#include "path"` relative to the including file. Each file is read and split into text runs and
+ * includes once, and kept until its size or write time changes, so headers shared by many programs are not read
+ * again for every one of them. A file with `#pragma once` or a whole-file `#ifndef` guard is pasted at most once
+ * per stage, an include cycle is an error.
+ *
+ * Does not touch GL, the result only needs a compiler.
+ */
+class ShaderPreprocessor {
+public:
+    static uint64_t hash(std::string_view bytes, uint64_t seed = 14695981039346656037ull);
+
+    std::expected<ShaderSource, std::string> preprocess(const std::string& path);
+
+    size_t cachedFiles() const {
+        return files.size();
+    }
+
+    void clear() {
+        files.clear();
+    }
+private:
+    struct Stamp {
+        uint64_t size = 0;
+        int64_t writeTime = 0;
+
+        bool operator==(const Stamp&) const = default;
+    };
+
+    /* a run of text lines, or an include when `include` is set */
+    struct Segment {
+        uint32_t firstLine;
+        uint32_t lineCount;
+        std::string_view text;
+        std::string include;
+    };
+
+    struct File {
+        Stamp stamp;
+        std::string text;
+        std::vector<Segment> segments;
+        bool once = false;
+    };
+
+    const File* load(const std::string& path, std::string& error);
+    static void parse(const std::string& path, File& file);
+
+    std::expected<void, std::string> expand(const std::string& path, ShaderSource& out, std::vector<std::string>& stack);
+
+    std::unordered_map<std::string, File> files;
+    std::unordered_set<std::string> checked;
+};
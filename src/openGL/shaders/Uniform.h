@@ -110,7 +110,7 @@ public:
             value.mat4 = std::forward<T>(val);
             type = Type::MAT4;
         } else {
-            static_assert(false, "Invalid Uniform Type");
+            static_assert(sizeof(dT) == 0, "Invalid Uniform Type");
         }
         return *this;
     }
@@ -6,7 +6,11 @@
 
 void UniformData::upload(const char* key, const Uniform& uniform)
 {
-    const int location = glGetUniformLocation(programID, key);
+    upload(glGetUniformLocation(programID, key), uniform);
+}
+
+void UniformData::upload(const int location, const Uniform& uniform)
+{
     const auto data = static_cast<const float*>(uniform.raw());
 
     const int amount = uniform.amount();
@@ -32,8 +36,4 @@ void UniformData::upload(const char* key, const Uniform& uniform)
             break;                    
         default: break;
     }
-
-    if (strcmp(key, "model") == 0) {
-      //  uniform.print();
-    }
 }
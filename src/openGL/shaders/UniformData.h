@@ -57,6 +57,9 @@ public:
         upload(key, uniform);
     }
 
+    /* uploads to an already resolved location of the current program */
+    static void upload(int location, const Uniform& uniform);
+
     const Uniform& operator [] (const std::string& key) const {
         return uniforms.at(key);
     }
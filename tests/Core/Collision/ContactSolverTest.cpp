@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <Core/Collision/ContactSolver.h>
+
+#include <glm/geometric.hpp>
+
+namespace {
+    constexpr float GRAVITY = 9.81f;
+    constexpr float STEP = 1.f / 60.f;
+
+    /* what a physics step does to the boxes: gravity, movement, then the contacts of every overlapping pair */
+    struct Scene {
+        std::vector<ContactBody> bodies;
+        ContactSolver solver;
+
+        uint32_t addGround(const float friction = 0.5f) {
+            ContactBody& ground = bodies.emplace_back();
+            ground.box = AABB(glm::vec3(0.f, -5.f, 0.f), glm::vec3(50.f, 5.f, 50.f));
+            ground.friction = friction;
+            return static_cast<uint32_t>(bodies.size() - 1);
+        }
+
+        uint32_t addBox(const glm::vec3& center, const float friction = 0.5f, const float mass = 1.f) {
+            ContactBody& box = bodies.emplace_back();
+            box.box = AABB(center, glm::vec3(0.5f));
+            box.inverseMass = 1.f / mass;
+            box.friction = friction;
+            return static_cast<uint32_t>(bodies.size() - 1);
+        }
+
+        std::span<const ContactSolver::Contact> step(const glm::vec3& push = glm::vec3(0.f), const uint32_t pushed = 0) {
+            for (uint32_t i = 0; i < bodies.size(); ++i) {
+                ContactBody& body = bodies[i];
+                if (body.inverseMass <= 0.f) continue;
+                body.velocity.y -= GRAVITY * STEP;
+                if (i == pushed) body.velocity += push * body.inverseMass * STEP;
+                body.box.center += body.velocity * STEP;
+            }
+
+            std::vector<ContactSolver::Pair> pairs;
+            for (uint32_t a = 0; a < bodies.size(); ++a) {
+                for (uint32_t b = a + 1; b < bodies.size(); ++b) {
+                    pairs.push_back({ a, b, Entity(a), Entity(b) });
+                }
+            }
+            return solver.solve(bodies, pairs, STEP);
+        }
+    };
+}
+
+TEST(ContactSolver, StackedBoxesComeToRest) {
+    constexpr int HEIGHT = 6;
+    Scene scene;
+    scene.addGround();
+    // dropped a little apart, so the stack has to land and settle rather than start at rest
+    for (int i = 0; i < HEIGHT; ++i) {
+        scene.addBox(glm::vec3(0.f, 0.52f + 1.02f * i, 0.f));
+    }
+
+    for (int s = 0; s < 600; ++s) scene.step();
+
+    const ContactSolver::Settings settings;
+    for (int i = 0; i < HEIGHT; ++i) {
+        const ContactBody& box = scene.bodies[1 + i];
+        const ContactBody& below = scene.bodies[i];
+        SCOPED_TRACE(testing::Message() << "box " << i);
+        EXPECT_LT(glm::length(box.velocity), 1e-2f);
+        // every contact keeps touching, by about the slop plus what gravity pushes in per step, and nothing slid sideways
+        const float overlap = (below.box.center.y + below.box.halfSize.y) - (box.box.center.y - box.box.halfSize.y);
+        EXPECT_GT(overlap, 0.f);
+        EXPECT_LT(overlap, 2.f * settings.slop);
+        EXPECT_NEAR(box.box.center.x, 0.f, 1e-4f);
+        EXPECT_NEAR(box.box.center.z, 0.f, 1e-4f);
+    }
+    // every resting contact stays cached from step to step
+    EXPECT_EQ(scene.solver.cachedContacts(), static_cast<size_t>(HEIGHT));
+}
+
+TEST(ContactSolver, StacksHoldForLongRuns) {
+    Scene scene;
+    scene.addGround();
+    for (int i = 0; i < 4; ++i) scene.addBox(glm::vec3(0.f, 0.5f + i - 0.004f * (i + 1), 0.f));
+    for (int s = 0; s < 120; ++s) scene.step();
+
+    std::vector<float> settled;
+    for (const ContactBody& body : scene.bodies) settled.push_back(body.box.center.y);
+    // a minute more creeps by no more than a fraction of the slop
+    for (int s = 0; s < 3600; ++s) scene.step();
+    for (size_t i = 1; i < scene.bodies.size(); ++i) {
+        EXPECT_NEAR(scene.bodies[i].box.center.y, settled[i], 1e-3f) << i;
+    }
+}
+
+TEST(ContactSolver, FrictionStopsASlidingBoxAtTheCoulombDistance) {
+    for (const float friction : { 0.2f, 0.5f, 0.9f }) {
+        Scene scene;
+        scene.addGround(friction);
+        const uint32_t box = scene.addBox(glm::vec3(0.f, 0.496f, 0.f), friction);
+        scene.step();
+
+        constexpr float SPEED = 3.f;
+        scene.bodies[box].velocity.x = SPEED;
+        const float start = scene.bodies[box].box.center.x;
+        for (int s = 0; s < 600; ++s) {
+            scene.step();
+            // friction never pushes it back
+            ASSERT_GE(scene.bodies[box].velocity.x, 0.f) << s;
+        }
+
+        // the combined coefficient of two equal surfaces is theirs, the box decelerates at mu * g
+        const float expected = SPEED * SPEED / (2.f * friction * GRAVITY);
+        EXPECT_NEAR(scene.bodies[box].box.center.x - start, expected, expected * 0.05f) << friction;
+        EXPECT_EQ(scene.bodies[box].velocity.x, 0.f) << friction;
+    }
+}
+
+TEST(ContactSolver, FrictionHoldsInsideTheConeAndSlipsOutside) {
+    constexpr float FRICTION = 0.5f;
+    constexpr float LIMIT = FRICTION * GRAVITY; // for a mass of 1
+
+    for (const float push : { 0.5f * LIMIT, 0.9f * LIMIT, 1.5f * LIMIT }) {
+        Scene scene;
+        scene.addGround(FRICTION);
+        const uint32_t box = scene.addBox(glm::vec3(0.f, 0.496f, 0.f), FRICTION);
+        scene.step();
+
+        const float start = scene.bodies[box].box.center.x;
+        for (int s = 0; s < 120; ++s) scene.step(glm::vec3(push, 0.f, 0.f), box);
+        const float moved = scene.bodies[box].box.center.x - start;
+
+        if (push < LIMIT) {
+            EXPECT_NEAR(moved, 0.f, 1e-5f) << push;
+        } else {
+            // two seconds of the net acceleration
+            const float expected = 0.5f * (push - LIMIT) * 4.f;
+            EXPECT_NEAR(moved, expected, expected * 0.05f) << push;
+        }
+    }
+}
+
+TEST(ContactSolver, FrictionlessBoxesKeepSliding) {
+    Scene scene;
+    scene.addGround(0.f);
+    const uint32_t box = scene.addBox(glm::vec3(0.f, 0.496f, 0.f), 0.f);
+    scene.step();
+    scene.bodies[box].velocity.z = -2.f;
+    for (int s = 0; s < 300; ++s) scene.step();
+    EXPECT_NEAR(scene.bodies[box].velocity.z, -2.f, 1e-5f);
+    EXPECT_NEAR(scene.bodies[box].box.center.y, 0.5f, 0.01f);
+}
+
+TEST(ContactSolver, EndedContactsLeaveTheCache) {
+    Scene scene;
+    scene.addGround();
+    scene.addBox(glm::vec3(0.f, 0.496f, 0.f));
+    scene.step();
+    ASSERT_EQ(scene.solver.cachedContacts(), 1u);
+
+    // a step without any pairs, as a frame whose broad phase found nothing
+    scene.solver.solve(scene.bodies, {});
+    EXPECT_EQ(scene.solver.cachedContacts(), 0u);
+
+    // a pair that is reported but no longer touches ages out as well
+    scene.step();
+    ASSERT_EQ(scene.solver.cachedContacts(), 1u);
+    scene.bodies[1].box.center.y = 5.f;
+    scene.bodies[1].velocity = glm::vec3(0.f);
+    scene.step();
+    EXPECT_EQ(scene.solver.cachedContacts(), 0u);
+}
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include <Core/Collision/FixedTimestep.h>
+#include <Core/Collision/Integrator.h>
+
+#include <cmath>
+#include <random>
+
+namespace {
+    struct Body {
+        Transform transform;
+        Velocity velocity;
+        RigidBody rigid;
+    };
+
+    struct State {
+        glm::vec3 position;
+        glm::vec3 velocity;
+
+        bool operator==(const State&) const = default;
+    };
+
+    /* what SlowdownSystem and MovementSystem do to a body in one step */
+    void step(Body& body, const float seconds) {
+        integrate::velocity(body.velocity, body.rigid, seconds);
+        integrate::position(body.transform, body.velocity, seconds);
+    }
+
+    Body thrownBody() {
+        Body body;
+        body.transform.translation = glm::vec3(0.f, 10.f, 0.f);
+        // slower than the air speed cap, so only gravity acts
+        body.velocity = Velocity(glm::vec3(0.1f, 5.f, 0.f));
+        body.rigid.gravity = 9.81f;
+        return body;
+    }
+
+    /* the body's state after every step the timestep hands out for these frame times */
+    std::vector<State> simulate(FixedTimestep& timestep, const std::vector<double>& frames, std::vector<uint32_t>* stepsPerFrame = nullptr) {
+        Body body = thrownBody();
+        std::vector<State> states;
+        for (const double frame : frames) {
+            const uint32_t steps = timestep.advance(frame);
+            if (stepsPerFrame) stepsPerFrame->push_back(steps);
+            for (uint32_t s = 0; s < steps; ++s) {
+                step(body, timestep.getStep());
+                states.push_back({ body.transform.translation, body.velocity });
+            }
+        }
+        return states;
+    }
+
+    std::vector<double> framesAt(const double fps, const double seconds) {
+        return std::vector<double>(static_cast<size_t>(seconds * fps), 1.0 / fps);
+    }
+
+    std::vector<double> jitteredFrames(const unsigned seed, const double seconds) {
+        std::mt19937 rng(seed);
+        // from 500 fps down to 20, none long enough to hit the step cap
+        std::uniform_real_distribution<double> frame(0.002, 0.05);
+        std::vector<double> frames;
+        for (double total = 0; total < seconds;) {
+            frames.push_back(frame(rng));
+            total += frames.back();
+        }
+        return frames;
+    }
+
+    double energy(const Body& body) {
+        const glm::dvec3 v(body.velocity);
+        return 0.5 * (v.x * v.x + v.y * v.y + v.z * v.z) + double(body.rigid.gravity) * body.transform.translation.y;
+    }
+}
+
+TEST(FixedTimestep, EveryFrameRateRunsTheSameSteps) {
+    // a longer reference, so every other run is a prefix of it
+    FixedTimestep reference;
+    const std::vector<State> expected = simulate(reference, framesAt(60.0, 11.0));
+
+    int run = 0;
+    for (const auto& frames : { framesAt(24.0, 10.0), framesAt(144.0, 10.0), framesAt(1000.0, 10.0), jitteredFrames(1, 10.0), jitteredFrames(2, 10.0) }) {
+        SCOPED_TRACE(testing::Message() << "run " << run++);
+        FixedTimestep timestep;
+        const std::vector<State> states = simulate(timestep, frames);
+
+        // the frame times only decide how many steps fit, give or take the rounding of their sum
+        double elapsed = 0;
+        for (const double frame : frames) elapsed += frame;
+        ASSERT_NEAR(static_cast<double>(states.size()), std::floor(elapsed / timestep.getStep()), 1.0);
+        ASSERT_LE(states.size(), expected.size());
+        for (size_t tick = 0; tick < states.size(); ++tick) {
+            ASSERT_EQ(states[tick], expected[tick]) << "tick " << tick;
+        }
+        EXPECT_EQ(timestep.getTick(), states.size());
+    }
+}
+
+TEST(FixedTimestep, ReplayRunsTheRecordedSteps) {
+    std::vector<uint32_t> recorded;
+    FixedTimestep recording;
+    recording.record(&recorded);
+    std::vector<uint32_t> live;
+    const std::vector<State> expected = simulate(recording, jitteredFrames(3, 5.0), &live);
+    EXPECT_EQ(recorded, live);
+
+    // replayed with frames far too long, which live would cap at maxSubSteps
+    FixedTimestep replaying;
+    replaying.replay(recorded);
+    std::vector<uint32_t> replayed;
+    const std::vector<State> states = simulate(replaying, std::vector<double>(recorded.size(), 0.5), &replayed);
+    EXPECT_EQ(replayed, recorded);
+    EXPECT_EQ(states, expected);
+    EXPECT_FALSE(replaying.isReplaying());
+}
+
+TEST(FixedTimestep, SlowFramesAreCappedAndTheRestIsTheAlpha) {
+    FixedTimestep timestep({ 50.f, 4 });
+    EXPECT_EQ(timestep.advance(1.0), 4u);
+    EXPECT_EQ(timestep.getAlpha(), 0.f);
+
+    // 2.5 steps: two now, half a step to blend
+    EXPECT_EQ(timestep.advance(0.05), 2u);
+    EXPECT_NEAR(timestep.getAlpha(), 0.5f, 1e-5f);
+    EXPECT_EQ(timestep.advance(0.01), 1u);
+    EXPECT_NEAR(timestep.getAlpha(), 0.0f, 1e-5f);
+
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<double> frame(0.0, 0.07);
+    for (int i = 0; i < 1000; ++i) {
+        timestep.advance(frame(rng));
+        EXPECT_GE(timestep.getAlpha(), 0.f);
+        EXPECT_LT(timestep.getAlpha(), 1.f);
+    }
+}
+
+TEST(FixedTimestep, FreeFallDriftsByTheEulerBound) {
+    // semi-implicit Euler under constant gravity lands g * dt * t / 2 short of the exact height, so the energy
+    // drifts by -g^2 * dt * t / 2 and halves with the step. Over a short fall, so float rounding stays well below it
+    constexpr double SECONDS = 3.0;
+    double previousDrift = 0.0;
+    for (const float rate : { 30.f, 60.f, 120.f }) {
+        Body body = thrownBody();
+        const double start = energy(body);
+        const float dt = 1.f / rate;
+        const auto steps = static_cast<int>(SECONDS * rate);
+        for (int s = 0; s < steps; ++s) step(body, dt);
+
+        const double g = body.rigid.gravity;
+        const double bound = g * g * dt * SECONDS / 2.0;
+        const double drift = energy(body) - start;
+        EXPECT_LT(drift, 0.0) << rate;
+        EXPECT_NEAR(-drift, bound, bound * 0.02) << rate;
+        if (previousDrift != 0.0) {
+            EXPECT_NEAR(drift / previousDrift, 0.5, 0.02) << rate;
+        }
+        previousDrift = drift;
+    }
+}
+
+TEST(FixedTimestep, AirClampSlowsTheSameAtEveryRate) {
+    constexpr float SECONDS = 0.5f;
+    const auto horizontalSpeedAfter = [&](const float rate) {
+        Body body = thrownBody();
+        body.velocity = Velocity(glm::vec3(6.f, 5.f, 0.f));
+        const auto steps = static_cast<int>(SECONDS * rate);
+        for (int s = 0; s < steps; ++s) step(body, 1.f / rate);
+        return std::hypot(body.velocity.x, body.velocity.z);
+    };
+
+    const float reference = horizontalSpeedAfter(integrate::AIR_CLAMP_RATE);
+    EXPECT_LT(reference, 6.f);
+    for (const float rate : { 30.f, 120.f, 240.f }) {
+        EXPECT_NEAR(horizontalSpeedAfter(rate), reference, 1e-3f) << rate;
+    }
+}
+
+TEST(FixedTimestep, GroundDampingOnlyRemovesEnergy) {
+    Body body;
+    body.rigid.onGround = true;
+    body.velocity = Velocity(glm::vec3(3.f, 0.f, -2.f));
+    const float start = glm::length(glm::vec3(body.velocity));
+
+    constexpr float dt = 1.f / 60.f;
+    float previous = start;
+    for (int s = 1; s <= 120; ++s) {
+        step(body, dt);
+        const float speed = glm::length(glm::vec3(body.velocity));
+        EXPECT_LE(speed, previous) << s;
+        EXPECT_NEAR(speed, start * std::exp(-body.rigid.damping * dt * s), 1e-4f) << s;
+        previous = speed;
+    }
+}
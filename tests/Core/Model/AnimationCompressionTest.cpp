@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include <Core/Model/AnimationClip.h>
+#include "SyntheticSkeleton.h"
+
+#include <cmath>
+#include <random>
+
+namespace {
+    constexpr double FPS = 30.0;
+
+    /* the angle between two rotations from their chord, acos of the dot product is too coarse near 1 */
+    double angleBetween(const glm::quat& a, const glm::quat& b) {
+        double minus = 0, plus = 0;
+        for (int c = 0; c < 4; ++c) {
+            minus += (double(a[c]) - b[c]) * (double(a[c]) - b[c]);
+            plus += (double(a[c]) + b[c]) * (double(a[c]) + b[c]);
+        }
+        const double chord = std::sqrt(std::min(minus, plus));
+        return 4.0 * std::asin(std::min(1.0, chord * 0.5));
+    }
+
+    /* noisy keys that leave little to drop, so the bound is tested on every kind of segment */
+    ModelAnimation randomWalk(const unsigned seed, const size_t channels, const size_t keys) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> unit(-1.f, 1.f);
+
+        ModelAnimation animation("walk");
+        for (size_t c = 0; c < channels; ++c) {
+            const std::string target = "channel_" + std::to_string(c);
+            glm::vec3 position(unit(rng), unit(rng), unit(rng));
+            glm::vec3 scale(1.f);
+            glm::quat rotation(1, 0, 0, 0);
+            for (size_t k = 1; k <= keys; ++k) {
+                const double time = static_cast<double>(k) / FPS;
+                // every few keys a run of straight motion, which reduces to its ends
+                const float step = k % 10 < 4 ? 0.f : 1.f;
+                position += glm::vec3(unit(rng), unit(rng), unit(rng)) * 0.02f * step + glm::vec3(0.01f);
+                scale += glm::vec3(unit(rng)) * 0.01f * step;
+                rotation = glm::normalize(rotation * glm::angleAxis(0.05f * (1.f + unit(rng)), glm::normalize(glm::vec3(unit(rng), unit(rng), 1.f))));
+                animation.addTranslation(target, time, position);
+                animation.addScale(target, time, scale);
+                animation.addRotation(target, time, rotation);
+            }
+        }
+        return animation;
+    }
+
+    size_t uncompressedBytes(const AnimationClip& clip) {
+        return clip.keyCount() * (sizeof(float) + 3 * sizeof(glm::vec4));
+    }
+}
+
+TEST(AnimationCompression, ChannelsStayWithinTheirBudget) {
+    const CompressedAnimation::Settings settings;
+    const ModelAnimation animation = randomWalk(1, 12, 90);
+    const AnimationClip raw(animation);
+    const AnimationClip compressed(animation, settings);
+    ASSERT_NE(compressed.getCompressed(), nullptr);
+    EXPECT_LE(compressed.getCompressed()->getMaxError(), 1.f);
+
+    // without a hierarchy every channel reaches only the shell around itself
+    const float lever = settings.shellDistance;
+    // the 16 bit key times move a sample by up to half a step of the clip duration
+    const float slack = 1.02f;
+
+    const MeshPose from = MeshPose::identity();
+    for (uint32_t c = 0; c < raw.channelCount(); ++c) {
+        AnimationClip::Hints rawHints{}, compressedHints{};
+        for (double time = 0; time <= raw.getDuration() + 0.1; time += 1.0 / 240.0) {
+            const MeshPose expected = raw.sample(c, static_cast<float>(time), from, rawHints);
+            const MeshPose actual = compressed.sample(c, static_cast<float>(time), from, compressedHints);
+
+            ASSERT_LE(glm::length(actual.transform.translation - expected.transform.translation), settings.tolerance * slack)
+                << "channel " << c << " time " << time;
+            ASSERT_LE(glm::length(actual.transform.scale - expected.transform.scale) * lever, settings.tolerance * slack)
+                << "channel " << c << " time " << time;
+            ASSERT_LE(angleBetween(actual.transform.rotation, expected.transform.rotation) * lever, settings.tolerance * slack)
+                << "channel " << c << " time " << time;
+        }
+    }
+}
+
+TEST(AnimationCompression, TighterTolerancesKeepMoreKeys) {
+    const ModelAnimation animation = randomWalk(2, 4, 120);
+    size_t previous = 0;
+    for (const float tolerance : { 0.05f, 0.01f, 0.002f, 0.0005f }) {
+        CompressedAnimation::Settings settings;
+        settings.tolerance = tolerance;
+        const CompressedAnimation compressed(animation, settings);
+        EXPECT_GE(compressed.byteSize(), previous) << tolerance;
+        previous = compressed.byteSize();
+    }
+}
+
+TEST(AnimationCompression, ConstantCurvesKeepOneKey) {
+    ModelAnimation two, many;
+    for (size_t k = 1; k <= 100; ++k) {
+        const double time = static_cast<double>(k) / FPS;
+        many.addTranslation("still", time, glm::vec3(1.f, 2.f, 3.f));
+        many.addRotation("still", time, glm::angleAxis(0.5f, glm::vec3(0, 1, 0)));
+        if (k == 1 || k == 100) {
+            two.addTranslation("still", time, glm::vec3(1.f, 2.f, 3.f));
+            two.addRotation("still", time, glm::angleAxis(0.5f, glm::vec3(0, 1, 0)));
+        }
+    }
+    const CompressedAnimation::Settings settings;
+    EXPECT_EQ(CompressedAnimation(many, settings).byteSize(), CompressedAnimation(two, settings).byteSize());
+}
+
+TEST(AnimationCompression, ZombieJointsStayWithinTheTolerance) {
+    const SyntheticSkeleton rig = makeZombieSkeleton(3);
+    const SkeletonAsset asset = rig.asset();
+    const CompressedAnimation::Hierarchy hierarchy = CompressedAnimation::hierarchyOf(asset);
+
+    // a two second shamble: every bone sways around its bind pose, the hips also drift forward
+    ModelAnimation animation("shamble");
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    for (int bone = 0; bone < rig.boneCount; ++bone) {
+        const BoneNode& node = rig.nodes[bone];
+        const glm::vec3 axis = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)));
+        const float amplitude = 0.4f * (1.f + unit(rng)) / 2.f, frequency = 1.f + unit(rng) * 0.5f, phase = unit(rng) * 3.f;
+        for (int k = 0; k <= 60; ++k) {
+            const float time = static_cast<float>(k / FPS);
+            const glm::quat sway = glm::angleAxis(amplitude * std::sin(6.2831853f * frequency * time + phase), axis);
+            animation.addRotation(node.name, time, node.localTransform.rotation * sway);
+            if (node.name == "hips") {
+                animation.addTranslation(node.name, time, node.localTransform.translation + glm::vec3(0, 0.05f * std::sin(12.f * time), 0.6f * time));
+            }
+        }
+    }
+
+    CompressedAnimation::Settings settings;
+    settings.tolerance = 0.002f;
+    const AnimationClip raw(animation);
+    const AnimationClip compressed(animation, settings, hierarchy);
+    EXPECT_LT(compressed.getCompressed()->byteSize() * 4, uncompressedBytes(raw));
+
+    std::vector<glm::vec3> bindJoints;
+    for (int bone = 0; bone < rig.boneCount; ++bone) {
+        bindJoints.emplace_back(glm::inverse(rig.nodes[bone].offset)[3]);
+    }
+    const auto jointsAt = [&](const AnimationClip& clip, const float time) {
+        std::vector<Transform> locals;
+        for (const BoneNode& node : rig.nodes) locals.push_back(node.localTransform);
+        // the channels were added bone by bone
+        for (uint32_t c = 0; c < clip.channelCount(); ++c) {
+            const auto bone = static_cast<int>(c);
+            EXPECT_EQ(clip.getChannels()[c].target, rig.nodes[bone].name);
+            MeshPose from;
+            from.transform = rig.nodes[bone].localTransform;
+            AnimationClip::Hints hints{};
+            const MeshPose pose = clip.sample(c, time, from, hints);
+            locals[bone].translation = pose.transform.translation;
+            locals[bone].rotation = pose.transform.rotation;
+        }
+        const std::vector<glm::mat4> palette = recursivePalette(rig, locals);
+        std::vector<glm::vec3> joints;
+        for (int bone = 0; bone < rig.boneCount; ++bone) {
+            joints.emplace_back(palette[bone] * glm::vec4(bindJoints[bone], 1.f));
+        }
+        return joints;
+    };
+
+    // the budget is split along the longest chain, so even the fingertips move less than the tolerance
+    float worst = 0.f;
+    for (float time = 0.f; time <= 2.f; time += 1.f / 90.f) {
+        const auto expected = jointsAt(raw, time);
+        const auto actual = jointsAt(compressed, time);
+        for (int bone = 0; bone < rig.boneCount; ++bone) {
+            worst = std::max(worst, glm::length(actual[bone] - expected[bone]));
+        }
+    }
+    EXPECT_LE(worst, settings.tolerance);
+}
@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+#include <Core/Model/FCurve.h>
+#include "KeyframeCurve.h"
+
+#include <random>
+
+namespace {
+    /* random key times with repeated gaps and the odd near-duplicate, like baked and hand-made keys mixed */
+    std::vector<float> randomTimes(std::mt19937& rng, const size_t count) {
+        std::uniform_real_distribution<float> gap(1e-4f, 0.5f);
+        std::vector<float> times;
+        float time = std::uniform_real_distribution<float>(-1.f, 1.f)(rng);
+        for (size_t i = 0; i < count; ++i) {
+            times.push_back(time);
+            time += i % 7 == 3 ? 1e-4f : gap(rng);
+        }
+        return times;
+    }
+
+    FCurve3 randomCurve(std::mt19937& rng, const size_t keys, const InterpolationType interpolation) {
+        std::uniform_real_distribution<float> unit(-10.f, 10.f);
+        FCurve3 curve;
+        for (const float time : randomTimes(rng, keys)) {
+            curve.add(glm::vec3(unit(rng), unit(rng), unit(rng)), time);
+        }
+        curve.setInterpolationType(interpolation);
+        if (interpolation == InterpolationType::HERMITE) curve.generateTangentsHermite();
+        return curve;
+    }
+
+    constexpr EasingFunction EASINGS[] = { Easing::linear, Easing::sine_in_out, Easing::cubic_in, Easing::cubic_out };
+
+    /* the segment the curves found with a linear scan before the cursor and binary search */
+    size_t scanSegment(const std::span<const float> times, const float time) {
+        size_t i = 0;
+        while (i + 2 < times.size() && times[i + 1] < time) ++i;
+        return i;
+    }
+
+    void expectNear(const glm::vec3& actual, const glm::vec3& expected, const float epsilon) {
+        for (int c = 0; c < 3; ++c) {
+            EXPECT_NEAR(actual[c], expected[c], epsilon) << c;
+        }
+    }
+}
+
+TEST(FCurve, FindSegmentMatchesALinearScan) {
+    std::mt19937 rng(1);
+    for (int round = 0; round < 200; ++round) {
+        const auto times = randomTimes(rng, std::uniform_int_distribution<size_t>(2, 300)(rng));
+        std::uniform_real_distribution<float> inside(times.front(), times.back());
+        std::uniform_int_distribution<size_t> anyCursor(0, times.size() - 1);
+
+        for (int i = 0; i < 100; ++i) {
+            // exact key times are where an off by one would show
+            const float time = i % 3 == 0 ? times[anyCursor(rng)] : inside(rng);
+            if (time <= times.front() || time >= times.back()) continue;
+
+            const size_t segment = curves::findSegment(times.data(), times.size(), time, anyCursor(rng));
+            ASSERT_EQ(segment, scanSegment(times, time)) << "time " << time;
+            ASSERT_LT(times[segment], time);
+            ASSERT_LE(time, times[segment + 1]);
+        }
+    }
+}
+
+TEST(FCurve, CursorBinarySearchAndBatchAgree) {
+    std::mt19937 rng(2);
+    for (const auto interpolation : { InterpolationType::LERP, InterpolationType::HERMITE }) {
+        for (int round = 0; round < 50; ++round) {
+            const FCurve3 curve = randomCurve(rng, std::uniform_int_distribution<size_t>(1, 200)(rng), interpolation);
+            const auto times = curve.getTimes();
+
+            // sequential playback past both ends, with steps shorter and longer than the key gaps
+            std::vector<double> at;
+            std::uniform_real_distribution<double> step(0.0, 0.3);
+            for (double t = times.front() - 0.5; t < times.back() + 0.5; t += step(rng)) at.push_back(t);
+
+            std::vector<glm::vec3> batch(at.size());
+            curve.sample(at, batch);
+
+            size_t hint = 0;
+            for (size_t i = 0; i < at.size(); ++i) {
+                const glm::vec3 sequential = curve.at(at[i], hint);
+                ASSERT_EQ(sequential, curve.at(at[i])) << at[i];
+                ASSERT_EQ(sequential, batch[i]) << at[i];
+            }
+
+            // seeking anywhere from a stale cursor
+            std::uniform_real_distribution<double> seek(times.front() - 1.0, times.back() + 1.0);
+            for (int i = 0; i < 50; ++i) {
+                const double t = seek(rng);
+                ASSERT_EQ(curve.at(t, hint), curve.at(t)) << t;
+            }
+        }
+    }
+}
+
+TEST(FCurve, ClampsOutsideAndHitsTheKeys) {
+    std::mt19937 rng(3);
+    const FCurve3 curve = randomCurve(rng, 40, InterpolationType::LERP);
+    const auto times = curve.getTimes();
+    const auto values = curve.getValues();
+
+    EXPECT_EQ(curve.at(times.front() - 100.0), values.front());
+    EXPECT_EQ(curve.at(times.back() + 100.0), values.back());
+    for (size_t k = 0; k < times.size(); ++k) {
+        expectNear(curve.at(times[k]), values[k], 1e-4f);
+    }
+
+    EXPECT_EQ(FCurve3().at(1.0), glm::vec3(0));
+}
+
+TEST(FCurve, LerpStaysBetweenItsKeys) {
+    std::mt19937 rng(4);
+    const FCurve3 curve = randomCurve(rng, 100, InterpolationType::LERP);
+    const auto times = curve.getTimes();
+    const auto values = curve.getValues();
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+
+    for (size_t i = 0; i + 1 < times.size(); ++i) {
+        const float time = times[i] + u(rng) * (times[i + 1] - times[i]);
+        if (time <= times[i] || time >= times[i + 1]) continue;
+        const glm::vec3 value = curve.at(time);
+        for (int c = 0; c < 3; ++c) {
+            EXPECT_GE(value[c], std::min(values[i][c], values[i + 1][c]) - 1e-4f);
+            EXPECT_LE(value[c], std::max(values[i][c], values[i + 1][c]) + 1e-4f);
+        }
+    }
+}
+
+TEST(FCurve, HermiteReproducesALine) {
+    // the generated tangents of a line are its slope, so the interior segments are exact
+    FCurve3 curve;
+    const glm::vec3 origin(1.f, -2.f, 0.5f), slope(0.5f, 3.f, -1.f);
+    std::mt19937 rng(5);
+    for (const float time : randomTimes(rng, 30)) {
+        curve.add(origin + slope * time, time);
+    }
+    curve.setInterpolationType(InterpolationType::HERMITE);
+    curve.generateTangentsHermite();
+
+    const auto times = curve.getTimes();
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    for (size_t i = 1; i + 2 < times.size(); ++i) {
+        const float time = times[i] + u(rng) * (times[i + 1] - times[i]);
+        expectNear(curve.at(time), origin + slope * time, 1e-3f);
+    }
+}
+
+TEST(FCurve, RotationsStayUnitLength) {
+    std::mt19937 rng(6);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    QCurve curve;
+    for (const float time : randomTimes(rng, 60)) {
+        curve.add(glm::normalize(glm::quat(unit(rng), unit(rng), unit(rng), unit(rng))), time);
+    }
+
+    std::uniform_real_distribution<double> at(curve.getTimes().front(), curve.getTimes().back());
+    size_t hint = 0;
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_NEAR(glm::length(curve.at(at(rng), hint)), 1.f, 1e-4f);
+    }
+}
+
+TEST(FCurve, AddKeepsKeysSortedAndEraseFromCuts) {
+    std::mt19937 rng(7);
+    auto times = randomTimes(rng, 64);
+    std::ranges::shuffle(times, rng);
+
+    FCurve3 curve;
+    for (const float time : times) curve.add(glm::vec3(time), time);
+    ASSERT_EQ(curve.size(), times.size());
+    EXPECT_TRUE(std::ranges::is_sorted(curve.getTimes()));
+    for (size_t k = 0; k < curve.size(); ++k) {
+        // the values moved with their times
+        EXPECT_EQ(curve.getValues()[k], glm::vec3(curve.getTimes()[k]));
+    }
+
+    const float cut = curve.getTimes()[20];
+    curve.eraseFrom(cut);
+    EXPECT_EQ(curve.size(), 20u);
+    EXPECT_LT(curve.getTimes().back(), cut);
+}
+
+TEST(FCurve, MatchesTheKeyframeCurve) {
+    std::mt19937 rng(8);
+    std::uniform_real_distribution<float> unit(-10.f, 10.f);
+    for (const auto interpolation : { InterpolationType::LERP, InterpolationType::HERMITE }) {
+        for (int round = 0; round < 100; ++round) {
+            const EasingFunction easing = EASINGS[round % std::size(EASINGS)];
+            FCurve3 curve;
+            KeyframeCurve3 keyframes;
+            for (const float time : randomTimes(rng, std::uniform_int_distribution<size_t>(2, 120)(rng))) {
+                const glm::vec3 value(unit(rng), unit(rng), unit(rng));
+                curve.add(value, time);
+                keyframes.add(value, time);
+            }
+            curve.setInterpolationType(interpolation);
+            curve.setEasingFunction(easing);
+            keyframes.setInterpolationType(interpolation);
+            keyframes.setEasingFunction(easing);
+            if (interpolation == InterpolationType::HERMITE) {
+                curve.generateTangentsHermite();
+                keyframes.generateTangentsHermite();
+            }
+
+            // float sample times, the double keyframes only differ in how they round
+            const auto times = curve.getTimes();
+            std::uniform_real_distribution<float> at(times.front() - 0.5f, times.back() + 0.5f);
+            for (int i = 0; i < 200; ++i) {
+                const double time = at(rng);
+                const glm::vec3 expected = keyframes.at(time);
+                SCOPED_TRACE(testing::Message() << "round " << round << " time " << time);
+                expectNear(curve.at(time), expected, 1e-3f * std::max(1.f, glm::length(expected)));
+            }
+        }
+    }
+}
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include <Core/Model/ModelCache.h>
+#include "SyntheticModel.h"
+
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <thread>
+
+namespace {
+    namespace fs = std::filesystem;
+
+    constexpr ModelCache::SourceStamp STAMP{ 4096, 1234567 };
+
+    /* the Header fields in ModelCache.cpp, by offset */
+    constexpr size_t VERSION_OFFSET = 4;
+    constexpr size_t SECTIONS_OFFSET = 32;
+    constexpr size_t SECTION_SIZE = 2 * sizeof(uint64_t);
+    constexpr size_t NODES_SECTION = 2;
+    constexpr size_t NAMES_SECTION = 6;
+    constexpr size_t TEXTURE_PATHS_SECTION = 7;
+    /* firstChild, nameOffset and meshCount in the NodeRecord */
+    constexpr size_t NODE_FIRST_CHILD_OFFSET = 4 * 16 * 2 + 4 * 4 + 3 * 4 * 2 + 8;
+    constexpr size_t NODE_NAME_OFFSET = NODE_FIRST_CHILD_OFFSET + 2 * 8;
+    constexpr size_t NODE_MESH_COUNT_OFFSET = NODE_NAME_OFFSET + 3 * 4;
+
+    struct TempDirectory {
+        fs::path path;
+
+        TempDirectory() : path(fs::path(testing::TempDir()) / ("idk_model_cache_" + std::to_string(std::random_device{}()))) {
+            fs::create_directories(path);
+        }
+
+        ~TempDirectory() {
+            std::error_code error;
+            fs::remove_all(path, error);
+        }
+
+        size_t fileCount() const {
+            return static_cast<size_t>(std::distance(fs::directory_iterator(path), fs::directory_iterator()));
+        }
+    };
+
+    uint64_t sectionField(const std::vector<std::byte>& bytes, const size_t section, const size_t field) {
+        uint64_t value;
+        std::memcpy(&value, bytes.data() + SECTIONS_OFFSET + section * SECTION_SIZE + field * sizeof(uint64_t), sizeof(value));
+        return value;
+    }
+
+    void setSectionField(std::vector<std::byte>& bytes, const size_t section, const size_t field, const uint64_t value) {
+        std::memcpy(bytes.data() + SECTIONS_OFFSET + section * SECTION_SIZE + field * sizeof(uint64_t), &value, sizeof(value));
+    }
+
+    void expectSameModel(const ModelDefinitionBuilder& actual, const ModelDefinitionBuilder& expected) {
+        ASSERT_EQ(actual.nodes.size(), expected.nodes.size());
+        for (size_t n = 0; n < expected.nodes.size(); ++n) {
+            const MeshNode& a = actual.nodes[n];
+            const MeshNode& e = expected.nodes[n];
+            EXPECT_EQ(a.name, e.name) << n;
+            EXPECT_EQ(a.parent, e.parent) << n;
+            EXPECT_EQ(a.firstChild, e.firstChild) << n;
+            EXPECT_EQ(a.childrenCount, e.childrenCount) << n;
+            EXPECT_EQ(a.firstMeshIndex, e.firstMeshIndex) << n;
+            EXPECT_EQ(a.meshCount, e.meshCount) << n;
+            EXPECT_EQ(a.localMatrix, e.localMatrix) << n;
+            EXPECT_EQ(a.finalTransform, e.finalTransform) << n;
+            EXPECT_EQ(a.localTransform.translation, e.localTransform.translation) << n;
+            // names must point into the deserialized model, not at the input bytes
+            EXPECT_TRUE(a.name.data() >= actual.names.data() && a.name.data() < actual.names.data() + actual.names.size());
+        }
+        EXPECT_EQ(actual.nameToNode, expected.nameToNode);
+        EXPECT_EQ(actual.pathToTexture, expected.pathToTexture);
+        EXPECT_EQ(std::vector<std::string>(actual.texturePaths.begin(), actual.texturePaths.end()),
+                  std::vector<std::string>(expected.texturePaths.begin(), expected.texturePaths.end()));
+        EXPECT_EQ(actual.indices, expected.indices);
+        ASSERT_EQ(actual.vertices.size(), expected.vertices.size());
+        EXPECT_EQ(std::memcmp(actual.vertices.data(), expected.vertices.data(), expected.vertices.size() * sizeof(Vertex)), 0);
+        ASSERT_EQ(actual.materials.size(), expected.materials.size());
+        for (size_t m = 0; m < expected.materials.size(); ++m) {
+            EXPECT_EQ(actual.materials[m].diffuse, expected.materials[m].diffuse);
+            EXPECT_EQ(actual.materials[m].normal, expected.materials[m].normal);
+            EXPECT_EQ(actual.materials[m].isTransparent, expected.materials[m].isTransparent);
+        }
+    }
+}
+
+TEST(ModelCache, RoundTripKeepsTheModel) {
+    const ModelDefinitionBuilder model = makeSyntheticModel(60, 12, 1);
+    const std::vector<std::byte> bytes = ModelCache::serialize(model, STAMP);
+
+    auto decoded = ModelCache::deserialize(bytes, STAMP);
+    ASSERT_TRUE(decoded.has_value());
+    expectSameModel(*decoded, model);
+
+    // no padding or pointers end up in the file, so serializing again is byte identical
+    EXPECT_EQ(ModelCache::serialize(*decoded, STAMP), bytes);
+}
+
+TEST(ModelCache, EmptyModelRoundTrips) {
+    const ModelDefinitionBuilder model(0, 0, 0);
+    const auto decoded = ModelCache::deserialize(ModelCache::serialize(model, STAMP), STAMP);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_TRUE(decoded->nodes.empty());
+    EXPECT_TRUE(decoded->vertices.empty());
+}
+
+TEST(ModelCache, StampDecidesIfACacheIsCurrent) {
+    const auto bytes = ModelCache::serialize(makeSyntheticModel(4, 3, 2), STAMP);
+
+    EXPECT_TRUE(ModelCache::deserialize(bytes, STAMP).has_value());
+    // a missing source accepts the cache, so caches can ship without their sources
+    EXPECT_TRUE(ModelCache::deserialize(bytes, {}).has_value());
+    EXPECT_EQ(ModelCache::deserialize(bytes, { STAMP.size + 1, STAMP.writeTime }).error(), ModelLoadError::CACHE_STALE);
+    EXPECT_EQ(ModelCache::deserialize(bytes, { STAMP.size, STAMP.writeTime + 1 }).error(), ModelLoadError::CACHE_STALE);
+}
+
+TEST(ModelCache, RejectsCorruptCaches) {
+    const auto bytes = ModelCache::serialize(makeSyntheticModel(8, 5, 3), STAMP);
+
+    for (size_t size = 0; size < bytes.size(); ++size) {
+        ASSERT_FALSE(ModelCache::deserialize(std::span(bytes.data(), size), STAMP).has_value()) << size;
+    }
+
+    auto badMagic = bytes;
+    badMagic[0] = std::byte{ 'X' };
+    EXPECT_EQ(ModelCache::deserialize(badMagic, STAMP).error(), ModelLoadError::CACHE_CORRUPT);
+
+    auto newerVersion = bytes;
+    const uint32_t version = ModelCache::VERSION + 1;
+    std::memcpy(newerVersion.data() + VERSION_OFFSET, &version, sizeof(version));
+    EXPECT_EQ(ModelCache::deserialize(newerVersion, STAMP).error(), ModelLoadError::CACHE_VERSION);
+
+    auto misaligned = bytes;
+    setSectionField(misaligned, NODES_SECTION, 0, sectionField(bytes, NODES_SECTION, 0) + 4);
+    EXPECT_EQ(ModelCache::deserialize(misaligned, STAMP).error(), ModelLoadError::CACHE_CORRUPT);
+
+    auto overlong = bytes;
+    setSectionField(overlong, NAMES_SECTION, 1, bytes.size());
+    EXPECT_EQ(ModelCache::deserialize(overlong, STAMP).error(), ModelLoadError::CACHE_CORRUPT);
+
+    auto hugeCount = bytes;
+    setSectionField(hugeCount, NODES_SECTION, 1, ~uint64_t(0) / 2);
+    EXPECT_EQ(ModelCache::deserialize(hugeCount, STAMP).error(), ModelLoadError::CACHE_CORRUPT);
+
+    auto nameOutside = bytes;
+    const uint32_t farAway = 1u << 30;
+    std::memcpy(nameOutside.data() + sectionField(bytes, NODES_SECTION, 0) + NODE_NAME_OFFSET, &farAway, sizeof(farAway));
+    EXPECT_EQ(ModelCache::deserialize(nameOutside, STAMP).error(), ModelLoadError::CACHE_CORRUPT);
+
+    // the root's children pointing back at the root, past the nodes, and the root owning every mesh index and more
+    const uint64_t nodesBegin = sectionField(bytes, NODES_SECTION, 0);
+    for (const uint64_t firstChild : { uint64_t(0), uint64_t(8), ~uint64_t(0) }) {
+        auto badChildren = bytes;
+        std::memcpy(badChildren.data() + nodesBegin + NODE_FIRST_CHILD_OFFSET, &firstChild, sizeof(firstChild));
+        EXPECT_EQ(ModelCache::deserialize(badChildren, STAMP).error(), ModelLoadError::CACHE_CORRUPT) << firstChild;
+    }
+    auto meshesOutside = bytes;
+    const uint32_t meshCount = 9;
+    std::memcpy(meshesOutside.data() + nodesBegin + NODE_MESH_COUNT_OFFSET, &meshCount, sizeof(meshCount));
+    EXPECT_EQ(ModelCache::deserialize(meshesOutside, STAMP).error(), ModelLoadError::CACHE_CORRUPT);
+
+    auto unterminatedPath = bytes;
+    const uint64_t pathsEnd = sectionField(bytes, TEXTURE_PATHS_SECTION, 0) + sectionField(bytes, TEXTURE_PATHS_SECTION, 1);
+    unterminatedPath[pathsEnd - 1] = std::byte{ 'x' };
+    EXPECT_EQ(ModelCache::deserialize(unterminatedPath, STAMP).error(), ModelLoadError::CACHE_CORRUPT);
+}
+
+TEST(ModelCache, RandomBitFlipsNeverCrash) {
+    const auto bytes = ModelCache::serialize(makeSyntheticModel(16, 4, 4), STAMP);
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<size_t> position(0, bytes.size() - 1);
+    std::uniform_int_distribution<int> bit(0, 7);
+
+    for (int i = 0; i < 4000; ++i) {
+        auto flipped = bytes;
+        flipped[position(rng)] ^= std::byte(1 << bit(rng));
+        auto decoded = ModelCache::deserialize(flipped, STAMP);
+        if (!decoded) continue;
+
+        // whatever the cache accepts has to make a model that can be walked and drawn without further checks
+        const ModelDefinition definition("flipped", *decoded);
+        ASSERT_EQ(definition.order.size(), definition.nodes.size()) << i;
+        for (const MeshNode& node : definition.nodes) {
+            ASSERT_LE(node.name.data() + node.name.size(), definition.names.data() + definition.names.size());
+            for (const unsigned mesh : node.meshes()) {
+                const RMeshNode& render = definition.renderNodes[mesh];
+                ASSERT_LT(render.materialIndex, definition.materials.size());
+                ASSERT_LE(render.drawParams.vertexOffset + render.drawParams.vertexCount, definition.geometry.vertices.size());
+                ASSERT_LE(render.drawParams.indexOffset + render.drawParams.indexCount, definition.geometry.indices.size());
+            }
+        }
+    }
+}
+
+TEST(ModelCache, WriteThenReadFromDisk) {
+    const TempDirectory directory;
+    const std::string path = (directory.path / "model.gltf.kmdl").string();
+    const ModelDefinitionBuilder model = makeSyntheticModel(30, 8, 6);
+
+    EXPECT_EQ(ModelCache::read(path, STAMP).error(), ModelLoadError::CACHE_MISS);
+
+    ASSERT_TRUE(ModelCache::write(path, model, STAMP).has_value());
+    EXPECT_EQ(directory.fileCount(), 1u);
+
+    const auto read = ModelCache::read(path, STAMP);
+    ASSERT_TRUE(read.has_value());
+    expectSameModel(*read, model);
+    EXPECT_EQ(ModelCache::read(path, { 1, 1 }).error(), ModelLoadError::CACHE_STALE);
+}
+
+TEST(ModelCache, ConcurrentWritersLeaveOneValidCache) {
+    const TempDirectory directory;
+    const std::string path = (directory.path / "model.gltf.kmdl").string();
+    const ModelDefinitionBuilder model = makeSyntheticModel(200, 30, 7);
+
+    std::vector<std::thread> writers;
+    std::atomic<int> failures = 0;
+    for (int t = 0; t < 8; ++t) {
+        writers.emplace_back([&] {
+            for (int i = 0; i < 5; ++i) {
+                if (!ModelCache::write(path, model, STAMP)) ++failures;
+            }
+        });
+    }
+    for (auto& writer : writers) writer.join();
+
+    EXPECT_EQ(failures.load(), 0);
+    // every temporary was renamed over the cache
+    EXPECT_EQ(directory.fileCount(), 1u);
+    const auto read = ModelCache::read(path, STAMP);
+    ASSERT_TRUE(read.has_value());
+    expectSameModel(*read, model);
+}
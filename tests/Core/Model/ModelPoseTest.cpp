@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <Core/Model/ModelPose.h>
+#include "PoseListBlend.h"
+
+#include <random>
+
+namespace {
+    constexpr unsigned PARTS = 8;
+
+    /* the layers every part should hold, kept as the pose lists the stack replaced */
+    using Reference = std::array<std::array<std::vector<ListPoseEntry>, PARTS>, 2>;
+
+    ModelPart partOf(const size_t p) {
+        return p == 0 ? ModelPart::MESH : ModelPart::BONE;
+    }
+
+    MeshPose randomPose(std::mt19937& rng) {
+        std::uniform_real_distribution<float> unit(-1.f, 1.f);
+        MeshPose pose;
+        pose.transform.translation = glm::vec3(unit(rng), unit(rng), unit(rng));
+        pose.transform.scale = glm::vec3(1.f + 0.5f * unit(rng));
+        pose.transform.rotation = glm::normalize(glm::quat(1.f + unit(rng), unit(rng), unit(rng), unit(rng)));
+        pose.tint = glm::vec3(0.5f + 0.5f * unit(rng));
+        return pose;
+    }
+
+    void expectSamePose(const MeshPose& actual, const MeshPose& expected) {
+        EXPECT_EQ(actual.transform.translation, expected.transform.translation);
+        EXPECT_EQ(actual.transform.scale, expected.transform.scale);
+        EXPECT_EQ(actual.transform.rotation, expected.transform.rotation);
+        EXPECT_EQ(actual.tint, expected.tint);
+    }
+
+    /* float weights against the old double ones only agree to rounding */
+    void expectNearPose(const MeshPose& actual, const MeshPose& expected) {
+        constexpr float EPSILON = 1e-4f;
+        for (int i = 0; i < 3; ++i) {
+            EXPECT_NEAR(actual.transform.translation[i], expected.transform.translation[i], EPSILON);
+            EXPECT_NEAR(actual.transform.scale[i], expected.transform.scale[i], EPSILON);
+            EXPECT_NEAR(actual.tint[i], expected.tint[i], EPSILON);
+        }
+        for (int i = 0; i < 4; ++i) {
+            EXPECT_NEAR(actual.transform.rotation[i], expected.transform.rotation[i], EPSILON);
+        }
+    }
+}
+
+TEST(ModelPoseStack, LayeredMatchesThePoseLists) {
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<unsigned> partIndex(0, PARTS - 1), idIndex(1, 9), op(0, 9), modeIndex(0, 2), affectedBits(1, 15);
+    std::uniform_real_distribution<float> influence(0.f, 1.f);
+
+    ModelPoseStack stack;
+    Reference reference;
+    for (int step = 0; step < 3000; ++step) {
+        const size_t p = step % 2;
+        const unsigned part = partIndex(rng);
+        const PoseID id = idIndex(rng);
+        auto& layers = reference[p][part];
+        const auto found = std::ranges::find(layers, id, &ListPoseEntry::id);
+        const int action = op(rng);
+
+        if (action < 6) {
+            const ListPoseEntry entry{ randomPose(rng), id, influence(rng), static_cast<MeshAffected>(affectedBits(rng)), static_cast<BlendMode>(modeIndex(rng)) };
+            const bool accepted = stack.setPose(part, id, entry.pose, entry.affected, entry.blendMode, float(entry.influence), partOf(p));
+            if (found != layers.end()) {
+                // an update keeps the layer's slot and what it affects
+                found->pose = entry.pose;
+                found->influence = entry.influence;
+                found->blendMode = entry.blendMode;
+                EXPECT_TRUE(accepted);
+            } else {
+                EXPECT_EQ(accepted, layers.size() < ModelPoseStack::MAX_LAYERS);
+                if (accepted) layers.push_back(entry);
+            }
+        } else if (action < 9) {
+            stack.removePose(part, id, partOf(p));
+            if (found != layers.end()) layers.erase(found);
+        } else {
+            stack.blendAll();
+        }
+
+        // cached or not, every part reads what blending its list of layers did
+        for (size_t q = 0; q < 2; ++q) {
+            for (unsigned other = 0; other < PARTS; ++other) {
+                SCOPED_TRACE(testing::Message() << "step " << step << " part " << other);
+                EXPECT_EQ(stack.hasPose(other, partOf(q)), !reference[q][other].empty());
+                expectNearPose(stack.getFinalPose(other, partOf(q)), blendPoseList(reference[q][other]));
+            }
+        }
+        if (testing::Test::HasFailure()) return;
+    }
+}
+
+TEST(ModelPoseStack, BlendAllReportsWhatItBlended) {
+    std::mt19937 rng(2);
+    ModelPoseStack stack;
+    stack.setPose(1, 7, randomPose(rng), MeshAffected::POSITION, BlendMode::OVERRIDE, 1.f, ModelPart::BONE);
+    stack.setPose(3, 7, randomPose(rng), MeshAffected::ROTATION, BlendMode::OVERRIDE, 1.f, ModelPart::BONE);
+    stack.setPose(0, 7, randomPose(rng), MeshAffected::SCALE, BlendMode::MULTIPLY, 1.f, ModelPart::MESH);
+
+    stack.blendAll();
+    EXPECT_EQ(std::vector<unsigned>(stack.getBlended(ModelPart::BONE).begin(), stack.getBlended(ModelPart::BONE).end()),
+              (std::vector<unsigned>{ 1, 3 }));
+    EXPECT_EQ(stack.getBlended(ModelPart::MESH).size(), 1u);
+
+    stack.blendAll();
+    EXPECT_TRUE(stack.getBlended(ModelPart::BONE).empty());
+    EXPECT_TRUE(stack.getBlended(ModelPart::MESH).empty());
+
+    // a removed last pose is reported, so whoever applied it can tell
+    stack.removePose(3, 7, ModelPart::BONE);
+    stack.blendAll();
+    ASSERT_EQ(stack.getBlended(ModelPart::BONE).size(), 1u);
+    EXPECT_EQ(stack.getBlended(ModelPart::BONE)[0], 3u);
+    EXPECT_FALSE(stack.hasPose(3, ModelPart::BONE));
+}
+
+TEST(ModelPoseStack, BlendingManyStacksInParallelMatchesOneByOne) {
+    std::mt19937 rng(3);
+    std::vector<ModelPoseStack> parallel(300), serial(300);
+    for (size_t s = 0; s < parallel.size(); ++s) {
+        for (unsigned part = 0; part < PARTS; ++part) {
+            for (PoseID id = 1; id <= 3; ++id) {
+                const MeshPose pose = randomPose(rng);
+                const auto mode = static_cast<BlendMode>(id % 3);
+                parallel[s].setPose(part, id, pose, MeshAffected::ROTATION, mode, 0.5f, ModelPart::BONE);
+                serial[s].setPose(part, id, pose, MeshAffected::ROTATION, mode, 0.5f, ModelPart::BONE);
+            }
+        }
+    }
+
+    std::vector<ModelPoseStack*> stacks;
+    for (auto& stack : parallel) stacks.push_back(&stack);
+    ModelPoseStack::blendAll(stacks);
+    for (auto& stack : serial) stack.blendAll();
+
+    for (size_t s = 0; s < parallel.size(); ++s) {
+        EXPECT_EQ(parallel[s].getBlended(ModelPart::BONE).size(), PARTS);
+        for (unsigned part = 0; part < PARTS; ++part) {
+            expectSamePose(parallel[s].getFinalPose(part, ModelPart::BONE), serial[s].getFinalPose(part, ModelPart::BONE));
+        }
+    }
+}
+
+TEST(ModelPoseStack, AFullPartRejectsNewPosesButTakesUpdates) {
+    std::mt19937 rng(4);
+    ModelPoseStack stack;
+    for (PoseID id = 1; id <= ModelPoseStack::MAX_LAYERS; ++id) {
+        ASSERT_TRUE(stack.setPose(0, id, randomPose(rng), MeshAffected::POSITION, BlendMode::OVERRIDE, 1.f, ModelPart::MESH));
+    }
+    stack.blendAll();
+    const MeshPose full = stack.getFinalPose(0, ModelPart::MESH);
+
+    EXPECT_FALSE(stack.setPose(0, 100, randomPose(rng), MeshAffected::POSITION, BlendMode::OVERRIDE, 1.f, ModelPart::MESH));
+    expectSamePose(stack.getFinalPose(0, ModelPart::MESH), full);
+
+    EXPECT_TRUE(stack.setPose(0, 1, randomPose(rng), MeshAffected::POSITION, BlendMode::OVERRIDE, 1.f, ModelPart::MESH));
+    EXPECT_NE(stack.getFinalPose(0, ModelPart::MESH).transform.translation, full.transform.translation);
+}
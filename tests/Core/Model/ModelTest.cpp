@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <Core/Model/Model.h>
+#include "SyntheticModel.h"
+
+#include <random>
+
+namespace {
+    /* every node composed from the root down, the way the hierarchy was built before the dirty ranges */
+    std::vector<glm::mat4> recomputeAll(const ModelDefinition& definition, const std::vector<Transform>& locals, const glm::mat4& modelTransform) {
+        std::vector<glm::mat4> finals(definition.size());
+        const auto compose = [&](const auto& self, const size_t node, const glm::mat4& parent) -> void {
+            finals[node] = parent * locals[node].createModel3D();
+            for (const size_t child : definition.nodes[node].children()) self(self, child, finals[node]);
+        };
+        compose(compose, 0, modelTransform);
+        return finals;
+    }
+
+    std::vector<Transform> bindLocals(const ModelDefinition& definition) {
+        std::vector<Transform> locals;
+        for (const MeshNode& node : definition.nodes) locals.push_back(node.localTransform);
+        return locals;
+    }
+
+    Transform randomTransform(std::mt19937& rng) {
+        std::uniform_real_distribution<float> unit(-1.f, 1.f);
+        return Transform(glm::vec3(unit(rng), unit(rng), unit(rng)) * 3.f, glm::vec3(1.f + 0.3f * unit(rng)),
+            glm::vec3(unit(rng), unit(rng), unit(rng)));
+    }
+
+    void expectFinals(const Model& model, const std::vector<glm::mat4>& expected) {
+        const auto finals = model.getFinalTransforms();
+        ASSERT_EQ(finals.size(), expected.size());
+        for (size_t node = 0; node < expected.size(); ++node) {
+            // clean parents hold exactly what a full pass would compute, so the subtrees match bit for bit
+            ASSERT_EQ(finals[node], expected[node]) << "node " << node;
+        }
+    }
+}
+
+TEST(Model, IncrementalUpdatesMatchAFullRecompute) {
+    ModelDefinitionBuilder builder = makeSyntheticModel(500, 3, 1);
+    const ModelDefinition definition("tree", builder);
+    Model model(&definition);
+    std::vector<Transform> locals = bindLocals(definition);
+
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<size_t> anyNode(0, definition.size() - 1), edits(0, 6);
+    glm::mat4 modelTransform(1.0f);
+    model.update(modelTransform);
+    expectFinals(model, recomputeAll(definition, locals, modelTransform));
+
+    for (int frame = 0; frame < 300; ++frame) {
+        // no edits, a few leaves or inner nodes, sometimes the root
+        for (size_t e = edits(rng); e-- > 0;) {
+            const size_t node = frame % 25 == 0 && e == 0 ? 0 : anyNode(rng);
+            locals[node] = randomTransform(rng);
+            model.setLocalTransform(static_cast<MeshID>(node), locals[node]);
+        }
+        if (frame % 3 == 0) {
+            if (frame % 7 == 0) modelTransform = randomTransform(rng).createModel3D();
+            model.update(modelTransform);
+        } else {
+            model.update();
+        }
+        SCOPED_TRACE(testing::Message() << "frame " << frame);
+        expectFinals(model, recomputeAll(definition, locals, modelTransform));
+        if (testing::Test::HasFailure()) return;
+    }
+}
+
+TEST(Model, EditsWaitForTheNextUpdate) {
+    ModelDefinitionBuilder builder = makeSyntheticModel(40, 3, 3);
+    const ModelDefinition definition("tree", builder);
+    Model model(&definition);
+    std::vector<Transform> locals = bindLocals(definition);
+    model.update();
+    const std::vector<glm::mat4> before = recomputeAll(definition, locals, glm::mat4(1.0f));
+
+    std::mt19937 rng(4);
+    locals[5] = randomTransform(rng);
+    model.setLocalTransform(static_cast<MeshID>(5), locals[5]);
+    EXPECT_EQ(model.getLocalTransform(static_cast<MeshID>(5)).translation, locals[5].translation);
+    expectFinals(model, before);
+
+    // the same model transform again is not a change
+    model.update(glm::mat4(1.0f));
+    expectFinals(model, recomputeAll(definition, locals, glm::mat4(1.0f)));
+}
+
+TEST(Model, MeshPosesLayerOnTheBindLocals) {
+    ModelDefinitionBuilder builder = makeSyntheticModel(30, 3, 5);
+    const ModelDefinition definition("tree", builder);
+    Model model(&definition);
+    std::vector<Transform> locals = bindLocals(definition);
+    model.update();
+
+    std::mt19937 rng(6);
+    ModelPoseStack poses(definition);
+    for (const unsigned mesh : { 0u, 7u, 12u }) {
+        MeshPose pose;
+        pose.transform = randomTransform(rng);
+        poses.setPose(mesh, 1, pose, static_cast<MeshAffected>(7), BlendMode::OVERRIDE, 1.f, ModelPart::MESH);
+    }
+    poses.blendAll();
+    model.applyPose(poses);
+    model.update();
+    for (const unsigned mesh : { 0u, 7u, 12u }) {
+        locals[mesh] = definition.nodes[mesh].localTransform * poses.getFinalPose(mesh, ModelPart::MESH).transform;
+    }
+    expectFinals(model, recomputeAll(definition, locals, glm::mat4(1.0f)));
+
+    // removing the last pose puts the bind local back
+    poses.removePose(7, 1, ModelPart::MESH);
+    poses.blendAll();
+    model.applyPose(poses);
+    model.update();
+    locals[7] = definition.nodes[7].localTransform;
+    expectFinals(model, recomputeAll(definition, locals, glm::mat4(1.0f)));
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <Core/Model/ModelPose.h>
+
+#include <vector>
+
+/*
+ * ModelPoseStack::getFinalPose from before layers moved into fixed slots: every part held a plain list of entries,
+ * blended on each call with double influences and weights. Only for tests that compare the slotted stack against it.
+ */
+struct ListPoseEntry {
+    MeshPose pose;
+    PoseID id;
+    double influence = 1;
+    MeshAffected affected;
+    BlendMode blendMode = BlendMode::ADDITIVE;
+};
+
+inline MeshPose blendPoseList(const std::vector<ListPoseEntry>& poseEntries) {
+    MeshPose finalPose{};
+    if (poseEntries.empty()) return finalPose;
+
+    auto finalRotation = glm::quat(0, 0, 0, 0);
+    auto finalPosition = glm::vec3(0);
+    auto finalScale    = glm::vec3(0);
+    auto finalColor    = glm::vec3(0);
+
+    double positionWeight = 0;
+    double rotationWeight = 0;
+    double scaleWeight = 0;
+    double colorWeight = 0;
+
+    for (const auto& entry : poseEntries) {
+        const auto& [transform, tint] = entry.pose;
+        auto weight = static_cast<float>(entry.influence);
+
+        switch (entry.blendMode) {
+        case BlendMode::OVERRIDE: {
+            if (entry.affected & MeshAffected::POSITION) {
+                finalPosition += transform.translation * weight;
+                positionWeight += entry.influence;
+            }
+            if (entry.affected & MeshAffected::SCALE) {
+                finalScale += transform.scale * weight;
+                scaleWeight += entry.influence;
+            }
+            if (entry.affected & MeshAffected::COLOR) {
+                finalColor += tint * weight;
+                colorWeight += entry.influence;
+            }
+            if (entry.affected & MeshAffected::ROTATION) {
+                if (rotationWeight == 0.0) {
+                    finalRotation = transform.rotation;
+                } else {
+                    finalRotation = glm::slerp(finalRotation, transform.rotation, static_cast<float>(weight / (rotationWeight + weight)));
+                }
+                rotationWeight += weight;
+            }
+            break;
+        }
+
+        case BlendMode::MULTIPLY: {
+            if (entry.affected & MeshAffected::SCALE) {
+                finalPose.transform.scale *= glm::pow(transform.scale, glm::vec3(weight));
+            }
+            if (entry.affected & MeshAffected::COLOR) {
+                finalPose.tint *= glm::mix(glm::vec3(1.0f), tint, weight);
+            }
+            if (entry.affected & MeshAffected::ROTATION) {
+                glm::quat delta = normalize(transform.rotation);
+                glm::quat blendedDelta = slerp(glm::quat(1, 0, 0, 0), delta, weight);
+
+                glm::quat before = normalize(finalPose.transform.rotation);
+
+                finalPose.transform.rotation = normalize(blendedDelta * before);
+            }
+            if (entry.affected & MeshAffected::POSITION) {
+                finalPose.transform.translation += transform.translation * weight;
+            }
+            break;
+        }
+
+        case BlendMode::ADDITIVE: {
+            if (entry.affected & MeshAffected::POSITION) {
+                finalPose.transform.translation += transform.translation * weight;
+            }
+            if (entry.affected & MeshAffected::SCALE) {
+                finalPose.transform.scale += transform.scale * weight;
+            }
+            if (entry.affected & MeshAffected::COLOR) {
+                finalPose.tint += tint * weight;
+            }
+            if (entry.affected & MeshAffected::ROTATION) {
+                glm::quat delta = slerp(glm::quat(), transform.rotation, weight);
+                finalPose.transform.rotation = normalize(finalPose.transform.rotation + delta);
+            }
+            break;
+        }
+        }
+    }
+    if (positionWeight > 0.0) {
+        finalPosition /= positionWeight;
+        finalPose.transform.translation = finalPosition;
+    }
+    if (rotationWeight > 0.0) {
+        finalRotation = normalize(finalRotation);
+        finalPose.transform.rotation = finalRotation;
+    }
+    if (scaleWeight > 0.0) {
+        finalScale /= scaleWeight;
+        finalPose.transform.scale = finalScale * finalPose.transform.scale;
+    }
+    if (colorWeight > 0.0) {
+        finalColor /= colorWeight;
+        finalPose.tint = finalColor;
+    }
+    return finalPose;
+}
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include <Core/Model/Skeleton.h>
+#include "SyntheticSkeleton.h"
+
+#include <random>
+
+namespace {
+    constexpr float EPSILON = 1e-4f;
+
+    void expectNear(const glm::mat4& actual, const glm::mat4& expected, const int bone) {
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 4; ++r) {
+                ASSERT_NEAR(actual[c][r], expected[c][r], EPSILON) << "bone " << bone << " [" << c << "][" << r << "]";
+            }
+        }
+    }
+
+    void expectPalette(const glm::mat4* actual, const std::vector<glm::mat4>& expected) {
+        for (int bone = 0; bone < static_cast<int>(expected.size()); ++bone) {
+            expectNear(actual[bone], expected[bone], bone);
+        }
+    }
+
+    /* a zombie instance with its own copy of the local transforms by id, edited like an animation would */
+    struct Zombie {
+        Skeleton skeleton;
+        std::vector<Transform> locals;
+
+        Zombie(const SkeletonAsset& asset, const SyntheticSkeleton& rig) : skeleton(&asset) {
+            for (const BoneNode& node : rig.nodes) locals.push_back(node.localTransform);
+        }
+
+        /* moves a few random nodes, through the id and the name setters */
+        void animate(const SyntheticSkeleton& rig, std::mt19937& rng) {
+            std::uniform_int_distribution<int> node(0, static_cast<int>(rig.nodes.size()) - 1);
+            std::uniform_real_distribution<float> unit(-1.f, 1.f);
+            const int edits = std::uniform_int_distribution<int>(0, 6)(rng);
+
+            for (int e = 0; e < edits; ++e) {
+                const int id = node(rng);
+                Transform& local = locals[id];
+                switch (e % 4) {
+                    case 0:
+                        local.rotation = glm::normalize(local.rotation * glm::quat(1.f, unit(rng) * 0.2f, unit(rng) * 0.2f, unit(rng) * 0.2f));
+                        skeleton.setBoneTransform(id, local);
+                        break;
+                    case 1:
+                        local.translation += glm::vec3(unit(rng), unit(rng), unit(rng)) * 0.05f;
+                        skeleton.setBonePosition(rig.nodes[id].name, local.translation);
+                        break;
+                    case 2:
+                        local.rotation = glm::normalize(glm::quat(1.f, unit(rng), unit(rng), unit(rng)));
+                        skeleton.setBoneRotation(rig.nodes[id].name, local.rotation);
+                        break;
+                    default:
+                        local.scale = glm::vec3(1.f + 0.1f * unit(rng));
+                        skeleton.setBoneScale(rig.nodes[id].name, local.scale);
+                        break;
+                }
+            }
+        }
+    };
+}
+
+TEST(Skeleton, TopologyCoversTheZombieRig) {
+    const SyntheticSkeleton rig = makeZombieSkeleton(1);
+    const SkeletonAsset asset = rig.asset();
+
+    EXPECT_EQ(asset.size(), rig.boneCount);
+    EXPECT_GT(rig.nodes.size(), static_cast<size_t>(rig.boneCount));
+    for (const BoneNode& node : rig.nodes) {
+        EXPECT_TRUE(asset.hasBone(node.name)) << node.name;
+    }
+    EXPECT_EQ(asset.makeInstance().getBoneCount(), static_cast<size_t>(rig.boneCount));
+}
+
+TEST(Skeleton, BindPoseMatchesTheRecursiveHierarchy) {
+    const SyntheticSkeleton rig = makeZombieSkeleton(2);
+    const SkeletonAsset asset = rig.asset();
+    Zombie zombie(asset, rig);
+
+    std::vector<glm::mat4> palette(rig.boneCount);
+    zombie.skeleton.writeHierarchy(palette.data());
+
+    const std::vector<glm::mat4> expected = recursivePalette(rig, zombie.locals);
+    expectPalette(palette.data(), expected);
+    // the offsets are the inverse bind matrices
+    for (int bone = 0; bone < rig.boneCount; ++bone) {
+        expectNear(palette[bone], glm::mat4(1.0f), bone);
+    }
+}
+
+TEST(Skeleton, AnimatedZombiesMatchTheRecursiveHierarchy) {
+    const SyntheticSkeleton rig = makeZombieSkeleton(3);
+    const SkeletonAsset asset = rig.asset();
+    std::mt19937 rng(4);
+
+    constexpr size_t ZOMBIES = 24;
+    std::vector<Zombie> zombies;
+    zombies.reserve(ZOMBIES);
+    for (size_t z = 0; z < ZOMBIES; ++z) zombies.emplace_back(asset, rig);
+
+    // one palette per zombie with a gap between them that must never be written
+    const uint32_t stride = static_cast<uint32_t>(rig.boneCount) + 3;
+    const glm::mat4 sentinel(-7.f);
+    std::vector<glm::mat4> output(ZOMBIES * stride, sentinel);
+    std::vector<Skeleton*> skeletons;
+    std::vector<uint32_t> offsets;
+    for (size_t z = 0; z < ZOMBIES; ++z) {
+        skeletons.push_back(&zombies[z].skeleton);
+        offsets.push_back(static_cast<uint32_t>(z * stride));
+    }
+
+    // the incrementally written buffer of one zombie, to check the dirty-only path along the way
+    Zombie single(asset, rig);
+    std::vector<glm::mat4> incremental(rig.boneCount);
+    single.skeleton.writeHierarchy(incremental.data());
+
+    for (int frame = 0; frame < 120; ++frame) {
+        for (Zombie& zombie : zombies) zombie.animate(rig, rng);
+        single.animate(rig, rng);
+
+        Skeleton::writePalettes(skeletons, offsets, output.data());
+        single.skeleton.writeDirtyBones(incremental.data());
+
+        for (size_t z = 0; z < ZOMBIES; ++z) {
+            SCOPED_TRACE(testing::Message() << "frame " << frame << " zombie " << z);
+            expectPalette(output.data() + offsets[z], recursivePalette(rig, zombies[z].locals));
+            for (uint32_t gap = rig.boneCount; gap < stride; ++gap) {
+                ASSERT_EQ(output[offsets[z] + gap], sentinel);
+            }
+        }
+        SCOPED_TRACE(testing::Message() << "frame " << frame << " incremental");
+        expectPalette(incremental.data(), recursivePalette(rig, single.locals));
+    }
+}
+
+TEST(Skeleton, WritePalettesIsCurrentWithoutChanges) {
+    const SyntheticSkeleton rig = makeZombieSkeleton(5);
+    const SkeletonAsset asset = rig.asset();
+    Zombie zombie(asset, rig);
+    std::mt19937 rng(6);
+    zombie.animate(rig, rng);
+
+    Skeleton* skeleton = &zombie.skeleton;
+    const uint32_t offset = 0;
+    std::vector<glm::mat4> first(rig.boneCount), second(rig.boneCount);
+    Skeleton::writePalettes({ &skeleton, 1 }, { &offset, 1 }, first.data());
+    // nothing is dirty now, the full palette is still written
+    Skeleton::writePalettes({ &skeleton, 1 }, { &offset, 1 }, second.data());
+
+    expectPalette(first.data(), recursivePalette(rig, zombie.locals));
+    EXPECT_EQ(first, second);
+}
+
+TEST(Skeleton, UnreachableBonesIgnoreEdits) {
+    // bones 1 and 2 are each other's parent, so the walk from the root never reaches them
+    const std::vector<BoneNode> nodes = {
+        { .name = "root" }, { .name = "left", .parent = 2 }, { .name = "right", .parent = 1 }
+    };
+    const SkeletonAsset asset(nodes, 3);
+    Skeleton skeleton(&asset);
+
+    Transform moved;
+    moved.translation = glm::vec3(1.f, 2.f, 3.f);
+    skeleton.setBoneTransform(1, moved);
+    skeleton.setBonePosition("right", moved.translation);
+    skeleton.setBoneRotation("left", glm::quat(0.f, 1.f, 0.f, 0.f));
+    skeleton.setBoneScale("right", glm::vec3(2.f));
+    EXPECT_EQ(skeleton.getBoneTransform(1).translation, glm::vec3(0.f));
+    EXPECT_EQ(skeleton.getBoneTransform("right").scale, glm::vec3(1.f));
+
+    skeleton.setBoneTransform(0, moved);
+    EXPECT_EQ(skeleton.getBoneTransform(0).translation, moved.translation);
+    EXPECT_EQ(skeleton.getBoneTransform("root").translation, moved.translation);
+}
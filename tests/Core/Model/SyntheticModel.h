@@ -0,0 +1,97 @@
+#pragma once
+#include <Core/Model/Model.h>
+
+#include <random>
+#include <string>
+
+/*
+ * A ModelDefinitionBuilder shaped like an import: a random tree of named nodes, one mesh per node with its own
+ * vertices and indices, a few materials and texture paths. Only for tests and benchmarks that need a model
+ * without Assimp.
+ */
+inline ModelDefinitionBuilder makeSyntheticModel(const size_t nodeCount, const size_t verticesPerMesh, const unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+
+    // parents come before their children and every node's children are consecutive, like loadTransformHierarchy
+    std::vector<std::vector<size_t>> children(nodeCount);
+    for (size_t n = 1; n < nodeCount; ++n) {
+        children[std::uniform_int_distribution<size_t>(0, n - 1)(rng)].push_back(n);
+    }
+    std::vector<size_t> order{ 0 }, parentOf(nodeCount, ~size_t(0));
+    for (size_t i = 0; i < order.size(); ++i) {
+        for (const size_t child : children[order[i]]) {
+            parentOf[child] = i;
+            order.push_back(child);
+        }
+    }
+
+    std::vector<std::string> names(nodeCount);
+    std::vector<size_t> nameOffsets(nodeCount);
+    size_t chars = 0;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        names[i] = "node_" + std::to_string(order[i]);
+        nameOffsets[i] = chars;
+        chars += names[i].size() + 1;
+    }
+
+    ModelDefinitionBuilder model(nodeCount, nodeCount, chars);
+    for (const std::string& name : names) {
+        model.names.insert(model.names.end(), name.begin(), name.end());
+        model.names.push_back('\0');
+    }
+
+    for (size_t i = 0; i < nodeCount; ++i) {
+        MeshNode& node = model.nodes.emplace_back();
+        node.parent = parentOf[order[i]];
+        node.localTransform = Transform(glm::vec3(unit(rng), unit(rng), unit(rng)) * 4.f, glm::vec3(1.f + 0.2f * unit(rng)),
+            glm::vec3(unit(rng), unit(rng), unit(rng)));
+        node.localMatrix = node.localTransform.createModel3D();
+        node.finalTransform = node.parent == ~size_t(0) ? node.localMatrix : model.nodes[node.parent].finalTransform * node.localMatrix;
+        node.name = { model.names.data() + nameOffsets[i], names[i].size() };
+        node.firstMeshIndex = static_cast<unsigned>(i);
+        node.meshCount = 1;
+        model.nameToNode.emplace(std::hash<std::string_view>{}(node.name), static_cast<unsigned>(i));
+    }
+    // the children of the node at position i are the positions whose parent is i, consecutive by construction
+    for (size_t i = nodeCount; i-- > 1;) {
+        MeshNode& parent = model.nodes[model.nodes[i].parent];
+        parent.firstChild = i;
+        ++parent.childrenCount;
+    }
+
+    for (size_t m = 0; m < nodeCount; ++m) {
+        const auto vertexOffset = static_cast<unsigned>(model.vertices.size());
+        const auto indexOffset = static_cast<unsigned>(model.indices.size());
+        for (size_t v = 0; v < verticesPerMesh; ++v) {
+            Vertex& vertex = model.vertices.emplace_back();
+            vertex.Position = glm::vec3(unit(rng), unit(rng), unit(rng));
+            vertex.Normal = glm::normalize(glm::vec3(unit(rng), unit(rng), 1.f));
+            vertex.TexCoords = glm::vec2(unit(rng), unit(rng));
+            vertex.Tangent = glm::vec3(1, 0, 0);
+            vertex.Bitangent = glm::vec3(0, 1, 0);
+            for (int b = 0; b < MAX_BONE_INFLUENCE; ++b) {
+                vertex.m_BoneIDs[b] = b;
+                vertex.m_Weights[b] = 0.25f;
+            }
+        }
+        for (size_t t = 0; t + 2 < verticesPerMesh; ++t) {
+            model.indices.insert(model.indices.end(), { unsigned(t), unsigned(t + 1), unsigned(t + 2) });
+        }
+        model.meshIndicesArena.push_back(static_cast<unsigned>(m));
+        model.renderNodes.push_back({ MeshDrawParams(vertexOffset, static_cast<unsigned>(verticesPerMesh), indexOffset,
+            static_cast<unsigned>(model.indices.size() - indexOffset)), static_cast<unsigned>(m % 3) });
+    }
+
+    for (int m = 0; m < 3; ++m) {
+        MeshMaterial& material = model.materials.emplace_back();
+        material.diffuse = m;
+        material.normal = m == 0 ? 3 : -1;
+        material.isTransparent = m == 2;
+    }
+    for (const char* path : { "textures/albedo_0.png", "textures/albedo_1.png", "textures/albedo_2.png", "textures/normal.png" }) {
+        model.pathToTexture.emplace(std::hash<std::string_view>{}(path), static_cast<unsigned>(model.texturePaths.size()));
+        model.texturePaths.emplace_back(path);
+    }
+    return model;
+}
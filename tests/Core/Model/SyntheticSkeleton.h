@@ -0,0 +1,109 @@
+#pragma once
+#include <Core/Model/Skeleton.h>
+
+#include <random>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * A humanoid rig shaped like the zombie import: an "Armature" node above the hips, spine, head and jaw, arms with
+ * three-joint fingers, legs, and the non-bone helper and end nodes exporters add. Offsets are the inverse bind
+ * matrices, so the bind pose palette is identity. Only for tests and benchmarks that need a skeleton without Assimp.
+ */
+struct SyntheticSkeleton {
+    std::vector<BoneNode> nodes;
+    int boneCount = 0;
+
+    SkeletonAsset asset() const {
+        return SkeletonAsset(nodes, boneCount);
+    }
+};
+
+inline SyntheticSkeleton makeZombieSkeleton(const unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+
+    // (name, parent name, is a bone), parents listed before their children
+    std::vector<std::tuple<std::string, std::string, bool>> rig = {
+        { "Armature", "", false },
+        { "hips", "Armature", true },
+        { "spine", "hips", true },
+        { "spine1", "spine", true },
+        { "spine2", "spine1", true },
+        { "neck", "spine2", true },
+        { "neck_twist", "neck", false },
+        { "head", "neck_twist", true },
+        { "jaw", "head", true },
+        { "head_end", "head", false },
+    };
+    for (const std::string side : { "left", "right" }) {
+        rig.emplace_back(side + "_shoulder", "spine2", true);
+        rig.emplace_back(side + "_arm", side + "_shoulder", true);
+        rig.emplace_back(side + "_forearm", side + "_arm", true);
+        rig.emplace_back(side + "_hand", side + "_forearm", true);
+        for (const std::string finger : { "thumb", "index", "middle", "ring", "pinky" }) {
+            std::string parent = side + "_hand";
+            for (int joint = 1; joint <= 3; ++joint) {
+                std::string name = side + "_" + finger + std::to_string(joint);
+                rig.emplace_back(name, parent, true);
+                parent = std::move(name);
+            }
+            rig.emplace_back(side + "_" + finger + "_end", parent, false);
+        }
+        rig.emplace_back(side + "_upleg", "hips", true);
+        rig.emplace_back(side + "_leg", side + "_upleg", true);
+        rig.emplace_back(side + "_foot", side + "_leg", true);
+        rig.emplace_back(side + "_toe", side + "_foot", true);
+        rig.emplace_back(side + "_toe_end", side + "_toe", false);
+    }
+
+    // bones take the ids [0, boneCount) in rig order, the other nodes follow
+    std::unordered_map<std::string, int> idOf;
+    SyntheticSkeleton skeleton;
+    for (const auto& [name, parent, isBone] : rig) {
+        if (isBone) idOf[name] = skeleton.boneCount++;
+    }
+    int next = skeleton.boneCount;
+    for (const auto& [name, parent, isBone] : rig) {
+        if (!isBone) idOf[name] = next++;
+    }
+
+    skeleton.nodes.resize(rig.size());
+    std::vector<glm::mat4> bindGlobal(rig.size());
+    for (const auto& [name, parent, isBone] : rig) {
+        BoneNode& node = skeleton.nodes[idOf[name]];
+        node.name = name;
+        node.parent = parent.empty() ? -1 : idOf[parent];
+        node.localTransform = Transform(glm::vec3(unit(rng), 1.f + unit(rng), unit(rng)) * 0.3f, glm::vec3(1.f),
+            glm::vec3(unit(rng), unit(rng), unit(rng)) * 20.f);
+        // helper nodes carry a little shear, like the decomposed matrices of some exports
+        if (!isBone) node.skew = glm::vec3(unit(rng), unit(rng), unit(rng)) * 0.05f;
+
+        const glm::mat4 local = node.localTransform.createModel3DSkew(node.skew);
+        bindGlobal[idOf[name]] = node.parent < 0 ? local : bindGlobal[node.parent] * local;
+        node.offset = glm::inverse(bindGlobal[idOf[name]]);
+    }
+    return skeleton;
+}
+
+/* the skinning palette by recursion from the root, as Skeleton computed it before its linear pass */
+inline std::vector<glm::mat4> recursivePalette(const SyntheticSkeleton& skeleton, const std::vector<Transform>& locals) {
+    std::vector<std::vector<int>> children(skeleton.nodes.size());
+    int root = -1;
+    for (int id = 0; id < static_cast<int>(skeleton.nodes.size()); ++id) {
+        if (skeleton.nodes[id].parent < 0) root = id;
+        else children[skeleton.nodes[id].parent].push_back(id);
+    }
+
+    std::vector<glm::mat4> palette(skeleton.boneCount);
+    const auto visit = [&](const auto& self, const int id, const glm::mat4& parentGlobal) -> void {
+        const BoneNode& node = skeleton.nodes[id];
+        const glm::mat4 global = parentGlobal * locals[id].createModel3DSkew(node.skew);
+        if (id < skeleton.boneCount) palette[id] = global * node.offset;
+        for (const int child : children[id]) self(self, child, global);
+    };
+    visit(visit, root, glm::mat4(1.0f));
+    return palette;
+}
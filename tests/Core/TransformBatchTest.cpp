@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <Core/TransformBatch.h>
+
+#include <random>
+
+namespace {
+    Transform randomTransform(std::mt19937& rng, const float translationRange, const float scaleRange) {
+        std::uniform_real_distribution<float> unit(-1.f, 1.f);
+        std::uniform_real_distribution<float> logScale(-scaleRange, scaleRange);
+        Transform transform;
+        transform.translation = glm::vec3(unit(rng), unit(rng), unit(rng)) * translationRange;
+        // mirrored and squashed scales too, the batch must not assume a uniform or positive one
+        transform.scale = glm::vec3(std::exp(logScale(rng)), std::exp(logScale(rng)), std::exp(logScale(rng)));
+        if (rng() % 5 == 0) transform.scale.y = -transform.scale.y;
+        transform.rotation = glm::normalize(glm::quat(unit(rng), unit(rng), unit(rng), unit(rng)));
+        return transform;
+    }
+
+    /* both are `T * R * S` from the same floats, they differ only in rounding */
+    void expectNearModel3D(const glm::mat4& actual, const Transform& transform) {
+        const glm::mat4 expected = transform.createModel3D();
+        const float largestScale = std::max({ std::abs(transform.scale.x), std::abs(transform.scale.y), std::abs(transform.scale.z) });
+        for (int c = 0; c < 4; ++c) {
+            const float magnitude = c == 3 ? glm::length(transform.translation) : largestScale;
+            for (int r = 0; r < 4; ++r) {
+                ASSERT_NEAR(actual[c][r], expected[c][r], 4e-6f * std::max(1.f, magnitude)) << "column " << c << " row " << r;
+            }
+        }
+    }
+}
+
+TEST(TransformBatch, MatchesCreateModel3DForEveryCount) {
+    std::mt19937 rng(1);
+    // every tail length, and counts well past a batch
+    for (size_t count = 0; count <= 4 * transforms::LANES + 3; ++count) {
+        std::vector<Transform> batch;
+        for (size_t i = 0; i < count; ++i) batch.push_back(randomTransform(rng, 10.f, 1.f));
+
+        // one matrix either side of the output, which the batch must leave alone
+        const glm::mat4 sentinel(7.f);
+        std::vector<glm::mat4> out(count + 2, sentinel);
+        transforms::composeMatrices(batch, out.data() + 1);
+
+        EXPECT_EQ(out.front(), sentinel);
+        EXPECT_EQ(out.back(), sentinel);
+        for (size_t i = 0; i < count; ++i) {
+            SCOPED_TRACE(testing::Message() << "count " << count << " transform " << i);
+            expectNearModel3D(out[i + 1], batch[i]);
+        }
+    }
+}
+
+TEST(TransformBatch, PointersMatchTheContiguousBatch) {
+    std::mt19937 rng(2);
+    std::vector<Transform> batch;
+    for (int i = 0; i < 101; ++i) batch.push_back(randomTransform(rng, 100.f, 2.f));
+
+    // scattered in reverse, like components gathered from entities
+    std::vector<const Transform*> pointers;
+    for (auto it = batch.rbegin(); it != batch.rend(); ++it) pointers.push_back(&*it);
+
+    std::vector<glm::mat4> contiguous(batch.size()), gathered(batch.size());
+    transforms::composeMatrices(batch, contiguous.data());
+    transforms::composeMatrices(pointers, gathered.data());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        EXPECT_EQ(gathered[i], contiguous[batch.size() - 1 - i]) << i;
+    }
+}
+
+TEST(TransformBatch, StaysWithinEpsilonAtExtremes) {
+    std::mt19937 rng(3);
+    std::vector<Transform> batch;
+    for (int i = 0; i < 64; ++i) {
+        // world sized translations, tiny and huge scales
+        batch.push_back(randomTransform(rng, i % 2 ? 1e4f : 1e-3f, i % 3 ? 8.f : 0.1f));
+    }
+    batch.push_back(Transform());
+
+    std::vector<glm::mat4> out(batch.size());
+    transforms::composeMatrices(batch, out.data());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        SCOPED_TRACE(testing::Message() << "transform " << i);
+        expectNearModel3D(out[i], batch[i]);
+    }
+    EXPECT_EQ(out.back(), glm::mat4(1.0f));
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <Core/World/FrustumCuller.h>
+
+#include <random>
+#include <set>
+#include <tuple>
+
+namespace {
+    constexpr float REGION_SIZE = 64.f;
+
+    using Key = std::tuple<int, int, int>;
+
+    Key keyOf(const glm::ivec3& region) {
+        return { region.x, region.y, region.z };
+    }
+
+    struct World {
+        std::vector<glm::ivec3> regions;
+        std::vector<AABB> bounds;
+    };
+
+    /* sparse regions around the origin, each box a random part of its region's cube */
+    World makeWorld(std::mt19937& rng, const int count) {
+        std::uniform_int_distribution<int> horizontal(-16, 15);
+        std::uniform_int_distribution<int> vertical(-3, 2);
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+        World world;
+        std::set<Key> taken;
+        while (static_cast<int>(world.regions.size()) < count) {
+            const glm::ivec3 region(horizontal(rng), vertical(rng), horizontal(rng));
+            if (!taken.insert(keyOf(region)).second) continue;
+
+            const glm::vec3 origin = glm::vec3(region) * REGION_SIZE;
+            glm::vec3 a(unit(rng), unit(rng), unit(rng)), b(unit(rng), unit(rng), unit(rng));
+            world.regions.push_back(region);
+            world.bounds.push_back(AABB::fromTo(origin + glm::min(a, b) * REGION_SIZE, origin + glm::max(a, b) * REGION_SIZE));
+        }
+        return world;
+    }
+
+    struct Camera {
+        Frustum frustum;
+        glm::vec3 origin;
+        float viewDistance;
+    };
+
+    Camera makeCamera(std::mt19937& rng) {
+        std::uniform_real_distribution<float> position(-600.f, 600.f);
+        std::uniform_real_distribution<float> angle(-3.14159f, 3.14159f);
+        std::uniform_real_distribution<float> pitch(-1.2f, 1.2f);
+        std::uniform_real_distribution<float> distance(50.f, 1200.f);
+
+        Camera camera;
+        camera.origin = glm::vec3(position(rng), position(rng) * 0.2f, position(rng));
+        const float yaw = angle(rng), tilt = pitch(rng);
+        const glm::vec3 forward(std::cos(tilt) * std::cos(yaw), std::sin(tilt), std::cos(tilt) * std::sin(yaw));
+        const glm::mat4 view = glm::lookAt(camera.origin, camera.origin + forward, glm::vec3(0.f, 1.f, 0.f));
+        const glm::mat4 projection = glm::perspective(glm::radians(70.f), 16.f / 9.f, 0.1f, 2000.f);
+        camera.frustum.extract(projection * view);
+        camera.viewDistance = distance(rng);
+        return camera;
+    }
+
+    std::set<Key> reference(const World& world, const Camera& camera) {
+        std::set<Key> visible;
+        for (size_t i = 0; i < world.regions.size(); ++i) {
+            if (camera.frustum.isVisible(world.bounds[i], camera.origin, camera.viewDistance)) visible.insert(keyOf(world.regions[i]));
+        }
+        return visible;
+    }
+}
+
+TEST(FrustumCuller, MatchesTheScalarTest) {
+    std::mt19937 rng(5);
+    for (const int count : { 1, 7, 8, 9, 100, 3000 }) {
+        const World world = makeWorld(rng, count);
+        FrustumCuller culler;
+        culler.setRegions(world.regions, world.bounds);
+        ASSERT_EQ(culler.size(), size_t(count));
+
+        // repeated culls also exercise the remembered rejecting planes
+        for (int c = 0; c < 60; ++c) {
+            const Camera camera = makeCamera(rng);
+            culler.cull(camera.frustum, camera.origin, camera.viewDistance);
+
+            const auto visible = culler.getVisible();
+            ASSERT_TRUE(std::ranges::is_sorted(visible, FrustumCuller::regionOrder));
+
+            std::set<Key> culled;
+            for (const glm::ivec3& region : visible) {
+                EXPECT_TRUE(culled.insert(keyOf(region)).second) << "duplicate region";
+            }
+            ASSERT_EQ(culled, reference(world, camera)) << count << " regions, camera " << c;
+        }
+    }
+}
+
+TEST(FrustumCuller, CommitReportsTheDifference) {
+    std::mt19937 rng(6);
+    const World world = makeWorld(rng, 2000);
+    FrustumCuller culler;
+    culler.setRegions(world.regions, world.bounds);
+
+    std::set<Key> shown;
+    for (int c = 0; c < 30; ++c) {
+        const Camera camera = makeCamera(rng);
+        culler.cull(camera.frustum, camera.origin, camera.viewDistance);
+
+        std::vector<FrustumCuller::Change> changes;
+        culler.commit(changes);
+
+        bool removing = true;
+        for (const auto& [region, isVisible] : changes) {
+            // removals come first
+            if (isVisible) removing = false;
+            EXPECT_TRUE(isVisible || removing);
+
+            if (isVisible) {
+                EXPECT_TRUE(shown.insert(keyOf(region)).second);
+            } else {
+                EXPECT_EQ(shown.erase(keyOf(region)), 1u);
+            }
+        }
+        ASSERT_EQ(shown, reference(world, camera)) << c;
+    }
+}
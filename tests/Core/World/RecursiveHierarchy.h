@@ -0,0 +1,91 @@
+#pragma once
+#include <Core/World/TransformHierarchy.h>
+
+#include <algorithm>
+#include <vector>
+
+/*
+ * The scene graph's recursive walk over per node children lists, kept by the same handles a TransformHierarchy
+ * hands out. Only for tests and benchmarks that compare the flattened hierarchy against it.
+ */
+struct RecursiveHierarchy {
+    std::vector<HierarchyNode> parents;
+    std::vector<std::vector<uint32_t>> children;
+    std::vector<uint32_t> roots;
+    std::vector<Transform> locals;
+    std::vector<glm::vec3> offsets;
+    std::vector<bool> alive;
+
+    std::vector<Transform> worlds;
+    std::vector<glm::mat4> matrices;
+
+    void add(const HierarchyNode node, const HierarchyNode parent, const Transform& local, const glm::vec3& offset = glm::vec3(0)) {
+        const auto handle = static_cast<size_t>(node);
+        if (handle >= alive.size()) {
+            const size_t size = handle + 1;
+            parents.resize(size, HierarchyNode::INVALID);
+            children.resize(size);
+            locals.resize(size);
+            offsets.resize(size);
+            alive.resize(size, false);
+            worlds.resize(size);
+            matrices.resize(size);
+        }
+        alive[handle] = true;
+        locals[handle] = local;
+        offsets[handle] = offset;
+        children[handle].clear();
+        link(node, parent);
+    }
+
+    void remove(const HierarchyNode node) {
+        unlink(node);
+        std::vector<uint32_t> stack{ static_cast<uint32_t>(node) };
+        while (!stack.empty()) {
+            const uint32_t current = stack.back();
+            stack.pop_back();
+            stack.insert(stack.end(), children[current].begin(), children[current].end());
+            children[current].clear();
+            alive[current] = false;
+        }
+    }
+
+    void reparent(const HierarchyNode node, const HierarchyNode parent) {
+        unlink(node);
+        link(node, parent);
+    }
+
+    /* whether `node` is `ancestor` or below it */
+    bool inSubtree(HierarchyNode node, const HierarchyNode ancestor) const {
+        for (; node != HierarchyNode::INVALID; node = parents[static_cast<uint32_t>(node)]) {
+            if (node == ancestor) return true;
+        }
+        return false;
+    }
+
+    void update() {
+        for (const uint32_t root : roots) walk(root, nullptr);
+    }
+
+    void walk(const uint32_t node, const Transform* parentWorld) {
+        Transform world = parentWorld ? *parentWorld * locals[node] : locals[node];
+        world.translation += world.rotation * offsets[node];
+        worlds[node] = world;
+        matrices[node] = world.createModel3D();
+        for (const uint32_t child : children[node]) walk(child, &worlds[node]);
+    }
+
+private:
+    void link(const HierarchyNode node, const HierarchyNode parent) {
+        parents[static_cast<uint32_t>(node)] = parent;
+        auto& siblings = parent == HierarchyNode::INVALID ? roots : children[static_cast<uint32_t>(parent)];
+        siblings.push_back(static_cast<uint32_t>(node));
+    }
+
+    void unlink(const HierarchyNode node) {
+        const HierarchyNode parent = parents[static_cast<uint32_t>(node)];
+        auto& siblings = parent == HierarchyNode::INVALID ? roots : children[static_cast<uint32_t>(parent)];
+        std::erase(siblings, static_cast<uint32_t>(node));
+        parents[static_cast<uint32_t>(node)] = HierarchyNode::INVALID;
+    }
+};
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <Core/World/TerrainRegion.h>
+
+#include <random>
+#include <set>
+
+namespace {
+    using Region = TerrainRegion<uint32_t>;
+
+    struct Scene {
+        std::vector<AABB> bounds;
+        std::mt19937 rng{ 7 };
+
+        AABB randomBox() {
+            std::uniform_real_distribution<float> position(0.f, 64.f);
+            std::uniform_real_distribution<float> size(0.2f, 1.5f);
+            return AABB(glm::vec3(position(rng), position(rng), position(rng)), glm::vec3(size(rng)));
+        }
+
+        void add(Region& region, const size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                bounds.push_back(randomBox());
+                region.updateEntity(static_cast<uint32_t>(bounds.size() - 1), bounds.back());
+            }
+        }
+
+        void move(Region& region, const size_t count, const float distance) {
+            std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(bounds.size() - 1));
+            std::uniform_real_distribution<float> step(-distance, distance);
+            for (size_t i = 0; i < count; ++i) {
+                const uint32_t e = pick(rng);
+                bounds[e] = AABB(bounds[e].center + glm::vec3(step(rng), step(rng), step(rng)), bounds[e].halfSize);
+                region.updateEntity(e, bounds[e]);
+            }
+        }
+    };
+
+    void expectQueriesMatch(const Region& region, const Scene& scene) {
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> position(0.f, 64.f);
+        for (int q = 0; q < 100; ++q) {
+            const AABB query(glm::vec3(position(rng), position(rng), position(rng)), glm::vec3(4.f));
+            std::set<uint32_t> expected, found;
+            for (uint32_t e = 0; e < scene.bounds.size(); ++e) {
+                if (geom::intersects(query, scene.bounds[e])) expected.insert(e);
+            }
+            region.bvh.forEachIntersects(query, [&](const Region::Entry& entry) {
+                found.insert(entry.entity);
+                return false;
+            });
+            ASSERT_EQ(found, expected) << q;
+        }
+    }
+}
+
+TEST(TerrainRegion, StashedUpdatesKeepTheLatestBounds) {
+    Region region;
+    Scene scene;
+    scene.add(region, 100);
+    scene.move(region, 300, 5.f);
+    EXPECT_EQ(region.stash.size(), 100u);
+
+    region.update();
+    EXPECT_FALSE(region.hasChanges());
+    EXPECT_EQ(region.bvh.size(), 100u);
+    expectQueriesMatch(region, scene);
+}
+
+TEST(TerrainRegion, InsertsIncrementallyUntilTheTreeDegrades) {
+    Region region;
+    Scene scene;
+    scene.add(region, 2000);
+    region.update();
+    ASSERT_EQ(region.rebuilds, 1u);
+
+    // a few entities at a time fit into the existing leaves
+    for (int tick = 0; tick < 5; ++tick) {
+        scene.add(region, 5);
+        region.update();
+        expectQueriesMatch(region, scene);
+    }
+    EXPECT_EQ(region.rebuilds, 1u);
+    EXPECT_LE(region.bvh.sahCost(), region.builtCost * Region::REBUILD_SAH_RATIO);
+
+    // doubling the region overfills the leaves, which the SAH check turns into a rebuild
+    scene.add(region, 2000);
+    region.update();
+    EXPECT_EQ(region.rebuilds, 2u);
+    EXPECT_EQ(region.bvh.size(), scene.bounds.size());
+    expectQueriesMatch(region, scene);
+}
+
+TEST(TerrainRegion, MovesRefitAndRebuildOnlyWhenNeeded) {
+    Region region;
+    Scene scene;
+    scene.add(region, 3000);
+    region.update();
+
+    for (int tick = 0; tick < 50; ++tick) {
+        scene.move(region, 30, 0.5f);
+        region.update();
+        EXPECT_LE(region.bvh.sahCost(), region.builtCost * Region::REBUILD_SAH_RATIO) << tick;
+    }
+    expectQueriesMatch(region, scene);
+
+    // scattering everything blows the refit bounds up, and the next update rebuilds
+    const uint64_t before = region.rebuilds;
+    scene.move(region, 3000, 40.f);
+    region.update();
+    EXPECT_GT(region.rebuilds, before);
+    expectQueriesMatch(region, scene);
+}
@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include <Core/World/TransformHierarchy.h>
+#include "RecursiveHierarchy.h"
+
+#include <random>
+
+namespace {
+    Transform randomLocal(std::mt19937& rng) {
+        std::uniform_real_distribution<float> unit(-1.f, 1.f);
+        return Transform(glm::vec3(unit(rng), unit(rng), unit(rng)) * 2.f, glm::vec3(1.f + 0.1f * unit(rng)),
+            glm::vec3(unit(rng), unit(rng), unit(rng)));
+    }
+
+    glm::vec3 randomOffset(std::mt19937& rng) {
+        std::uniform_real_distribution<float> unit(-1.f, 1.f);
+        return rng() % 4 == 0 ? glm::vec3(unit(rng), unit(rng), unit(rng)) : glm::vec3(0);
+    }
+
+    void expectMatches(const TransformHierarchy& hierarchy, const RecursiveHierarchy& reference) {
+        size_t alive = 0;
+        for (size_t handle = 0; handle < reference.alive.size(); ++handle) {
+            const auto node = static_cast<HierarchyNode>(handle);
+            ASSERT_EQ(hierarchy.contains(node), reference.alive[handle]) << "node " << handle;
+            if (!reference.alive[handle]) continue;
+            ++alive;
+
+            ASSERT_EQ(hierarchy.getParent(node), reference.parents[handle]) << "node " << handle;
+            // the same composition in the same order, only the level by level schedule differs
+            const Transform& world = hierarchy.getWorldTransform(node);
+            const Transform& expected = reference.worlds[handle];
+            ASSERT_EQ(world.translation, expected.translation) << "node " << handle;
+            ASSERT_EQ(world.rotation, expected.rotation) << "node " << handle;
+            ASSERT_EQ(world.scale, expected.scale) << "node " << handle;
+
+            const glm::mat4& matrix = hierarchy.getWorld(node);
+            for (int c = 0; c < 4; ++c) {
+                for (int r = 0; r < 4; ++r) {
+                    ASSERT_NEAR(matrix[c][r], reference.matrices[handle][c][r], 1e-4f * (1.f + std::abs(reference.matrices[handle][c][r])))
+                        << "node " << handle;
+                }
+            }
+        }
+        ASSERT_EQ(hierarchy.size(), alive);
+    }
+
+    std::vector<HierarchyNode> aliveNodes(const RecursiveHierarchy& reference) {
+        std::vector<HierarchyNode> nodes;
+        for (size_t handle = 0; handle < reference.alive.size(); ++handle) {
+            if (reference.alive[handle]) nodes.push_back(static_cast<HierarchyNode>(handle));
+        }
+        return nodes;
+    }
+}
+
+TEST(TransformHierarchy, RandomEditsMatchTheRecursiveWalk) {
+    std::mt19937 rng(1);
+    TransformHierarchy hierarchy;
+    RecursiveHierarchy reference;
+
+    for (int step = 0; step < 4000; ++step) {
+        const std::vector<HierarchyNode> nodes = aliveNodes(reference);
+        const auto pick = [&] {
+            return nodes[std::uniform_int_distribution<size_t>(0, nodes.size() - 1)(rng)];
+        };
+        const unsigned action = nodes.size() < 20 ? 0 : rng() % 100;
+
+        if (action < 40) {
+            const HierarchyNode parent = nodes.empty() || rng() % 20 == 0 ? HierarchyNode::INVALID : pick();
+            const Transform local = randomLocal(rng);
+            const glm::vec3 offset = randomOffset(rng);
+            reference.add(hierarchy.add(parent, local, offset), parent, local, offset);
+        } else if (action < 45) {
+            const HierarchyNode node = pick();
+            hierarchy.remove(node);
+            reference.remove(node);
+        } else if (action < 55) {
+            const HierarchyNode node = pick();
+            HierarchyNode parent = rng() % 10 == 0 ? HierarchyNode::INVALID : pick();
+            if (parent != HierarchyNode::INVALID && reference.inSubtree(parent, node)) parent = HierarchyNode::INVALID;
+            hierarchy.reparent(node, parent);
+            reference.reparent(node, parent);
+        } else if (action < 90) {
+            const HierarchyNode node = pick();
+            const Transform local = randomLocal(rng);
+            if (rng() % 2 == 0) {
+                hierarchy.setLocal(node, local);
+                reference.locals[static_cast<uint32_t>(node)] = local;
+            } else {
+                const glm::vec3 offset = randomOffset(rng);
+                hierarchy.setLocal(node, local, offset);
+                reference.locals[static_cast<uint32_t>(node)] = local;
+                reference.offsets[static_cast<uint32_t>(node)] = offset;
+            }
+        }
+
+        // several edits often land between two updates
+        if (rng() % 4 == 0) {
+            hierarchy.update();
+            reference.update();
+            SCOPED_TRACE(testing::Message() << "step " << step);
+            expectMatches(hierarchy, reference);
+            if (testing::Test::HasFailure()) return;
+        }
+    }
+}
+
+TEST(TransformHierarchy, WideLevelsComposeInParallel) {
+    std::mt19937 rng(2);
+    TransformHierarchy hierarchy;
+    RecursiveHierarchy reference;
+
+    // a root with a level a few grains wide, and a second level below half of it
+    const Transform rootLocal = randomLocal(rng);
+    const HierarchyNode root = hierarchy.add(HierarchyNode::INVALID, rootLocal);
+    reference.add(root, HierarchyNode::INVALID, rootLocal);
+    std::vector<HierarchyNode> wide;
+    for (uint32_t i = 0; i < 4 * TransformHierarchy::PARALLEL_GRAIN; ++i) {
+        const Transform local = randomLocal(rng);
+        wide.push_back(hierarchy.add(root, local));
+        reference.add(wide.back(), root, local);
+        if (i % 2 == 0) {
+            const Transform leaf = randomLocal(rng);
+            reference.add(hierarchy.add(wide.back(), leaf, glm::vec3(0.5f)), wide.back(), leaf, glm::vec3(0.5f));
+        }
+    }
+    hierarchy.update();
+    reference.update();
+    expectMatches(hierarchy, reference);
+
+    // a few scattered edits are separate runs on this thread, enough of them go parallel, the root dirties everything
+    const std::pair<uint32_t, bool> rounds[] = { { 50, false }, { 2 * TransformHierarchy::PARALLEL_GRAIN, false }, { 50, true } };
+    for (const auto& [edits, withRoot] : rounds) {
+        for (uint32_t e = 0; e < edits; ++e) {
+            const HierarchyNode node = wide[rng() % wide.size()];
+            const Transform local = randomLocal(rng);
+            hierarchy.setLocal(node, local);
+            reference.locals[static_cast<uint32_t>(node)] = local;
+        }
+        if (withRoot) {
+            const Transform local = randomLocal(rng);
+            hierarchy.setLocal(root, local);
+            reference.locals[static_cast<uint32_t>(root)] = local;
+        }
+        hierarchy.update();
+        reference.update();
+        expectMatches(hierarchy, reference);
+    }
+}
+
+TEST(TransformHierarchy, UpdatesOnlyTheDirtySubtrees) {
+    std::mt19937 rng(3);
+    TransformHierarchy hierarchy;
+    RecursiveHierarchy reference;
+    const HierarchyNode a = hierarchy.add(HierarchyNode::INVALID, randomLocal(rng));
+    const HierarchyNode b = hierarchy.add(HierarchyNode::INVALID, randomLocal(rng));
+    const HierarchyNode childOfA = hierarchy.add(a, randomLocal(rng));
+    const HierarchyNode childOfB = hierarchy.add(b, randomLocal(rng));
+    hierarchy.update();
+
+    // an edit is invisible until the update, and leaves the other root's subtree alone
+    const glm::mat4 before = hierarchy.getWorld(childOfA);
+    const glm::mat4 untouched = hierarchy.getWorld(childOfB);
+    hierarchy.setLocal(a, randomLocal(rng));
+    EXPECT_EQ(hierarchy.getWorld(childOfA), before);
+    hierarchy.update();
+    EXPECT_NE(hierarchy.getWorld(childOfA), before);
+    EXPECT_EQ(hierarchy.getWorld(childOfB), untouched);
+
+    // a freed handle is reused, and the node under it is new
+    hierarchy.remove(childOfA);
+    EXPECT_FALSE(hierarchy.contains(childOfA));
+    const HierarchyNode reused = hierarchy.add(b, Transform());
+    EXPECT_EQ(reused, childOfA);
+    EXPECT_EQ(hierarchy.getParent(reused), b);
+}
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+#include <Math/BoundingVolumeHierarchy.h>
+
+#include <random>
+#include <set>
+
+namespace {
+    struct Box {
+        AABB bounds;
+        uint32_t id;
+
+        operator const AABB&() const {
+            return bounds;
+        }
+
+        bool operator == (const uint32_t other) const {
+            return id == other;
+        }
+    };
+
+    std::vector<Box> makeBoxes(const size_t count, const unsigned seed, const uint32_t firstId = 0) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> position(0.f, 200.f);
+        std::uniform_real_distribution<float> size(0.1f, 4.f);
+
+        std::vector<Box> boxes;
+        for (uint32_t i = 0; i < count; ++i) {
+            const glm::vec3 center(position(rng), position(rng), position(rng));
+            boxes.push_back({ AABB(center, glm::vec3(size(rng), size(rng), size(rng))), firstId + i });
+        }
+        return boxes;
+    }
+
+    std::set<uint32_t> bruteForce(const std::vector<Box>& boxes, const AABB& query) {
+        std::set<uint32_t> hits;
+        for (const Box& box : boxes) {
+            if (geom::intersects(query, box.bounds)) hits.insert(box.id);
+        }
+        return hits;
+    }
+
+    std::set<uint32_t> queried(const BVH<Box>& bvh, const AABB& query) {
+        std::set<uint32_t> hits;
+        bvh.forEachIntersects(query, [&](const Box& box) {
+            hits.insert(box.id);
+            return false;
+        });
+        return hits;
+    }
+
+    void expectQueriesMatch(const BVH<Box>& bvh, const std::vector<Box>& boxes, const unsigned seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> position(0.f, 200.f);
+        for (int q = 0; q < 200; ++q) {
+            const AABB query(glm::vec3(position(rng), position(rng), position(rng)), glm::vec3(12.f));
+            ASSERT_EQ(queried(bvh, query), bruteForce(boxes, query)) << q;
+        }
+    }
+
+    /* every primitive's recorded leaf owns it and every node contains its primitives */
+    void expectConsistent(const BVH<Box>& bvh) {
+        bvh.forEachPrimitive([&](const uint32_t index, const Box& box) {
+            const uint32_t leaf = bvh.leafOf(index);
+            ASSERT_NE(leaf, BVH<Box>::NONE);
+            uint32_t n = 0;
+            bvh.forEachNode([&](const BVH<Box>::BVHNode& node) {
+                if (n++ != leaf) return;
+                EXPECT_TRUE(node.isLeaf());
+                EXPECT_GE(index, node.offset);
+                EXPECT_LT(index, node.offset + node.count);
+                EXPECT_TRUE(glm::all(glm::lessThanEqual(node.min, box.bounds.min())));
+                EXPECT_TRUE(glm::all(glm::greaterThanEqual(node.max, box.bounds.max())));
+            });
+        });
+    }
+}
+
+TEST(BVH, AABBQueriesMatchBruteForce) {
+    const std::vector<Box> boxes = makeBoxes(5000, 1);
+    const BVH<Box> bvh(boxes, BVH<Box>::BuildOptions(4));
+    expectQueriesMatch(bvh, boxes, 2);
+    expectConsistent(bvh);
+}
+
+TEST(BVH, RaycastFindsTheClosestHit) {
+    const std::vector<Box> boxes = makeBoxes(5000, 3);
+    const BVH<Box> bvh(boxes, BVH<Box>::BuildOptions(4));
+
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<float> position(0.f, 200.f);
+    for (int r = 0; r < 200; ++r) {
+        const Ray ray = Ray::cast(glm::vec3(position(rng), position(rng), position(rng)),
+                                  glm::vec3(position(rng), position(rng), position(rng)));
+        float closest = std::numeric_limits<float>::infinity();
+        for (const Box& box : boxes) {
+            if (const RayResult hit = ray.intersects(box.bounds); hit.hasHit()) closest = std::min(closest, hit.distance);
+        }
+
+        const auto hit = bvh.raycast(ray);
+        if (closest == std::numeric_limits<float>::infinity()) {
+            EXPECT_FALSE(hit.has_value()) << r;
+        } else {
+            ASSERT_TRUE(hit.has_value()) << r;
+            EXPECT_FLOAT_EQ(hit->distance, closest) << r;
+        }
+    }
+}
+
+TEST(BVH, InsertKeepsQueriesExact) {
+    std::vector<Box> boxes = makeBoxes(2000, 5);
+    BVH<Box> bvh(boxes, BVH<Box>::BuildOptions(4));
+    const float builtCost = bvh.sahCost();
+
+    const std::vector<Box> batch = makeBoxes(500, 6, 2000);
+    bvh.insert(batch);
+    boxes.insert(boxes.end(), batch.begin(), batch.end());
+
+    for (const Box& box : makeBoxes(50, 7, 2500)) {
+        bvh.insert(box);
+        boxes.push_back(box);
+    }
+
+    EXPECT_EQ(bvh.size(), boxes.size());
+    expectQueriesMatch(bvh, boxes, 8);
+    expectConsistent(bvh);
+    EXPECT_TRUE(bvh.find(2549u));
+
+    // fuller leaves cost more, the sum tracked through insert matches a fresh one
+    EXPECT_GT(bvh.sahCost(), builtCost);
+    float recomputed = 0.f;
+    bvh.forEachNode([&](const BVH<Box>::BVHNode& node) {
+        const glm::vec3 e = node.max - node.min;
+        recomputed += 2.f * (e.x * e.y + e.y * e.z + e.z * e.x) * (node.isLeaf() ? float(node.count) : 1.f);
+    });
+    const glm::vec3 e = bvh.root()->max - bvh.root()->min;
+    EXPECT_NEAR(bvh.sahCost(), recomputed / (2.f * (e.x * e.y + e.y * e.z + e.z * e.x)), bvh.sahCost() * 1e-3f);
+
+    bvh.rebuild(BVH<Box>::BuildOptions(4));
+    expectQueriesMatch(bvh, boxes, 9);
+}
+
+TEST(BVH, InsertIntoAnEmptyTreeBuildsIt) {
+    BVH<Box> bvh;
+    const std::vector<Box> boxes = makeBoxes(100, 10);
+    bvh.insert(boxes);
+    EXPECT_EQ(bvh.size(), boxes.size());
+    expectQueriesMatch(bvh, boxes, 11);
+}
+
+TEST(BVH, ParallelBuildMatchesSequential) {
+    const std::vector<Box> boxes = makeBoxes(20000, 12);
+
+    BVH<Box>::BuildOptions sequential(4);
+    sequential.taskThreshold = ~0u;
+    sequential.parallelBinThreshold = ~0u;
+
+    // low thresholds so a test-sized input takes both the task and the reduction paths
+    BVH<Box>::BuildOptions parallel(4);
+    parallel.taskThreshold = 64;
+    parallel.parallelBinThreshold = 256;
+
+    for (const int bins : { 12, 32 }) {
+        sequential.binCount = parallel.binCount = bins;
+        const BVH<Box> a(boxes, sequential);
+        const BVH<Box> b(boxes, parallel);
+
+        ASSERT_EQ(a.nodeCount(), b.nodeCount());
+        EXPECT_EQ(a.sahCost(), b.sahCost());
+
+        std::vector<BVH<Box>::BVHNode> nodes;
+        a.forEachNode([&](const BVH<Box>::BVHNode& node) { nodes.push_back(node); });
+        size_t n = 0;
+        b.forEachNode([&](const BVH<Box>::BVHNode& node) {
+            const auto& expected = nodes[n++];
+            ASSERT_EQ(node.min, expected.min);
+            ASSERT_EQ(node.max, expected.max);
+            ASSERT_EQ(node.offset, expected.offset);
+            ASSERT_EQ(node.count, expected.count);
+        });
+        for (uint32_t i = 0; i < a.size(); ++i) {
+            ASSERT_EQ(a.primitive(i).id, b.primitive(i).id);
+        }
+    }
+}
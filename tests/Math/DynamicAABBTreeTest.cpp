@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include <Math/DynamicAABBTree.h>
+
+#include <cmath>
+#include <map>
+#include <random>
+#include <set>
+
+namespace {
+    using Tree = DynamicAABBTree<int>;
+    using ProxyID = Tree::ProxyID;
+
+    /* what the tree should hold: each live proxy's exact box and payload */
+    struct Oracle {
+        std::map<ProxyID, std::pair<AABB, int>> live;
+
+        std::set<ProxyID> intersecting(const Tree& tree, const AABB& query) const {
+            std::set<ProxyID> hits;
+            for (const auto& [proxy, entry] : live) {
+                if (tree.getFatAABB(proxy).intersects(query)) hits.insert(proxy);
+            }
+            return hits;
+        }
+
+        std::set<std::pair<ProxyID, ProxyID>> pairs(const Tree& tree) const {
+            std::set<std::pair<ProxyID, ProxyID>> result;
+            for (auto a = live.begin(); a != live.end(); ++a) {
+                for (auto b = std::next(a); b != live.end(); ++b) {
+                    if (tree.getFatAABB(a->first).intersects(tree.getFatAABB(b->first))) result.insert({ a->first, b->first });
+                }
+            }
+            return result;
+        }
+    };
+
+    AABB randomBox(std::mt19937& rng, const float world) {
+        std::uniform_real_distribution<float> position(-world, world);
+        std::uniform_real_distribution<float> size(0.1f, 2.f);
+        return AABB(glm::vec3(position(rng), position(rng), position(rng)), glm::vec3(size(rng), size(rng), size(rng)));
+    }
+
+    /* the rotations keep the tree within the AVL bound of 1.44 log2 over its 2n - 1 nodes, a degenerate tree would be linear */
+    void expectBalanced(const Tree& tree) {
+        if (tree.size() < 2) return;
+        const double nodes = 2.0 * double(tree.size()) - 1.0;
+        EXPECT_LE(tree.height(), int(1.44 * std::log2(nodes + 2.0))) << tree.size();
+    }
+
+    void expectMatches(const Tree& tree, const Oracle& oracle, std::mt19937& rng, const float world) {
+        ASSERT_EQ(tree.size(), oracle.live.size());
+        for (const auto& [proxy, entry] : oracle.live) {
+            ASSERT_TRUE(tree.getFatAABB(proxy).contains(entry.first)) << proxy;
+            ASSERT_EQ(tree.getData(proxy), entry.second) << proxy;
+        }
+
+        for (int q = 0; q < 20; ++q) {
+            const AABB query = randomBox(rng, world);
+            std::set<ProxyID> found;
+            tree.forEachIntersects(query, [&](const ProxyID proxy, const int) {
+                EXPECT_TRUE(found.insert(proxy).second) << "reported twice: " << proxy;
+                return false;
+            });
+            ASSERT_EQ(found, oracle.intersecting(tree, query));
+        }
+
+        std::set<std::pair<ProxyID, ProxyID>> pairs;
+        tree.forEachPair([&](const ProxyID a, const ProxyID b) {
+            EXPECT_LT(a, b);
+            EXPECT_TRUE(pairs.insert({ a, b }).second) << "reported twice: " << a << ' ' << b;
+            return false;
+        });
+        ASSERT_EQ(pairs, oracle.pairs(tree));
+
+        expectBalanced(tree);
+    }
+}
+
+TEST(DynamicAABBTree, RandomOperationsMatchBruteForce) {
+    for (const unsigned seed : { 1u, 2u, 3u, 4u }) {
+        std::mt19937 rng(seed);
+        const float world = seed % 2 ? 20.f : 60.f;
+        Tree tree(0.2f);
+        Oracle oracle;
+        int nextData = 0;
+
+        for (int step = 0; step < 3000; ++step) {
+            const int op = std::uniform_int_distribution<int>(0, 9)(rng);
+            if (oracle.live.empty() || op < 4) {
+                const AABB box = randomBox(rng, world);
+                const ProxyID proxy = tree.insert(box, nextData);
+                ASSERT_FALSE(oracle.live.contains(proxy)) << "proxy id reused while live";
+                oracle.live[proxy] = { box, nextData++ };
+            } else {
+                auto it = oracle.live.begin();
+                std::advance(it, std::uniform_int_distribution<size_t>(0, oracle.live.size() - 1)(rng));
+                if (op < 6) {
+                    tree.remove(it->first);
+                    oracle.live.erase(it);
+                } else {
+                    // mostly small moves that stay within the fat box, sometimes teleports
+                    std::uniform_real_distribution<float> nudge(-0.3f, 0.3f);
+                    const glm::vec3 displacement = op < 9 ? glm::vec3(nudge(rng), nudge(rng), nudge(rng))
+                                                          : randomBox(rng, world).center - it->second.first.center;
+                    const AABB moved(it->second.first.center + displacement, it->second.first.halfSize);
+                    tree.move(it->first, moved, displacement);
+                    it->second.first = moved;
+                }
+            }
+            if (step % 250 == 0) expectMatches(tree, oracle, rng, world);
+        }
+        expectMatches(tree, oracle, rng, world);
+
+        for (const auto& [proxy, entry] : oracle.live) tree.remove(proxy);
+        EXPECT_TRUE(tree.empty());
+        EXPECT_EQ(tree.height(), 0);
+    }
+}
+
+TEST(DynamicAABBTree, SmallMovesStayInTheFatBox) {
+    Tree tree(0.5f);
+    const AABB box(glm::vec3(0.f), glm::vec3(1.f));
+    const ProxyID proxy = tree.insert(box, 7);
+
+    EXPECT_FALSE(tree.move(proxy, AABB(glm::vec3(0.2f, 0.f, 0.f), glm::vec3(1.f))));
+    EXPECT_TRUE(tree.move(proxy, AABB(glm::vec3(2.f, 0.f, 0.f), glm::vec3(1.f)), glm::vec3(2.f, 0.f, 0.f)));
+
+    // the fat box now stretches ahead along the displacement
+    const AABB& fat = tree.getFatAABB(proxy);
+    const float ahead = fat.max().x - 3.f;
+    const float behind = 1.f - fat.min().x;
+    EXPECT_GT(ahead, behind);
+    EXPECT_FALSE(tree.move(proxy, AABB(glm::vec3(4.f, 0.f, 0.f), glm::vec3(1.f)), glm::vec3(2.f, 0.f, 0.f)));
+}
+
+TEST(DynamicAABBTree, CrossTreePairsMatchBruteForce) {
+    std::mt19937 rng(9);
+    DynamicAABBTree<int> dynamic;
+    DynamicAABBTree<char> statics;
+    std::vector<ProxyID> a, b;
+    for (int i = 0; i < 400; ++i) a.push_back(dynamic.insert(randomBox(rng, 30.f), i));
+    for (int i = 0; i < 300; ++i) b.push_back(statics.insert(randomBox(rng, 30.f), char(i)));
+
+    std::set<std::pair<ProxyID, ProxyID>> expected, found;
+    for (const ProxyID x : a) {
+        for (const ProxyID y : b) {
+            if (dynamic.getFatAABB(x).intersects(statics.getFatAABB(y))) expected.insert({ x, y });
+        }
+    }
+    dynamic.forEachPair(statics, [&](const ProxyID x, const ProxyID y) {
+        found.insert({ x, y });
+        return false;
+    });
+    EXPECT_EQ(found, expected);
+}
+
+TEST(DynamicAABBTree, SortedInsertionsStayBalanced) {
+    Tree tree(0.f);
+    for (int i = 0; i < 4096; ++i) {
+        tree.insert(AABB(glm::vec3(float(i) * 2.f, 0.f, 0.f), glm::vec3(0.5f)), i);
+        if ((i & (i + 1)) == 0) expectBalanced(tree);
+    }
+    expectBalanced(tree);
+
+    int hits = 0;
+    tree.forEachIntersects(AABB(glm::vec3(4096.f, 0.f, 0.f), glm::vec3(5000.f)), [&](ProxyID, int) {
+        ++hits;
+        return false;
+    });
+    EXPECT_EQ(hits, 4096);
+}
+
+TEST(DynamicAABBTree, CoincidentBoxesReportEveryPair) {
+    Tree tree;
+    constexpr int COUNT = 1500;
+    for (int i = 0; i < COUNT; ++i) tree.insert(AABB(glm::vec3(0.f), glm::vec3(1.f)), i);
+    expectBalanced(tree);
+
+    size_t pairs = 0;
+    tree.forEachPair([&](const ProxyID a, const ProxyID b) {
+        EXPECT_LT(a, b);
+        ++pairs;
+        return false;
+    });
+    EXPECT_EQ(pairs, size_t(COUNT) * (COUNT - 1) / 2);
+}
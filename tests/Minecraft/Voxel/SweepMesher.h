@@ -0,0 +1,106 @@
+#pragma once
+#include <Minecraft/Voxel/VoxelMesher.h>
+
+#include <vector>
+
+/*
+ * The per-cell greedy sweep VoxelMesher replaced, as VoxelWorldSystem::greedyMesh had it. Meshes a volume
+ * on its own, everything outside `dims` reading as air. Only for tests and benchmarks that compare the
+ * bitmask mesher against it.
+ */
+inline std::vector<Quad> sweepMesh(const VoxelVolume& volume, const glm::ivec3 dims) {
+    auto f = [&](int x, int y, int z, Face f) {
+        if (x < 0 || y < 0 || z < 0 || x >= dims.x || y >= dims.y || z >= dims.z)
+            return 0u;
+        return volume.at(x, y, z, int(f));
+    };
+
+    std::vector<Quad> quads;
+    quads.reserve(32);
+
+    for (int d = 0; d < 3; ++d) {
+        int u = (d + 1) % 3;
+        int v = (d + 2) % 3;
+        glm::ivec3 x{};
+        glm::ivec3 q{};
+        q[d] = 1;
+
+        Face posFace = static_cast<Face>(d * 2 + 1);
+        Face negFace = static_cast<Face>(d * 2 + 0);
+
+        bool dirMask[256];
+        unsigned textureMask[256];
+
+        for (x[d] = -1; x[d] < dims[d]; ) {
+            int n = 0;
+
+            for (x[v] = 0; x[v] < dims[v]; ++x[v]) {
+                for (x[u] = 0; x[u] < dims[u]; ++x[u]) {
+                    glm::vec3 neightbor = x + q;
+                    unsigned a = f(x.x, x.y, x.z, posFace);
+                    unsigned b = f(neightbor.x, neightbor.y, neightbor.z, negFace);
+                    dirMask[n] = (a && !b);
+                    unsigned currentTex = 0;
+                    if (a == 0 && b > 0) {
+                        currentTex = b;
+                    } else if (a > 0 && b == 0) {
+                        currentTex = a;
+                    } else {
+                        currentTex = 0;
+                    }
+                    textureMask[n] = currentTex;
+                    ++n;
+                }
+            }
+
+            ++x[d];
+            n = 0;
+            for (int j = 0; j < dims[v]; ++j) {
+                for (int i = 0; i < dims[u]; ) {
+                    if (textureMask[n]) {
+                        const bool currentDir = dirMask[n];
+                        const unsigned currentTex = textureMask[n];
+                        int w;
+                        for (w = 1; i + w < dims[u] && currentTex == textureMask[n + w] && textureMask[n + w] != 0 && dirMask[n + w] == currentDir; ++w);
+
+                        int h;
+                        for (h = 1; j + h < dims[v]; ++h) {
+                            int hIdx = n + h * dims[u];
+                            for (int k = 0; k < w; ++k) {
+                                int idx = hIdx + k;
+                                if (dirMask[idx] != currentDir || currentTex != textureMask[idx]) {
+                                    goto Done;
+                                }
+                            }
+                        }
+                    Done:
+                        x[u] = i;
+                        x[v] = j;
+
+                        glm::ivec3 axis{};
+                        axis[u] = w;
+                        axis[v] = h;
+
+                        Face face = static_cast<Face>(d * 2 + (currentDir ? 1 : 0));
+                        quads.emplace_back(face, AABB::fromTo(x, x + axis), currentTex);
+
+                        for (int l = 0; l < h; ++l) {
+                            int idx = n + l * dims[u];
+                            for (int k = 0; k < w; ++k) {
+                                textureMask[idx + k] = 0;
+                                dirMask[idx + k] = false;
+                            }
+                        }
+
+                        i += w;
+                        n += w;
+                    } else {
+                        ++i;
+                        ++n;
+                    }
+                }
+            }
+        }
+    }
+    return quads;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <Minecraft/Voxel/VoxelMesher.h>
+
+#include <cmath>
+#include <map>
+#include <random>
+#include <tuple>
+#include <vector>
+
+/* chunk contents for the mesher tests and the benchmarks that need voxel geometry */
+
+inline VoxelFaceData uniformVoxel(const uint16_t texture) {
+    VoxelFaceData voxel;
+    for (auto& face : voxel.faces) face = texture;
+    return voxel;
+}
+
+/* voxels of `materials` textures scattered at `density`, some with a different texture per face */
+inline VoxelVolume randomChunk(const float density, const int materials, const unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> chance(0.f, 1.f);
+    std::uniform_int_distribution<int> material(1, materials);
+
+    VoxelVolume volume;
+    for (int z = 0; z < VoxelVolume::SIZE; ++z) {
+        for (int y = 0; y < VoxelVolume::SIZE; ++y) {
+            for (int x = 0; x < VoxelVolume::SIZE; ++x) {
+                if (chance(rng) >= density) continue;
+
+                VoxelFaceData voxel = uniformVoxel(static_cast<uint16_t>(material(rng)));
+                if (chance(rng) < 0.25f) {
+                    for (auto& face : voxel.faces) face = static_cast<uint16_t>(material(rng));
+                }
+                volume.set(x, y, z, voxel);
+            }
+        }
+    }
+    return volume;
+}
+
+/* chunk `coords` of rolling hills, grass over a few layers of dirt over stone */
+inline VoxelVolume terrainChunk(const glm::ivec3 coords) {
+    VoxelFaceData grass = uniformVoxel(2);
+    grass.posY = 1;
+    grass.negY = 3;
+
+    VoxelVolume volume;
+    for (int z = 0; z < VoxelVolume::SIZE; ++z) {
+        for (int x = 0; x < VoxelVolume::SIZE; ++x) {
+            const float wx = float(coords.x * VoxelVolume::SIZE + x);
+            const float wz = float(coords.z * VoxelVolume::SIZE + z);
+            const int height = 20 + int(std::floor(6.f * std::sin(wx * 0.11f) * std::cos(wz * 0.07f) + 3.f * std::sin((wx + wz) * 0.23f)));
+
+            for (int y = 0; y < VoxelVolume::SIZE; ++y) {
+                const int wy = coords.y * VoxelVolume::SIZE + y;
+                if (wy > height) break;
+                volume.set(x, y, z, wy == height ? grass : uniformVoxel(wy + 3 >= height ? 3 : 4));
+            }
+        }
+    }
+    return volume;
+}
+
+/* extent x 2 x extent chunks of terrain, each with the apron VoxelWorldSystem would mesh it with */
+struct TerrainArea {
+    std::map<std::tuple<int, int, int>, VoxelVolume> volumes;
+    std::vector<glm::ivec3> coords;
+    std::vector<const VoxelVolume*> chunks;
+    std::vector<VoxelMesher::Neighbors> neighbors;
+
+    explicit TerrainArea(const int extent) {
+        for (int z = 0; z < extent; ++z) {
+            for (int y = 0; y < 2; ++y) {
+                for (int x = 0; x < extent; ++x) {
+                    volumes.emplace(std::tuple(x, y, z), terrainChunk({ x, y, z }));
+                }
+            }
+        }
+        for (const auto& [key, volume] : volumes) {
+            const auto [x, y, z] = key;
+            VoxelMesher::Neighbors apron{};
+            for (int f = 0; f < 6; ++f) {
+                glm::ivec3 offset{};
+                offset[f / 2] = f % 2 ? 1 : -1;
+                const auto it = volumes.find({ x + offset.x, y + offset.y, z + offset.z });
+                apron[f] = it != volumes.end() ? &it->second : nullptr;
+            }
+            coords.emplace_back(x, y, z);
+            chunks.push_back(&volume);
+            neighbors.push_back(apron);
+        }
+    }
+};
@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+#include <Minecraft/Voxel/VoxelMesher.h>
+#include "SweepMesher.h"
+#include "TerrainChunks.h"
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <tuple>
+
+namespace {
+    constexpr int SIZE = VoxelMesher::SIZE;
+
+    VoxelFaceData solid(const uint16_t texture) {
+        VoxelFaceData voxel;
+        for (auto& face : voxel.faces) face = texture;
+        return voxel;
+    }
+
+    glm::ivec3 neighborOffset(const Face face) {
+        glm::ivec3 offset{};
+        offset[int(face) / 2] = int(face) % 2 ? 1 : -1;
+        return offset;
+    }
+
+    /* chunks by coordinates, meshed the way VoxelWorldSystem does with its loaded neighbors as the apron */
+    struct ChunkGrid {
+        std::map<std::tuple<int, int, int>, VoxelVolume> volumes;
+
+        VoxelVolume& add(const glm::ivec3 coords) {
+            return volumes[{ coords.x, coords.y, coords.z }];
+        }
+
+        const VoxelVolume* find(const glm::ivec3 coords) const {
+            const auto it = volumes.find({ coords.x, coords.y, coords.z });
+            return it != volumes.end() ? &it->second : nullptr;
+        }
+
+        std::vector<Quad> mesh(const glm::ivec3 coords) const {
+            VoxelMesher::Neighbors neighbors{};
+            for (int f = 0; f < 6; ++f) {
+                neighbors[f] = find(coords + neighborOffset(Face(f)));
+            }
+            return VoxelMesher::greedyMesh(*find(coords), neighbors);
+        }
+    };
+
+    ChunkGrid solidBlock(const int extent) {
+        ChunkGrid grid;
+        for (int z = 0; z < extent; ++z) {
+            for (int y = 0; y < extent; ++y) {
+                for (int x = 0; x < extent; ++x) {
+                    grid.add({ x, y, z }).fill(solid(1));
+                }
+            }
+        }
+        return grid;
+    }
+
+    using QuadKey = std::tuple<int, unsigned, int, int, int, int, int, int>;
+
+    std::vector<QuadKey> sorted(const std::vector<Quad>& quads) {
+        std::vector<QuadKey> keys;
+        for (const Quad& quad : quads) {
+            const glm::ivec3 min(quad.aabb.min());
+            const glm::ivec3 max(quad.aabb.max());
+            keys.emplace_back(int(quad.face), quad.texture, min.x, min.y, min.z, max.x, max.y, max.z);
+        }
+        std::ranges::sort(keys);
+        return keys;
+    }
+
+    /* texture shown by every unit face cell, by face then plane then (u, v); 0 where nothing is drawn */
+    using Coverage = std::array<std::array<unsigned, (SIZE + 1) * SIZE * SIZE>, 6>;
+
+    /* rasterizes both triangles of every quad, a cell covered twice is an overlap */
+    Coverage rasterize(const std::vector<Quad>& quads) {
+        Coverage coverage{};
+        for (const Quad& quad : quads) {
+            const int d = int(quad.face) / 2;
+            const int u = (d + 1) % 3;
+            const int v = (d + 2) % 3;
+            const glm::ivec3 min(quad.aabb.min());
+            const glm::ivec3 max(quad.aabb.max());
+
+            for (int j = min[v]; j < max[v]; ++j) {
+                for (int i = min[u]; i < max[u]; ++i) {
+                    unsigned& cell = coverage[int(quad.face)][(min[d] * SIZE + j) * SIZE + i];
+                    EXPECT_EQ(cell, 0u) << "overlapping quads at face " << int(quad.face) << " plane " << min[d];
+                    cell = quad.texture;
+                }
+            }
+        }
+        return coverage;
+    }
+
+    /* what a voxel by voxel walk says should be drawn, a face hidden only by the facing side of its neighbor */
+    Coverage visibleFaces(const VoxelVolume& volume) {
+        Coverage coverage{};
+        for (int z = 0; z < SIZE; ++z) {
+            for (int y = 0; y < SIZE; ++y) {
+                for (int x = 0; x < SIZE; ++x) {
+                    const glm::ivec3 p(x, y, z);
+                    for (int f = 0; f < 6; ++f) {
+                        const unsigned texture = volume.at(x, y, z, f);
+                        if (!texture) continue;
+
+                        const glm::ivec3 n = p + neighborOffset(Face(f));
+                        if (!VoxelVolume::isOutsideBounds(n.x, n.y, n.z) && volume.at(n.x, n.y, n.z, f ^ 1)) continue;
+
+                        const int d = f / 2;
+                        const int plane = p[d] + f % 2;
+                        coverage[f][(plane * SIZE + p[(d + 2) % 3]) * SIZE + p[(d + 1) % 3]] = texture;
+                    }
+                }
+            }
+        }
+        return coverage;
+    }
+
+    void expectSameMesh(const VoxelVolume& volume) {
+        const auto quads = VoxelMesher::greedyMesh(volume);
+        const auto reference = sweepMesh(volume, glm::ivec3(SIZE));
+
+        EXPECT_EQ(sorted(quads), sorted(reference));
+
+        const Coverage expected = visibleFaces(volume);
+        EXPECT_TRUE(rasterize(quads) == expected);
+        EXPECT_TRUE(rasterize(reference) == expected);
+    }
+
+    /* how many of the chunk's six sides lie on the outside of an extent^3 block */
+    int outerSides(const glm::ivec3 coords, const int extent) {
+        int sides = 0;
+        for (int d = 0; d < 3; ++d) {
+            sides += coords[d] == 0;
+            sides += coords[d] == extent - 1;
+        }
+        return sides;
+    }
+}
+
+TEST(VoxelMesherBorders, SolidBlockOnlyEmitsItsOuterSurface) {
+    const ChunkGrid grid = solidBlock(3);
+
+    size_t total = 0;
+    for (const auto& [key, volume] : grid.volumes) {
+        const glm::ivec3 coords(std::get<0>(key), std::get<1>(key), std::get<2>(key));
+        const auto quads = grid.mesh(coords);
+
+        // a uniform side merges into one full quad, sides shared with a neighbor emit nothing
+        EXPECT_EQ(quads.size(), size_t(outerSides(coords, 3))) << coords;
+        for (const Quad& quad : quads) {
+            const glm::vec3 size = quad.aabb.max() - quad.aabb.min();
+            EXPECT_EQ(size[int(quad.face) / 2], 0.f);
+            EXPECT_EQ(size.x * size.y + size.y * size.z + size.x * size.z, float(SIZE * SIZE));
+        }
+        total += quads.size();
+    }
+    EXPECT_EQ(total, size_t(6 * 3 * 3));
+    EXPECT_TRUE(grid.mesh({ 1, 1, 1 }).empty());
+}
+
+TEST(VoxelMesherBorders, MissingNeighborsReadAsAir) {
+    const ChunkGrid grid = solidBlock(3);
+
+    size_t total = 0;
+    for (const auto& [key, volume] : grid.volumes) {
+        total += VoxelMesher::greedyMesh(volume).size();
+    }
+    EXPECT_EQ(total, size_t(6 * 27));
+}
+
+TEST(VoxelMesherBorders, BorderEditExposesTheNeighborFace) {
+    ChunkGrid grid;
+    grid.add({ 0, 0, 0 }).fill(solid(1));
+    grid.add({ 1, 0, 0 }).fill(solid(2));
+
+    const auto before = grid.mesh({ 1, 0, 0 });
+    EXPECT_EQ(before.size(), 5u);
+
+    grid.add({ 0, 0, 0 }).removeVoxel(SIZE - 1, 5, 7);
+    const auto after = grid.mesh({ 1, 0, 0 });
+    ASSERT_EQ(after.size(), 6u);
+
+    const auto exposed = std::ranges::find_if(after, [](const Quad& quad) { return quad.face == Face::X_NEG; });
+    ASSERT_NE(exposed, after.end());
+    EXPECT_EQ(exposed->aabb.min(), glm::vec3(0, 5, 7));
+    EXPECT_EQ(exposed->aabb.max(), glm::vec3(0, 6, 8));
+    EXPECT_EQ(exposed->texture, 2u);
+
+    // the hole shows five faces of its own chunk, the sixth side is hidden by the neighbor
+    const auto edited = grid.mesh({ 0, 0, 0 });
+    EXPECT_EQ(edited.size(), 5u + 5u);
+    const auto single = std::ranges::count_if(edited, [](const Quad& quad) {
+        const glm::vec3 size = quad.aabb.max() - quad.aabb.min();
+        return size.x + size.y + size.z == 2.f;
+    });
+    EXPECT_EQ(single, 5);
+}
+
+TEST(VoxelMesherReference, RandomChunksMatchTheSweep) {
+    for (unsigned seed = 0; seed < 40; ++seed) {
+        SCOPED_TRACE(seed);
+        const float density = 0.05f + 0.9f * float(seed % 10) / 9.f;
+        expectSameMesh(randomChunk(density, 1 + seed % 5, seed));
+    }
+}
+
+TEST(VoxelMesherReference, TerrainChunksMatchTheSweep) {
+    for (int y = 0; y < 3; ++y) {
+        for (int z = -2; z < 2; ++z) {
+            for (int x = -2; x < 2; ++x) {
+                SCOPED_TRACE(testing::Message() << glm::ivec3(x, y, z));
+                expectSameMesh(terrainChunk({ x, y, z }));
+            }
+        }
+    }
+}
+
+TEST(VoxelMesherReference, UniformAndEmptyChunks) {
+    VoxelVolume empty;
+    EXPECT_TRUE(VoxelMesher::greedyMesh(empty).empty());
+    EXPECT_TRUE(sweepMesh(empty, glm::ivec3(SIZE)).empty());
+
+    VoxelVolume full;
+    full.fill(solid(7));
+    expectSameMesh(full);
+    EXPECT_EQ(VoxelMesher::greedyMesh(full).size(), 6u);
+}
@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include <Minecraft/Voxel/Voxel.h>
+
+#include <array>
+#include <random>
+
+namespace {
+    constexpr int SIZE = VoxelVolume::SIZE;
+    constexpr int VOLUME = VoxelVolume::VOLUME;
+
+    VoxelFaceData solid(const uint16_t texture) {
+        VoxelFaceData voxel;
+        for (auto& face : voxel.faces) face = texture;
+        return voxel;
+    }
+
+    /* the layout VoxelVolume replaced, one full VoxelFaceData per voxel */
+    struct DenseVolume {
+        std::array<VoxelFaceData, VOLUME> voxels{};
+
+        VoxelFaceData& at(const int x, const int y, const int z) {
+            return voxels[VoxelVolume::index(x, y, z)];
+        }
+    };
+
+    /* applies the same random edits to both volumes, drawing from `materials` textures plus air */
+    void randomEdits(VoxelVolume& volume, DenseVolume& dense, const int edits, const int materials, const unsigned seed) {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> coord(0, SIZE - 1);
+        std::uniform_int_distribution<int> material(0, materials);
+        for (int e = 0; e < edits; ++e) {
+            const int x = coord(rng), y = coord(rng), z = coord(rng);
+            const VoxelFaceData voxel = solid(static_cast<uint16_t>(material(rng)));
+            volume.set(x, y, z, voxel);
+            dense.at(x, y, z) = voxel;
+        }
+    }
+
+    void expectSame(const VoxelVolume& volume, DenseVolume& dense) {
+        for (int z = 0; z < SIZE; ++z) {
+            for (int y = 0; y < SIZE; ++y) {
+                for (int x = 0; x < SIZE; ++x) {
+                    ASSERT_EQ(volume.at(x, y, z), dense.at(x, y, z)) << x << ' ' << y << ' ' << z;
+                }
+            }
+        }
+    }
+}
+
+TEST(VoxelVolume, EditsMatchADenseVolume) {
+    for (const int materials : { 1, 3, 12, 200, 600 }) {
+        VoxelVolume volume;
+        DenseVolume dense;
+        randomEdits(volume, dense, 20000, materials, materials);
+        expectSame(volume, dense);
+
+        volume.compact();
+        expectSame(volume, dense);
+    }
+}
+
+TEST(VoxelVolume, IndexWidthFollowsThePalette) {
+    VoxelVolume volume;
+    EXPECT_TRUE(volume.isEmpty());
+    EXPECT_EQ(volume.getIndexBits(), 0);
+
+    volume.set(1, 2, 3, solid(1));
+    EXPECT_EQ(volume.getIndexBits(), 1);
+    volume.set(4, 5, 6, solid(2));
+    EXPECT_EQ(volume.getIndexBits(), 2);
+    for (uint16_t t = 3; t < 20; ++t) volume.set(t % SIZE, 0, 0, solid(t));
+    EXPECT_EQ(volume.getIndexBits(), 8);
+
+    // overwritten materials stay in the palette until compact()
+    for (int x = 0; x < SIZE; ++x) volume.removeVoxel(x, 0, 0);
+    volume.compact();
+    EXPECT_EQ(volume.getPalette().size(), 3u);
+    EXPECT_EQ(volume.getIndexBits(), 2);
+
+    volume.removeVoxel(1, 2, 3);
+    volume.removeVoxel(4, 5, 6);
+    EXPECT_TRUE(volume.isUniform());
+    EXPECT_TRUE(volume.isEmpty());
+}
+
+TEST(VoxelVolume, FillingEveryVoxelCollapsesToUniform) {
+    VoxelVolume volume;
+    for (int i = 0; i < VOLUME; ++i) {
+        volume.set(i % SIZE, i / SIZE % SIZE, i / (SIZE * SIZE), solid(7));
+    }
+    EXPECT_TRUE(volume.isUniform());
+    EXPECT_EQ(volume.at(3, 3, 3), solid(7));
+}
+
+TEST(VoxelVolume, RLERoundTrip) {
+    for (const int materials : { 0, 1, 3, 40, 600 }) {
+        VoxelVolume volume;
+        DenseVolume dense;
+        randomEdits(volume, dense, materials ? 5000 : 0, materials, 17 + materials);
+
+        const std::vector<uint8_t> encoded = volume.encodeRLE();
+        const auto decoded = VoxelVolume::decodeRLE(encoded);
+        ASSERT_TRUE(decoded.has_value()) << materials;
+        expectSame(*decoded, dense);
+
+        // decoding yields the compacted form, so encoding it again is byte identical
+        EXPECT_EQ(decoded->encodeRLE(), encoded);
+    }
+}
+
+TEST(VoxelVolume, RLEEncodesLayeredTerrainCompactly) {
+    VoxelVolume volume;
+    for (int z = 0; z < SIZE; ++z) {
+        for (int y = 0; y < 6; ++y) {
+            for (int x = 0; x < SIZE; ++x) {
+                volume.set(x, y, z, solid(y < 5 ? 1 : 2));
+            }
+        }
+    }
+
+    // index order is x, y, z, so every z slice is three runs: stone, grass, air
+    const std::vector<uint8_t> encoded = volume.encodeRLE();
+    const size_t header = sizeof(uint16_t) + 3 * sizeof(VoxelFaceData);
+    EXPECT_EQ(encoded.size(), header + SIZE * 3 * 2 * sizeof(uint16_t));
+
+    VoxelVolume uniform;
+    uniform.fill(solid(4));
+    EXPECT_EQ(uniform.encodeRLE().size(), sizeof(uint16_t) + sizeof(VoxelFaceData) + 2 * sizeof(uint16_t));
+}
+
+TEST(VoxelVolume, DecodeRejectsMalformedInput) {
+    VoxelVolume volume;
+    volume.set(0, 0, 0, solid(1));
+    const std::vector<uint8_t> encoded = volume.encodeRLE();
+
+    for (size_t size = 0; size < encoded.size(); ++size) {
+        const auto decoded = VoxelVolume::decodeRLE(std::span(encoded.data(), size));
+        ASSERT_FALSE(decoded.has_value()) << size;
+        EXPECT_EQ(decoded.error(), VoxelDecodeError::TRUNCATED);
+    }
+
+    std::vector<uint8_t> noPalette = encoded;
+    noPalette[0] = noPalette[1] = 0;
+    EXPECT_EQ(VoxelVolume::decodeRLE(noPalette).error(), VoxelDecodeError::BAD_PALETTE);
+
+    // the first run points at palette entry 2 of 2
+    const size_t firstRun = sizeof(uint16_t) + 2 * sizeof(VoxelFaceData);
+    std::vector<uint8_t> badIndex = encoded;
+    const uint16_t outOfRange = 2;
+    memcpy(badIndex.data() + firstRun + sizeof(uint16_t), &outOfRange, sizeof(outOfRange));
+    EXPECT_EQ(VoxelVolume::decodeRLE(badIndex).error(), VoxelDecodeError::BAD_PALETTE);
+
+    std::vector<uint8_t> overlong = encoded;
+    const uint16_t tooLong = VOLUME + 1;
+    memcpy(overlong.data() + firstRun, &tooLong, sizeof(tooLong));
+    EXPECT_EQ(VoxelVolume::decodeRLE(overlong).error(), VoxelDecodeError::BAD_RUN);
+}
+
+TEST(VoxelVolume, MemoryFootprintBeatsDenseStorage) {
+    constexpr size_t dense = sizeof(DenseVolume);
+
+    VoxelVolume empty;
+    EXPECT_LT(empty.memoryFootprint(), size_t(256));
+
+    // two materials pack 64 voxels per word
+    VoxelVolume twoMaterials;
+    for (int z = 0; z < SIZE; ++z) {
+        for (int x = 0; x < SIZE; ++x) {
+            twoMaterials.set(x, 0, z, solid(1));
+        }
+    }
+    EXPECT_EQ(twoMaterials.getIndexBits(), 1);
+    EXPECT_LE(twoMaterials.memoryFootprint(), sizeof(VoxelVolume) + VOLUME / 8 + 256);
+
+    // 16-bit indices are the worst case and still a fraction of the dense layout
+    VoxelVolume noisy;
+    DenseVolume reference;
+    randomEdits(noisy, reference, 20000, 1000, 3);
+    noisy.compact();
+    EXPECT_EQ(noisy.getIndexBits(), 16);
+    EXPECT_LT(noisy.memoryFootprint(), dense);
+
+    std::cout << "dense " << dense << " B, empty " << empty.memoryFootprint()
+              << " B, two materials " << twoMaterials.memoryFootprint()
+              << " B, 1000 materials " << noisy.memoryFootprint() << " B\n";
+}
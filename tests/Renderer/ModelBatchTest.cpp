@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include <Renderer/ModelBatch.h>
+#include <Renderer/RenderDevice.h>
+#include "Core/Model/SyntheticModel.h"
+#include "Core/Model/SyntheticSkeleton.h"
+
+#include <memory>
+#include <set>
+
+namespace {
+    const ModelBatch::DefaultTextures DEFAULTS{ 1, 2, 3, 4 };
+
+    unsigned noTexture(Texture2DKey) {
+        return 0;
+    }
+
+    /* every texture key resolves to its own id, as if loaded */
+    unsigned loadedTexture(const Texture2DKey key) {
+        return 100 + key.index();
+    }
+
+    std::vector<glm::mat4> nodeMatrices(const ModelDefinition& definition) {
+        std::vector<glm::mat4> matrices;
+        for (const MeshNode& node : definition.nodes) matrices.push_back(node.finalTransform);
+        return matrices;
+    }
+
+    std::vector<Transform> bindLocals(const SyntheticSkeleton& rig) {
+        std::vector<Transform> locals;
+        for (const BoneNode& node : rig.nodes) locals.push_back(node.localTransform);
+        return locals;
+    }
+
+    void expectPalette(std::span<const glm::mat4> actual, const std::vector<glm::mat4>& expected) {
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t bone = 0; bone < expected.size(); ++bone) {
+            for (int c = 0; c < 4; ++c) {
+                for (int r = 0; r < 4; ++r) {
+                    ASSERT_NEAR(actual[bone][c][r], expected[bone][c][r], 1e-4f) << "bone " << bone;
+                }
+            }
+        }
+    }
+}
+
+TEST(ModelBatch, PalettesFollowTheSkeletonsEveryFrame) {
+    ModelDefinitionBuilder builder = makeSyntheticModel(6, 4, 1);
+    const ModelDefinition definition("zombie", builder);
+    const std::vector<glm::mat4> matrices = nodeMatrices(definition);
+
+    const SyntheticSkeleton rig = makeZombieSkeleton(2);
+    const SkeletonAsset asset = rig.asset();
+    Skeleton first(&asset), second(&asset);
+    std::vector<Transform> firstLocals = bindLocals(rig), secondLocals = bindLocals(rig);
+
+    ModelBatch batch;
+    for (int frame = 0; frame < 3; ++frame) {
+        // a pose change between frames must show up in the next palette, not the one after
+        firstLocals[frame].rotation = glm::normalize(glm::quat(1.f, 0.3f * frame, 0.1f, 0.f));
+        first.setBoneTransform(frame, firstLocals[frame]);
+
+        batch.add(definition, matrices, &first);
+        batch.add(definition, matrices);
+        batch.add(definition, matrices, &second);
+
+        RenderPassContext ctx;
+        batch.build(ctx, noTexture, DEFAULTS);
+
+        const auto palettes = batch.getPalettes();
+        ASSERT_EQ(palettes.size(), 2u * rig.boneCount);
+        expectPalette(palettes.first(rig.boneCount), recursivePalette(rig, firstLocals));
+        expectPalette(palettes.subspan(rig.boneCount), recursivePalette(rig, secondLocals));
+
+        // every draw of an instance points at its own palette, or none
+        const auto instances = batch.getInstanceData();
+        ASSERT_EQ(instances.size(), 3 * definition.nodes.size());
+        for (const Renderable& renderable : ctx.instances) {
+            ASSERT_EQ(renderable.cmd.instanceCount, 3u);
+            const auto* instance = &instances[renderable.cmd.baseInstance];
+            EXPECT_EQ(instance[0].palette, 0u);
+            EXPECT_EQ(instance[1].palette, ModelBatch::NO_PALETTE);
+            EXPECT_EQ(instance[2].palette, static_cast<uint32_t>(rig.boneCount));
+        }
+        batch.clear();
+        EXPECT_TRUE(batch.getPalettes().empty());
+    }
+}
+
+TEST(ModelBatch, ThousandsOfInstancesRecordTheCallsOfOne) {
+    constexpr size_t INSTANCES = 1000;
+    const SyntheticSkeleton rig = makeZombieSkeleton(3);
+    const SkeletonAsset asset = rig.asset();
+
+    // three models of different sizes and their own textures, the last one skinned
+    std::vector<ModelDefinitionBuilder> builders;
+    builders.push_back(makeSyntheticModel(4, 4, 1));
+    builders.push_back(makeSyntheticModel(7, 5, 2));
+    builders.push_back(makeSyntheticModel(12, 3, 3));
+    std::vector<std::unique_ptr<ModelDefinition>> definitions;
+    for (size_t m = 0; m < builders.size(); ++m) {
+        definitions.push_back(std::make_unique<ModelDefinition>("model_" + std::to_string(m), builders[m]));
+        for (uint32_t t = 0; t < 4; ++t) definitions.back()->textures.push_back(Texture2DKey(static_cast<uint32_t>(4 * m) + t, 0));
+    }
+    std::vector<std::vector<glm::mat4>> matrices;
+    for (const auto& definition : definitions) matrices.push_back(nodeMatrices(*definition));
+
+    std::vector<Skeleton> skeletons;
+    for (size_t i = 0; i < INSTANCES; ++i) skeletons.emplace_back(&asset);
+
+    struct Frame {
+        RenderPassContext ctx;
+        RecordingRenderDevice device;
+        /* the first matrix of every instance, by model and then in the order added */
+        std::vector<std::vector<uint32_t>> firstMatrices;
+    };
+    const auto record = [&](ModelBatch& batch, const size_t instances, Frame& frame) {
+        frame.firstMatrices.assign(definitions.size(), {});
+        uint32_t next = 0;
+        // interleaved, as entities come out of the query
+        for (size_t i = 0; i < instances; ++i) {
+            for (size_t m = 0; m < definitions.size(); ++m) {
+                frame.firstMatrices[m].push_back(next);
+                next += static_cast<uint32_t>(matrices[m].size());
+                batch.add(*definitions[m], matrices[m], m == 2 ? &skeletons[i] : nullptr);
+            }
+        }
+        frame.ctx.shader = "MeshShader";
+        batch.build(frame.ctx, loadedTexture, DEFAULTS);
+
+        RenderQueue queue;
+        queue.add(frame.ctx);
+        queue.submit(frame.device);
+    };
+
+    ModelBatch batch;
+    Frame one;
+    record(batch, 1, one);
+    batch.clear();
+    Frame many;
+    record(batch, INSTANCES, many);
+
+    // one command per mesh whatever the instance count, and the same state changes and draws as for a single instance
+    const size_t meshes = 4 + 7 + 12;
+    ASSERT_EQ(many.ctx.instances.size(), meshes);
+    ASSERT_EQ(many.device.commands.size(), meshes);
+    ASSERT_EQ(many.device.calls.size(), one.device.calls.size());
+    for (size_t c = 0; c < many.device.calls.size(); ++c) {
+        EXPECT_EQ(many.device.calls[c].type, one.device.calls[c].type) << c;
+    }
+    std::set<std::pair<unsigned, size_t>> states;
+    for (const Renderable& renderable : many.ctx.instances) states.emplace(renderable.VAO, renderable.materials.hash());
+    EXPECT_EQ(many.device.count(RecordingRenderDevice::CallType::MULTI_DRAW_INDIRECT), states.size());
+    EXPECT_LT(states.size(), meshes);
+
+    // every instance of every command reads its own node matrix and, when skinned, its own palette
+    const auto instances = batch.getInstanceData();
+    ASSERT_EQ(instances.size(), INSTANCES * meshes);
+    ASSERT_EQ(batch.getMatrices().size(), INSTANCES * meshes);
+    ASSERT_EQ(batch.getPalettes().size(), INSTANCES * rig.boneCount);
+    uint32_t drawn = 0;
+    for (const DrawElementsIndirectCommand& command : many.device.commands) {
+        ASSERT_EQ(command.instanceCount, INSTANCES);
+        drawn += command.instanceCount;
+
+        // the first instances of the models were added one after another, so the first matrix tells the model apart
+        const uint32_t firstMatrix = instances[command.baseInstance].matrix;
+        size_t model = 0;
+        while (model + 1 < definitions.size() && firstMatrix >= many.firstMatrices[model + 1][0]) ++model;
+        const uint32_t node = firstMatrix - many.firstMatrices[model][0];
+        ASSERT_LT(node, matrices[model].size());
+
+        for (uint32_t i = 0; i < INSTANCES; ++i) {
+            const ModelBatch::InstanceData& instance = instances[command.baseInstance + i];
+            ASSERT_EQ(instance.matrix, many.firstMatrices[model][i] + node) << "model " << model << " instance " << i;
+            ASSERT_EQ(batch.getMatrices()[instance.matrix], matrices[model][node]);
+            ASSERT_EQ(instance.palette, model == 2 ? i * static_cast<uint32_t>(rig.boneCount) : ModelBatch::NO_PALETTE);
+        }
+    }
+    EXPECT_EQ(drawn, INSTANCES * meshes);
+}
@@ -0,0 +1,250 @@
+#include <gtest/gtest.h>
+#include <Renderer/RenderDevice.h>
+#include <Renderer/RenderQueue.h>
+
+#include <limits>
+#include <random>
+
+namespace {
+    using CallType = RecordingRenderDevice::CallType;
+
+    MaterialHandle material(const unsigned texture) {
+        MaterialHandle handle;
+        handle.materials.push_back({ "diffuse", texture, MaterialHandle::Material::Type::TEXTURE_2D });
+        return handle;
+    }
+
+    /* baseInstance carries an id, so the recorded commands can be traced back to their renderables */
+    Renderable renderable(const unsigned VAO, const unsigned texture, const float depth, const unsigned id) {
+        return { VAO, material(texture), { 6, 1, 0, 0, id }, depth };
+    }
+
+    RenderPassContext context(const std::string& shader, const uint8_t pass) {
+        RenderPassContext ctx;
+        ctx.shader = shader;
+        ctx.pass = pass;
+        ctx.buffers.push_back({ BufferHandleTarget::SSBO, 10u + pass, 1 });
+        return ctx;
+    }
+
+    /* queues random renderables over a few passes, shaders, VAOs and materials */
+    std::vector<RenderPassContext> randomScene(const unsigned seed, const size_t perContext) {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<unsigned> vao(1, 4), texture(1, 5);
+        std::uniform_real_distribution<float> depth(0.f, 1024.f);
+
+        std::vector<RenderPassContext> contexts;
+        contexts.push_back(context("mesh", 1));
+        contexts.push_back(context("voxel", 0));
+        contexts.push_back(context("mesh", 0));
+        contexts.push_back(context("particle", 2));
+
+        unsigned id = 0;
+        for (auto& ctx : contexts) {
+            for (size_t i = 0; i < perContext; ++i) {
+                ctx.instances.push_back(renderable(vao(rng), texture(rng), depth(rng), id++));
+            }
+        }
+        return contexts;
+    }
+}
+
+TEST(RenderQueue, BatchesAreSortedAndCoverEveryDraw) {
+    RenderQueue queue;
+    const auto contexts = randomScene(1, 200);
+    for (const auto& ctx : contexts) queue.add(ctx);
+    queue.build();
+
+    const auto& batches = queue.getBatches();
+    const auto& commands = queue.getCommands();
+    ASSERT_EQ(commands.size(), queue.size());
+
+    uint32_t next = 0;
+    for (size_t i = 0; i < batches.size(); ++i) {
+        EXPECT_EQ(batches[i].firstCommand, next);
+        EXPECT_GT(batches[i].commandCount, 0u);
+        next += batches[i].commandCount;
+        if (i == 0) continue;
+
+        // a run of draws that share everything above the depth is a single batch
+        const uint64_t previous = batches[i - 1].key >> RenderQueue::MATERIAL_SHIFT;
+        EXPECT_LT(previous, batches[i].key >> RenderQueue::MATERIAL_SHIFT);
+    }
+    EXPECT_EQ(next, commands.size());
+
+    std::vector<bool> seen(commands.size());
+    for (const auto& command : commands) {
+        ASSERT_LT(command.baseInstance, seen.size());
+        EXPECT_FALSE(seen[command.baseInstance]);
+        seen[command.baseInstance] = true;
+    }
+}
+
+TEST(RenderQueue, DrawsWithinABatchAreFrontToBack) {
+    RenderQueue queue;
+    RenderPassContext ctx = context("mesh", 0);
+    const float depths[] = { 900.f, 10.f, 500.f, 10.f, 0.f };
+    for (unsigned i = 0; i < std::size(depths); ++i) {
+        ctx.instances.push_back(renderable(1, 1, depths[i], i));
+    }
+    queue.add(ctx);
+    queue.build();
+
+    ASSERT_EQ(queue.getBatches().size(), 1u);
+    std::vector<unsigned> order;
+    for (const auto& command : queue.getCommands()) order.push_back(command.baseInstance);
+    // equal depths keep submission order
+    EXPECT_EQ(order, (std::vector<unsigned>{ 4, 1, 3, 2, 0 }));
+}
+
+TEST(RenderQueue, SubmitOnlyChangesStateBetweenBatches) {
+    RenderQueue queue;
+    const auto contexts = randomScene(2, 300);
+    for (const auto& ctx : contexts) queue.add(ctx);
+
+    RecordingRenderDevice device;
+    queue.submit(device);
+
+    ASSERT_FALSE(device.calls.empty());
+    EXPECT_EQ(device.calls.front().type, CallType::UPLOAD_COMMANDS);
+    EXPECT_EQ(device.count(CallType::UPLOAD_COMMANDS), 1u);
+    EXPECT_EQ(device.commands.size(), queue.size());
+    EXPECT_EQ(device.count(CallType::MULTI_DRAW_INDIRECT), queue.getBatches().size());
+
+    // replays the recorded state and checks every draw against the batch it should come from
+    std::string shader;
+    unsigned vao = 0, boundMaterial = 0;
+    uint32_t lastPass = 0;
+    size_t batch = 0, shaderSwitches = 0, vaoSwitches = 0;
+    const auto& batches = queue.getBatches();
+
+    for (size_t i = 1; i < device.calls.size(); ++i) {
+        const auto& call = device.calls[i];
+        switch (call.type) {
+            case CallType::USE_SHADER:
+                // a shader is only set when it changes
+                EXPECT_NE(device.shaders[call.first], shader);
+                shader = device.shaders[call.first];
+                ++shaderSwitches;
+                break;
+            case CallType::BIND_VERTEX_ARRAY:
+                EXPECT_NE(call.first, vao);
+                vao = call.first;
+                ++vaoSwitches;
+                break;
+            case CallType::BIND_MATERIALS:
+                boundMaterial = call.first;
+                break;
+            case CallType::MULTI_DRAW_INDIRECT: {
+                ASSERT_LT(batch, batches.size());
+                EXPECT_EQ(call.first, batches[batch].firstCommand);
+                EXPECT_EQ(call.second, batches[batch].commandCount);
+
+                const uint32_t pass = RenderQueue::field(batches[batch].key, RenderQueue::PASS_SHIFT, RenderQueue::PASS_BITS);
+                EXPECT_GE(pass, lastPass);
+                lastPass = pass;
+
+                for (uint32_t c = call.first; c < call.first + call.second; ++c) {
+                    const unsigned id = device.commands[c].baseInstance;
+                    const auto& ctx = contexts[id / 300];
+                    const Renderable& drawn = ctx.instances[id % 300];
+                    EXPECT_EQ(ctx.shader, shader);
+                    EXPECT_EQ(ctx.pass, pass);
+                    EXPECT_EQ(drawn.VAO, vao);
+                    EXPECT_EQ(static_cast<uint32_t>(drawn.materials.hash()), boundMaterial);
+                }
+                ++batch;
+                break;
+            }
+            default: break;
+        }
+    }
+    EXPECT_EQ(batch, batches.size());
+
+    // every VAO change is a new batch, but not every batch changes the VAO
+    EXPECT_LE(vaoSwitches, batches.size());
+    EXPECT_LE(shaderSwitches, contexts.size());
+}
+
+TEST(RenderQueue, ContextsSharingAShaderDoNotRebindIt) {
+    RenderQueue queue;
+    RenderPassContext first = context("mesh", 0), second = context("mesh", 0);
+    first.instances.push_back(renderable(1, 1, 0.f, 0));
+    second.instances.push_back(renderable(1, 1, 0.f, 1));
+    queue.add(first);
+    queue.add(second);
+
+    RecordingRenderDevice device;
+    queue.submit(device);
+
+    EXPECT_EQ(device.count(CallType::USE_SHADER), 1u);
+    // the uniforms and buffers belong to the context, so both are set again
+    EXPECT_EQ(device.count(CallType::UPLOAD_UNIFORMS), 2u);
+    EXPECT_EQ(device.count(CallType::BIND_BUFFER), 2u);
+    // same VAO and material, the second context's draw keeps the VAO but rebinds the material after its own
+    EXPECT_EQ(device.count(CallType::BIND_VERTEX_ARRAY), 1u);
+    EXPECT_EQ(device.count(CallType::MULTI_DRAW_INDIRECT), 2u);
+}
+
+TEST(RenderQueue, ClearDropsEverything) {
+    RenderQueue queue;
+    for (const auto& ctx : randomScene(3, 10)) queue.add(ctx);
+    queue.clear();
+
+    RecordingRenderDevice device;
+    queue.submit(device);
+    EXPECT_TRUE(device.calls.empty());
+    EXPECT_EQ(queue.size(), 0u);
+}
+
+TEST(RenderQueue, FieldsThatDoNotFitAreRejected) {
+    const uint32_t pass = (1u << RenderQueue::PASS_BITS) - 1, context = (1u << RenderQueue::CONTEXT_BITS) - 1;
+    const uint32_t vao = (1u << RenderQueue::VAO_BITS) - 1, material = (1u << RenderQueue::MATERIAL_BITS) - 1;
+    const uint32_t depth = (1u << RenderQueue::DEPTH_BITS) - 1;
+
+    EXPECT_EQ(RenderQueue::encode(pass, context, vao, material, depth), ~uint64_t(0));
+    EXPECT_FALSE(RenderQueue::encode(pass + 1, 0, 0, 0, 0));
+    EXPECT_FALSE(RenderQueue::encode(0, context + 1, 0, 0, 0));
+    EXPECT_FALSE(RenderQueue::encode(0, 0, vao + 1, 0, 0));
+    EXPECT_FALSE(RenderQueue::encode(0, 0, 0, material + 1, 0));
+    EXPECT_FALSE(RenderQueue::encode(0, 0, 0, 0, depth + 1));
+}
+
+TEST(RenderQueue, DrawsPastTheKeyAreDroppedOrClamped) {
+    RenderQueue queue;
+    constexpr uint32_t CONTEXTS = 1u << RenderQueue::CONTEXT_BITS;
+    for (uint32_t c = 0; c <= CONTEXTS; ++c) {
+        RenderPassContext ctx = context("mesh", 0);
+        ctx.instances.push_back(renderable(1, 1, 0.f, c));
+        queue.add(ctx);
+    }
+    EXPECT_EQ(queue.size(), CONTEXTS);
+    EXPECT_EQ(queue.getDropped(), 1u);
+
+    // one more VAO than the field holds, in a context of its own
+    RenderQueue vaos;
+    RenderPassContext wide = context("mesh", 0);
+    for (unsigned v = 0; v <= 1u << RenderQueue::VAO_BITS; ++v) {
+        wide.instances.push_back(renderable(v + 1, 1, 0.f, v));
+    }
+    vaos.add(wide);
+    EXPECT_EQ(vaos.size(), size_t(1) << RenderQueue::VAO_BITS);
+    EXPECT_EQ(vaos.getDropped(), 1u);
+
+    // a pass past the last and depths outside [0, maxDepth] still draw, clamped into their fields
+    RenderQueue clamped;
+    RenderPassContext late = context("overlay", 200);
+    late.instances.push_back(renderable(1, 1, std::numeric_limits<float>::quiet_NaN(), 0));
+    late.instances.push_back(renderable(1, 1, -5.f, 1));
+    late.instances.push_back(renderable(1, 1, 1e30f, 2));
+    clamped.add(late);
+    clamped.build();
+    ASSERT_EQ(clamped.getBatches().size(), 1u);
+    EXPECT_EQ(clamped.getDropped(), 0u);
+    const uint64_t key = clamped.getBatches().front().key;
+    EXPECT_EQ(RenderQueue::field(key, RenderQueue::PASS_SHIFT, RenderQueue::PASS_BITS), (1u << RenderQueue::PASS_BITS) - 1);
+    EXPECT_EQ(clamped.getCommands().back().baseInstance, 2u);
+
+    clamped.clear();
+    EXPECT_EQ(clamped.getDropped(), 0u);
+}
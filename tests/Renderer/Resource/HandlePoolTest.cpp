@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <Renderer/Resource/HandlePool.h>
+
+#include <memory>
+#include <string>
+
+namespace {
+    using Key = Handle<struct TestTag>;
+    using Pool = HandlePool<TestTag, std::string>;
+}
+
+TEST(HandlePool, ReleasedSlotsAreReusedWithTheNextGeneration) {
+    Pool pool;
+    const Key a = pool.insert("a");
+    const Key b = pool.insert("b");
+    EXPECT_EQ(a.index(), 0u);
+    EXPECT_EQ(b.index(), 1u);
+    EXPECT_EQ(a.generation(), 0u);
+    EXPECT_EQ(pool.size(), 2u);
+
+    pool.release(a);
+    EXPECT_FALSE(pool.contains(a));
+    EXPECT_TRUE(pool.contains(b));
+    EXPECT_EQ(pool.size(), 1u);
+
+    const Key c = pool.insert("c");
+    EXPECT_EQ(c.index(), a.index());
+    EXPECT_EQ(c.generation(), 1u);
+    EXPECT_NE(c, a);
+    EXPECT_FALSE(pool.contains(a));
+    EXPECT_EQ(pool[c], "c");
+    EXPECT_EQ(pool[b], "b");
+
+    // releasing a stale handle leaves the slot's new resource alone
+    pool.release(a);
+    EXPECT_TRUE(pool.contains(c));
+    EXPECT_EQ(pool.size(), 2u);
+}
+
+TEST(HandlePool, InvalidAndForeignHandlesAreNotContained) {
+    Pool pool;
+    const Key a = pool.insert("a");
+    EXPECT_FALSE(pool.contains(Key{}));
+    EXPECT_FALSE(Key{}.isValid());
+    EXPECT_FALSE(pool.contains(Key(1, 0)));
+    EXPECT_FALSE(pool.contains(Key(a.index(), a.generation() + 1)));
+    EXPECT_EQ(Key(Key::INDEX_MASK + 1, 0).index(), 0u);
+}
+
+TEST(HandlePool, GenerationsWrapAfter256Releases) {
+    Pool pool;
+    const Key first = pool.insert("0");
+    Key current = first;
+    for (uint32_t i = 1; i <= Key::GENERATION_MASK; ++i) {
+        pool.release(current);
+        current = pool.insert(std::to_string(i));
+        ASSERT_EQ(current.index(), first.index());
+        ASSERT_EQ(current.generation(), i);
+        ASSERT_FALSE(pool.contains(first)) << i;
+    }
+
+    // eight bits of generation: the 256th reuse aliases the first handle again, which is the price of 24 index bits
+    pool.release(current);
+    const Key wrapped = pool.insert("256");
+    EXPECT_EQ(wrapped.generation(), 0u);
+    EXPECT_EQ(wrapped, first);
+    EXPECT_FALSE(pool.contains(current));
+}
+
+TEST(HandlePool, NamesReloadInPlaceAndLeaveWithTheResource) {
+    Pool pool;
+    const Key shader = pool.insert("mesh", "v1");
+    EXPECT_EQ(pool.find("mesh"), shader);
+    EXPECT_FALSE(pool.find("missing").isValid());
+
+    // registering the name again keeps every handle to it valid
+    const Key reloaded = pool.insert("mesh", "v2");
+    EXPECT_EQ(reloaded, shader);
+    EXPECT_EQ(pool[shader], "v2");
+    EXPECT_EQ(pool.size(), 1u);
+
+    const Key alias = pool.insert("other", "o");
+    pool.release(shader);
+    EXPECT_FALSE(pool.find("mesh").isValid());
+    EXPECT_EQ(pool.find("other"), alias);
+
+    // the name is free for a new resource, which gets a new handle
+    const Key fresh = pool.insert("mesh", "v3");
+    EXPECT_NE(fresh, shader);
+    EXPECT_EQ(pool.find("mesh"), fresh);
+    EXPECT_EQ(pool[fresh], "v3");
+}
+
+TEST(HandlePool, ReleaseDestroysTheResource) {
+    HandlePool<TestTag, std::shared_ptr<int>> pool;
+    auto value = std::make_shared<int>(1);
+    const Key key = pool.insert(std::shared_ptr(value));
+    EXPECT_EQ(value.use_count(), 2);
+    pool.release(key);
+    EXPECT_EQ(value.use_count(), 1);
+}
+
+TEST(HandlePoolDeathTest, StaleAndInvalidLookupsStopInEveryBuild) {
+    Pool pool;
+    const Key stale = pool.insert("a");
+    pool.release(stale);
+    pool.insert("b");
+
+    EXPECT_DEATH(pool[stale], "stale or invalid handle, slot 0 generation 0");
+    EXPECT_DEATH(pool[Key{}], "stale or invalid handle");
+    const Pool& view = pool;
+    EXPECT_DEATH(view[Key(5, 0)], "stale or invalid handle, slot 5");
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/*
+ * Just enough of a benchmark harness to compare two implementations in one run. A BENCH body times its
+ * variants with bench::measure and prints them with bench::report; idk_bench runs the ones matching its argument.
+ */
+namespace bench {
+    using Clock = std::chrono::steady_clock;
+
+    struct Benchmark {
+        const char* name;
+        void (*run)();
+    };
+
+    std::vector<Benchmark>& registry();
+
+    /* set by --quick, every variant runs once so the benchmarks double as a smoke test */
+    extern bool quick;
+
+    /* set by mismatch, idk_bench then exits non-zero so the smoke test fails */
+    extern bool failed;
+
+    /* where doNotOptimize publishes the addresses it is given */
+    extern const void* volatile sink;
+
+    struct Registrar {
+        Registrar(const char* name, void (*run)()) {
+            registry().push_back({ name, run });
+        }
+    };
+
+    /* keeps `value` observable so the work producing it is not optimized away */
+    template <typename T>
+    void doNotOptimize(const T& value) {
+        sink = &value;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+
+    /* a variant disagreeing with the one it is compared against, printf-style */
+    template <typename... Args>
+    void mismatch(const char* format, const Args... args) {
+        std::printf("  MISMATCH: ");
+        std::printf(format, args...);
+        std::printf("\n");
+        failed = true;
+    }
+
+    /* mean nanoseconds per call of `body`, repeating it until it has run for at least minTime */
+    template <typename Body>
+    double measure(Body&& body, const std::chrono::milliseconds minTime = std::chrono::milliseconds(300)) {
+        body();
+        if (quick) return 0.0;
+
+        uint64_t runs = 0;
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration::zero();
+        while (elapsed < minTime) {
+            body();
+            ++runs;
+            elapsed = Clock::now() - start;
+        }
+        return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(runs);
+    }
+
+    /* one line per variant; `items` > 0 adds the time per item */
+    void report(const std::string& variant, double nanoseconds, double items = 0.0);
+}
+
+#define BENCH(name) \
+    static void name(); \
+    static const bench::Registrar name##Registrar(#name, name); \
+    static void name()
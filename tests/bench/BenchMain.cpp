@@ -0,0 +1,45 @@
+#include "Bench.h"
+
+#include <cstdio>
+#include <string_view>
+
+namespace bench {
+    bool quick = false;
+    bool failed = false;
+    const void* volatile sink = nullptr;
+
+    std::vector<Benchmark>& registry() {
+        static std::vector<Benchmark> benchmarks;
+        return benchmarks;
+    }
+
+    void report(const std::string& variant, const double nanoseconds, const double items) {
+        if (quick) return;
+        if (items > 0.0) {
+            std::printf("  %-44s %12.3f us %10.2f ns/item\n", variant.c_str(), nanoseconds / 1000.0, nanoseconds / items);
+        } else {
+            std::printf("  %-44s %12.3f us\n", variant.c_str(), nanoseconds / 1000.0);
+        }
+    }
+}
+
+/* idk_bench [--quick] [filter], runs the benchmarks whose name contains the filter */
+int main(const int argc, char** argv) {
+    std::string_view filter;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--quick") {
+            bench::quick = true;
+        } else {
+            filter = arg;
+        }
+    }
+
+    for (const auto& [name, run] : bench::registry()) {
+        if (std::string_view(name).find(filter) == std::string_view::npos) continue;
+        std::printf("%s\n", name);
+        std::fflush(stdout);
+        run();
+    }
+    return bench::failed ? 1 : 0;
+}
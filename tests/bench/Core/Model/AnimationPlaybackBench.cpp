@@ -0,0 +1,136 @@
+#include "bench/Bench.h"
+
+#include <Core/Model/AnimationClip.h>
+#include <Core/Model/ModelAnimation.h>
+#include <Core/Model/ModelPose.h>
+
+#include <random>
+
+namespace {
+    constexpr size_t TRACKS = 1000;
+    constexpr size_t CHANNELS = 30;
+    constexpr size_t KEYS = 24;
+    constexpr double FRAME = 0.016;
+
+    ModelAnimation makeAnimation() {
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> unit(-1.f, 1.f);
+
+        ModelAnimation animation("bench");
+        for (size_t c = 0; c < CHANNELS; ++c) {
+            const std::string target = "bone_" + std::to_string(c);
+            for (size_t k = 1; k <= KEYS; ++k) {
+                const double time = static_cast<double>(k) * 0.125;
+                animation.addTranslation(target, time, glm::vec3(unit(rng), unit(rng), unit(rng)));
+                animation.addRotation(target, time, glm::normalize(glm::quat(1.f + unit(rng), unit(rng), unit(rng), unit(rng))));
+                animation.addScale(target, time, glm::vec3(1.f + 0.25f * unit(rng)));
+            }
+        }
+        return animation;
+    }
+
+    /* what a track held before clips were shared: its own curves with the start pose keyed in at 0 */
+    struct CopiedTrack {
+        std::vector<AnimationChannel> channels;
+        std::vector<std::array<size_t, AnimationClip::PROPERTY_COUNT>> hints;
+        double currentTime = 0;
+    };
+
+    struct SharedTrack {
+        std::vector<MeshPose> from;
+        std::vector<AnimationClip::Hints> hints;
+        double currentTime = 0;
+    };
+
+    void startCopied(CopiedTrack& track, const ModelAnimation& animation, const MeshPose& from) {
+        track.channels = animation.getChannels();
+        for (AnimationChannel& channel : track.channels) {
+            channel.position.add(from.transform.translation, 0.0);
+            channel.scale.add(from.transform.scale, 0.0);
+            channel.rotation.add(from.transform.rotation, 0.0);
+        }
+        track.hints.assign(track.channels.size(), {});
+        track.currentTime = 0;
+    }
+
+    void startShared(SharedTrack& track, const AnimationClip& clip, const MeshPose& from) {
+        track.from.assign(clip.channelCount(), from);
+        track.hints.assign(clip.channelCount(), {});
+        track.currentTime = 0;
+    }
+
+    /* advances like AnimationPlayer::onUpdate, restarting the track once it has played through */
+    bool advance(double& currentTime, const double duration) {
+        currentTime += FRAME;
+        if (currentTime < duration) return false;
+        currentTime = 0;
+        return true;
+    }
+}
+
+/*
+ * AnimationPlayer is an ECS system, so this drives its per-track loop directly: every frame, every track samples
+ * all channels of the clip and sets the poses on its own ModelPoseStack. Tracks are staggered so they sit at
+ * different keys, and each restarts when it reaches the end, which is when the copying player copied the curves again.
+ */
+BENCH(AnimationPlayback) {
+    const ModelAnimation animation = makeAnimation();
+    const AnimationClip clip(animation);
+    const double duration = animation.getDuration();
+    const MeshPose from = MeshPose::identity();
+    const auto affected = static_cast<MeshAffected>(static_cast<unsigned>(MeshAffected::POSITION)
+        | static_cast<unsigned>(MeshAffected::ROTATION) | static_cast<unsigned>(MeshAffected::SCALE));
+    constexpr PoseID POSE = 1;
+
+    std::vector<ModelPoseStack> stacks(TRACKS);
+    std::vector<CopiedTrack> copied(TRACKS);
+    std::vector<SharedTrack> shared(TRACKS);
+    for (size_t t = 0; t < TRACKS; ++t) {
+        startCopied(copied[t], animation, from);
+        startShared(shared[t], clip, from);
+        copied[t].currentTime = shared[t].currentTime = duration * static_cast<double>(t) / TRACKS;
+    }
+
+    const double copiedFrame = bench::measure([&] {
+        for (size_t t = 0; t < TRACKS; ++t) {
+            CopiedTrack& track = copied[t];
+            for (size_t c = 0; c < track.channels.size(); ++c) {
+                const AnimationChannel& channel = track.channels[c];
+                auto& hints = track.hints[c];
+                MeshPose pose;
+                pose.transform.translation = channel.position.at(track.currentTime, hints[AnimationClip::POSITION]);
+                pose.transform.scale = channel.scale.at(track.currentTime, hints[AnimationClip::SCALE]);
+                pose.transform.rotation = channel.rotation.at(track.currentTime, hints[AnimationClip::ROTATION]);
+                stacks[t].setPose(static_cast<unsigned>(c), POSE, pose, affected, BlendMode::OVERRIDE, 1.f, ModelPart::BONE);
+            }
+            if (advance(track.currentTime, duration)) startCopied(track, animation, from);
+        }
+    });
+
+    const double sharedFrame = bench::measure([&] {
+        for (size_t t = 0; t < TRACKS; ++t) {
+            SharedTrack& track = shared[t];
+            const auto time = static_cast<float>(track.currentTime);
+            for (uint32_t c = 0; c < clip.channelCount(); ++c) {
+                const MeshPose pose = clip.sample(c, time, track.from[c], track.hints[c]);
+                stacks[t].setPose(c, POSE, pose, affected, BlendMode::OVERRIDE, 1.f, ModelPart::BONE);
+            }
+            if (advance(track.currentTime, duration)) startShared(track, clip, from);
+        }
+    });
+
+    // starting all tracks at once, e.g. a crowd entering a level
+    const double copiedStart = bench::measure([&] {
+        for (CopiedTrack& track : copied) startCopied(track, animation, from);
+        bench::doNotOptimize(copied);
+    });
+    const double sharedStart = bench::measure([&] {
+        for (SharedTrack& track : shared) startShared(track, clip, from);
+        bench::doNotOptimize(shared);
+    });
+
+    bench::report("frame, copied curves", copiedFrame, TRACKS);
+    bench::report("frame, shared clip", sharedFrame, TRACKS);
+    bench::report("start, copied curves", copiedStart, TRACKS);
+    bench::report("start, shared clip", sharedStart, TRACKS);
+}
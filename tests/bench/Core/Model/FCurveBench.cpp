@@ -0,0 +1,46 @@
+#include "bench/Bench.h"
+
+#include <Core/Model/FCurve.h>
+
+#include <random>
+
+/*
+ * One curve played back at 60 fps from start to end: the cursor lookup of at(time, hint), a binary search per
+ * frame with at(time), and the single forward pass of sample(). Short curves are typical hand-made animation,
+ * long ones are baked.
+ */
+BENCH(FCurveLookup) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+
+    for (const size_t keys : { size_t(8), size_t(4096) }) {
+        FCurve3 curve;
+        for (size_t k = 0; k < keys; ++k) {
+            curve.add(glm::vec3(unit(rng), unit(rng), unit(rng)), static_cast<double>(k) * 0.1);
+        }
+
+        std::vector<double> frames;
+        for (double t = 0; t < curve.duration(); t += 1.0 / 60.0) frames.push_back(t);
+        std::vector<glm::vec3> out(frames.size());
+
+        const double cursor = bench::measure([&] {
+            size_t hint = 0;
+            for (size_t i = 0; i < frames.size(); ++i) out[i] = curve.at(frames[i], hint);
+            bench::doNotOptimize(out);
+        });
+        const double search = bench::measure([&] {
+            for (size_t i = 0; i < frames.size(); ++i) out[i] = curve.at(frames[i]);
+            bench::doNotOptimize(out);
+        });
+        const double batch = bench::measure([&] {
+            curve.sample(frames, out);
+            bench::doNotOptimize(out);
+        });
+
+        const std::string suffix = ", " + std::to_string(keys) + " keys";
+        const auto samples = static_cast<double>(frames.size());
+        bench::report("at(time, hint)" + suffix, cursor, samples);
+        bench::report("at(time)" + suffix, search, samples);
+        bench::report("sample" + suffix, batch, samples);
+    }
+}
@@ -0,0 +1,47 @@
+#include "bench/Bench.h"
+#include "Core/Model/SyntheticModel.h"
+
+#include <Core/Model/ModelCache.h>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+/*
+ * The Assimp import is not linked here, so the cold load is measured as what the cache adds to it: serializing
+ * and writing the file. Warm loads compare mapping the cache with reading it through a stream first.
+ */
+BENCH(ModelCacheLoad) {
+    namespace fs = std::filesystem;
+    const fs::path directory = fs::temp_directory_path() / ("idk_model_cache_bench_" + std::to_string(std::random_device{}()));
+    fs::create_directories(directory);
+    const std::string path = (directory / "model.gltf.kmdl").string();
+
+    // 100k vertices, about 9 MB, in 100 meshes
+    const ModelDefinitionBuilder model = makeSyntheticModel(100, 1000, 1);
+    const ModelCache::SourceStamp stamp{ 1, 1 };
+    const double vertices = static_cast<double>(model.vertices.size());
+
+    const double cold = bench::measure([&] {
+        bench::doNotOptimize(ModelCache::write(path, model, stamp));
+    });
+    const double mapped = bench::measure([&] {
+        const auto loaded = ModelCache::read(path, stamp);
+        bench::doNotOptimize(loaded);
+    });
+    const double streamed = bench::measure([&] {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        std::vector<std::byte> bytes(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        const auto loaded = ModelCache::deserialize(bytes, stamp);
+        bench::doNotOptimize(loaded);
+    });
+
+    bench::report("cold, serialize and write", cold, vertices);
+    bench::report("warm, mapped", mapped, vertices);
+    bench::report("warm, read into a buffer", streamed, vertices);
+
+    std::error_code error;
+    fs::remove_all(directory, error);
+}
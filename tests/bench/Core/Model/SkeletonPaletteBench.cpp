@@ -0,0 +1,70 @@
+#include "bench/Bench.h"
+#include "Core/Model/SyntheticSkeleton.h"
+
+#include <Core/Model/Skeleton.h>
+
+/*
+ * A frame of 500 animated zombies: every node gets a new local transform, as a playing animation sets every
+ * channel, then all palettes are written to one buffer. Compares the recursive walk the skeleton used before,
+ * the linear pass run instance by instance, and Skeleton::writePalettes across worker threads.
+ */
+BENCH(SkeletonPalettes) {
+    constexpr size_t ZOMBIES = 500;
+    const SyntheticSkeleton rig = makeZombieSkeleton(1);
+    const SkeletonAsset asset = rig.asset();
+    const auto bones = static_cast<uint32_t>(rig.boneCount);
+
+    std::vector<Skeleton> skeletons;
+    std::vector<Skeleton*> pointers;
+    std::vector<uint32_t> offsets;
+    skeletons.reserve(ZOMBIES);
+    for (size_t z = 0; z < ZOMBIES; ++z) {
+        pointers.push_back(&skeletons.emplace_back(&asset));
+        offsets.push_back(static_cast<uint32_t>(z) * bones);
+    }
+    std::vector<glm::mat4> output(ZOMBIES * bones);
+
+    std::vector<Transform> locals;
+    for (const BoneNode& node : rig.nodes) locals.push_back(node.localTransform);
+    float phase = 0.f;
+    const auto animate = [&] {
+        phase += 0.01f;
+        const glm::quat sway = glm::angleAxis(phase, glm::vec3(0, 0, 1));
+        for (size_t id = 0; id < locals.size(); ++id) {
+            locals[id].rotation = rig.nodes[id].localTransform.rotation * sway;
+        }
+    };
+    const auto pose = [&](Skeleton& skeleton) {
+        for (size_t id = 0; id < locals.size(); ++id) {
+            skeleton.setBoneTransform(static_cast<int>(id), locals[id]);
+        }
+    };
+
+    const double recursive = bench::measure([&] {
+        animate();
+        for (size_t z = 0; z < ZOMBIES; ++z) {
+            const std::vector<glm::mat4> palette = recursivePalette(rig, locals);
+            std::copy(palette.begin(), palette.end(), output.begin() + offsets[z]);
+        }
+        bench::doNotOptimize(output);
+    });
+    const double linear = bench::measure([&] {
+        animate();
+        for (size_t z = 0; z < ZOMBIES; ++z) {
+            pose(skeletons[z]);
+            skeletons[z].writeDirtyBones(output.data() + offsets[z]);
+        }
+        bench::doNotOptimize(output);
+    });
+    const double batched = bench::measure([&] {
+        animate();
+        for (Skeleton& skeleton : skeletons) pose(skeleton);
+        Skeleton::writePalettes(pointers, offsets, output.data());
+        bench::doNotOptimize(output);
+    });
+
+    const double matrices = static_cast<double>(ZOMBIES * bones);
+    bench::report("recursive, per instance", recursive, matrices);
+    bench::report("linear, per instance", linear, matrices);
+    bench::report("linear, writePalettes batch", batched, matrices);
+}
@@ -0,0 +1,71 @@
+#include "bench/Bench.h"
+
+#include <Core/World/TerrainRegion.h>
+
+#include <cstdio>
+#include <random>
+#include <string>
+
+namespace {
+    using Region = TerrainRegion<uint32_t>;
+
+    AABB randomBox(std::mt19937& rng) {
+        std::uniform_real_distribution<float> position(0.f, 64.f);
+        std::uniform_real_distribution<float> size(0.05f, 0.4f);
+        return AABB(glm::vec3(position(rng), position(rng), position(rng)), glm::vec3(size(rng)));
+    }
+}
+
+/* a fixed number of movers per tick; refits touch only their paths, so the tick should grow with log n, not n */
+BENCH(TerrainRegionMovingEntities) {
+    constexpr size_t MOVERS = 64;
+
+    for (const size_t count : { 1'000u, 10'000u, 100'000u }) {
+        std::mt19937 rng(1);
+        std::vector<AABB> bounds;
+        Region region;
+        for (uint32_t e = 0; e < count; ++e) {
+            bounds.push_back(randomBox(rng));
+            region.updateEntity(e, bounds.back());
+        }
+        region.update();
+
+        std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(count - 1));
+        std::uniform_real_distribution<float> step(-0.05f, 0.05f);
+        const uint64_t rebuildsBefore = region.rebuilds;
+        uint64_t ticks = 0;
+        const double time = bench::measure([&] {
+            for (size_t m = 0; m < MOVERS; ++m) {
+                const uint32_t e = pick(rng);
+                bounds[e].center += glm::vec3(step(rng), step(rng), step(rng));
+                region.updateEntity(e, bounds[e]);
+            }
+            region.update();
+            ++ticks;
+        });
+
+        char label[96];
+        std::snprintf(label, sizeof(label), "%zu entities, %zu moving, %llu rebuilds in %llu ticks", count, MOVERS,
+            static_cast<unsigned long long>(region.rebuilds - rebuildsBefore), static_cast<unsigned long long>(ticks));
+        bench::report(label, time, double(MOVERS));
+    }
+}
+
+/* one entity at a time into the stash, then a single update; linear in n with the stash index */
+BENCH(TerrainRegionBulkLoad) {
+    for (const size_t count : { 10'000u, 100'000u }) {
+        std::mt19937 rng(2);
+        std::vector<AABB> bounds;
+        for (size_t e = 0; e < count; ++e) bounds.push_back(randomBox(rng));
+
+        const double time = bench::measure([&] {
+            Region region;
+            for (uint32_t e = 0; e < count; ++e) {
+                region.updateEntity(e, bounds[e]);
+            }
+            region.update();
+            bench::doNotOptimize(region);
+        });
+        bench::report(std::to_string(count) + " entities", time, double(count));
+    }
+}
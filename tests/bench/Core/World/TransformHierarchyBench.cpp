@@ -0,0 +1,76 @@
+#include "bench/Bench.h"
+#include "Core/World/RecursiveHierarchy.h"
+
+#include <Core/World/TransformHierarchy.h>
+
+#include <random>
+
+/*
+ * A 100k node scene: a few roots, every node below one of the nodes added before it, so the levels widen like
+ * a scene of props under rooms under zones. Compares the recursive walk over children lists with the flattened
+ * hierarchy composing everything, a single moved leaf, a hundred leaves scattered over the levels, and one percent
+ * of the nodes moving each frame.
+ */
+BENCH(TransformHierarchyUpdate) {
+    constexpr size_t NODES = 100'000;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    const auto randomLocal = [&] {
+        return Transform(glm::vec3(unit(rng), unit(rng), unit(rng)), glm::vec3(1.f), glm::vec3(unit(rng), unit(rng), unit(rng)) * 0.2f);
+    };
+
+    TransformHierarchy hierarchy;
+    RecursiveHierarchy recursive;
+    std::vector<HierarchyNode> nodes;
+    std::vector<bool> isLeaf(NODES, true);
+    for (size_t n = 0; n < NODES; ++n) {
+        const size_t parentIndex = n < 8 ? n : std::uniform_int_distribution<size_t>(0, n - 1)(rng);
+        const HierarchyNode parent = n < 8 ? HierarchyNode::INVALID : nodes[parentIndex];
+        if (n >= 8) isLeaf[parentIndex] = false;
+        const Transform local = randomLocal();
+        nodes.push_back(hierarchy.add(parent, local));
+        recursive.add(nodes.back(), parent, local);
+    }
+    hierarchy.update();
+
+    const double walk = bench::measure([&] {
+        recursive.update();
+        bench::doNotOptimize(recursive.matrices);
+    });
+    const double full = bench::measure([&] {
+        for (size_t r = 0; r < 8; ++r) hierarchy.setLocal(nodes[r], recursive.locals[r]);
+        hierarchy.update();
+        bench::doNotOptimize(hierarchy.getWorldMatrices());
+    });
+
+    const HierarchyNode leaf = nodes.back();
+    const double single = bench::measure([&] {
+        hierarchy.setLocal(leaf, randomLocal());
+        hierarchy.update();
+        bench::doNotOptimize(hierarchy.getWorldMatrices());
+    });
+
+    std::vector<HierarchyNode> leaves;
+    for (size_t n = 0; n < NODES; ++n) {
+        if (isLeaf[n]) leaves.push_back(nodes[n]);
+    }
+    std::uniform_int_distribution<size_t> anyLeaf(0, leaves.size() - 1);
+    const double scattered = bench::measure([&] {
+        for (size_t m = 0; m < 100; ++m) hierarchy.setLocal(leaves[anyLeaf(rng)], randomLocal());
+        hierarchy.update();
+        bench::doNotOptimize(hierarchy.getWorldMatrices());
+    });
+
+    std::uniform_int_distribution<size_t> any(0, NODES - 1);
+    const double percent = bench::measure([&] {
+        for (size_t m = 0; m < NODES / 100; ++m) hierarchy.setLocal(nodes[any(rng)], randomLocal());
+        hierarchy.update();
+        bench::doNotOptimize(hierarchy.getWorldMatrices());
+    });
+
+    bench::report("recursive walk, every node", walk, NODES);
+    bench::report("flattened, every node", full, NODES);
+    bench::report("flattened, one dirty leaf", single);
+    bench::report("flattened, 100 scattered leaves", scattered, 100);
+    bench::report("flattened, 1% dirty", percent, NODES / 100.0);
+}
@@ -0,0 +1,187 @@
+#include "bench/Bench.h"
+#include "PointerBVH.h"
+#include "Minecraft/Voxel/TerrainChunks.h"
+
+#include <Math/BoundingVolumeHierarchy.h>
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <tbb/global_control.h>
+#include <tbb/info.h>
+
+namespace {
+    struct Box {
+        AABB bounds;
+        uint32_t id;
+
+        operator const AABB&() const {
+            return bounds;
+        }
+
+        bool operator == (const uint32_t other) const {
+            return id == other;
+        }
+    };
+
+    /* 42 x 42 chunk columns of terrain mesh to about 490k quads, close to a million collision triangles */
+    constexpr int TERRAIN_EXTENT = 42;
+    constexpr float WORLD = float(TERRAIN_EXTENT * VoxelMesher::SIZE);
+
+    /* the quads of a terrain area's voxel collision meshes, two triangles each, in world space */
+    const std::vector<Box>& collisionMesh() {
+        static const std::vector<Box> boxes = [] {
+            const TerrainArea area(TERRAIN_EXTENT);
+            std::vector<Box> quads;
+            std::vector<Quad> mesh;
+            for (size_t c = 0; c < area.chunks.size(); ++c) {
+                mesh.clear();
+                VoxelMesher::greedyMesh(*area.chunks[c], area.neighbors[c], mesh);
+
+                const glm::vec3 origin(area.coords[c] * VoxelMesher::SIZE);
+                for (const Quad& quad : mesh) {
+                    const AABB bounds = AABB::fromTo(origin + quad.aabb.min(), origin + quad.aabb.max());
+                    quads.push_back({ bounds, static_cast<uint32_t>(quads.size()) });
+                }
+            }
+            return quads;
+        }();
+        return boxes;
+    }
+
+    /* boxes around the size of an entity, anywhere over the terrain between its valleys and hilltops */
+    std::vector<AABB> makeQueries(const size_t count, const unsigned seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> position(0.f, WORLD);
+        std::uniform_real_distribution<float> height(8.f, 32.f);
+        std::vector<AABB> queries;
+        for (size_t i = 0; i < count; ++i) {
+            queries.emplace_back(glm::vec3(position(rng), height(rng), position(rng)), glm::vec3(1.f, 2.f, 1.f));
+        }
+        return queries;
+    }
+
+    /* rays from above the hills down to the bottom of the area */
+    std::vector<Ray> makeRays(const size_t count, const unsigned seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> position(0.f, WORLD);
+        std::vector<Ray> rays;
+        for (size_t i = 0; i < count; ++i) {
+            const glm::vec3 from(position(rng), 64.f, position(rng));
+            const glm::vec3 to(position(rng), 0.f, position(rng));
+            rays.push_back(Ray::cast(from, to));
+        }
+        return rays;
+    }
+
+    BVH<Box>::BuildOptions sequential() {
+        BVH<Box>::BuildOptions options(4);
+        options.taskThreshold = ~0u;
+        options.parallelBinThreshold = ~0u;
+        return options;
+    }
+}
+
+BENCH(BVHBuild) {
+    const std::vector<Box>& boxes = collisionMesh();
+
+    const double pointer = bench::measure([&] {
+        const PointerBVH<Box> tree(boxes, 4);
+        bench::doNotOptimize(tree);
+    });
+    const double flat = bench::measure([&] {
+        const BVH<Box> tree(boxes, sequential());
+        bench::doNotOptimize(tree);
+    });
+    bench::report("pointer tree, " + std::to_string(boxes.size()) + " quads", pointer, double(boxes.size()));
+    bench::report("flat array, " + std::to_string(boxes.size()) + " quads", flat, double(boxes.size()));
+}
+
+BENCH(BVHQueryAABB) {
+    const std::vector<Box>& boxes = collisionMesh();
+    const std::vector<AABB> queries = makeQueries(10'000, 3);
+    const PointerBVH<Box> pointer(boxes, 4);
+    const BVH<Box> flat(boxes, sequential());
+
+    size_t pointerHits = 0, flatHits = 0;
+    const double pointerTime = bench::measure([&] {
+        pointerHits = 0;
+        for (const AABB& query : queries) {
+            pointer.forEachIntersects(query, [&](const Box&) { ++pointerHits; return false; });
+        }
+    });
+    const double flatTime = bench::measure([&] {
+        flatHits = 0;
+        for (const AABB& query : queries) {
+            flat.forEachIntersects(query, [&](const Box&) { ++flatHits; return false; });
+        }
+    });
+    bench::report("pointer tree", pointerTime, double(queries.size()));
+    bench::report("flat array", flatTime, double(queries.size()));
+    if (pointerHits != flatHits) bench::mismatch("%zu vs %zu hits", pointerHits, flatHits);
+}
+
+BENCH(BVHClosestHit) {
+    const std::vector<Box>& boxes = collisionMesh();
+    const std::vector<Ray> rays = makeRays(10'000, 5);
+    const PointerBVH<Box> pointer(boxes, 4);
+    const BVH<Box> flat(boxes, sequential());
+
+    // the pointer tree has no closest-hit query, callers walked every hit and kept the nearest
+    double pointerSum = 0.0, flatSum = 0.0;
+    const double pointerTime = bench::measure([&] {
+        pointerSum = 0.0;
+        for (const Ray& ray : rays) {
+            float closest = std::numeric_limits<float>::infinity();
+            pointer.forEachRayIntersects(ray, [&](const Box&, const RayResult& hit) {
+                closest = std::min(closest, hit.distance);
+                return false;
+            });
+            if (closest != std::numeric_limits<float>::infinity()) pointerSum += closest;
+        }
+    });
+    const double flatTime = bench::measure([&] {
+        flatSum = 0.0;
+        for (const Ray& ray : rays) {
+            if (const auto hit = flat.raycast(ray)) flatSum += hit->distance;
+        }
+    });
+    bench::report("pointer tree, all hits", pointerTime, double(rays.size()));
+    bench::report("flat array, ordered closest hit", flatTime, double(rays.size()));
+    if (std::abs(pointerSum - flatSum) > 1e-3 * std::max(1.0, pointerSum)) {
+        bench::mismatch("%f vs %f summed distance", pointerSum, flatSum);
+    }
+}
+
+BENCH(BVHParallelBuild) {
+    const std::vector<Box>& boxes = collisionMesh();
+
+    const BVH<Box> reference(boxes, sequential());
+    const double base = bench::measure([&] {
+        const BVH<Box> tree(boxes, sequential());
+        bench::doNotOptimize(tree);
+    });
+    bench::report("sequential", base, double(boxes.size()));
+
+    const int hardware = tbb::info::default_concurrency();
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < hardware; threads *= 2) threadCounts.push_back(threads);
+    threadCounts.push_back(hardware);
+
+    for (const int threads : threadCounts) {
+        const tbb::global_control limit(tbb::global_control::max_allowed_parallelism, threads);
+        BVH<Box> tree;
+        const double time = bench::measure([&] {
+            tree.build(boxes, BVH<Box>::BuildOptions(4));
+        });
+        char label[64];
+        std::snprintf(label, sizeof(label), "tasks, %d threads (x%.2f)", threads, base / std::max(time, 1.0));
+        bench::report(label, time, double(boxes.size()));
+
+        // splits only depend on exact reductions, so scheduling must not change the tree
+        if (tree.nodeCount() != reference.nodeCount() || tree.sahCost() != reference.sahCost()) {
+            bench::mismatch("%zu nodes, SAH %f vs %zu nodes, SAH %f",
+                tree.nodeCount(), tree.sahCost(), reference.nodeCount(), reference.sahCost());
+        }
+    }
+}
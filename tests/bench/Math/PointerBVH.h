@@ -0,0 +1,161 @@
+#pragma once
+#include <Math/Shapes/geom.h>
+
+#include <deque>
+#include <vector>
+
+/*
+ * The pointer-linked BVH that the flat BoundingVolumeHierarchy replaced, reduced to what the benchmarks compare:
+ * heap nodes with parent/child pointers, a primitive vector per leaf, the 12-bucket SAH build with its
+ * quadratic sweep and recursive traversal that tests every child it reaches. Empty buckets are skipped, the
+ * original merged them in as a box at the origin, so both trees get the same splits and only the layout differs.
+ */
+template <typename Primitive>
+class PointerBVH {
+public:
+    struct Node {
+        AABB bounds;
+        Node* parent = nullptr;
+        Node* left = nullptr;
+        Node* right = nullptr;
+        std::vector<Primitive> primitives;
+
+        bool isLeaf() const {
+            return !left;
+        }
+    };
+
+    PointerBVH(std::vector<Primitive> all, const size_t maxLeafSize) {
+        if (!all.empty()) {
+            root = build(all, 0, all.size(), maxLeafSize, nullptr);
+        }
+    }
+
+    template <typename Callable>
+    void forEachIntersects(const AABB& aabb, Callable&& callable) const {
+        if (root) forEachIntersects(aabb, callable, root);
+    }
+
+    /* bool(const Primitive&, const RayResult&) -> return true to early exit */
+    template <typename Callable>
+    void forEachRayIntersects(const Ray& ray, Callable&& callable) const {
+        if (root) forEachRayIntersects(ray, callable, root);
+    }
+
+    size_t nodeCount() const {
+        return nodes.size();
+    }
+
+private:
+    std::deque<Node> nodes;
+    Node* root = nullptr;
+
+    static float bucketPosition(const AABB& centroidBounds, const glm::vec3& extent, const int axis, const glm::vec3& centroid) {
+        return 12 * (centroid[axis] - centroidBounds.min()[axis]) / (extent[axis] + 1e-5f);
+    }
+
+    Node* build(std::vector<Primitive>& all, const size_t start, const size_t end, const size_t maxLeafSize, Node* parent) {
+        Node* node = &nodes.emplace_back();
+        node->parent = parent;
+        node->bounds = all[start];
+        for (auto i = start + 1; i < end; ++i) {
+            node->bounds = geom::merge(node->bounds, all[i]);
+        }
+
+        const size_t count = end - start;
+        if (count <= maxLeafSize) {
+            node->primitives.assign(all.begin() + start, all.begin() + end);
+            return node;
+        }
+
+        glm::vec3 min(std::numeric_limits<float>::max()), max(-std::numeric_limits<float>::max());
+        for (auto i = start; i < end; ++i) {
+            const glm::vec3 centroid = geom::centroid(static_cast<const AABB&>(all[i]));
+            min = glm::min(min, centroid);
+            max = glm::max(max, centroid);
+        }
+        const AABB centroidBounds = AABB::fromTo(min, max);
+        const glm::vec3 extent = max - min;
+
+        int axis = 0;
+        if (extent.y > extent.x) axis = 1;
+        if (extent.z > extent[axis]) axis = 2;
+
+        constexpr int bucketCount = 12;
+        struct Bucket {
+            int count = 0;
+            AABB bounds;
+        } buckets[bucketCount];
+
+        auto bucketOf = [&](const Primitive& p) {
+            const int b = static_cast<int>(bucketPosition(centroidBounds, extent, axis, geom::centroid(static_cast<const AABB&>(p))));
+            return std::min(b, bucketCount - 1);
+        };
+        for (auto i = start; i < end; ++i) {
+            Bucket& bucket = buckets[bucketOf(all[i])];
+            bucket.bounds = bucket.count++ ? geom::merge(bucket.bounds, all[i]) : static_cast<const AABB&>(all[i]);
+        }
+
+        float minCost = std::numeric_limits<float>::max();
+        int minCostSplit = -1;
+        for (int i = 1; i < bucketCount; ++i) {
+            AABB b0, b1;
+            int count0 = 0, count1 = 0;
+            for (int j = 0; j < i; ++j) {
+                if (!buckets[j].count) continue;
+                b0 = count0 ? geom::merge(b0, buckets[j].bounds) : buckets[j].bounds;
+                count0 += buckets[j].count;
+            }
+            for (int j = i; j < bucketCount; ++j) {
+                if (!buckets[j].count) continue;
+                b1 = count1 ? geom::merge(b1, buckets[j].bounds) : buckets[j].bounds;
+                count1 += buckets[j].count;
+            }
+            if (!count0 || !count1) continue;
+            const float cost = 1 + (count0 * geom::surface_area(b0) + count1 * geom::surface_area(b1)) / geom::surface_area(node->bounds);
+            if (cost < minCost) {
+                minCost = cost;
+                minCostSplit = i;
+            }
+        }
+
+        const auto mid = static_cast<size_t>(std::partition(all.begin() + start, all.begin() + end,
+            [&](const Primitive& p) { return bucketOf(p) < minCostSplit; }) - all.begin());
+        if (minCost >= count || mid == start || mid == end) {
+            node->primitives.assign(all.begin() + start, all.begin() + end);
+            return node;
+        }
+
+        node->left = build(all, start, mid, maxLeafSize, node);
+        node->right = build(all, mid, end, maxLeafSize, node);
+        return node;
+    }
+
+    template <typename Callable>
+    bool forEachIntersects(const AABB& aabb, Callable& callable, const Node* node) const {
+        if (!geom::intersects(aabb, node->bounds)) return false;
+
+        if (node->isLeaf()) {
+            for (const auto& primitive : node->primitives) {
+                if (geom::intersects(aabb, static_cast<const AABB&>(primitive)) && callable(primitive)) return true;
+            }
+            return false;
+        }
+        return forEachIntersects(aabb, callable, node->left) || forEachIntersects(aabb, callable, node->right);
+    }
+
+    template <typename Callable>
+    bool forEachRayIntersects(const Ray& ray, Callable& callable, const Node* node) const {
+        if (!ray.intersects(node->bounds).hasHit()) return false;
+
+        if (node->isLeaf()) {
+            for (const auto& primitive : node->primitives) {
+                if (const RayResult result = ray.intersects(static_cast<const AABB&>(primitive)); result.hasHit()) {
+                    if (callable(primitive, result)) return true;
+                }
+            }
+            return false;
+        }
+        return forEachRayIntersects(ray, callable, node->left) || forEachRayIntersects(ray, callable, node->right);
+    }
+};
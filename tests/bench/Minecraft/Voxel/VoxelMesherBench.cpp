@@ -0,0 +1,83 @@
+#include "bench/Bench.h"
+#include "Minecraft/Voxel/SweepMesher.h"
+#include "Minecraft/Voxel/TerrainChunks.h"
+
+#include <Minecraft/Voxel/VoxelMesher.h>
+
+#include <cstdio>
+#include <tbb/global_control.h>
+#include <tbb/info.h>
+#include <tbb/parallel_for.h>
+
+namespace {
+    size_t quadCount(const std::vector<std::vector<Quad>>& meshes) {
+        size_t quads = 0;
+        for (const auto& mesh : meshes) quads += mesh.size();
+        return quads;
+    }
+}
+
+BENCH(VoxelMeshChunk) {
+    std::vector<VoxelVolume> random;
+    for (unsigned seed = 0; seed < 16; ++seed) random.push_back(randomChunk(0.5f, 4, seed));
+    std::vector<VoxelVolume> terrain;
+    for (int x = 0; x < 16; ++x) terrain.push_back(terrainChunk({ x, 1, 0 }));
+
+    for (const auto& [name, volumes] : { std::pair("random", &random), std::pair("terrain", &terrain) }) {
+        size_t sweepQuads = 0, bitmaskQuads = 0;
+        const double sweep = bench::measure([&] {
+            sweepQuads = 0;
+            for (const VoxelVolume& volume : *volumes) sweepQuads += sweepMesh(volume, glm::ivec3(VoxelMesher::SIZE)).size();
+        });
+        std::vector<Quad> quads;
+        const double bitmask = bench::measure([&] {
+            bitmaskQuads = 0;
+            for (const VoxelVolume& volume : *volumes) {
+                quads.clear();
+                VoxelMesher::greedyMesh(volume, {}, quads);
+                bitmaskQuads += quads.size();
+            }
+        });
+        bench::report(std::string(name) + ", per-cell sweep", sweep, double(volumes->size()));
+        bench::report(std::string(name) + ", bitmask", bitmask, double(volumes->size()));
+        if (sweepQuads != bitmaskQuads) bench::mismatch("%zu vs %zu quads", sweepQuads, bitmaskQuads);
+    }
+}
+
+/* every chunk of the area dirty at once, meshed into per-chunk lists as VoxelWorldSystem::onUpdate does */
+BENCH(VoxelParallelRemesh) {
+    const TerrainArea area(16);
+    const size_t count = area.chunks.size();
+    std::vector<std::vector<Quad>> meshes(count);
+
+    const double base = bench::measure([&] {
+        for (size_t i = 0; i < count; ++i) {
+            meshes[i].clear();
+            VoxelMesher::greedyMesh(*area.chunks[i], area.neighbors[i], meshes[i]);
+        }
+    });
+    const size_t reference = quadCount(meshes);
+    bench::report("sequential, " + std::to_string(reference) + " quads", base, double(count));
+
+    const int hardware = tbb::info::default_concurrency();
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < hardware; threads *= 2) threadCounts.push_back(threads);
+    threadCounts.push_back(hardware);
+
+    for (const int threads : threadCounts) {
+        const tbb::global_control limit(tbb::global_control::max_allowed_parallelism, threads);
+        const double time = bench::measure([&] {
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, count), [&](const tbb::blocked_range<size_t>& range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    meshes[i].clear();
+                    VoxelMesher::greedyMesh(*area.chunks[i], area.neighbors[i], meshes[i]);
+                }
+            });
+        });
+        char label[64];
+        std::snprintf(label, sizeof(label), "tasks, %d threads (x%.2f)", threads, base / std::max(time, 1.0));
+        bench::report(label, time, double(count));
+
+        if (quadCount(meshes) != reference) bench::mismatch("%zu vs %zu quads", quadCount(meshes), reference);
+    }
+}
@@ -0,0 +1,43 @@
+#include "bench/Bench.h"
+
+#include <Renderer/Resource/HandlePool.h>
+
+#include <random>
+#include <string>
+
+/*
+ * What the per-frame resource paths paid before handles: a lookup by name in a string map for every use, against
+ * the handle resolved once. Shader-like names of realistic length, for a small and a large set of resources,
+ * looked up in a shuffled order so neither side runs through memory in a line.
+ */
+BENCH(HandleLookup) {
+    constexpr size_t LOOKUPS = 4096;
+    for (const size_t count : { size_t(64), size_t(4096) }) {
+        HandlePool<struct BenchTag, uint32_t> pool;
+        std::vector<std::string> names;
+        std::vector<Handle<BenchTag>> handles;
+        for (size_t i = 0; i < count; ++i) {
+            names.push_back("shaders/Mesh/mesh_variant_" + std::to_string(i) + ".glsl");
+            handles.push_back(pool.insert(names.back(), static_cast<uint32_t>(i)));
+        }
+
+        std::mt19937 rng(1);
+        std::uniform_int_distribution<size_t> any(0, count - 1);
+        std::vector<size_t> order(LOOKUPS);
+        for (size_t& index : order) index = any(rng);
+
+        const double byName = bench::measure([&] {
+            uint32_t sum = 0;
+            for (const size_t index : order) sum += pool[pool.find(names[index])];
+            bench::doNotOptimize(sum);
+        });
+        const double byHandle = bench::measure([&] {
+            uint32_t sum = 0;
+            for (const size_t index : order) sum += pool[handles[index]];
+            bench::doNotOptimize(sum);
+        });
+
+        bench::report("by name, " + std::to_string(count) + " resources", byName, LOOKUPS);
+        bench::report("by handle, " + std::to_string(count) + " resources", byHandle, LOOKUPS);
+    }
+}
@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+#include <openGL/BufferObjects/PersistentBuffer.h>
+
+#include <functional>
+#include <random>
+
+namespace {
+    /*
+     * The simulated backend, with the GPU reading every frame's memory at the moment its fence completes: whether it
+     * catches up on its own or the ring waits for it. Anything overwritten before that is caught by `onComplete`.
+     */
+    class ReadingBackend final : public PersistentBackend {
+        SimulatedPersistentBackend& gpu;
+        Fence reported = 0;
+    public:
+        std::function<void(Fence)> onComplete;
+
+        explicit ReadingBackend(SimulatedPersistentBackend& gpu) : gpu(gpu) {}
+
+        Fence insertFence() override { return gpu.insertFence(); }
+        bool isSignaled(const Fence fence) override { return gpu.isSignaled(fence); }
+        void releaseFence(const Fence fence) override { gpu.releaseFence(fence); }
+        Storage createStorage(const size_t bytes) override { return gpu.createStorage(bytes); }
+        void destroyStorage(const Storage& storage) override { gpu.destroyStorage(storage); }
+        size_t alignment() const override { return gpu.alignment(); }
+
+        void wait(const Fence fence) override {
+            report(fence);
+            gpu.wait(fence);
+        }
+
+        /* the GPU finishing on its own */
+        void complete(const Fence fence) {
+            report(std::min(fence, gpu.getLastFence()));
+            gpu.complete(fence);
+        }
+    private:
+        void report(const Fence fence) {
+            for (; reported < fence; ) {
+                if (onComplete) onComplete(++reported);
+            }
+        }
+    };
+
+    struct Upload {
+        std::byte* data;
+        std::vector<std::byte> bytes;
+        unsigned buffer;
+        size_t offset;
+    };
+
+    /* frames filled with random bytes, checked when the simulated GPU reads them */
+    struct Scene {
+        SimulatedPersistentBackend gpu;
+        ReadingBackend* reading;
+        std::optional<PersistentRing> ring;
+        /* by frame, which is also the frame's fence */
+        std::vector<std::vector<Upload>> frames{ {} };
+        std::mt19937 rng{ 7 };
+        size_t checked = 0;
+
+        Scene(const size_t frameBytes, const size_t alignment = 256) : gpu(alignment) {
+            auto backend = std::make_unique<ReadingBackend>(gpu);
+            reading = backend.get();
+            reading->onComplete = [this](const FenceBackend::Fence fence) {
+                for (const Upload& upload : frames[fence]) {
+                    ASSERT_EQ(std::memcmp(upload.data, upload.bytes.data(), upload.bytes.size()), 0) << "frame " << fence << " was overwritten before the GPU read it";
+                    ++checked;
+                }
+            };
+            ring.emplace(std::move(backend), frameBytes);
+        }
+
+        void frame(const std::vector<size_t>& sizes) {
+            ring->beginFrame();
+            std::vector<Upload>& uploads = frames.emplace_back();
+            for (const size_t size : sizes) {
+                std::vector<std::byte> bytes(size);
+                for (std::byte& byte : bytes) byte = static_cast<std::byte>(rng());
+                const auto allocation = ring->upload(std::span<const std::byte>(bytes));
+                EXPECT_EQ(allocation.offset % gpu.alignment(), 0u);
+                uploads.push_back({ allocation.data, std::move(bytes), allocation.buffer, allocation.offset });
+            }
+            ring->endFrame();
+        }
+    };
+}
+
+TEST(FrameFences, FramesCompleteInOrderAndReleaseTheirFences) {
+    SimulatedPersistentBackend gpu;
+    {
+        FrameFences fences(gpu);
+        EXPECT_EQ(fences.getFrame(), 1u);
+        for (int i = 0; i < 4; ++i) fences.endFrame();
+        EXPECT_EQ(fences.getFrame(), 5u);
+        EXPECT_EQ(gpu.getLiveFences(), 4u);
+
+        // signaled fences are only collected when asked
+        gpu.complete(2);
+        EXPECT_EQ(fences.getCompleted(), 0u);
+        EXPECT_EQ(fences.poll(), 2u);
+        EXPECT_EQ(gpu.getLiveFences(), 2u);
+        EXPECT_EQ(gpu.getStalls(), 0u);
+
+        // waiting on frame 3 retires it, not frame 4
+        fences.waitFor(3);
+        EXPECT_EQ(fences.getCompleted(), 3u);
+        EXPECT_EQ(gpu.getStalls(), 1u);
+        EXPECT_EQ(gpu.getLiveFences(), 1u);
+
+        // a frame already finished does not wait
+        fences.waitFor(2);
+        EXPECT_EQ(gpu.getStalls(), 1u);
+    }
+    EXPECT_EQ(gpu.getLiveFences(), 0u);
+}
+
+TEST(PersistentRing, AGpuWithinTheFramesInFlightNeverStalls) {
+    for (const uint64_t lag : { 0u, 1u, 2u }) {
+        Scene scene(4096);
+        std::uniform_int_distribution<size_t> size(1, 700);
+        for (uint64_t frame = 1; frame <= 300; ++frame) {
+            // the GPU is `lag` frames behind the one being recorded
+            if (frame > lag + 1) scene.reading->complete(frame - lag - 1);
+            scene.frame({ size(scene.rng), size(scene.rng), size(scene.rng), size(scene.rng) });
+        }
+        EXPECT_EQ(scene.gpu.getStalls(), 0u) << lag;
+        EXPECT_EQ(scene.gpu.getLiveStorages(), 1u);
+        EXPECT_EQ(scene.ring->getFrameCapacity(), 4096u);
+
+        scene.reading->complete(scene.gpu.getLastFence());
+        EXPECT_EQ(scene.checked, 300u * 4u) << lag;
+    }
+}
+
+TEST(PersistentRing, ASlowGpuStallsOnlyForTheOldestFrame) {
+    Scene scene(1024);
+    for (uint64_t frame = 1; frame <= 3; ++frame) scene.frame({ 512 });
+    EXPECT_EQ(scene.gpu.getStalls(), 0u);
+
+    // the fourth frame reuses the first frame's region, which the GPU has not finished
+    scene.frame({ 512 });
+    EXPECT_EQ(scene.gpu.getStalls(), 1u);
+    EXPECT_TRUE(scene.gpu.isSignaled(1));
+    EXPECT_FALSE(scene.gpu.isSignaled(2));
+
+    for (uint64_t frame = 5; frame <= 100; ++frame) scene.frame({ 300, 300 });
+    EXPECT_EQ(scene.gpu.getStalls(), 97u);
+
+    scene.reading->complete(scene.gpu.getLastFence());
+    EXPECT_EQ(scene.checked, 4u + 96u * 2u);
+}
+
+TEST(PersistentRing, FramesInFlightNeverShareMemory) {
+    constexpr uint32_t FRAMES = PersistentRing::DEFAULT_FRAMES;
+    Scene scene(2048, 64);
+    std::uniform_int_distribution<size_t> size(1, 400);
+    for (uint64_t frame = 1; frame <= 200; ++frame) {
+        if (frame > 2) scene.reading->complete(frame - 2);
+        scene.frame({ size(scene.rng), size(scene.rng), size(scene.rng) });
+    }
+
+    for (size_t frame = 1; frame + FRAMES - 1 < scene.frames.size(); ++frame) {
+        for (size_t other = frame + 1; other < frame + FRAMES; ++other) {
+            for (const Upload& a : scene.frames[frame]) {
+                for (const Upload& b : scene.frames[other]) {
+                    const bool overlap = a.offset < b.offset + b.bytes.size() && b.offset < a.offset + a.bytes.size();
+                    ASSERT_FALSE(a.buffer == b.buffer && overlap) << "frames " << frame << " and " << other;
+                }
+            }
+        }
+    }
+}
+
+TEST(PersistentRing, OutgrownFramesMoveToLargerStorage) {
+    Scene scene(1024);
+    scene.frame({ 512 });
+    scene.frame({ 512 });
+    const unsigned first = scene.ring->getBuffer();
+
+    // the third frame needs more than its region: the early upload stays in the old storage, the rest goes to the new
+    scene.frame({ 800, 800, 800 });
+    const std::vector<Upload>& grown = scene.frames.back();
+    EXPECT_EQ(grown[0].buffer, first);
+    EXPECT_NE(grown[1].buffer, first);
+    EXPECT_EQ(grown[2].buffer, grown[1].buffer);
+    EXPECT_GE(scene.ring->getFrameCapacity(), 2048u);
+    EXPECT_EQ(scene.gpu.getLiveStorages(), 2u);
+    EXPECT_EQ(scene.gpu.getStalls(), 0u);
+
+    // the new storage's regions were never used, so the next frame does not wait for frame 1 although it is unfinished
+    scene.frame({ 100 });
+    EXPECT_EQ(scene.gpu.getStalls(), 0u);
+
+    // the old storage lives until the frames reading it finished
+    scene.reading->complete(2);
+    scene.frame({ 100 });
+    EXPECT_EQ(scene.gpu.getLiveStorages(), 2u);
+    scene.reading->complete(4);
+    scene.frame({ 1500 });
+    EXPECT_EQ(scene.gpu.getLiveStorages(), 1u);
+    EXPECT_EQ(scene.gpu.getStalls(), 0u);
+
+    scene.reading->complete(scene.gpu.getLastFence());
+    EXPECT_EQ(scene.checked, 2u + 3u + 3u);
+
+    scene.ring.reset();
+    EXPECT_EQ(scene.gpu.getLiveStorages(), 0u);
+    EXPECT_EQ(scene.gpu.getLiveFences(), 0u);
+}
+
+TEST(PersistentRing, AllocationsHonourTheStricterAlignment) {
+    SimulatedPersistentBackend* gpu;
+    auto backend = std::make_unique<SimulatedPersistentBackend>(16);
+    gpu = backend.get();
+    PersistentRing ring(std::move(backend), 1024);
+
+    ring.beginFrame();
+    const auto a = ring.allocate(3);
+    const auto b = ring.allocate(5, 64);
+    const auto c = ring.allocate(1);
+    EXPECT_EQ(a.offset % 16, 0u);
+    EXPECT_EQ(b.offset % 64, 0u);
+    EXPECT_EQ(c.offset % 16, 0u);
+    EXPECT_GE(b.offset, a.offset + 3);
+    EXPECT_GE(c.offset, b.offset + 5);
+    EXPECT_EQ(ring.getFrameUsage(), c.offset + 1 - a.offset);
+    ring.endFrame();
+    EXPECT_EQ(gpu->getLiveFences(), 1u);
+}
@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+#include <openGL/Texture/MipChain.h>
+
+#include <cmath>
+#include <numbers>
+#include <random>
+
+namespace {
+    struct Image {
+        int width;
+        int height;
+        int channels;
+        std::vector<unsigned char> pixels;
+
+        unsigned char at(const int x, const int y, const int c) const {
+            return pixels[(static_cast<size_t>(y) * width + x) * channels + c];
+        }
+    };
+
+    TextureData textureOf(const Image& image) {
+        return TextureData("reference", image.pixels.data(), image.width, image.height, image.channels);
+    }
+
+    /* the test images: smooth, hard edged, noisy, and a pixel checkerboard that aliases to anything but gray */
+    Image pattern(const int width, const int height, const int channels, const unsigned seed) {
+        Image image{ width, height, channels, std::vector<unsigned char>(static_cast<size_t>(width) * height * channels) };
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> noise(0, 255);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const double u = (x + 0.5) / width, v = (y + 0.5) / height;
+                const unsigned char values[4] = {
+                    static_cast<unsigned char>(std::lround(127.5 + 127.5 * std::sin(6.0 * u + 4.0 * v * v))),
+                    static_cast<unsigned char>((x / 3 + y / 5) % 2 ? 230 : 20),
+                    static_cast<unsigned char>(noise(rng)),
+                    static_cast<unsigned char>((x + y) % 2 ? 255 : 0),
+                };
+                for (int c = 0; c < channels; ++c) {
+                    image.pixels[(static_cast<size_t>(y) * width + x) * channels + c] = values[c];
+                }
+            }
+        }
+        return image;
+    }
+
+    /* the box filter as specified: 2x2 averages rounded to nearest, a trailing odd row or column joins the last output */
+    Image boxReference(const Image& source) {
+        const int width = std::max(source.width / 2, 1), height = std::max(source.height / 2, 1);
+        Image out{ width, height, source.channels, std::vector<unsigned char>(static_cast<size_t>(width) * height * source.channels) };
+        const auto taps = [](const int i, const int size, const int outSize) {
+            if (size == 1) return std::pair(0, 1);
+            return std::pair(2 * i, i == outSize - 1 && size % 2 ? 3 : 2);
+        };
+        for (int y = 0; y < height; ++y) {
+            const auto [firstRow, rows] = taps(y, source.height, height);
+            for (int x = 0; x < width; ++x) {
+                const auto [firstColumn, columns] = taps(x, source.width, width);
+                for (int c = 0; c < source.channels; ++c) {
+                    int sum = 0;
+                    for (int sy = firstRow; sy < firstRow + rows; ++sy) {
+                        for (int sx = firstColumn; sx < firstColumn + columns; ++sx) sum += source.at(sx, sy, c);
+                    }
+                    const int n = rows * columns;
+                    out.pixels[(static_cast<size_t>(y) * width + x) * source.channels + c] = static_cast<unsigned char>((sum + n / 2) / n);
+                }
+            }
+        }
+        return out;
+    }
+
+    /* the Kaiser windowed sinc in double precision, every level from the unrounded level above */
+    std::vector<Image> kaiserReference(const Image& image) {
+        constexpr int RADIUS = 6;
+        constexpr double ALPHA = 4.0;
+        const auto i0 = [](const double x) {
+            double sum = 1.0, term = 1.0;
+            for (int k = 1; k < 40; ++k) {
+                term *= x * x / (4.0 * k * k);
+                sum += term;
+            }
+            return sum;
+        };
+        std::vector<double> weights(2 * RADIUS);
+        double total = 0.0;
+        for (int i = 0; i < 2 * RADIUS; ++i) {
+            const double t = (i - RADIUS + 0.5) / 2.0;
+            const double r = t / (RADIUS / 2.0);
+            weights[i] = std::sin(std::numbers::pi * t) / (std::numbers::pi * t) * i0(ALPHA * std::sqrt(1.0 - r * r)) / i0(ALPHA);
+            total += weights[i];
+        }
+        for (double& weight : weights) weight /= total;
+
+        int width = image.width, height = image.height;
+        const int channels = image.channels;
+        std::vector<double> current(image.pixels.begin(), image.pixels.end());
+        std::vector<Image> levels;
+        while (width > 1 || height > 1) {
+            const int outWidth = std::max(width / 2, 1), outHeight = std::max(height / 2, 1);
+            std::vector<double> columns(static_cast<size_t>(width) * outHeight * channels);
+            for (int y = 0; y < outHeight; ++y) {
+                for (int j = 0; j < width * channels; ++j) {
+                    double sum = 0.0;
+                    for (int i = 0; i < 2 * RADIUS; ++i) {
+                        const int row = height > 1 ? std::clamp(2 * y + i - RADIUS + 1, 0, height - 1) : 0;
+                        sum += (height > 1 ? weights[i] : (i == 0)) * current[static_cast<size_t>(row) * width * channels + j];
+                    }
+                    columns[static_cast<size_t>(y) * width * channels + j] = sum;
+                }
+            }
+            std::vector<double> next(static_cast<size_t>(outWidth) * outHeight * channels);
+            for (int y = 0; y < outHeight; ++y) {
+                for (int x = 0; x < outWidth; ++x) {
+                    for (int c = 0; c < channels; ++c) {
+                        double sum = 0.0;
+                        for (int i = 0; i < 2 * RADIUS; ++i) {
+                            const int column = width > 1 ? std::clamp(2 * x + i - RADIUS + 1, 0, width - 1) : 0;
+                            sum += (width > 1 ? weights[i] : (i == 0)) * columns[(static_cast<size_t>(y) * width + column) * channels + c];
+                        }
+                        next[(static_cast<size_t>(y) * outWidth + x) * channels + c] = sum;
+                    }
+                }
+            }
+
+            Image& level = levels.emplace_back(Image{ outWidth, outHeight, channels, {} });
+            for (const double value : next) level.pixels.push_back(static_cast<unsigned char>(std::clamp(std::lround(value), 0l, 255l)));
+            current = std::move(next);
+            width = outWidth;
+            height = outHeight;
+        }
+        return levels;
+    }
+
+    struct Size {
+        int width;
+        int height;
+        int channels;
+    };
+
+    /* even, odd, thin and single pixel images in every channel count, the SIMD paths at 4 channels included */
+    constexpr Size SIZES[] = {
+        { 64, 64, 4 }, { 37, 10, 4 }, { 33, 17, 3 }, { 128, 2, 2 }, { 1, 33, 1 }, { 5, 1, 4 }, { 3, 3, 4 }, { 1, 1, 4 }, { 20, 31, 1 }
+    };
+}
+
+TEST(MipChain, LevelsFollowTheStorageChain) {
+    EXPECT_EQ(MipChain::levelCount(1, 1), 1);
+    EXPECT_EQ(MipChain::levelCount(2, 1), 2);
+    EXPECT_EQ(MipChain::levelCount(256, 256), 9);
+    EXPECT_EQ(MipChain::levelCount(257, 3), 9);
+
+    const MipChain chain = MipChain::generate(textureOf(pattern(37, 10, 3, 1)));
+    const std::vector<std::pair<int, int>> expected = { { 37, 10 }, { 18, 5 }, { 9, 2 }, { 4, 1 }, { 2, 1 }, { 1, 1 } };
+    ASSERT_EQ(chain.levels(), static_cast<int>(expected.size()));
+    size_t bytes = 0;
+    for (int level = 0; level < chain.levels(); ++level) {
+        EXPECT_EQ(chain.level(level).width, expected[level].first) << level;
+        EXPECT_EQ(chain.level(level).height, expected[level].second) << level;
+        EXPECT_EQ(chain.pixels(level).size(), static_cast<size_t>(expected[level].first) * expected[level].second * 3) << level;
+        bytes += chain.pixels(level).size();
+    }
+    EXPECT_EQ(chain.bytes(), bytes);
+}
+
+TEST(MipChain, BoxMatchesAHandComputedImage) {
+    const Image image{ 4, 4, 1, {
+          0,  10,  20,  30,
+         40,  50,  60,  70,
+        100, 100,   0,   0,
+        100, 104,   0,   2,
+    } };
+    const MipChain chain = MipChain::generate(textureOf(image));
+    ASSERT_EQ(chain.levels(), 3);
+    const auto level1 = chain.pixels(1), level2 = chain.pixels(2);
+    EXPECT_EQ(std::vector(level1.begin(), level1.end()), (std::vector<unsigned char>{ 25, 45, 101, 1 }));
+    EXPECT_EQ(std::vector(level2.begin(), level2.end()), (std::vector<unsigned char>{ 43 }));
+
+    // odd sides fold their last row and column into the last output
+    const Image odd{ 3, 2, 1, { 0, 3, 6, 9, 12, 16 } };
+    const MipChain folded = MipChain::generate(textureOf(odd));
+    ASSERT_EQ(folded.levels(), 2);
+    EXPECT_EQ(folded.pixels(1)[0], 8);
+}
+
+TEST(MipChain, BoxMatchesTheReferenceExactly) {
+    for (const Size size : SIZES) {
+        SCOPED_TRACE(testing::Message() << size.width << "x" << size.height << "x" << size.channels);
+        Image expected = pattern(size.width, size.height, size.channels, 2);
+        const MipChain chain = MipChain::generate(textureOf(expected), MipFilter::BOX);
+
+        for (int level = 1; level < chain.levels(); ++level) {
+            expected = boxReference(expected);
+            const auto actual = chain.pixels(level);
+            ASSERT_EQ(actual.size(), expected.pixels.size()) << level;
+            for (size_t i = 0; i < actual.size(); ++i) {
+                ASSERT_EQ(actual[i], expected.pixels[i]) << "level " << level << " byte " << i;
+            }
+        }
+    }
+}
+
+TEST(MipChain, KaiserMatchesTheReferenceWithinRounding) {
+    for (const Size size : SIZES) {
+        SCOPED_TRACE(testing::Message() << size.width << "x" << size.height << "x" << size.channels);
+        const Image image = pattern(size.width, size.height, size.channels, 3);
+        const MipChain chain = MipChain::generate(textureOf(image), MipFilter::KAISER);
+        const std::vector<Image> expected = kaiserReference(image);
+
+        ASSERT_EQ(chain.levels(), static_cast<int>(expected.size()) + 1);
+        for (int level = 1; level < chain.levels(); ++level) {
+            const auto actual = chain.pixels(level);
+            ASSERT_EQ(actual.size(), expected[level - 1].pixels.size()) << level;
+            for (size_t i = 0; i < actual.size(); ++i) {
+                ASSERT_LE(std::abs(actual[i] - expected[level - 1].pixels[i]), 1) << "level " << level << " byte " << i;
+            }
+        }
+    }
+}
+
+TEST(MipChain, FlatImagesStayFlatAndCheckerboardsTurnGray) {
+    for (const MipFilter filter : { MipFilter::BOX, MipFilter::KAISER }) {
+        Image flat{ 19, 12, 4, std::vector<unsigned char>(19 * 12 * 4, 77) };
+        const MipChain chain = MipChain::generate(textureOf(flat), filter);
+        for (int level = 1; level < chain.levels(); ++level) {
+            for (const unsigned char value : chain.pixels(level)) ASSERT_EQ(value, 77) << level;
+        }
+
+        // a pixel checkerboard has no frequency a smaller level can show, so every pixel is its mean; the box
+        // averages it out exactly, the Kaiser taps only away from the edges, where clamping breaks the pattern
+        const Image checker = pattern(64, 64, 4, 4);
+        const MipChain checkers = MipChain::generate(textureOf(checker), filter);
+        const MipChain::Level& level = checkers.level(1);
+        const int margin = filter == MipFilter::BOX ? 0 : 3;
+        for (int y = margin; y < level.height - margin; ++y) {
+            for (int x = margin; x < level.width - margin; ++x) {
+                ASSERT_NEAR(checkers.pixels(1)[(static_cast<size_t>(y) * level.width + x) * 4 + 3], 127.5, 1.0) << x << ", " << y;
+            }
+        }
+    }
+}
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include <openGL/Texture/TextureLoader.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+    /* 3 x 2 RGBA PNG, stored without compression so the bytes can be read off */
+    constexpr unsigned char RGBA_PNG[] = {
+        0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52,
+        0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x02, 0x08, 0x06, 0x00, 0x00, 0x00, 0x9d, 0x74, 0x66,
+        0x1a, 0x00, 0x00, 0x00, 0x25, 0x49, 0x44, 0x41, 0x54, 0x78, 0x01, 0x01, 0x1a, 0x00, 0xe5, 0xff,
+        0x00, 0xff, 0x00, 0x00, 0xff, 0x00, 0xff, 0x00, 0x80, 0x00, 0x00, 0xff, 0x00, 0x00, 0x0a, 0x14,
+        0x1e, 0x28, 0x32, 0x3c, 0x46, 0x50, 0x5a, 0x64, 0x6e, 0x78, 0x69, 0x00, 0x07, 0x89, 0xcf, 0x94,
+        0x13, 0xa0, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82,
+    };
+
+    constexpr unsigned char RGBA_PIXELS[2][12] = {
+        { 255, 0, 0, 255, 0, 255, 0, 128, 0, 0, 255, 0 },
+        { 10, 20, 30, 40, 50, 60, 70, 80, 90, 100, 110, 120 },
+    };
+
+    /* 2 x 3 grayscale PNG specular map, three rows so the middle one stays put when flipped */
+    constexpr unsigned char SPECULAR_PNG[] = {
+        0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52,
+        0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x03, 0x08, 0x00, 0x00, 0x00, 0x00, 0x9c, 0x81, 0x81,
+        0x5d, 0x00, 0x00, 0x00, 0x14, 0x49, 0x44, 0x41, 0x54, 0x78, 0x01, 0x01, 0x09, 0x00, 0xf6, 0xff,
+        0x00, 0x00, 0x14, 0x00, 0x80, 0xc8, 0x00, 0xff, 0x5a, 0x08, 0x8d, 0x02, 0xb6, 0x86, 0xbc, 0xa7,
+        0x71, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82,
+    };
+
+    constexpr unsigned char SPECULAR[3][2] = { { 0, 20 }, { 128, 200 }, { 255, 90 } };
+
+    /* 2 x 2 flat RGBE Radiance image of values RGBE holds exactly */
+    constexpr unsigned char RADIANCE_HDR[] = {
+        0x23, 0x3f, 0x52, 0x41, 0x44, 0x49, 0x41, 0x4e, 0x43, 0x45, 0x0a, 0x46, 0x4f, 0x52, 0x4d, 0x41,
+        0x54, 0x3d, 0x33, 0x32, 0x2d, 0x62, 0x69, 0x74, 0x5f, 0x72, 0x6c, 0x65, 0x5f, 0x72, 0x67, 0x62,
+        0x65, 0x0a, 0x0a, 0x2d, 0x59, 0x20, 0x32, 0x20, 0x2b, 0x58, 0x20, 0x32, 0x0a, 0x80, 0x40, 0x20,
+        0x81, 0x80, 0x80, 0x80, 0x82, 0x80, 0x00, 0x00, 0x7f, 0x80, 0x80, 0x80, 0x80,
+    };
+
+    constexpr float RADIANCE[2][6] = {
+        { 1.f, 0.5f, 0.25f, 2.f, 2.f, 2.f },
+        { 0.25f, 0.f, 0.f, 0.5f, 0.5f, 0.5f },
+    };
+
+    /* a fixture written out for the loaders that take a path, named after the test so parallel runs don't share it */
+    struct FixtureFile {
+        std::string path;
+
+        FixtureFile(const std::span<const unsigned char> bytes, const char* extension) {
+            const auto* test = testing::UnitTest::GetInstance()->current_test_info();
+            path = (std::filesystem::temp_directory_path() / (std::string("idk_") + test->name() + extension)).string();
+            std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        }
+
+        ~FixtureFile() {
+            std::filesystem::remove(path);
+        }
+
+        const char* c_str() const {
+            return path.c_str();
+        }
+    };
+
+    std::vector<unsigned char> row(const TextureData& data, const int y) {
+        const size_t bytes = static_cast<size_t>(data.width) * data.channels;
+        return { data.pixels + y * bytes, data.pixels + (y + 1) * bytes };
+    }
+
+    template <size_t N>
+    std::vector<unsigned char> row(const unsigned char (&pixels)[N]) {
+        return { pixels, pixels + N };
+    }
+
+    /* what fromSpecularToPBR writes for a specular value: full AO, inverse roughness, metallic above 8% */
+    std::vector<unsigned char> pbrOf(const unsigned char spec) {
+        const float metallic = std::clamp((spec / 255.0f - 0.08f) / (1.0f - 0.08f), 0.0f, 1.0f);
+        return { 255, static_cast<unsigned char>(255 - spec), static_cast<unsigned char>(metallic * 255.0f) };
+    }
+}
+
+TEST(TextureLoader, DecodesPNGPixels) {
+    const TextureData data = TextureLoader::decode(RGBA_PNG, false, 0, "rgba.png");
+    ASSERT_TRUE(data);
+    EXPECT_EQ(data.path, "rgba.png");
+    EXPECT_EQ(data.width, 3);
+    EXPECT_EQ(data.height, 2);
+    EXPECT_EQ(data.channels, 4);
+    EXPECT_EQ(data.format, TextureFormat::RGBA);
+    EXPECT_EQ(row(data, 0), row(RGBA_PIXELS[0]));
+    EXPECT_EQ(row(data, 1), row(RGBA_PIXELS[1]));
+}
+
+TEST(TextureLoader, FlipReversesTheRows) {
+    const TextureData data = TextureLoader::decode(RGBA_PNG, true);
+    ASSERT_TRUE(data);
+    EXPECT_EQ(row(data, 0), row(RGBA_PIXELS[1]));
+    EXPECT_EQ(row(data, 1), row(RGBA_PIXELS[0]));
+}
+
+TEST(TextureLoader, ForcedChannelsConvertThePixels) {
+    const TextureData data = TextureLoader::decode(RGBA_PNG, false, 3);
+    ASSERT_TRUE(data);
+    EXPECT_EQ(data.channels, 3);
+    EXPECT_EQ(data.format, TextureFormat::RGB);
+    EXPECT_EQ(row(data, 1), (std::vector<unsigned char>{ 10, 20, 30, 50, 60, 70, 90, 100, 110 }));
+}
+
+TEST(TextureLoader, CorruptDataDecodesToNothing) {
+    const TextureData truncated = TextureLoader::decode(std::span(RGBA_PNG).first(40), false, 0, "truncated.png");
+    EXPECT_FALSE(truncated);
+    EXPECT_EQ(truncated.width, 0);
+
+    constexpr unsigned char garbage[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    EXPECT_FALSE(TextureLoader::decode(garbage));
+}
+
+TEST(TextureLoader, LoadReadsWhatDecodeDoes) {
+    const FixtureFile file(RGBA_PNG, ".png");
+    for (const bool flip : { false, true }) {
+        const TextureData loaded = TextureLoader::load(file.c_str(), flip);
+        const TextureData decoded = TextureLoader::decode(RGBA_PNG, flip);
+        ASSERT_TRUE(loaded);
+        EXPECT_EQ(loaded.path, file.path);
+        for (int y = 0; y < 2; ++y) EXPECT_EQ(row(loaded, y), row(decoded, y)) << flip;
+    }
+    EXPECT_FALSE(TextureLoader::load((file.path + ".missing").c_str()));
+}
+
+TEST(TextureLoader, LoadsRadianceAsFloats) {
+    const FixtureFile file(RADIANCE_HDR, ".hdr");
+    for (const bool flip : { false, true }) {
+        const TextureData data = TextureLoader::loadf(file.c_str(), flip);
+        ASSERT_TRUE(data);
+        ASSERT_NE(data.floatPixels, nullptr);
+        EXPECT_EQ(data.width, 2);
+        EXPECT_EQ(data.height, 2);
+        EXPECT_EQ(data.channels, 3);
+        for (int y = 0; y < 2; ++y) {
+            const float* expected = RADIANCE[flip ? 1 - y : y];
+            EXPECT_TRUE(std::equal(expected, expected + 6, data.floatPixels + y * 6)) << "row " << y << " flip " << flip;
+        }
+    }
+}
+
+TEST(TextureLoader, SpecularMapsFlipWithoutTheGlobalFlag) {
+    const FixtureFile file(SPECULAR_PNG, ".png");
+    for (const bool flip : { false, true }) {
+        const TextureData pbr = TextureLoader::fromSpecularToPBR(file.c_str(), flip);
+        ASSERT_TRUE(pbr);
+        EXPECT_EQ(pbr.width, 2);
+        EXPECT_EQ(pbr.height, 3);
+        EXPECT_EQ(pbr.channels, 3);
+        for (int y = 0; y < 3; ++y) {
+            const auto& source = SPECULAR[flip ? 2 - y : y];
+            std::vector<unsigned char> expected = pbrOf(source[0]);
+            std::ranges::copy(pbrOf(source[1]), std::back_inserter(expected));
+            EXPECT_EQ(row(pbr, y), expected) << "row " << y << " flip " << flip;
+        }
+    }
+
+    // flipping one load must not leak into the next, as stbi_set_flip_vertically_on_load would
+    const TextureData after = TextureLoader::decode(RGBA_PNG);
+    EXPECT_EQ(row(after, 0), row(RGBA_PIXELS[0]));
+}
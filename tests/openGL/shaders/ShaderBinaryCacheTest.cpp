@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include <openGL/shaders/ShaderBinaryCache.h>
+
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <random>
+
+namespace {
+    namespace fs = std::filesystem;
+
+    /* the Header fields in ShaderBinaryCache.cpp, by offset */
+    constexpr size_t VERSION_OFFSET = 4;
+    constexpr size_t HEADER_SIZE = 32;
+
+    /* the store of a cache in memory, shared with the test after the cache took ownership */
+    struct MemoryStore final : ShaderBinaryStore {
+        struct Files {
+            std::map<std::string, std::vector<std::byte>, std::less<>> entries;
+            size_t loads = 0;
+            size_t stores = 0;
+            bool failing = false;
+        };
+        std::shared_ptr<Files> files = std::make_shared<Files>();
+
+        std::optional<std::vector<std::byte>> load(const std::string_view name) override {
+            ++files->loads;
+            const auto it = files->entries.find(name);
+            if (it == files->entries.end()) return std::nullopt;
+            return it->second;
+        }
+
+        bool store(const std::string_view name, const std::span<const std::byte> bytes) override {
+            ++files->stores;
+            if (files->failing) return false;
+            files->entries[std::string(name)] = std::vector(bytes.begin(), bytes.end());
+            return true;
+        }
+    };
+
+    std::pair<ShaderBinaryCache, std::shared_ptr<MemoryStore::Files>> memoryCache() {
+        auto store = std::make_unique<MemoryStore>();
+        auto files = store->files;
+        return { ShaderBinaryCache(std::move(store)), files };
+    }
+
+    ShaderBinaryCache::Binary binaryOf(const size_t size, const uint32_t format = 0x8e21) {
+        ShaderBinaryCache::Binary binary;
+        binary.format = format;
+        for (size_t i = 0; i < size; ++i) binary.bytes.push_back(static_cast<std::byte>(i * 7 + 3));
+        return binary;
+    }
+
+    constexpr std::string_view DRIVER = "Vendor\nRenderer\n4.6.0 1.2.3\n";
+    constexpr ShaderBinaryCache::Stage STAGES[] = { { 0x8b31, 0x1234 }, { 0x8b30, 0x5678 } };
+}
+
+TEST(ShaderBinaryCache, InsertedProgramsAreFoundByTheirKey) {
+    auto [cache, files] = memoryCache();
+    const uint64_t key = ShaderBinaryCache::keyOf(DRIVER, STAGES);
+
+    const auto missing = cache.find(key);
+    ASSERT_FALSE(missing);
+    EXPECT_EQ(missing.error(), ShaderCacheError::CACHE_MISS);
+
+    const ShaderBinaryCache::Binary binary = binaryOf(1000);
+    ASSERT_TRUE(cache.insert(key, binary));
+    ASSERT_EQ(files->entries.size(), 1u);
+    EXPECT_EQ(files->entries.begin()->first, ShaderBinaryCache::nameOf(key));
+    EXPECT_EQ(files->entries.begin()->second.size(), HEADER_SIZE + binary.bytes.size());
+
+    const auto found = cache.find(key);
+    ASSERT_TRUE(found);
+    EXPECT_EQ(found->format, binary.format);
+    EXPECT_EQ(found->bytes, binary.bytes);
+
+    // an empty program round trips as well
+    const uint64_t other = key + 1;
+    ASSERT_TRUE(cache.insert(other, binaryOf(0)));
+    ASSERT_TRUE(cache.find(other));
+    EXPECT_TRUE(cache.find(other)->bytes.empty());
+}
+
+TEST(ShaderBinaryCache, KeysChangeWithTheDriverAndEveryStage) {
+    const uint64_t key = ShaderBinaryCache::keyOf(DRIVER, STAGES);
+    EXPECT_EQ(ShaderBinaryCache::keyOf(DRIVER, STAGES), key);
+
+    EXPECT_NE(ShaderBinaryCache::keyOf("Vendor\nRenderer\n4.6.0 1.2.4\n", STAGES), key);
+    EXPECT_NE(ShaderBinaryCache::keyOf("", STAGES), key);
+
+    std::vector stages(std::begin(STAGES), std::end(STAGES));
+    stages[1].sourceHash ^= 1;
+    EXPECT_NE(ShaderBinaryCache::keyOf(DRIVER, stages), key);
+
+    stages = { STAGES[1], STAGES[0] };
+    EXPECT_NE(ShaderBinaryCache::keyOf(DRIVER, stages), key);
+
+    stages = { STAGES[0], STAGES[1] };
+    stages[0].type = 0x91b9;
+    EXPECT_NE(ShaderBinaryCache::keyOf(DRIVER, stages), key);
+
+    stages = { STAGES[0] };
+    EXPECT_NE(ShaderBinaryCache::keyOf(DRIVER, stages), key);
+
+    EXPECT_EQ(ShaderBinaryCache::nameOf(0x0123456789abcdefull), "0123456789abcdef.bin");
+    EXPECT_EQ(ShaderBinaryCache::nameOf(0x2a), "000000000000002a.bin");
+}
+
+TEST(ShaderBinaryCache, DamagedEntriesAreRejected) {
+    auto [cache, files] = memoryCache();
+    const uint64_t key = ShaderBinaryCache::keyOf(DRIVER, STAGES);
+    ASSERT_TRUE(cache.insert(key, binaryOf(256)));
+    const std::string name = ShaderBinaryCache::nameOf(key);
+    const std::vector<std::byte> good = files->entries[name];
+
+    const auto findWith = [&](std::vector<std::byte> bytes) {
+        files->entries[name] = std::move(bytes);
+        return cache.find(key);
+    };
+
+    std::vector<std::byte> bytes = good;
+    bytes.resize(bytes.size() - 1);
+    EXPECT_EQ(findWith(bytes).error(), ShaderCacheError::CACHE_CORRUPT);
+
+    bytes.resize(HEADER_SIZE - 1);
+    EXPECT_EQ(findWith(bytes).error(), ShaderCacheError::CACHE_CORRUPT);
+    EXPECT_EQ(findWith({}).error(), ShaderCacheError::CACHE_CORRUPT);
+
+    bytes = good;
+    bytes[0] = std::byte{ 'X' };
+    EXPECT_EQ(findWith(bytes).error(), ShaderCacheError::CACHE_CORRUPT);
+
+    bytes = good;
+    const uint32_t version = ShaderBinaryCache::VERSION + 1;
+    std::memcpy(bytes.data() + VERSION_OFFSET, &version, sizeof(version));
+    EXPECT_EQ(findWith(bytes).error(), ShaderCacheError::CACHE_VERSION);
+
+    // an entry of another key under this name, as a colliding file name would give
+    EXPECT_EQ(findWith(ShaderBinaryCache::serialize(key ^ 1, binaryOf(256))).error(), ShaderCacheError::CACHE_CORRUPT);
+
+    EXPECT_TRUE(findWith(good));
+}
+
+TEST(ShaderBinaryCache, FailedWritesAndMissingStoresAreReported) {
+    auto [cache, files] = memoryCache();
+    files->failing = true;
+    const auto failed = cache.insert(1, binaryOf(16));
+    ASSERT_FALSE(failed);
+    EXPECT_EQ(failed.error(), ShaderCacheError::CACHE_WRITE_FAILED);
+    EXPECT_EQ(files->stores, 1u);
+    EXPECT_EQ(cache.find(1).error(), ShaderCacheError::CACHE_MISS);
+    EXPECT_EQ(files->loads, 1u);
+
+    // without a store the cache is off and never succeeds
+    ShaderBinaryCache disabled(nullptr);
+    EXPECT_FALSE(disabled.isEnabled());
+    EXPECT_EQ(disabled.insert(1, binaryOf(16)).error(), ShaderCacheError::CACHE_WRITE_FAILED);
+    EXPECT_EQ(disabled.find(1).error(), ShaderCacheError::CACHE_MISS);
+}
+
+TEST(ShaderBinaryCache, TheDiskStoreLeavesNoTemporaries) {
+    const fs::path directory = fs::path(testing::TempDir()) / ("idk_shader_cache_" + std::to_string(std::random_device{}())) / "nested";
+    {
+        ShaderBinaryCache cache(std::make_unique<DiskShaderBinaryStore>(directory.string()));
+        EXPECT_EQ(cache.find(7).error(), ShaderCacheError::CACHE_MISS);
+
+        ASSERT_TRUE(cache.insert(7, binaryOf(100)));
+        ASSERT_TRUE(cache.insert(7, binaryOf(300)));
+        const auto found = cache.find(7);
+        ASSERT_TRUE(found);
+        EXPECT_EQ(found->bytes, binaryOf(300).bytes);
+    }
+
+    std::vector<std::string> names;
+    for (const auto& entry : fs::directory_iterator(directory)) names.push_back(entry.path().filename().string());
+    EXPECT_EQ(names, std::vector<std::string>{ ShaderBinaryCache::nameOf(7) });
+
+    std::error_code error;
+    fs::remove_all(directory.parent_path(), error);
+}
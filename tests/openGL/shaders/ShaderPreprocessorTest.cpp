@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include <openGL/shaders/ShaderPreprocessor.h>
+
+#include <chrono>
+#include <fstream>
+#include <filesystem>
+#include <random>
+
+namespace {
+    namespace fs = std::filesystem;
+
+    struct ShaderTree {
+        fs::path path;
+
+        ShaderTree() : path(fs::path(testing::TempDir()) / ("idk_shader_tree_" + std::to_string(std::random_device{}()))) {
+            fs::create_directories(path);
+        }
+
+        ~ShaderTree() {
+            std::error_code error;
+            fs::remove_all(path, error);
+        }
+
+        std::string write(const std::string& name, const std::string& text) const {
+            const fs::path file = path / name;
+            fs::create_directories(file.parent_path());
+            std::ofstream(file, std::ios::binary | std::ios::trunc) << text;
+            return file.lexically_normal().generic_string();
+        }
+
+        std::string operator/(const std::string& name) const {
+            return (path / name).lexically_normal().generic_string();
+        }
+    };
+
+    /* the expanded text of the lines that came from `file` */
+    std::vector<uint32_t> linesOf(const ShaderSource& source, const std::string& file) {
+        std::vector<uint32_t> lines;
+        for (const ShaderSource::Line& line : source.lines) {
+            if (source.files[line.file] == file) lines.push_back(line.line);
+        }
+        return lines;
+    }
+}
+
+TEST(ShaderPreprocessor, IncludesExpandRelativeToTheIncludingFile) {
+    ShaderTree tree;
+    tree.write("common/math.glsl", "float square(float x) { return x * x; }\n");
+    tree.write("common/light.glsl", "#include \"math.glsl\"\nfloat light(float x) { return square(x); }\n");
+    const std::string root = tree.write("mesh/mesh.frag", "#version 460 core\n#include \"../common/light.glsl\"\nvoid main() {}");
+
+    ShaderPreprocessor preprocessor;
+    const auto source = preprocessor.preprocess(root);
+    ASSERT_TRUE(source) << source.error();
+
+    EXPECT_EQ(source->text,
+        "#version 460 core\n"
+        "float square(float x) { return x * x; }\n"
+        "float light(float x) { return square(x); }\n"
+        "void main() {}\n");
+    ASSERT_EQ(source->files.size(), 3u);
+    EXPECT_EQ(source->files[0], root);
+    EXPECT_EQ(source->files[1], tree / "common/light.glsl");
+    EXPECT_EQ(source->files[2], tree / "common/math.glsl");
+
+    // one origin per expanded line, the include lines themselves are gone
+    ASSERT_EQ(source->lines.size(), 4u);
+    EXPECT_EQ(linesOf(*source, root), (std::vector<uint32_t>{ 1, 3 }));
+    EXPECT_EQ(linesOf(*source, tree / "common/light.glsl"), (std::vector<uint32_t>{ 2 }));
+    EXPECT_EQ(linesOf(*source, tree / "common/math.glsl"), (std::vector<uint32_t>{ 1 }));
+    EXPECT_EQ(source->hash, ShaderPreprocessor::hash(source->text));
+}
+
+TEST(ShaderPreprocessor, GuardedFilesArePastedOncePerStage) {
+    ShaderTree tree;
+    tree.write("once.glsl", "#pragma once\nconst int ONCE = 1;\n");
+    tree.write("guarded.glsl", "// a comment above the guard\n#ifndef GUARDED\n#define GUARDED\nconst int GUARD = 2;\n#endif\n");
+    // not a whole-file guard, the last line is outside of it
+    tree.write("partial.glsl", "#ifndef PARTIAL\n#define PARTIAL\n#endif\nconst int PARTIAL_VALUE = 3;\n");
+    const std::string root = tree.write("root.glsl",
+        "#include \"once.glsl\"\n#include \"guarded.glsl\"\n#include \"partial.glsl\"\n"
+        "#include \"once.glsl\"\n#include \"guarded.glsl\"\n#include \"partial.glsl\"\n");
+
+    ShaderPreprocessor preprocessor;
+    const auto source = preprocessor.preprocess(root);
+    ASSERT_TRUE(source) << source.error();
+
+    const auto count = [&](const std::string_view needle) {
+        size_t found = 0;
+        for (size_t at = source->text.find(needle); at != std::string::npos; at = source->text.find(needle, at + 1)) ++found;
+        return found;
+    };
+    EXPECT_EQ(count("ONCE = 1"), 1u);
+    EXPECT_EQ(count("GUARD = 2"), 1u);
+    EXPECT_EQ(count("PARTIAL_VALUE = 3"), 2u);
+    EXPECT_EQ(count("#pragma once"), 0u);
+
+    // the next stage starts over, a guarded file is pasted into it again
+    const auto next = preprocessor.preprocess(root);
+    ASSERT_TRUE(next);
+    EXPECT_EQ(next->text, source->text);
+}
+
+TEST(ShaderPreprocessor, CyclesAndMissingFilesNameTheInclude) {
+    ShaderTree tree;
+    tree.write("a.glsl", "// a\n#include \"b.glsl\"\n");
+    tree.write("b.glsl", "// b\n\n#include \"a.glsl\"\n");
+    const std::string missing = tree.write("missing.glsl", "void main() {}\n#include \"nowhere.glsl\"\n");
+
+    ShaderPreprocessor preprocessor;
+    const auto cycle = preprocessor.preprocess(tree / "a.glsl");
+    ASSERT_FALSE(cycle);
+    EXPECT_NE(cycle.error().find(tree / "a.glsl" + ":2: "), std::string::npos) << cycle.error();
+    EXPECT_NE(cycle.error().find(tree / "b.glsl" + ":3: "), std::string::npos) << cycle.error();
+    EXPECT_NE(cycle.error().find("include cycle through " + tree / "a.glsl"), std::string::npos) << cycle.error();
+
+    const auto absent = preprocessor.preprocess(missing);
+    ASSERT_FALSE(absent);
+    EXPECT_EQ(absent.error(), missing + ":2: cannot open " + tree / "nowhere.glsl");
+
+    const auto root = preprocessor.preprocess(tree / "none.glsl");
+    ASSERT_FALSE(root);
+    EXPECT_EQ(root.error(), "cannot open " + tree / "none.glsl");
+}
+
+TEST(ShaderPreprocessor, FilesAreParsedOnceUntilTheyChange) {
+    ShaderTree tree;
+    const std::string shared = tree.write("shared.glsl", "const float A = 1.0;\n");
+    const std::string first = tree.write("first.glsl", "#include \"shared.glsl\"\nvoid first() {}\n");
+    const std::string second = tree.write("second.glsl", "#include \"shared.glsl\"\nvoid second() {}\n");
+
+    ShaderPreprocessor preprocessor;
+    const auto before = preprocessor.preprocess(first);
+    ASSERT_TRUE(before);
+    ASSERT_TRUE(preprocessor.preprocess(second));
+    EXPECT_EQ(preprocessor.cachedFiles(), 3u);
+
+    // the same size, only the write time tells the edit apart
+    const auto written = fs::last_write_time(shared);
+    tree.write("shared.glsl", "const float A = 2.0;\n");
+    fs::last_write_time(shared, written + std::chrono::seconds(5));
+
+    const auto after = preprocessor.preprocess(first);
+    ASSERT_TRUE(after);
+    EXPECT_NE(after->text.find("A = 2.0"), std::string::npos);
+    EXPECT_NE(after->hash, before->hash);
+    EXPECT_EQ(preprocessor.cachedFiles(), 3u);
+
+    // a file removed from disk is dropped from the cache rather than served stale
+    fs::remove(shared);
+    EXPECT_FALSE(preprocessor.preprocess(second));
+    EXPECT_EQ(preprocessor.cachedFiles(), 2u);
+
+    preprocessor.clear();
+    EXPECT_EQ(preprocessor.cachedFiles(), 0u);
+}
+
+TEST(ShaderPreprocessor, DriverLogsPointAtTheIncludeLine) {
+    ShaderTree tree;
+    const std::string include = tree.write("lib.glsl", "float a;\nfloat b;\n");
+    const std::string root = tree.write("root.glsl", "#version 460 core\n#include \"lib.glsl\"\nvoid main() {}\n");
+
+    ShaderPreprocessor preprocessor;
+    const auto source = preprocessor.preprocess(root);
+    ASSERT_TRUE(source);
+
+    // NVIDIA writes 0(line), Mesa and AMD 0:line
+    EXPECT_EQ(source->mapLog("0(3) : error C1008: undefined variable"), include + ":2 : error C1008: undefined variable");
+    EXPECT_EQ(source->mapLog("ERROR: 0:4: 'x' : undeclared identifier"), "ERROR: " + root + ":3: 'x' : undeclared identifier");
+    EXPECT_EQ(source->mapLog("0:1(10): error\n0(2) : warning"), root + ":1(10): error\n" + include + ":1 : warning");
+
+    // anything that is not a position in this source is left alone
+    EXPECT_EQ(source->mapLog("0(99) : error"), "0(99) : error");
+    EXPECT_EQ(source->mapLog("10(2) : error, x0:2"), "10(2) : error, x0:2");
+    EXPECT_EQ(source->mapLog("0(2 : error"), "0(2 : error");
+}